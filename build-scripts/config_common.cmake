@@ -141,7 +141,12 @@ else ()
   message ("     WAMR AOT disabled")
 endif ()
 if (WAMR_BUILD_FAST_JIT EQUAL 1)
-  message ("     WAMR Fast JIT enabled")
+  if (WAMR_BUILD_FAST_JIT_TIER_UP EQUAL 1)
+    add_definitions("-DWASM_ENABLE_FAST_JIT_TIER_UP=1")
+    message ("     WAMR Fast JIT enabled with Tier-up Compilation")
+  else ()
+    message ("     WAMR Fast JIT enabled")
+  endif ()
 else ()
   message ("     WAMR Fast JIT disabled")
 endif ()
@@ -153,6 +158,9 @@ if (WAMR_BUILD_JIT EQUAL 1)
   else ()
     message ("     WAMR LLVM ORC JIT enabled with Eager Compilation")
   endif ()
+  if (WAMR_BUILD_FAST_JIT EQUAL 1)
+    message ("     WAMR Fast JIT tiers up to LLVM ORC JIT for hot functions")
+  endif ()
 else ()
   message ("     WAMR LLVM ORC JIT disabled")
 endif ()
@@ -175,6 +183,25 @@ else ()
   add_definitions (-DWASM_ENABLE_FAST_INTERP=0)
   message ("     Fast interpreter disabled")
 endif ()
+if (WAMR_BUILD_LAZY_PREPARE EQUAL 1)
+  if ((WAMR_BUILD_FAST_INTERP EQUAL 1) AND (WAMR_BUILD_INTERP EQUAL 1))
+    add_definitions (-DWASM_ENABLE_LAZY_PREPARE=1)
+    message ("     Lazy bytecode preparation enabled")
+  else ()
+    message ("     Lazy bytecode preparation disabled due to fast interpreter disabled")
+  endif ()
+endif ()
+if (WAMR_BUILD_BLOCK_ADDR_TABLE EQUAL 1)
+  if ((WAMR_BUILD_FAST_INTERP EQUAL 0) AND (WAMR_BUILD_INTERP EQUAL 1))
+    add_definitions (-DWASM_ENABLE_BLOCK_ADDR_TABLE=1)
+    message ("     Block address table enabled")
+    if (DEFINED WAMR_BLOCK_ADDR_TABLE_BUDGET)
+      add_definitions (-DBLOCK_ADDR_TABLE_BUDGET=${WAMR_BLOCK_ADDR_TABLE_BUDGET})
+    endif ()
+  else ()
+    message ("     Block address table disabled due to classic interpreter disabled")
+  endif ()
+endif ()
 if (WAMR_BUILD_MULTI_MODULE EQUAL 1)
   add_definitions (-DWASM_ENABLE_MULTI_MODULE=1)
   message ("     Multiple modules enabled")
@@ -241,6 +268,14 @@ if (WAMR_BUILD_PERF_PROFILING EQUAL 1)
   add_definitions (-DWASM_ENABLE_PERF_PROFILING=1)
   message ("     Performance profiling enabled")
 endif ()
+if (WAMR_BUILD_SAMPLING_PROFILER EQUAL 1)
+  add_definitions (-DWASM_ENABLE_SAMPLING_PROFILER=1)
+  message ("     Sampling profiler enabled")
+endif ()
+if (WAMR_BUILD_AOT_PGO EQUAL 1)
+  add_definitions (-DWASM_ENABLE_AOT_PGO=1)
+  message ("     AOT PGO enabled")
+endif ()
 if (DEFINED WAMR_APP_THREAD_STACK_SIZE_MAX)
   add_definitions (-DAPP_THREAD_STACK_SIZE_MAX=${WAMR_APP_THREAD_STACK_SIZE_MAX})
 endif ()
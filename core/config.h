@@ -120,6 +120,43 @@
 #define FAST_JIT_DEFAULT_CODE_CACHE_SIZE 10 * 1024 * 1024
 #endif
 
+/* Save the jitted code of functions into the directory set with
+   RuntimeInitArgs and reuse it in the later runs */
+#ifndef WASM_ENABLE_FAST_JIT_DISK_CACHE
+#define WASM_ENABLE_FAST_JIT_DISK_CACHE 0
+#endif
+
+/* Build the global linear scan register allocator of Fast JIT, which is
+   experimental and isn't benchmarked yet */
+#ifndef WASM_ENABLE_FAST_JIT_LINEAR_SCAN
+#define WASM_ENABLE_FAST_JIT_LINEAR_SCAN 0
+#endif
+
+/* Maximum number of the threads to compile functions with Fast JIT in
+   background, the number used is set with RuntimeInitArgs */
+#ifndef FAST_JIT_MAX_COMPILE_THREAD_NUM
+#define FAST_JIT_MAX_COMPILE_THREAD_NUM 16
+#endif
+
+/* Run functions in the classic interpreter first and compile them with
+   Fast JIT once they become hot */
+#ifndef WASM_ENABLE_FAST_JIT_TIER_UP
+#define WASM_ENABLE_FAST_JIT_TIER_UP 0
+#endif
+
+/* Default hotness threshold (calls plus loop back-edges) of a function
+   to trigger Fast JIT compilation in tier-up mode */
+#ifndef FAST_JIT_DEFAULT_TIER_UP_THRESHOLD
+#define FAST_JIT_DEFAULT_TIER_UP_THRESHOLD 1000
+#endif
+
+/* Default call count of a function in Fast JIT code to request LLVM JIT
+   to compile it in background, only valid when both Fast JIT and LLVM
+   JIT are enabled */
+#ifndef LLVM_JIT_DEFAULT_TIER_UP_THRESHOLD
+#define LLVM_JIT_DEFAULT_TIER_UP_THRESHOLD 1000
+#endif
+
 #ifndef WASM_ENABLE_WAMR_COMPILER
 #define WASM_ENABLE_WAMR_COMPILER 0
 #endif
@@ -231,6 +268,39 @@
 #define WASM_DEBUG_PREPROCESSOR 0
 #endif
 
+/* Only validate the functions when loading a module, and translate the
+   bytecode of a function for the fast interpreter when it is called the
+   first time */
+#ifndef WASM_ENABLE_LAZY_PREPARE
+#define WASM_ENABLE_LAZY_PREPARE 0
+#endif
+
+#if WASM_ENABLE_FAST_INTERP == 0
+/* Lazy preparation is only supported by the fast interpreter */
+#undef WASM_ENABLE_LAZY_PREPARE
+#define WASM_ENABLE_LAZY_PREPARE 0
+#endif
+
+/* Build a table of the else and end addresses of the blocks of each
+   function when loading a module, so that the classic interpreter finds
+   them without looking up the block address cache */
+#ifndef WASM_ENABLE_BLOCK_ADDR_TABLE
+#define WASM_ENABLE_BLOCK_ADDR_TABLE 0
+#endif
+
+#if WASM_ENABLE_FAST_INTERP != 0
+/* The fast interpreter resolves the block addresses when loading */
+#undef WASM_ENABLE_BLOCK_ADDR_TABLE
+#define WASM_ENABLE_BLOCK_ADDR_TABLE 0
+#endif
+
+/* Maximum number of the threads to validate and prepare the function
+   bodies with when loading a wasm module, the number used is set with
+   RuntimeInitArgs */
+#ifndef WASM_LOADER_MAX_THREAD_NUM
+#define WASM_LOADER_MAX_THREAD_NUM 64
+#endif
+
 /* Enable opcode counter or not */
 #ifndef WASM_ENABLE_OPCODE_COUNTER
 #define WASM_ENABLE_OPCODE_COUNTER 0
@@ -272,6 +342,36 @@
 #define WASM_ENABLE_PERF_PROFILING 0
 #endif
 
+/* Sample the wasm call stacks with the profiling timer and aggregate
+   the samples into folded stacks */
+#ifndef WASM_ENABLE_SAMPLING_PROFILER
+#define WASM_ENABLE_SAMPLING_PROFILER 0
+#endif
+
+/* Default sampling interval of the sampling profiler, in microseconds
+   of the CPU time consumed */
+#ifndef SAMPLING_PROFILER_DEFAULT_INTERVAL
+#define SAMPLING_PROFILER_DEFAULT_INTERVAL 10000
+#endif
+
+/* Max number of the frames recorded in a sample, the outermost frames
+   beyond it are dropped */
+#ifndef SAMPLING_PROFILER_MAX_STACK_DEPTH
+#define SAMPLING_PROFILER_MAX_STACK_DEPTH 64
+#endif
+
+/* Number of the samples buffered by the signal handler before they
+   are symbolized and aggregated */
+#ifndef SAMPLING_PROFILER_BUFFER_SIZE
+#define SAMPLING_PROFILER_BUFFER_SIZE 1024
+#endif
+
+/* Record the profile data of the AOT module instrumented by
+   wamrc --enable-llvm-pgo */
+#ifndef WASM_ENABLE_AOT_PGO
+#define WASM_ENABLE_AOT_PGO 0
+#endif
+
 /* Dump call stack */
 #ifndef WASM_ENABLE_DUMP_CALL_STACK
 #define WASM_ENABLE_DUMP_CALL_STACK 0
@@ -397,6 +497,12 @@
 #endif
 #define BLOCK_ADDR_CONFLICT_SIZE 2
 
+/* Maximum total size in bytes of the block address tables of a module,
+   the functions whose tables don't fit in it use the block address cache */
+#ifndef BLOCK_ADDR_TABLE_BUDGET
+#define BLOCK_ADDR_TABLE_BUDGET (1024 * 1024)
+#endif
+
 /* Default max thread num per cluster. Can be overwrite by
     wasm_runtime_set_max_thread_num */
 #define CLUSTER_MAX_THREAD_NUM 4
@@ -512,6 +512,10 @@ load_native_symbol_section(const uint8 *buf, const uint8 *buf_end,
                                     "missing native symbol: %s", symbol);
                     goto fail;
                 }
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+                if (module->native_symbol_list[i] == (void *)aot_alloc_frame)
+                    module->has_aux_stack_frame = true;
+#endif
             }
         }
     }
@@ -649,6 +653,31 @@ fail:
 #endif /* WASM_ENABLE_CUSTOM_NAME_SECTION != 0 */
 }
 
+#if WASM_ENABLE_AOT_PGO != 0
+static bool
+load_pgo_section(const uint8 *buf, const uint8 *buf_end, AOTModule *module,
+                 char *error_buf, uint32 error_buf_size)
+{
+    const uint8 *p = buf, *p_end = buf_end;
+    uint64 total_size;
+
+    read_uint32(p, p_end, module->pgo_counter_count);
+    read_uint64(p, p_end, module->pgo_module_hash);
+
+    if (module->pgo_counter_count > 0) {
+        total_size = sizeof(uint64) * (uint64)module->pgo_counter_count;
+        if (!(module->pgo_counters =
+                  loader_malloc(total_size, error_buf, error_buf_size))) {
+            return false;
+        }
+    }
+
+    return true;
+fail:
+    return false;
+}
+#endif
+
 static bool
 load_custom_section(const uint8 *buf, const uint8 *buf_end, AOTModule *module,
                     bool is_load_from_file_buf, char *error_buf,
@@ -672,6 +701,18 @@ load_custom_section(const uint8 *buf, const uint8 *buf_end, AOTModule *module,
                                    error_buf, error_buf_size))
                 goto fail;
             break;
+        case AOT_CUSTOM_SECTION_PGO:
+#if WASM_ENABLE_AOT_PGO != 0
+            if (!load_pgo_section(buf, buf_end, module, error_buf,
+                                  error_buf_size))
+                goto fail;
+            break;
+#else
+            set_error_buf(error_buf, error_buf_size,
+                          "PGO instrumented AOT file isn't supported, "
+                          "please rebuild runtime with WAMR_BUILD_AOT_PGO=1");
+            goto fail;
+#endif
 #if WASM_ENABLE_LOAD_CUSTOM_SECTION != 0
         case AOT_CUSTOM_SECTION_RAW:
         {
@@ -1283,6 +1324,9 @@ load_import_funcs(const uint8 **p_buf, const uint8 *buf_end, AOTModule *module,
             module_name, field_name, import_funcs[i].func_type,
             &import_funcs[i].signature, &import_funcs[i].attachment,
             &import_funcs[i].call_conv_raw);
+        if (import_funcs[i].func_ptr_linked && !import_funcs[i].call_conv_raw)
+            import_funcs[i].call_shape = wasm_runtime_get_native_call_shape(
+                import_funcs[i].func_type, import_funcs[i].signature);
 
 #if WASM_ENABLE_LIBC_WASI != 0
         if (!strcmp(import_funcs[i].module_name, "wasi_unstable")
@@ -1944,6 +1988,11 @@ do_text_relocation(AOTModule *module, AOTRelocationGroup *group,
                             "resolve symbol %s failed", symbol);
             goto check_symbol_fail;
         }
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+        else if (symbol_addr == (void *)aot_alloc_frame) {
+            module->has_aux_stack_frame = true;
+        }
+#endif
 
         if (symbol != symbol_buf)
             wasm_runtime_free(symbol);
@@ -2807,6 +2856,63 @@ aot_load_from_aot_file(const uint8 *buf, uint32 size, char *error_buf,
     return module;
 }
 
+#ifdef OS_ENABLE_MMAP_FILE
+AOTModule *
+aot_load_from_mapped_file(const char *file_path, char *error_buf,
+                          uint32 error_buf_size)
+{
+    AOTModule *module;
+    uint8 *buf;
+    uint32 size;
+    /* The pages are copied on write: only the pages modified by the
+       loader, e.g. the ones applied relocations, become private */
+    int map_prot = MMAP_PROT_READ | MMAP_PROT_WRITE;
+#if defined(BUILD_TARGET_X86_64) || defined(BUILD_TARGET_AMD_64) \
+    || defined(BUILD_TARGET_RISCV64_LP64D)                       \
+    || defined(BUILD_TARGET_RISCV64_LP64)
+    /* aot code and data in x86_64 must be in range 0 to 2G due
+       to relocation for R_X86_64_32/32S/PC32 */
+    int map_flags = MMAP_MAP_32BIT;
+#else
+    int map_flags = MMAP_MAP_NONE;
+#endif
+
+    if (!(buf = os_mmap_file(file_path, map_prot, map_flags, &size))) {
+        set_error_buf_v(error_buf, error_buf_size, "map file %s failed",
+                        file_path);
+        return NULL;
+    }
+
+    if (!(module = create_module(error_buf, error_buf_size))) {
+        os_munmap(buf, size);
+        return NULL;
+    }
+
+    module->mapped_file = buf;
+    module->mapped_file_size = size;
+
+    if (!load(buf, size, module, error_buf, error_buf_size)) {
+        aot_unload(module);
+        return NULL;
+    }
+
+    /* The text section of indirect mode is used in place, make it
+       executable, or else the text was copied into the allocated code
+       memory and the file is only read by the runtime */
+    map_prot = MMAP_PROT_READ;
+    if (module->is_indirect_mode)
+        map_prot |= MMAP_PROT_EXEC;
+    if (os_mprotect(buf, size, map_prot) != 0) {
+        set_error_buf(error_buf, error_buf_size, "mprotect memory failed");
+        aot_unload(module);
+        return NULL;
+    }
+
+    LOG_VERBOSE("Load module from mapped file success.\n");
+    return module;
+}
+#endif
+
 void
 aot_unload(AOTModule *module)
 {
@@ -2899,6 +3005,16 @@ aot_unload(AOTModule *module)
     wasm_runtime_destroy_custom_sections(module->custom_section_list);
 #endif
 
+#if WASM_ENABLE_AOT_PGO != 0
+    if (module->pgo_counters)
+        wasm_runtime_free(module->pgo_counters);
+#endif
+
+#ifdef OS_ENABLE_MMAP_FILE
+    if (module->mapped_file)
+        os_munmap(module->mapped_file, module->mapped_file_size);
+#endif
+
     wasm_runtime_free(module);
 }
 
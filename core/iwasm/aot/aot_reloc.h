@@ -49,7 +49,8 @@ typedef struct {
 #define REG_REF_TYPES_SYM()
 #endif
 
-#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0)
+#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
 #define REG_AOT_TRACE_SYM()               \
     REG_SYM(aot_alloc_frame),             \
     REG_SYM(aot_free_frame),
@@ -57,6 +58,13 @@ typedef struct {
 #define REG_AOT_TRACE_SYM()
 #endif
 
+#if WASM_ENABLE_AOT_PGO != 0
+#define REG_AOT_PGO_SYM()                 \
+    REG_SYM(aot_pgo_record_indirect_call),
+#else
+#define REG_AOT_PGO_SYM()
+#endif
+
 #define REG_INTRINSIC_SYM()               \
     REG_SYM(aot_intrinsic_fabs_f32),      \
     REG_SYM(aot_intrinsic_fabs_f64),      \
@@ -137,6 +145,7 @@ typedef struct {
     REG_ATOMIC_WAIT_SYM()                 \
     REG_REF_TYPES_SYM()                   \
     REG_AOT_TRACE_SYM()                   \
+    REG_AOT_PGO_SYM()                     \
     REG_INTRINSIC_SYM()                   \
 
 #define CHECK_RELOC_OFFSET(data_size) do {              \
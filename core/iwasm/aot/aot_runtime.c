@@ -1097,6 +1097,12 @@ aot_instantiate(AOTModule *module, bool is_sub_inst, uint32 stack_size,
     }
 #endif
 
+#if WASM_ENABLE_AOT_PGO != 0
+    /* The counters are shared by all the instances of the module, so
+       that the profile data of the spawned threads are also recorded */
+    module_inst->pgo_counters = module->pgo_counters;
+#endif
+
     /* Execute __post_instantiate function and start function*/
     if (!execute_post_inst_function(module_inst)
         || !execute_start_function(module_inst)) {
@@ -1362,7 +1368,8 @@ aot_call_function(WASMExecEnv *exec_env, AOTFunctionInstance *function,
             cell_num += wasm_value_type_cell_num(ext_ret_types[i]);
         }
 
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
         if (!aot_alloc_frame(exec_env, function->func_index)) {
             if (argv1 != argv1_buf)
                 wasm_runtime_free(argv1);
@@ -1388,7 +1395,8 @@ aot_call_function(WASMExecEnv *exec_env, AOTFunctionInstance *function,
         }
 #endif
 
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
         aot_free_frame(exec_env);
 #endif
         if (!ret) {
@@ -1430,7 +1438,8 @@ aot_call_function(WASMExecEnv *exec_env, AOTFunctionInstance *function,
         return true;
     }
     else {
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
         if (!aot_alloc_frame(exec_env, function->func_index)) {
             return false;
         }
@@ -1450,7 +1459,8 @@ aot_call_function(WASMExecEnv *exec_env, AOTFunctionInstance *function,
         }
 #endif
 
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
         aot_free_frame(exec_env);
 #endif
 
@@ -1773,6 +1783,11 @@ aot_invoke_native(WASMExecEnv *exec_env, uint32 func_idx, uint32 argc,
             (WASMModuleInstanceCommon *)module_inst, func_ptr, func_type, argc,
             argv, import_func->wasm_c_api_with_env, attachment);
     }
+    else if (import_func->call_shape) {
+        return wasm_runtime_invoke_native_shape(exec_env, func_ptr,
+                                                import_func->call_shape,
+                                                attachment, argv, argv);
+    }
     else if (!import_func->call_conv_raw) {
         signature = import_func->signature;
         return wasm_runtime_invoke_native(exec_env, func_ptr, func_type,
@@ -2349,7 +2364,8 @@ aot_table_grow(AOTModuleInstance *module_inst, uint32 tbl_idx,
 }
 #endif /* WASM_ENABLE_REF_TYPES != 0 */
 
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
 #if WASM_ENABLE_CUSTOM_NAME_SECTION != 0
 static const char *
 lookup_func_name(const char **func_names, uint32 *func_indexes,
@@ -2376,9 +2392,9 @@ lookup_func_name(const char **func_names, uint32 *func_indexes,
 }
 #endif /* WASM_ENABLE_CUSTOM_NAME_SECTION != 0 */
 
-static const char *
-get_func_name_from_index(const AOTModuleInstance *module_inst,
-                         uint32 func_index)
+const char *
+aot_get_func_name_from_index(const AOTModuleInstance *module_inst,
+                             uint32 func_index)
 {
     const char *func_name = NULL;
     AOTModule *module = (AOTModule *)module_inst->module;
@@ -2453,8 +2469,61 @@ aot_free_frame(WASMExecEnv *exec_env)
     wasm_exec_env_free_wasm_frame(exec_env, cur_frame);
     exec_env->cur_frame = (struct WASMInterpFrame *)prev_frame;
 }
-#endif /* end of (WASM_ENABLE_DUMP_CALL_STACK != 0) \
-                 || (WASM_ENABLE_PERF_PROFILING != 0) */
+#endif /* end of (WASM_ENABLE_DUMP_CALL_STACK != 0)    \
+                 || (WASM_ENABLE_PERF_PROFILING != 0)  \
+                 || (WASM_ENABLE_SAMPLING_PROFILER != 0) */
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+uint32
+aot_sample_call_stack(WASMExecEnv *exec_env, void *pc, uint32 *func_idxes,
+                      uint32 max_depth)
+{
+    AOTModuleInstance *module_inst = (AOTModuleInstance *)exec_env->module_inst;
+    AOTModule *module = (AOTModule *)module_inst->module;
+    AOTFrame *frame = (AOTFrame *)exec_env->cur_frame;
+    uint8 *stack_bottom = exec_env->wasm_stack.s.bottom;
+    uint8 *stack_top = exec_env->wasm_stack.s.top;
+    uint8 *leaf_func_ptr = NULL;
+    uint32 depth = 0, i;
+
+    /* The frames are pushed by the AOTed code only if the module is
+       compiled with --enable-dump-call-stack or --enable-perf-profiling,
+       and then the frame chain is trusted. Otherwise only the frame of
+       the function called by the runtime is pushed, so get the innermost
+       function from the interrupted pc if it is in the code of the
+       module. The pc isn't used with frames since LLVM may inline the
+       callee into the caller and the pc doesn't match the frames. */
+    if (!module->has_aux_stack_frame && max_depth > 0
+        && (uint8 *)pc >= (uint8 *)module->code
+        && (uint8 *)pc < (uint8 *)module->code + module->code_size) {
+        for (i = 0; i < module->func_count; i++) {
+            if ((uint8 *)module->func_ptrs[i] <= (uint8 *)pc
+                && (uint8 *)module->func_ptrs[i] > leaf_func_ptr) {
+                leaf_func_ptr = module->func_ptrs[i];
+                func_idxes[0] = module->import_func_count + i;
+            }
+        }
+        if (leaf_func_ptr) {
+            /* Skip the frame of the called function if the pc is still
+               in it */
+            if (frame && (uint8 *)frame >= stack_bottom
+                && (uint8 *)frame < stack_top
+                && frame->func_index == func_idxes[0])
+                frame = frame->prev_frame;
+            depth = 1;
+        }
+    }
+
+    /* Don't follow the frames which are outside the used wasm stack, the
+       signal may interrupt the thread when it is pushing a frame */
+    while (frame && depth < max_depth && (uint8 *)frame >= stack_bottom
+           && (uint8 *)frame < stack_top) {
+        func_idxes[depth++] = frame->func_index;
+        frame = frame->prev_frame;
+    }
+    return depth;
+}
+#endif /* end of WASM_ENABLE_SAMPLING_PROFILER != 0 */
 
 #if WASM_ENABLE_DUMP_CALL_STACK != 0
 bool
@@ -2485,7 +2554,7 @@ aot_create_call_stack(struct WASMExecEnv *exec_env)
         frame.func_index = cur_frame->func_index;
         frame.func_offset = 0;
         frame.func_name_wp =
-            get_func_name_from_index(module_inst, cur_frame->func_index);
+            aot_get_func_name_from_index(module_inst, cur_frame->func_index);
 
         if (!bh_vector_append(module_inst->frames, &frame)) {
             bh_vector_destroy(module_inst->frames);
@@ -2578,7 +2647,7 @@ aot_dump_perf_profiling(const AOTModuleInstance *module_inst)
 
     os_printf("Performance profiler data:\n");
     for (i = 0; i < total_func_count; i++, perf_prof++) {
-        func_name = get_func_name_from_index(module_inst, i);
+        func_name = aot_get_func_name_from_index(module_inst, i);
 
         if (func_name)
             os_printf("  func %s, execution time: %.3f ms, execution count: %d "
@@ -2593,3 +2662,66 @@ aot_dump_perf_profiling(const AOTModuleInstance *module_inst)
     }
 }
 #endif /* end of WASM_ENABLE_PERF_PROFILING */
+
+#if WASM_ENABLE_AOT_PGO != 0
+void
+aot_pgo_record_indirect_call(uint64 *counters, uint32 func_idx)
+{
+    uint64 target = (uint64)func_idx + 1;
+    uint32 i;
+
+    for (i = 0; i < AOT_PGO_ICALL_TARGET_NUM; i++, counters += 2) {
+        if (counters[0] == target) {
+            counters[1]++;
+            return;
+        }
+        if (counters[0] == 0) {
+            /* Record a new target in the empty slot */
+            counters[0] = target;
+            counters[1] = 1;
+            return;
+        }
+    }
+
+    /* All the slots are occupied by other targets */
+    counters[0]++;
+}
+
+uint32
+aot_get_pgo_prof_data_size(const AOTModuleInstance *module_inst)
+{
+    AOTModule *module = (AOTModule *)module_inst->module;
+    uint64 total_size;
+
+    if (!module->pgo_counters)
+        return 0;
+
+    total_size = sizeof(AOTPGOProfHeader)
+                 + sizeof(uint64) * (uint64)module->pgo_counter_count;
+    return total_size < UINT32_MAX ? (uint32)total_size : 0;
+}
+
+uint32
+aot_dump_pgo_prof_data_to_buf(const AOTModuleInstance *module_inst, char *buf,
+                              uint32 len)
+{
+    AOTModule *module = (AOTModule *)module_inst->module;
+    AOTPGOProfHeader header;
+    uint32 total_size = aot_get_pgo_prof_data_size(module_inst);
+
+    if (total_size == 0 || !buf || len < total_size)
+        return 0;
+
+    header.magic = AOT_PGO_PROF_MAGIC;
+    header.version = AOT_PGO_PROF_VERSION;
+    header.module_hash = module->pgo_module_hash;
+    header.func_count = module->func_count;
+    header.counter_count = module->pgo_counter_count;
+
+    bh_memcpy_s(buf, len, &header, (uint32)sizeof(AOTPGOProfHeader));
+    bh_memcpy_s(buf + sizeof(AOTPGOProfHeader),
+                len - (uint32)sizeof(AOTPGOProfHeader), module->pgo_counters,
+                total_size - (uint32)sizeof(AOTPGOProfHeader));
+    return total_size;
+}
+#endif /* end of WASM_ENABLE_AOT_PGO */
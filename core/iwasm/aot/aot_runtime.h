@@ -31,8 +31,30 @@ typedef enum AOTCustomSectionType {
     AOT_CUSTOM_SECTION_NATIVE_SYMBOL = 1,
     AOT_CUSTOM_SECTION_ACCESS_CONTROL = 2,
     AOT_CUSTOM_SECTION_NAME = 3,
+    AOT_CUSTOM_SECTION_PGO = 4,
 } AOTCustomSectionType;
 
+/* Magic number ("WPGO") and version of the profile data dumped from
+   the PGO instrumented AOT module, which is read by wamrc --use-prof */
+#define AOT_PGO_PROF_MAGIC 0x4F475057
+#define AOT_PGO_PROF_VERSION 1
+
+/* Max number of the targets recorded for a call_indirect site, each
+   target takes two counters: function index + 1 and call count, and
+   the last counter of the site records calls to the other targets */
+#define AOT_PGO_ICALL_TARGET_NUM 4
+#define AOT_PGO_ICALL_COUNTER_NUM (AOT_PGO_ICALL_TARGET_NUM * 2 + 1)
+
+/* Header of the profile data, followed by the uint64 counters */
+typedef struct AOTPGOProfHeader {
+    uint32 magic;
+    uint32 version;
+    /* Hash of the wasm function bodies that the counters belong to */
+    uint64 module_hash;
+    uint32 func_count;
+    uint32 counter_count;
+} AOTPGOProfHeader;
+
 typedef struct AOTObjectDataSection {
     char *name;
     uint8 *data;
@@ -174,6 +196,11 @@ typedef struct AOTModule {
     uint8 *literal;
     uint32 literal_size;
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    /* whether the AOTed code calls aot_alloc_frame to push the frames */
+    bool has_aux_stack_frame;
+#endif
+
 #if defined(BH_PLATFORM_WINDOWS)
     /* extra plt data area for __ymm, __xmm and __real constants
        in Windows platform */
@@ -224,6 +251,13 @@ typedef struct AOTModule {
     /* is indirect mode or not */
     bool is_indirect_mode;
 
+#ifdef OS_ENABLE_MMAP_FILE
+    /* the AOT file mapped by aot_load_from_mapped_file(), the module
+       is loaded from it and it is unmapped when the module is unloaded */
+    uint8 *mapped_file;
+    uint32 mapped_file_size;
+#endif
+
 #if WASM_ENABLE_LIBC_WASI != 0
     WASIArguments wasi_args;
     bool import_wasi_api;
@@ -240,6 +274,13 @@ typedef struct AOTModule {
 #if WASM_ENABLE_LOAD_CUSTOM_SECTION != 0
     WASMCustomSection *custom_section_list;
 #endif
+#if WASM_ENABLE_AOT_PGO != 0
+    /* Counters of the PGO instrumented AOT code, shared by all the
+       instances of the module */
+    uint64 *pgo_counters;
+    uint32 pgo_counter_count;
+    uint64 pgo_module_hash;
+#endif
 } AOTModule;
 
 #define AOTMemoryInstance WASMMemoryInstance
@@ -296,6 +337,23 @@ AOTModule *
 aot_load_from_aot_file(const uint8 *buf, uint32 size, char *error_buf,
                        uint32 error_buf_size);
 
+#ifdef OS_ENABLE_MMAP_FILE
+/**
+ * Load a AOT module by mapping the AOT file into memory. If the AOT file
+ * is generated with indirect mode, its text section is executed in place,
+ * so the code pages are shared by all the processes loading the same file.
+ *
+ * @param file_path the path of the AOT file
+ * @param error_buf output of the error info
+ * @param error_buf_size the size of the error string
+ *
+ * @return return AOT module loaded, NULL if failed
+ */
+AOTModule *
+aot_load_from_mapped_file(const char *file_path, char *error_buf,
+                          uint32 error_buf_size);
+#endif
+
 /**
  * Load a AOT module from a specified AOT section list.
  *
@@ -527,6 +585,39 @@ aot_dump_call_stack(WASMExecEnv *exec_env, bool print, char *buf, uint32 len);
 void
 aot_dump_perf_profiling(const AOTModuleInstance *module_inst);
 
+const char *
+aot_get_func_name_from_index(const AOTModuleInstance *module_inst,
+                             uint32 func_index);
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+/**
+ * Get the call stack of the exec_env from the innermost function, it is
+ * called in the signal handler of the sampling profiler
+ *
+ * @param exec_env the exec_env interrupted by the signal
+ * @param pc the interrupted pc, NULL if unknown
+ * @param func_idxes return the function indexes
+ * @param max_depth the max number of the functions to return
+ *
+ * @return the number of the functions returned
+ */
+uint32
+aot_sample_call_stack(WASMExecEnv *exec_env, void *pc, uint32 *func_idxes,
+                      uint32 max_depth);
+#endif
+
+#if WASM_ENABLE_AOT_PGO != 0
+void
+aot_pgo_record_indirect_call(uint64 *counters, uint32 func_idx);
+
+uint32
+aot_get_pgo_prof_data_size(const AOTModuleInstance *module_inst);
+
+uint32
+aot_dump_pgo_prof_data_to_buf(const AOTModuleInstance *module_inst, char *buf,
+                              uint32 len);
+#endif
+
 const uint8 *
 aot_get_custom_section(const AOTModule *module, const char *name, uint32 *len);
 
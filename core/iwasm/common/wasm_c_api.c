@@ -2422,6 +2422,11 @@ wasm_module_serialize(wasm_module_t *module, own wasm_byte_vec_t *out)
     module_ex = module_to_module_ext(module);
     comp_ctx = ((WASMModule *)(module_ex->module_comm_rt))->comp_ctx;
     comp_data = ((WASMModule *)(module_ex->module_comm_rt))->comp_data;
+#if WASM_ENABLE_FAST_JIT != 0
+    /* The LLVM IR isn't generated until a function becomes hot */
+    if (!comp_ctx || !comp_data)
+        return;
+#endif
     bh_assert(comp_ctx != NULL && comp_data != NULL);
 
     aot_file_buf = aot_emit_aot_file_buf(comp_ctx, comp_data, &aot_file_size);
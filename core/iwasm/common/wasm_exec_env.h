@@ -93,6 +93,17 @@ typedef struct WASMExecEnv {
      * - SSE instructions.
      **/
     uint64 jit_cache[2];
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Nesting depth of the calls from interpreter to the jitted code,
+       which keep the evicted jitted code from being freed */
+    uint32 jit_code_cache_pins;
+    /* The code cache epoch when the outermost call entered the jitted
+       code, the code evicted since then isn't referenced by the thread */
+    uint64 jit_code_cache_epoch;
+    /* The list of the threads running jitted code */
+    struct WASMExecEnv *jit_code_cache_prev;
+    struct WASMExecEnv *jit_code_cache_next;
+#endif
 #endif
 
 #if WASM_ENABLE_THREAD_MGR != 0
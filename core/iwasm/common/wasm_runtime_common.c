@@ -29,6 +29,10 @@
 #endif
 #if WASM_ENABLE_FAST_JIT != 0
 #include "../fast-jit/jit_compiler.h"
+#include "../fast-jit/jit_codecache.h"
+#endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+#include "wasm_sampling_profiler.h"
 #endif
 #include "../common/wasm_c_api_internal.h"
 #include "../../version.h"
@@ -125,6 +129,12 @@ runtime_malloc(uint64 size, WASMModuleInstanceCommon *module_inst,
 static JitCompOptions jit_options = { 0 };
 #endif
 
+#if WASM_ENABLE_JIT != 0
+static LLVMJITOptions llvm_jit_options = { 0 };
+#endif
+
+static uint32 loader_thread_num = 0;
+
 #ifdef OS_ENABLE_HW_BOUND_CHECK
 /* The exec_env of thread local storage, set before calling function
    and used in signal handler, as we cannot get it from the argument
@@ -347,8 +357,20 @@ wasm_runtime_env_init()
     }
 #endif
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    if (!wasm_sampling_profiler_init()) {
+        goto fail10;
+    }
+#endif
+
     return true;
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+fail10:
+#if WASM_ENABLE_FAST_JIT != 0
+    jit_compiler_destroy();
+#endif
+#endif
 #if WASM_ENABLE_FAST_JIT != 0
 fail9:
 #if WASM_ENABLE_REF_TYPES != 0
@@ -415,6 +437,10 @@ wasm_runtime_init()
 void
 wasm_runtime_destroy()
 {
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    wasm_sampling_profiler_destroy();
+#endif
+
 #if WASM_ENABLE_REF_TYPES != 0
     wasm_externref_map_destroy();
 #endif
@@ -463,6 +489,20 @@ wasm_runtime_destroy()
     wasm_runtime_memory_destroy();
 }
 
+#if WASM_ENABLE_JIT != 0
+LLVMJITOptions
+wasm_runtime_get_llvm_jit_options(void)
+{
+    return llvm_jit_options;
+}
+#endif
+
+uint32
+wasm_runtime_get_loader_thread_num(void)
+{
+    return loader_thread_num;
+}
+
 bool
 wasm_runtime_full_init(RuntimeInitArgs *init_args)
 {
@@ -472,8 +512,24 @@ wasm_runtime_full_init(RuntimeInitArgs *init_args)
 
 #if WASM_ENABLE_FAST_JIT != 0
     jit_options.code_cache_size = init_args->fast_jit_code_cache_size;
+    jit_options.compile_thread_num = init_args->fast_jit_compile_thread_num;
+    jit_options.linear_scan_regalloc =
+        init_args->fast_jit_linear_scan_regalloc;
+    jit_options.disk_cache_dir = init_args->fast_jit_disk_cache_dir;
+    jit_options.opt_passes = init_args->fast_jit_opt_passes;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    jit_options.tier_up_threshold = init_args->fast_jit_tier_up_threshold;
+#endif
 #endif
 
+#if WASM_ENABLE_JIT != 0
+    llvm_jit_options.object_cache_dir = init_args->llvm_jit_object_cache_dir;
+#endif
+
+    loader_thread_num = init_args->loader_thread_num;
+    if (loader_thread_num > WASM_LOADER_MAX_THREAD_NUM)
+        loader_thread_num = WASM_LOADER_MAX_THREAD_NUM;
+
     if (!wasm_runtime_env_init()) {
         wasm_runtime_memory_destroy();
         return false;
@@ -1011,6 +1067,23 @@ wasm_runtime_load(uint8 *buf, uint32 size, char *error_buf,
     return NULL;
 }
 
+WASMModuleCommon *
+wasm_runtime_load_mapped_aot_file(const char *file_path, char *error_buf,
+                                  uint32 error_buf_size)
+{
+#if WASM_ENABLE_AOT != 0 && defined(OS_ENABLE_MMAP_FILE)
+    WASMModuleCommon *module_common = (WASMModuleCommon *)
+        aot_load_from_mapped_file(file_path, error_buf, error_buf_size);
+    return register_module_with_null_name(module_common, error_buf,
+                                          error_buf_size);
+#else
+    (void)file_path;
+    set_error_buf(error_buf, error_buf_size,
+                  "WASM module load failed: mapping AOT file unsupported");
+    return NULL;
+#endif
+}
+
 WASMModuleCommon *
 wasm_runtime_load_from_sections(WASMSection *section_list, bool is_aot,
                                 char *error_buf, uint32 error_buf_size)
@@ -1102,6 +1175,11 @@ void
 wasm_runtime_deinstantiate_internal(WASMModuleInstanceCommon *module_inst,
                                     bool is_sub_inst)
 {
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    /* Symbolize the samples of the module instance before destroying it */
+    wasm_sampling_profiler_flush();
+#endif
+
 #if WASM_ENABLE_INTERP != 0
     if (module_inst->module_type == Wasm_Module_Bytecode) {
         wasm_deinstantiate((WASMModuleInstance *)module_inst, is_sub_inst);
@@ -1360,6 +1438,32 @@ wasm_runtime_dump_perf_profiling(WASMModuleInstanceCommon *module_inst)
 }
 #endif
 
+#if WASM_ENABLE_AOT_PGO != 0
+uint32
+wasm_runtime_get_pgo_prof_data_size(WASMModuleInstanceCommon *module_inst)
+{
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        return aot_get_pgo_prof_data_size((AOTModuleInstance *)module_inst);
+    }
+#endif
+    return 0;
+}
+
+uint32
+wasm_runtime_dump_pgo_prof_data_to_buf(WASMModuleInstanceCommon *module_inst,
+                                       char *buf, uint32 len)
+{
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT) {
+        return aot_dump_pgo_prof_data_to_buf((AOTModuleInstance *)module_inst,
+                                             buf, len);
+    }
+#endif
+    return 0;
+}
+#endif
+
 WASMModuleInstanceCommon *
 wasm_runtime_get_module_inst(WASMExecEnv *exec_env)
 {
@@ -1681,6 +1785,9 @@ wasm_runtime_call_wasm(WASMExecEnv *exec_env,
 #if WASM_ENABLE_REF_TYPES != 0
     uint32 result_argc = 0;
 #endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    WASMExecEnv *prev_exec_env;
+#endif
 
     if (!wasm_runtime_exec_env_check(exec_env)) {
         LOG_ERROR("Invalid exec env stack info.");
@@ -1700,6 +1807,9 @@ wasm_runtime_call_wasm(WASMExecEnv *exec_env,
     param_argc = argc;
 #endif
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    prev_exec_env = wasm_sampling_profiler_enter(exec_env);
+#endif
 #if WASM_ENABLE_INTERP != 0
     if (exec_env->module_inst->module_type == Wasm_Module_Bytecode)
         ret = wasm_call_function(exec_env, (WASMFunctionInstance *)function,
@@ -1709,6 +1819,9 @@ wasm_runtime_call_wasm(WASMExecEnv *exec_env,
     if (exec_env->module_inst->module_type == Wasm_Module_AoT)
         ret = aot_call_function(exec_env, (AOTFunctionInstance *)function,
                                 param_argc, new_argv);
+#endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    wasm_sampling_profiler_leave(prev_exec_env);
 #endif
     if (!ret) {
         if (new_argv != argv) {
@@ -2879,6 +2992,42 @@ wasm_runtime_get_custom_section(WASMModuleCommon *const module_comm,
 }
 #endif /* end of WASM_ENABLE_LOAD_CUSTOM_SECTION != 0 */
 
+bool
+wasm_runtime_get_fast_jit_code_cache_info(fast_jit_code_cache_info_t *info)
+{
+#if WASM_ENABLE_FAST_JIT != 0
+    jit_code_cache_get_info(info);
+    return true;
+#else
+    (void)info;
+    return false;
+#endif
+}
+
+uint32
+wasm_runtime_get_fast_jit_pass_stats(fast_jit_pass_stats_t *stats,
+                                     uint32 count)
+{
+#if WASM_ENABLE_FAST_JIT != 0
+    return jit_compiler_get_pass_stats(stats, count);
+#else
+    (void)stats;
+    (void)count;
+    return 0;
+#endif
+}
+
+uint32
+wasm_runtime_get_fast_jit_code_size(WASMModuleCommon *const module_comm)
+{
+#if WASM_ENABLE_INTERP != 0 && WASM_ENABLE_FAST_JIT != 0
+    if (module_comm->module_type == Wasm_Module_Bytecode)
+        return jit_code_cache_get_module_code_size((WASMModule *)module_comm);
+#endif
+    (void)module_comm;
+    return 0;
+}
+
 static union {
     int a;
     char b;
@@ -4065,6 +4214,240 @@ fail:
     return ret;
 }
 
+/**
+ * The call shape of a native function whose params and result are all
+ * passed in the integer registers: the exec_env followed by at most
+ * NATIVE_SHAPE_MAX_PARAMS i32/i64 params, and a void, i32 or i64 result.
+ * The kinds of the params are decoded from the signature once when the
+ * native is linked, and then the native is called with the C function
+ * pointer of its arity, without walking the signature and marshalling
+ * the arguments for invokeNative in each call.
+ *
+ *   bits 0~2: param count
+ *   bits 3~4: result kind
+ *   bits 5~25: param kinds, 3 bits for each param
+ *   bit 31: the shape is valid
+ */
+#define NATIVE_SHAPE_MAX_PARAMS (MAX_REG_INTS - 1)
+#define NATIVE_SHAPE_VALID 0x80000000
+#define NATIVE_SHAPE_PARAM_COUNT_MASK 0x7
+#define NATIVE_SHAPE_RESULT_SHIFT 3
+#define NATIVE_SHAPE_PARAM_SHIFT 5
+#define NATIVE_SHAPE_GET_PARAM(shape, i) \
+    (((shape) >> (NATIVE_SHAPE_PARAM_SHIFT + (i)*3)) & 0x7)
+
+enum {
+    NATIVE_SHAPE_RESULT_VOID = 0,
+    NATIVE_SHAPE_RESULT_I32,
+    NATIVE_SHAPE_RESULT_I64,
+};
+
+enum {
+    NATIVE_SHAPE_PARAM_I32 = 0,
+    NATIVE_SHAPE_PARAM_I64,
+    /* pointer to one byte, '*' in signature */
+    NATIVE_SHAPE_PARAM_PTR,
+    /* pointer with length followed, "*~" in signature */
+    NATIVE_SHAPE_PARAM_PTR_LEN,
+    /* string, '$' in signature */
+    NATIVE_SHAPE_PARAM_STR,
+};
+
+typedef uint64 (*NativeShape0)(WASMExecEnv *);
+typedef uint64 (*NativeShape1)(WASMExecEnv *, uint64);
+typedef uint64 (*NativeShape2)(WASMExecEnv *, uint64, uint64);
+typedef uint64 (*NativeShape3)(WASMExecEnv *, uint64, uint64, uint64);
+typedef uint64 (*NativeShape4)(WASMExecEnv *, uint64, uint64, uint64, uint64);
+typedef uint64 (*NativeShape5)(WASMExecEnv *, uint64, uint64, uint64, uint64,
+                               uint64);
+typedef uint64 (*NativeShape6)(WASMExecEnv *, uint64, uint64, uint64, uint64,
+                               uint64, uint64);
+typedef uint64 (*NativeShape7)(WASMExecEnv *, uint64, uint64, uint64, uint64,
+                               uint64, uint64, uint64);
+
+uint32
+wasm_runtime_get_native_call_shape(const WASMType *func_type,
+                                   const char *signature)
+{
+    uint32 shape, kind, i;
+
+    if (func_type->param_count > NATIVE_SHAPE_MAX_PARAMS
+        || func_type->result_count > 1)
+        return 0;
+
+    shape = NATIVE_SHAPE_VALID | func_type->param_count;
+
+    if (func_type->result_count == 1) {
+        switch (func_type->types[func_type->param_count]) {
+            case VALUE_TYPE_I32:
+                kind = NATIVE_SHAPE_RESULT_I32;
+                break;
+            case VALUE_TYPE_I64:
+                kind = NATIVE_SHAPE_RESULT_I64;
+                break;
+            default:
+                /* float and reference results use invokeNative */
+                return 0;
+        }
+        shape |= kind << NATIVE_SHAPE_RESULT_SHIFT;
+    }
+
+    for (i = 0; i < func_type->param_count; i++) {
+        switch (func_type->types[i]) {
+            case VALUE_TYPE_I32:
+                kind = NATIVE_SHAPE_PARAM_I32;
+                if (signature && signature[i + 1] == '*')
+                    kind = signature[i + 2] == '~' ? NATIVE_SHAPE_PARAM_PTR_LEN
+                                                   : NATIVE_SHAPE_PARAM_PTR;
+                else if (signature && signature[i + 1] == '$')
+                    kind = NATIVE_SHAPE_PARAM_STR;
+                break;
+            case VALUE_TYPE_I64:
+                kind = NATIVE_SHAPE_PARAM_I64;
+                break;
+            default:
+                return 0;
+        }
+        shape |= kind << (NATIVE_SHAPE_PARAM_SHIFT + i * 3);
+    }
+
+    return shape;
+}
+
+bool
+wasm_runtime_invoke_native_shape(WASMExecEnv *exec_env, void *func_ptr,
+                                 uint32 call_shape, void *attachment,
+                                 uint32 *argv, uint32 *argv_ret)
+{
+    WASMModuleInstanceCommon *module = wasm_runtime_get_module_inst(exec_env);
+    WASMMemoryInstance *memory_inst = NULL;
+    uint64 args[NATIVE_SHAPE_MAX_PARAMS], result;
+    uint32 param_count = call_shape & NATIVE_SHAPE_PARAM_COUNT_MASK;
+    uint32 i, kind, app_offset, ptr_len;
+
+    bh_assert(call_shape & NATIVE_SHAPE_VALID);
+
+    for (i = 0; i < param_count; i++) {
+        kind = NATIVE_SHAPE_GET_PARAM(call_shape, i);
+        if (kind == NATIVE_SHAPE_PARAM_I64) {
+            args[i] = (uint64)GET_I64_FROM_ADDR(argv);
+            argv += 2;
+            continue;
+        }
+
+        app_offset = *argv++;
+        if (kind == NATIVE_SHAPE_PARAM_I32) {
+            args[i] = app_offset;
+            continue;
+        }
+
+        if (!memory_inst
+            && !(memory_inst =
+                     wasm_get_default_memory((WASMModuleInstance *)module)))
+            goto fail_out_of_bounds;
+
+        if (kind == NATIVE_SHAPE_PARAM_STR) {
+            if (!wasm_runtime_validate_app_str_addr(module, app_offset))
+                return false;
+        }
+        else {
+            /* the length follows the pointer */
+            ptr_len = kind == NATIVE_SHAPE_PARAM_PTR_LEN ? *argv : 1;
+            if (app_offset > UINT32_MAX - ptr_len
+                || app_offset + ptr_len > memory_inst->memory_data_size)
+                goto fail_out_of_bounds;
+        }
+
+        args[i] = app_offset < memory_inst->memory_data_size
+                      ? (uint64)(uintptr_t)(memory_inst->memory_data
+                                            + app_offset)
+                      : 0;
+    }
+
+    exec_env->attachment = attachment;
+    switch (param_count) {
+        case 0:
+            result = ((NativeShape0)func_ptr)(exec_env);
+            break;
+        case 1:
+            result = ((NativeShape1)func_ptr)(exec_env, args[0]);
+            break;
+        case 2:
+            result = ((NativeShape2)func_ptr)(exec_env, args[0], args[1]);
+            break;
+        case 3:
+            result =
+                ((NativeShape3)func_ptr)(exec_env, args[0], args[1], args[2]);
+            break;
+        case 4:
+            result = ((NativeShape4)func_ptr)(exec_env, args[0], args[1],
+                                              args[2], args[3]);
+            break;
+        case 5:
+            result = ((NativeShape5)func_ptr)(exec_env, args[0], args[1],
+                                              args[2], args[3], args[4]);
+            break;
+#if NATIVE_SHAPE_MAX_PARAMS > 5
+        case 6:
+            result =
+                ((NativeShape6)func_ptr)(exec_env, args[0], args[1], args[2],
+                                         args[3], args[4], args[5]);
+            break;
+        case 7:
+            result =
+                ((NativeShape7)func_ptr)(exec_env, args[0], args[1], args[2],
+                                         args[3], args[4], args[5], args[6]);
+            break;
+#endif
+        default:
+            bh_assert(0);
+            result = 0;
+            break;
+    }
+    exec_env->attachment = NULL;
+
+    switch ((call_shape >> NATIVE_SHAPE_RESULT_SHIFT) & 0x3) {
+        case NATIVE_SHAPE_RESULT_I32:
+            argv_ret[0] = (uint32)result;
+            break;
+        case NATIVE_SHAPE_RESULT_I64:
+            PUT_I64_TO_ADDR(argv_ret, result);
+            break;
+        default:
+            break;
+    }
+
+    return !wasm_runtime_get_exception(module) ? true : false;
+fail_out_of_bounds:
+    wasm_runtime_set_exception(module, "out of bounds memory access");
+    return false;
+}
+
+#else /* else of defined(BUILD_TARGET_X86_64)           \
+                 || defined(BUILD_TARGET_AMD_64)        \
+                 || defined(BUILD_TARGET_AARCH64)       \
+                 || defined(BUILD_TARGET_RISCV64_LP64D) \
+                 || defined(BUILD_TARGET_RISCV64_LP64) */
+
+uint32
+wasm_runtime_get_native_call_shape(const WASMType *func_type,
+                                   const char *signature)
+{
+    /* the natives are always called by invokeNative */
+    (void)func_type;
+    (void)signature;
+    return 0;
+}
+
+bool
+wasm_runtime_invoke_native_shape(WASMExecEnv *exec_env, void *func_ptr,
+                                 uint32 call_shape, void *attachment,
+                                 uint32 *argv, uint32 *argv_ret)
+{
+    bh_assert(0);
+    return false;
+}
+
 #endif /* end of defined(BUILD_TARGET_X86_64)           \
                  || defined(BUILD_TARGET_AMD_64)        \
                  || defined(BUILD_TARGET_AARCH64)       \
@@ -4075,6 +4458,11 @@ bool
 wasm_runtime_call_indirect(WASMExecEnv *exec_env, uint32 element_indices,
                            uint32 argc, uint32 argv[])
 {
+    bool ret = false;
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    WASMExecEnv *prev_exec_env;
+#endif
+
     if (!wasm_runtime_exec_env_check(exec_env)) {
         LOG_ERROR("Invalid exec env stack info.");
         return false;
@@ -4084,15 +4472,21 @@ wasm_runtime_call_indirect(WASMExecEnv *exec_env, uint32 element_indices,
        exec_env->native_stack_boundary must have been set, we don't set
        it again */
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    prev_exec_env = wasm_sampling_profiler_enter(exec_env);
+#endif
 #if WASM_ENABLE_INTERP != 0
     if (exec_env->module_inst->module_type == Wasm_Module_Bytecode)
-        return wasm_call_indirect(exec_env, 0, element_indices, argc, argv);
+        ret = wasm_call_indirect(exec_env, 0, element_indices, argc, argv);
 #endif
 #if WASM_ENABLE_AOT != 0
     if (exec_env->module_inst->module_type == Wasm_Module_AoT)
-        return aot_call_indirect(exec_env, 0, element_indices, argc, argv);
+        ret = aot_call_indirect(exec_env, 0, element_indices, argc, argv);
 #endif
-    return false;
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    wasm_sampling_profiler_leave(prev_exec_env);
+#endif
+    return ret;
 }
 
 static void
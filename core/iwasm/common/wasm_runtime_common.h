@@ -429,6 +429,23 @@ WASMExecEnv *
 wasm_runtime_get_exec_env_tls(void);
 #endif
 
+#if WASM_ENABLE_JIT != 0
+/* Options of LLVM JIT set with RuntimeInitArgs */
+typedef struct LLVMJITOptions {
+    /* Directory to cache the object files compiled by LLVM JIT, NULL if
+       the object files aren't cached */
+    const char *object_cache_dir;
+} LLVMJITOptions;
+
+LLVMJITOptions
+wasm_runtime_get_llvm_jit_options(void);
+#endif
+
+/* Number of the threads to prepare the function bodies with when loading
+   a wasm module, set with RuntimeInitArgs */
+uint32
+wasm_runtime_get_loader_thread_num(void);
+
 /* See wasm_export.h for description */
 WASM_RUNTIME_API_EXTERN bool
 wasm_runtime_init(void);
@@ -454,6 +471,11 @@ WASM_RUNTIME_API_EXTERN WASMModuleCommon *
 wasm_runtime_load(uint8 *buf, uint32 size, char *error_buf,
                   uint32 error_buf_size);
 
+/* See wasm_export.h for description */
+WASM_RUNTIME_API_EXTERN WASMModuleCommon *
+wasm_runtime_load_mapped_aot_file(const char *file_path, char *error_buf,
+                                  uint32 error_buf_size);
+
 /* See wasm_export.h for description */
 WASM_RUNTIME_API_EXTERN WASMModuleCommon *
 wasm_runtime_load_from_sections(WASMSection *section_list, bool is_aot,
@@ -697,6 +719,19 @@ WASM_RUNTIME_API_EXTERN const uint8 *
 wasm_runtime_get_custom_section(WASMModuleCommon *const module_comm,
                                 const char *name, uint32 *len);
 
+/* See wasm_export.h for description */
+WASM_RUNTIME_API_EXTERN bool
+wasm_runtime_get_fast_jit_code_cache_info(fast_jit_code_cache_info_t *info);
+
+/* See wasm_export.h for description */
+WASM_RUNTIME_API_EXTERN uint32
+wasm_runtime_get_fast_jit_pass_stats(fast_jit_pass_stats_t *stats,
+                                     uint32 count);
+
+/* See wasm_export.h for description */
+WASM_RUNTIME_API_EXTERN uint32
+wasm_runtime_get_fast_jit_code_size(WASMModuleCommon *const module_comm);
+
 #if WASM_ENABLE_MULTI_MODULE != 0
 WASM_RUNTIME_API_EXTERN void
 wasm_runtime_set_module_reader(const module_reader reader,
@@ -876,6 +911,20 @@ wasm_runtime_invoke_native_raw(WASMExecEnv *exec_env, void *func_ptr,
                                void *attachment, uint32 *argv, uint32 argc,
                                uint32 *ret);
 
+/**
+ * Get the call shape of a registered native function, with which it can
+ * be called by wasm_runtime_invoke_native_shape, 0 if it must be called
+ * by wasm_runtime_invoke_native.
+ */
+uint32
+wasm_runtime_get_native_call_shape(const WASMType *func_type,
+                                   const char *signature);
+
+bool
+wasm_runtime_invoke_native_shape(WASMExecEnv *exec_env, void *func_ptr,
+                                 uint32 call_shape, void *attachment,
+                                 uint32 *argv, uint32 *ret);
+
 void
 wasm_runtime_read_v128(const uint8 *bytes, uint64 *ret1, uint64 *ret2);
 
@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "wasm_sampling_profiler.h"
+#include "wasm_runtime_common.h"
+#include "bh_hashmap.h"
+#if WASM_ENABLE_INTERP != 0
+#include "../interpreter/wasm_runtime.h"
+#endif
+#if WASM_ENABLE_AOT != 0
+#include "../aot/aot_runtime.h"
+#endif
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+
+#ifndef OS_ENABLE_PROF_TIMER
+#error "Sampling profiler isn't supported by the platform"
+#endif
+
+typedef struct WASMSample {
+    /* The sequence number of the sample plus one, which is set after
+       the other fields are written by the signal handler */
+    uint32 seq;
+    uint32 depth;
+    WASMModuleInstanceCommon *module_inst;
+    /* The function indexes from the innermost frame */
+    uint32 func_idxes[SAMPLING_PROFILER_MAX_STACK_DEPTH];
+} WASMSample;
+
+/* The ring buffer of the samples, the signal handler can't take any
+   lock, so the indexes are accessed with the atomic builtins. A slot
+   is written only if it has been read, or the sample is dropped */
+static WASMSample *samples;
+static uint32 sample_write_idx;
+static uint32 sample_read_idx;
+
+/* The folded stacks and their sample counts, the folded stack is the
+   function names from the outermost frame separated by ';' */
+static HashMap *folded_stacks;
+static uint32 lost_sample_count;
+
+static korp_mutex profiler_lock;
+static korp_cond profiler_cond;
+static korp_tid flush_thread;
+static uint32 flush_interval_us;
+static bool profiler_running;
+
+/* The exec_env which the current thread is running wasm code with */
+static os_thread_local_attribute WASMExecEnv *sampling_exec_env = NULL;
+
+static void
+sampling_profiler_signal_handler(void *pc)
+{
+    WASMExecEnv *exec_env = sampling_exec_env;
+    WASMModuleInstanceCommon *module_inst;
+    WASMSample *sample;
+    uint32 seq, depth = 0;
+
+    if (!exec_env || !__atomic_load_n(&profiler_running, __ATOMIC_ACQUIRE))
+        return;
+
+    seq = __atomic_fetch_add(&sample_write_idx, 1, __ATOMIC_RELAXED);
+    if (seq - __atomic_load_n(&sample_read_idx, __ATOMIC_ACQUIRE)
+        >= SAMPLING_PROFILER_BUFFER_SIZE)
+        /* The buffer is full, the sample is counted as lost when the
+           samples are flushed */
+        return;
+
+    sample = samples + seq % SAMPLING_PROFILER_BUFFER_SIZE;
+    module_inst = exec_env->module_inst;
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode)
+        depth = wasm_sample_call_stack(exec_env, sample->func_idxes,
+                                       SAMPLING_PROFILER_MAX_STACK_DEPTH);
+#endif
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT)
+        depth = aot_sample_call_stack(exec_env, pc, sample->func_idxes,
+                                      SAMPLING_PROFILER_MAX_STACK_DEPTH);
+#endif
+    (void)pc;
+
+    sample->module_inst = module_inst;
+    sample->depth = depth;
+    __atomic_store_n(&sample->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+static const char *
+get_func_name(WASMModuleInstanceCommon *module_inst, uint32 func_idx)
+{
+#if WASM_ENABLE_INTERP != 0
+    if (module_inst->module_type == Wasm_Module_Bytecode)
+        return wasm_get_func_name_from_index(
+            (WASMModuleInstance *)module_inst, func_idx);
+#endif
+#if WASM_ENABLE_AOT != 0
+    if (module_inst->module_type == Wasm_Module_AoT)
+        return aot_get_func_name_from_index((AOTModuleInstance *)module_inst,
+                                            func_idx);
+#endif
+    return NULL;
+}
+
+static void
+add_folded_stack(const char *folded_stack, uint32 count)
+{
+    uint32 size = (uint32)strlen(folded_stack) + 1;
+    uintptr_t old_count;
+    char *key;
+
+    if ((old_count = (uintptr_t)bh_hash_map_find(folded_stacks,
+                                                 (void *)folded_stack))) {
+        bh_hash_map_update(folded_stacks, (void *)folded_stack,
+                           (void *)(old_count + count), NULL);
+        return;
+    }
+
+    if (!(key = wasm_runtime_malloc(size))) {
+        lost_sample_count += count;
+        return;
+    }
+    bh_memcpy_s(key, size, folded_stack, size);
+    if (!bh_hash_map_insert(folded_stacks, key, (void *)(uintptr_t)count)) {
+        wasm_runtime_free(key);
+        lost_sample_count += count;
+    }
+}
+
+static void
+symbolize_sample(const WASMSample *sample)
+{
+    char folded_stack[SAMPLING_PROFILER_MAX_STACK_DEPTH * 32];
+    char name_buf[16];
+    const char *name;
+    uint32 size = sizeof(folded_stack), offset = 0, i, func_idx;
+
+    for (i = sample->depth; i > 0; i--) {
+        func_idx = sample->func_idxes[i - 1];
+        name = func_idx != (uint32)-1
+                   ? get_func_name(sample->module_inst, func_idx)
+                   : "[unknown]";
+        if (!name) {
+            snprintf(name_buf, sizeof(name_buf), "$f%u", func_idx);
+            name = name_buf;
+        }
+
+        if (offset > 0 && offset < size - 1)
+            folded_stack[offset++] = ';';
+        /* ';' and ' ' are the separators of the folded stack format */
+        for (; *name && offset < size - 1; name++)
+            folded_stack[offset++] =
+                (*name == ';' || isspace((uint8)*name)) ? '_' : *name;
+    }
+    folded_stack[offset] = '\0';
+
+    /* The thread is running wasm code but no frame is found, e.g. the
+       AOT module isn't compiled with the frames and the thread is
+       running in a runtime API */
+    add_folded_stack(offset > 0 ? folded_stack : "[unknown]", 1);
+}
+
+static void
+flush_samples()
+{
+    uint32 read_idx = sample_read_idx;
+    uint32 write_idx = __atomic_load_n(&sample_write_idx, __ATOMIC_ACQUIRE);
+    WASMSample *sample;
+
+    while (read_idx != write_idx) {
+        sample = samples + read_idx % SAMPLING_PROFILER_BUFFER_SIZE;
+        if (__atomic_load_n(&sample->seq, __ATOMIC_ACQUIRE) == read_idx + 1)
+            symbolize_sample(sample);
+        else
+            /* Dropped as the buffer was full, or still being written */
+            lost_sample_count++;
+        read_idx++;
+        __atomic_store_n(&sample_read_idx, read_idx, __ATOMIC_RELEASE);
+    }
+}
+
+static void *
+flush_thread_routine(void *arg)
+{
+    (void)arg;
+
+    os_mutex_lock(&profiler_lock);
+    while (profiler_running) {
+        os_cond_reltimedwait(&profiler_cond, &profiler_lock,
+                             flush_interval_us);
+        flush_samples();
+    }
+    os_mutex_unlock(&profiler_lock);
+    return NULL;
+}
+
+bool
+wasm_sampling_profiler_init(void)
+{
+    if (os_mutex_init(&profiler_lock) != 0)
+        return false;
+
+    if (os_cond_init(&profiler_cond) != 0) {
+        os_mutex_destroy(&profiler_lock);
+        return false;
+    }
+    return true;
+}
+
+void
+wasm_sampling_profiler_destroy(void)
+{
+    wasm_runtime_stop_sampling_profiler();
+
+    if (folded_stacks) {
+        bh_hash_map_destroy(folded_stacks);
+        folded_stacks = NULL;
+    }
+    if (samples) {
+        wasm_runtime_free(samples);
+        samples = NULL;
+    }
+    os_cond_destroy(&profiler_cond);
+    os_mutex_destroy(&profiler_lock);
+}
+
+WASMExecEnv *
+wasm_sampling_profiler_enter(WASMExecEnv *exec_env)
+{
+    WASMExecEnv *prev_exec_env = sampling_exec_env;
+
+    sampling_exec_env = exec_env;
+    return prev_exec_env;
+}
+
+void
+wasm_sampling_profiler_leave(WASMExecEnv *prev_exec_env)
+{
+    sampling_exec_env = prev_exec_env;
+}
+
+void
+wasm_sampling_profiler_flush(void)
+{
+    os_mutex_lock(&profiler_lock);
+    if (folded_stacks)
+        flush_samples();
+    os_mutex_unlock(&profiler_lock);
+}
+
+bool
+wasm_runtime_start_sampling_profiler(uint32 interval_us)
+{
+    if (interval_us == 0)
+        interval_us = SAMPLING_PROFILER_DEFAULT_INTERVAL;
+
+    os_mutex_lock(&profiler_lock);
+    if (profiler_running) {
+        LOG_WARNING("Sampling profiler has been started");
+        goto fail1;
+    }
+
+    /* The buffer isn't freed until the runtime is destroyed, since a
+       pending signal may still write it after the profiler is stopped */
+    if (!samples
+        && !(samples = wasm_runtime_malloc(sizeof(WASMSample)
+                                           * SAMPLING_PROFILER_BUFFER_SIZE))) {
+        LOG_ERROR("Allocate sampling profiler buffer failed");
+        goto fail1;
+    }
+
+    if (folded_stacks)
+        bh_hash_map_destroy(folded_stacks);
+    if (!(folded_stacks = bh_hash_map_create(
+              32, false, (HashFunc)wasm_string_hash,
+              (KeyEqualFunc)wasm_string_equal, wasm_runtime_free, NULL))) {
+        LOG_ERROR("Create sampling profiler hash map failed");
+        goto fail1;
+    }
+    lost_sample_count = 0;
+    /* Discard the samples written after the profiler was stopped */
+    __atomic_store_n(&sample_read_idx,
+                     __atomic_load_n(&sample_write_idx, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+
+    /* Flush the samples before the buffer is full, even if up to 16
+       threads are sampled at the same time */
+    flush_interval_us = interval_us * (SAMPLING_PROFILER_BUFFER_SIZE / 16);
+    __atomic_store_n(&profiler_running, true, __ATOMIC_RELEASE);
+
+    if (os_thread_create(&flush_thread, flush_thread_routine, NULL,
+                         APP_THREAD_STACK_SIZE_DEFAULT)
+        != 0) {
+        LOG_ERROR("Create sampling profiler thread failed");
+        goto fail2;
+    }
+
+    if (os_prof_timer_start(interval_us, sampling_profiler_signal_handler)
+        != 0) {
+        __atomic_store_n(&profiler_running, false, __ATOMIC_RELEASE);
+        os_cond_signal(&profiler_cond);
+        os_mutex_unlock(&profiler_lock);
+        os_thread_join(flush_thread, NULL);
+        return false;
+    }
+
+    os_mutex_unlock(&profiler_lock);
+    return true;
+
+fail2:
+    __atomic_store_n(&profiler_running, false, __ATOMIC_RELEASE);
+fail1:
+    os_mutex_unlock(&profiler_lock);
+    return false;
+}
+
+void
+wasm_runtime_stop_sampling_profiler(void)
+{
+    korp_tid tid;
+
+    os_mutex_lock(&profiler_lock);
+    if (!profiler_running) {
+        os_mutex_unlock(&profiler_lock);
+        return;
+    }
+
+    os_prof_timer_stop();
+    __atomic_store_n(&profiler_running, false, __ATOMIC_RELEASE);
+    os_cond_signal(&profiler_cond);
+    tid = flush_thread;
+    os_mutex_unlock(&profiler_lock);
+
+    os_thread_join(tid, NULL);
+    wasm_sampling_profiler_flush();
+}
+
+typedef struct FoldedStackDumpCtx {
+    char *buf;
+    uint32 len;
+    uint32 size;
+} FoldedStackDumpCtx;
+
+static void
+dump_folded_stack_line(FoldedStackDumpCtx *ctx, const char *folded_stack,
+                       uintptr_t count)
+{
+    char count_buf[24];
+    uint32 stack_len = (uint32)strlen(folded_stack);
+    uint32 count_len =
+        (uint32)snprintf(count_buf, sizeof(count_buf), " %u\n", (uint32)count);
+
+    /* Only calculate the size if buf is NULL */
+    if (ctx->buf) {
+        bh_memcpy_s(ctx->buf + ctx->size, ctx->len - ctx->size, folded_stack,
+                    stack_len);
+        bh_memcpy_s(ctx->buf + ctx->size + stack_len,
+                    ctx->len - ctx->size - stack_len, count_buf, count_len);
+    }
+    ctx->size += stack_len + count_len;
+}
+
+static void
+dump_folded_stack(void *key, void *value, void *user_data)
+{
+    dump_folded_stack_line((FoldedStackDumpCtx *)user_data, (const char *)key,
+                           (uintptr_t)value);
+}
+
+static uint32
+dump_folded_stacks(char *buf, uint32 len)
+{
+    FoldedStackDumpCtx ctx = { 0 };
+
+    if (!folded_stacks)
+        return 0;
+
+    flush_samples();
+    bh_hash_map_traverse(folded_stacks, dump_folded_stack, &ctx);
+    if (lost_sample_count > 0)
+        dump_folded_stack_line(&ctx, "[lost]", lost_sample_count);
+
+    if (!buf)
+        return ctx.size;
+    if (ctx.size > len)
+        return 0;
+
+    ctx.buf = buf;
+    ctx.len = len;
+    ctx.size = 0;
+    bh_hash_map_traverse(folded_stacks, dump_folded_stack, &ctx);
+    if (lost_sample_count > 0)
+        dump_folded_stack_line(&ctx, "[lost]", lost_sample_count);
+    return ctx.size;
+}
+
+uint32
+wasm_runtime_get_sampling_profile_size(void)
+{
+    uint32 size;
+
+    os_mutex_lock(&profiler_lock);
+    size = dump_folded_stacks(NULL, 0);
+    os_mutex_unlock(&profiler_lock);
+    return size;
+}
+
+uint32
+wasm_runtime_dump_sampling_profile_to_buf(char *buf, uint32 len)
+{
+    uint32 size;
+
+    os_mutex_lock(&profiler_lock);
+    size = dump_folded_stacks(buf, len);
+    os_mutex_unlock(&profiler_lock);
+    return size;
+}
+#endif /* end of WASM_ENABLE_SAMPLING_PROFILER != 0 */
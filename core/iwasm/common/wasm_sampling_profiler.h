@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _WASM_SAMPLING_PROFILER_H
+#define _WASM_SAMPLING_PROFILER_H
+
+#include "bh_platform.h"
+#include "wasm_exec_env.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+bool
+wasm_sampling_profiler_init(void);
+
+void
+wasm_sampling_profiler_destroy(void);
+
+/**
+ * Mark that the current thread starts to run wasm code with the exec_env,
+ * the signal handler of the sampling profiler samples the wasm call stack
+ * of the exec_env
+ *
+ * @return the exec_env marked before, which should be passed to
+ *         wasm_sampling_profiler_leave when the wasm code returns
+ */
+WASMExecEnv *
+wasm_sampling_profiler_enter(WASMExecEnv *exec_env);
+
+void
+wasm_sampling_profiler_leave(WASMExecEnv *prev_exec_env);
+
+/**
+ * Symbolize and aggregate the buffered samples, it must be called
+ * before a module instance is destroyed since the samples refer to it
+ */
+void
+wasm_sampling_profiler_flush(void);
+#endif /* end of WASM_ENABLE_SAMPLING_PROFILER != 0 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of _WASM_SAMPLING_PROFILER_H */
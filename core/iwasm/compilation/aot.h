@@ -178,6 +178,8 @@ typedef struct AOTImportFunc {
     const char *signature;
     /* attachment */
     void *attachment;
+    /* call shape of the native, 0 if it is called by invokeNative */
+    uint32 call_shape;
     bool call_conv_raw;
     bool call_conv_wasm_c_api;
     bool wasm_c_api_with_env;
@@ -0,0 +1,1633 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "aot_bundle.h"
+#include "../interpreter/wasm_opcode.h"
+
+/* The index spaces remapped when linking, the first four
+   are the same as the import kinds */
+enum {
+    BUNDLE_INDEX_FUNC = IMPORT_KIND_FUNC,
+    BUNDLE_INDEX_TABLE = IMPORT_KIND_TABLE,
+    BUNDLE_INDEX_MEMORY = IMPORT_KIND_MEMORY,
+    BUNDLE_INDEX_GLOBAL = IMPORT_KIND_GLOBAL,
+    BUNDLE_INDEX_ELEM,
+    BUNDLE_INDEX_DATA,
+    BUNDLE_INDEX_TYPE,
+    BUNDLE_INDEX_NUM
+};
+
+#ifndef SECTION_TYPE_DATACOUNT
+/* the data count section is kept even if bulk memory isn't enabled,
+   the loader reports the error */
+#define SECTION_TYPE_DATACOUNT 12
+#endif
+
+#define BUNDLE_IMPORT_KIND_NUM 4
+#define BUNDLE_SECTION_NUM (SECTION_TYPE_DATACOUNT + 1)
+
+typedef struct BundleBuf {
+    uint8 *data;
+    uint32 size;
+    uint32 capacity;
+} BundleBuf;
+
+typedef struct BundleItem {
+    const uint8 *buf;
+    uint32 len;
+} BundleItem;
+
+typedef struct BundleImport {
+    const uint8 *module_name;
+    uint32 module_name_len;
+    const uint8 *field_name;
+    uint32 field_name_len;
+    uint8 kind;
+    /* raw import descriptor of table, memory and global */
+    BundleItem desc;
+    /* type index of function */
+    uint32 type_index;
+    /* index of the module which the import is resolved to,
+       -1 if it is resolved by the host */
+    int32 from_module;
+} BundleImport;
+
+typedef struct BundleExport {
+    const uint8 *name;
+    uint32 name_len;
+    uint8 kind;
+    uint32 index;
+} BundleExport;
+
+typedef struct BundleSection {
+    /* the entries following the entry count */
+    const uint8 *buf;
+    const uint8 *buf_end;
+    uint32 count;
+} BundleSection;
+
+typedef struct BundleModule {
+    const AOTBundleModule *module;
+    BundleSection sections[BUNDLE_SECTION_NUM];
+    bool has_section[BUNDLE_SECTION_NUM];
+
+    BundleItem *types;
+    uint32 type_count;
+
+    BundleImport *imports;
+    uint32 import_count;
+    /* imports of each kind in the order of the index space */
+    BundleImport **kind_imports[BUNDLE_IMPORT_KIND_NUM];
+    uint32 kind_import_counts[BUNDLE_IMPORT_KIND_NUM];
+    uint32 kind_defined_counts[BUNDLE_IMPORT_KIND_NUM];
+
+    uint32 *func_types;
+    BundleItem *globals;
+
+    BundleExport *exports;
+    uint32 export_count;
+
+    bool has_start;
+    uint32 start_func;
+
+    /* map from the index spaces of the module to the ones of the bundle */
+    uint32 *maps[BUNDLE_INDEX_NUM];
+    uint32 map_sizes[BUNDLE_INDEX_NUM];
+} BundleModule;
+
+typedef struct BundleContext {
+    BundleModule *modules;
+    uint32 module_count;
+
+    BundleItem *types;
+    uint32 type_count;
+    BundleImport **host_imports;
+    uint32 host_import_count;
+    /* the item counts of the index spaces */
+    uint32 counts[BUNDLE_INDEX_NUM];
+    /* the host import counts of the index spaces */
+    uint32 import_counts[BUNDLE_IMPORT_KIND_NUM];
+    uint32 total_import_count;
+    bool has_data_count;
+} BundleContext;
+
+static void
+bundle_buf_destroy(BundleBuf *buf)
+{
+    if (buf->data)
+        wasm_runtime_free(buf->data);
+    memset(buf, 0, sizeof(BundleBuf));
+}
+
+static bool
+bundle_buf_append(BundleBuf *buf, const void *data, uint32 len)
+{
+    uint64 capacity;
+    uint8 *data_new;
+
+    if (!buf)
+        return true;
+
+    if ((uint64)buf->size + len > buf->capacity) {
+        capacity = (uint64)buf->capacity * 2;
+        if (capacity < (uint64)buf->size + len)
+            capacity = (uint64)buf->size + len;
+        if (capacity < 256)
+            capacity = 256;
+        if (capacity >= UINT32_MAX
+            || !(data_new = wasm_runtime_malloc((uint32)capacity))) {
+            aot_set_last_error("allocate memory failed.");
+            return false;
+        }
+        if (buf->data) {
+            bh_memcpy_s(data_new, (uint32)capacity, buf->data, buf->size);
+            wasm_runtime_free(buf->data);
+        }
+        buf->data = data_new;
+        buf->capacity = (uint32)capacity;
+    }
+
+    if (len > 0) {
+        bh_memcpy_s(buf->data + buf->size, buf->capacity - buf->size, data,
+                    len);
+        buf->size += len;
+    }
+    return true;
+}
+
+static bool
+bundle_buf_append_u8(BundleBuf *buf, uint8 value)
+{
+    return bundle_buf_append(buf, &value, 1);
+}
+
+static bool
+bundle_buf_append_leb(BundleBuf *buf, uint32 value)
+{
+    uint8 bytes[5];
+    uint32 n = 0;
+
+    do {
+        bytes[n] = value & 0x7F;
+        value >>= 7;
+        if (value)
+            bytes[n] |= 0x80;
+        n++;
+    } while (value);
+
+    return bundle_buf_append(buf, bytes, n);
+}
+
+/* Append a type index of block type, which is encoded as s33 */
+static bool
+bundle_buf_append_sleb33(BundleBuf *buf, uint32 value)
+{
+    uint8 bytes[5];
+    uint64 v = value;
+    uint32 n = 0;
+
+    do {
+        bytes[n] = v & 0x7F;
+        v >>= 7;
+        /* the sign bit of the last byte must be clear */
+        if (v || (bytes[n] & 0x40))
+            bytes[n] |= 0x80;
+        n++;
+    } while (bytes[n - 1] & 0x80);
+
+    return bundle_buf_append(buf, bytes, n);
+}
+
+static bool
+check_buf(const uint8 *buf, const uint8 *buf_end, uint32 length)
+{
+    if ((uintptr_t)(buf + length) < (uintptr_t)buf
+        || (uintptr_t)(buf + length) > (uintptr_t)buf_end) {
+        aot_set_last_error("unexpected end of wasm module.");
+        return false;
+    }
+    return true;
+}
+
+static bool
+read_leb(const uint8 **p_buf, const uint8 *buf_end, uint32 maxbits,
+         uint64 *p_result)
+{
+    const uint8 *buf = *p_buf;
+    uint64 result = 0;
+    uint32 shift = 0;
+    uint8 byte;
+
+    while (true) {
+        if (!check_buf(buf, buf_end, 1))
+            return false;
+        byte = *buf++;
+        if (shift < 64)
+            result |= ((uint64)(byte & 0x7F)) << shift;
+        shift += 7;
+        if (!(byte & 0x80))
+            break;
+        if (shift >= maxbits + 7) {
+            aot_set_last_error("invalid LEB integer in wasm module.");
+            return false;
+        }
+    }
+
+    *p_buf = buf;
+    if (p_result)
+        *p_result = result;
+    return true;
+}
+
+static bool
+read_u32(const uint8 **p_buf, const uint8 *buf_end, uint32 *p_result)
+{
+    uint64 result;
+
+    if (!read_leb(p_buf, buf_end, 32, &result))
+        return false;
+    *p_result = (uint32)result;
+    return true;
+}
+
+static bool
+read_name(const uint8 **p_buf, const uint8 *buf_end, const uint8 **p_name,
+          uint32 *p_name_len)
+{
+    if (!read_u32(p_buf, buf_end, p_name_len)
+        || !check_buf(*p_buf, buf_end, *p_name_len))
+        return false;
+    *p_name = *p_buf;
+    *p_buf += *p_name_len;
+    return true;
+}
+
+static bool
+skip_limits(const uint8 **p_buf, const uint8 *buf_end)
+{
+    const uint8 *p = *p_buf;
+    uint8 flag;
+
+    if (!check_buf(p, buf_end, 1))
+        return false;
+    flag = *p++;
+    if (!read_leb(&p, buf_end, 32, NULL)
+        || ((flag & 1) && !read_leb(&p, buf_end, 32, NULL)))
+        return false;
+    *p_buf = p;
+    return true;
+}
+
+/* Read an index and append the index of the bundle, the bytes between
+   *p_copy_from and the index are appended before it */
+static bool
+remap_index(BundleModule *module, uint32 index_kind, const uint8 **p_buf,
+            const uint8 *buf_end, const uint8 **p_copy_from, BundleBuf *out)
+{
+    const uint8 *p = *p_buf;
+    uint32 index;
+
+    if (!read_u32(&p, buf_end, &index))
+        return false;
+
+    if (module) {
+        if (index >= module->map_sizes[index_kind]) {
+            aot_set_last_error_v("index %u out of range in wasm module %s.",
+                                 index,
+                                 module->module->name ? module->module->name
+                                                      : "main");
+            return false;
+        }
+        if (!bundle_buf_append(out, *p_copy_from,
+                               (uint32)(*p_buf - *p_copy_from)))
+            return false;
+        index = module->maps[index_kind][index];
+        if (!bundle_buf_append_leb(out, index))
+            return false;
+        *p_copy_from = p;
+    }
+
+    *p_buf = p;
+    return true;
+}
+
+static bool
+remap_block_type(BundleModule *module, const uint8 **p_buf,
+                 const uint8 *buf_end, const uint8 **p_copy_from,
+                 BundleBuf *out)
+{
+    const uint8 *p = *p_buf;
+    uint32 index;
+    uint8 byte;
+
+    if (!check_buf(p, buf_end, 1))
+        return false;
+
+    byte = *p;
+    if (byte == VALUE_TYPE_VOID || (byte >= 0x6F && byte <= 0x7F)) {
+        *p_buf = p + 1;
+        return true;
+    }
+
+    /* type index encoded as s33 */
+    if (!read_u32(&p, buf_end, &index))
+        return false;
+
+    if (module) {
+        if (index >= module->map_sizes[BUNDLE_INDEX_TYPE]) {
+            aot_set_last_error("invalid block type in wasm module.");
+            return false;
+        }
+        if (!bundle_buf_append(out, *p_copy_from,
+                               (uint32)(*p_buf - *p_copy_from))
+            || !bundle_buf_append_sleb33(
+                out, module->maps[BUNDLE_INDEX_TYPE][index]))
+            return false;
+        *p_copy_from = p;
+    }
+
+    *p_buf = p;
+    return true;
+}
+
+/**
+ * Rewrite the instructions until the end of the expression, the indexes
+ * of the module are replaced with the ones of the bundle. If module is
+ * NULL, the expression is only skipped.
+ */
+static bool
+rewrite_expr(BundleModule *module, const uint8 **p_buf, const uint8 *buf_end,
+             BundleBuf *out)
+{
+    const uint8 *p = *p_buf, *copy_from = p;
+    uint32 block_nested_depth = 1, opcode1, count, i;
+    uint8 opcode;
+
+#define SKIP_LEB()                               \
+    do {                                         \
+        if (!read_leb(&p, buf_end, 64, NULL))    \
+            return false;                        \
+    } while (0)
+
+#define SKIP_BYTES(n)                            \
+    do {                                         \
+        if (!check_buf(p, buf_end, n))           \
+            return false;                        \
+        p += n;                                  \
+    } while (0)
+
+#define REMAP(index_kind)                                                   \
+    do {                                                                    \
+        if (!remap_index(module, index_kind, &p, buf_end, &copy_from, out)) \
+            return false;                                                   \
+    } while (0)
+
+    while (block_nested_depth > 0) {
+        if (!check_buf(p, buf_end, 1))
+            return false;
+        opcode = *p++;
+
+        switch (opcode) {
+            case WASM_OP_BLOCK:
+            case WASM_OP_LOOP:
+            case WASM_OP_IF:
+                if (!remap_block_type(module, &p, buf_end, &copy_from, out))
+                    return false;
+                block_nested_depth++;
+                break;
+
+            case WASM_OP_END:
+                block_nested_depth--;
+                break;
+
+            case WASM_OP_BR:
+            case WASM_OP_BR_IF:
+            case WASM_OP_GET_LOCAL:
+            case WASM_OP_SET_LOCAL:
+            case WASM_OP_TEE_LOCAL:
+            case WASM_OP_MEMORY_SIZE:
+            case WASM_OP_MEMORY_GROW:
+            case WASM_OP_I32_CONST:
+            case WASM_OP_I64_CONST:
+                SKIP_LEB();
+                break;
+
+            case WASM_OP_BR_TABLE:
+                if (!read_u32(&p, buf_end, &count))
+                    return false;
+                for (i = 0; i <= count; i++)
+                    SKIP_LEB();
+                break;
+
+            case WASM_OP_CALL:
+            case WASM_OP_RETURN_CALL:
+            case WASM_OP_REF_FUNC:
+                REMAP(BUNDLE_INDEX_FUNC);
+                break;
+
+            case WASM_OP_CALL_INDIRECT:
+            case WASM_OP_RETURN_CALL_INDIRECT:
+                REMAP(BUNDLE_INDEX_TYPE);
+                REMAP(BUNDLE_INDEX_TABLE);
+                break;
+
+            case WASM_OP_SELECT_T:
+                if (!read_u32(&p, buf_end, &count))
+                    return false;
+                SKIP_BYTES(count);
+                break;
+
+            case WASM_OP_GET_GLOBAL:
+            case WASM_OP_SET_GLOBAL:
+                REMAP(BUNDLE_INDEX_GLOBAL);
+                break;
+
+            case WASM_OP_TABLE_GET:
+            case WASM_OP_TABLE_SET:
+                REMAP(BUNDLE_INDEX_TABLE);
+                break;
+
+            case WASM_OP_F32_CONST:
+                SKIP_BYTES(sizeof(float32));
+                break;
+
+            case WASM_OP_F64_CONST:
+                SKIP_BYTES(sizeof(float64));
+                break;
+
+            case WASM_OP_REF_NULL:
+                SKIP_BYTES(1);
+                break;
+
+            case WASM_OP_MISC_PREFIX:
+                if (!read_u32(&p, buf_end, &opcode1))
+                    return false;
+                switch (opcode1) {
+                    case WASM_OP_MEMORY_INIT:
+                        REMAP(BUNDLE_INDEX_DATA);
+                        SKIP_LEB(); /* memory index */
+                        break;
+                    case WASM_OP_DATA_DROP:
+                        REMAP(BUNDLE_INDEX_DATA);
+                        break;
+                    case WASM_OP_MEMORY_COPY:
+                        SKIP_LEB();
+                        SKIP_LEB();
+                        break;
+                    case WASM_OP_MEMORY_FILL:
+                        SKIP_LEB();
+                        break;
+                    case WASM_OP_TABLE_INIT:
+                        REMAP(BUNDLE_INDEX_ELEM);
+                        REMAP(BUNDLE_INDEX_TABLE);
+                        break;
+                    case WASM_OP_ELEM_DROP:
+                        REMAP(BUNDLE_INDEX_ELEM);
+                        break;
+                    case WASM_OP_TABLE_COPY:
+                        REMAP(BUNDLE_INDEX_TABLE);
+                        REMAP(BUNDLE_INDEX_TABLE);
+                        break;
+                    case WASM_OP_TABLE_GROW:
+                    case WASM_OP_TABLE_SIZE:
+                    case WASM_OP_TABLE_FILL:
+                        REMAP(BUNDLE_INDEX_TABLE);
+                        break;
+                    default:
+                        /* the saturating truncation opcodes */
+                        if (opcode1 > WASM_OP_I64_TRUNC_SAT_U_F64)
+                            goto fail_unsupported_opcode;
+                        break;
+                }
+                break;
+
+            case WASM_OP_SIMD_PREFIX:
+                if (!read_u32(&p, buf_end, &opcode1))
+                    return false;
+                /* follow the order of enum WASMSimdEXTOpcode */
+                if (opcode1 <= SIMD_v128_store
+                    || opcode1 == SIMD_v128_load32_zero
+                    || opcode1 == SIMD_v128_load64_zero) {
+                    /* memarg */
+                    SKIP_LEB();
+                    SKIP_LEB();
+                }
+                else if (opcode1 == SIMD_v128_const
+                         || opcode1 == SIMD_v8x16_shuffle) {
+                    SKIP_BYTES(16);
+                }
+                else if (opcode1 >= SIMD_i8x16_extract_lane_s
+                         && opcode1 <= SIMD_f64x2_replace_lane) {
+                    /* lane index */
+                    SKIP_BYTES(1);
+                }
+                else if (opcode1 >= SIMD_v128_load8_lane
+                         && opcode1 <= SIMD_v128_store64_lane) {
+                    /* memarg and lane index */
+                    SKIP_LEB();
+                    SKIP_LEB();
+                    SKIP_BYTES(1);
+                }
+                break;
+
+            case WASM_OP_ATOMIC_PREFIX:
+                if (!read_u32(&p, buf_end, &opcode1))
+                    return false;
+                if (opcode1 == WASM_OP_ATOMIC_FENCE) {
+                    SKIP_BYTES(1);
+                }
+                else {
+                    /* memarg */
+                    SKIP_LEB();
+                    SKIP_LEB();
+                }
+                break;
+
+            default:
+                if (opcode >= WASM_OP_I32_LOAD
+                    && opcode <= WASM_OP_I64_STORE32) {
+                    /* memarg */
+                    SKIP_LEB();
+                    SKIP_LEB();
+                }
+                else if (!(opcode <= WASM_OP_NOP || opcode == WASM_OP_ELSE
+                           || opcode == WASM_OP_RETURN
+                           || opcode == WASM_OP_DROP
+                           || opcode == WASM_OP_SELECT
+                           || (opcode >= WASM_OP_I32_EQZ
+                               && opcode <= WASM_OP_I64_EXTEND32_S)
+                           || opcode == WASM_OP_REF_IS_NULL)) {
+                    aot_set_last_error_v("unsupported opcode 0x%02x in "
+                                         "wasm module.",
+                                         opcode);
+                    return false;
+                }
+                break;
+        }
+    }
+
+#undef SKIP_LEB
+#undef SKIP_BYTES
+#undef REMAP
+
+    if (module
+        && !bundle_buf_append(out, copy_from, (uint32)(p - copy_from)))
+        return false;
+
+    *p_buf = p;
+    return true;
+fail_unsupported_opcode:
+    aot_set_last_error_v("unsupported opcode 0x%02x%02x in wasm module.",
+                         opcode, opcode1);
+    return false;
+}
+
+static bool
+skip_func_type(const uint8 **p_buf, const uint8 *buf_end)
+{
+    const uint8 *p = *p_buf;
+    uint32 count;
+
+    if (!check_buf(p, buf_end, 1))
+        return false;
+    if (*p++ != 0x60) {
+        aot_set_last_error("invalid function type in wasm module.");
+        return false;
+    }
+    /* param types */
+    if (!read_u32(&p, buf_end, &count) || !check_buf(p, buf_end, count))
+        return false;
+    p += count;
+    /* result types */
+    if (!read_u32(&p, buf_end, &count) || !check_buf(p, buf_end, count))
+        return false;
+    p += count;
+
+    *p_buf = p;
+    return true;
+}
+
+static void *
+bundle_calloc(uint64 size)
+{
+    void *mem;
+
+    if (size >= UINT32_MAX || !(mem = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        return NULL;
+    }
+    memset(mem, 0, (uint32)size);
+    return mem;
+}
+
+static bool
+load_import_section(BundleModule *module)
+{
+    BundleSection *section = &module->sections[SECTION_TYPE_IMPORT];
+    const uint8 *p = section->buf, *buf_end = section->buf_end;
+    BundleImport *import;
+    uint32 i, kind, index[BUNDLE_IMPORT_KIND_NUM] = { 0 };
+
+    if (section->count > 0
+        && !(module->imports = bundle_calloc((uint64)sizeof(BundleImport)
+                                             * section->count)))
+        return false;
+    module->import_count = section->count;
+
+    for (i = 0; i < section->count; i++) {
+        import = &module->imports[i];
+        if (!read_name(&p, buf_end, &import->module_name,
+                       &import->module_name_len)
+            || !read_name(&p, buf_end, &import->field_name,
+                          &import->field_name_len)
+            || !check_buf(p, buf_end, 1))
+            return false;
+
+        import->kind = *p++;
+        import->desc.buf = p;
+        switch (import->kind) {
+            case IMPORT_KIND_FUNC:
+                if (!read_u32(&p, buf_end, &import->type_index))
+                    return false;
+                if (import->type_index >= module->type_count) {
+                    aot_set_last_error("unknown type in wasm module.");
+                    return false;
+                }
+                break;
+            case IMPORT_KIND_TABLE:
+                if (!check_buf(p, buf_end, 1))
+                    return false;
+                p++;
+                if (!skip_limits(&p, buf_end))
+                    return false;
+                break;
+            case IMPORT_KIND_MEMORY:
+                if (!skip_limits(&p, buf_end))
+                    return false;
+                break;
+            case IMPORT_KIND_GLOBAL:
+                if (!check_buf(p, buf_end, 2))
+                    return false;
+                p += 2;
+                break;
+            default:
+                aot_set_last_error("invalid import kind in wasm module.");
+                return false;
+        }
+        import->desc.len = (uint32)(p - import->desc.buf);
+        module->kind_import_counts[import->kind]++;
+    }
+
+    for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++) {
+        if (module->kind_import_counts[kind] > 0
+            && !(module->kind_imports[kind] = bundle_calloc(
+                     (uint64)sizeof(BundleImport *)
+                     * module->kind_import_counts[kind])))
+            return false;
+    }
+    for (i = 0; i < module->import_count; i++) {
+        kind = module->imports[i].kind;
+        module->kind_imports[kind][index[kind]++] = &module->imports[i];
+    }
+    return true;
+}
+
+static bool
+load_module(BundleModule *module)
+{
+    const uint8 *p = module->module->buf, *p_end = p + module->module->size;
+    const uint8 *section_end;
+    BundleSection *section;
+    BundleExport *export;
+    uint32 section_size, i;
+    uint8 section_type;
+
+    if (!check_buf(p, p_end, 8) || *(uint32 *)p != WASM_MAGIC_NUMBER
+        || *(uint32 *)(p + 4) != WASM_CURRENT_VERSION) {
+        aot_set_last_error("invalid wasm module.");
+        return false;
+    }
+    p += 8;
+
+    while (p < p_end) {
+        section_type = *p++;
+        if (!read_u32(&p, p_end, &section_size)
+            || !check_buf(p, p_end, section_size))
+            return false;
+        section_end = p + section_size;
+
+        if (section_type == SECTION_TYPE_USER) {
+            /* the custom sections aren't kept in the bundle */
+            p = section_end;
+            continue;
+        }
+        if (section_type >= BUNDLE_SECTION_NUM
+            || module->has_section[section_type]) {
+            aot_set_last_error("invalid section in wasm module.");
+            return false;
+        }
+
+        section = &module->sections[section_type];
+        module->has_section[section_type] = true;
+        section->buf_end = section_end;
+        /* the entry count, or the function index of start section */
+        if (!read_u32(&p, section_end, &section->count))
+            return false;
+        section->buf = p;
+        p = section_end;
+    }
+
+    /* type section */
+    section = &module->sections[SECTION_TYPE_TYPE];
+    if (section->count > 0
+        && !(module->types =
+                 bundle_calloc((uint64)sizeof(BundleItem) * section->count)))
+        return false;
+    p = section->buf;
+    for (i = 0; i < section->count; i++) {
+        module->types[i].buf = p;
+        if (!skip_func_type(&p, section->buf_end))
+            return false;
+        module->types[i].len = (uint32)(p - module->types[i].buf);
+    }
+    module->type_count = section->count;
+
+    if (!load_import_section(module))
+        return false;
+
+    /* function section */
+    section = &module->sections[SECTION_TYPE_FUNC];
+    if (section->count > 0
+        && !(module->func_types =
+                 bundle_calloc((uint64)sizeof(uint32) * section->count)))
+        return false;
+    p = section->buf;
+    for (i = 0; i < section->count; i++) {
+        if (!read_u32(&p, section->buf_end, &module->func_types[i]))
+            return false;
+        if (module->func_types[i] >= module->type_count) {
+            aot_set_last_error("unknown type in wasm module.");
+            return false;
+        }
+    }
+    module->kind_defined_counts[IMPORT_KIND_FUNC] = section->count;
+    if (section->count != module->sections[SECTION_TYPE_CODE].count) {
+        aot_set_last_error("function and code section have inconsistent "
+                           "lengths in wasm module.");
+        return false;
+    }
+
+    module->kind_defined_counts[IMPORT_KIND_TABLE] =
+        module->sections[SECTION_TYPE_TABLE].count;
+    module->kind_defined_counts[IMPORT_KIND_MEMORY] =
+        module->sections[SECTION_TYPE_MEMORY].count;
+
+    /* global section */
+    section = &module->sections[SECTION_TYPE_GLOBAL];
+    if (section->count > 0
+        && !(module->globals =
+                 bundle_calloc((uint64)sizeof(BundleItem) * section->count)))
+        return false;
+    p = section->buf;
+    for (i = 0; i < section->count; i++) {
+        module->globals[i].buf = p;
+        if (!check_buf(p, section->buf_end, 2))
+            return false;
+        p += 2;
+        if (!rewrite_expr(NULL, &p, section->buf_end, NULL))
+            return false;
+        module->globals[i].len = (uint32)(p - module->globals[i].buf);
+    }
+    module->kind_defined_counts[IMPORT_KIND_GLOBAL] = section->count;
+
+    /* export section */
+    section = &module->sections[SECTION_TYPE_EXPORT];
+    if (section->count > 0
+        && !(module->exports =
+                 bundle_calloc((uint64)sizeof(BundleExport) * section->count)))
+        return false;
+    p = section->buf;
+    for (i = 0; i < section->count; i++) {
+        export = &module->exports[i];
+        if (!read_name(&p, section->buf_end, &export->name,
+                       &export->name_len)
+            || !check_buf(p, section->buf_end, 1))
+            return false;
+        export->kind = *p++;
+        if (!read_u32(&p, section->buf_end, &export->index))
+            return false;
+        if (export->kind >= BUNDLE_IMPORT_KIND_NUM
+            || export->index
+                   >= module->kind_import_counts[export->kind]
+                          + module->kind_defined_counts[export->kind]) {
+            aot_set_last_error("invalid export in wasm module.");
+            return false;
+        }
+    }
+    module->export_count = section->count;
+
+    if (module->has_section[SECTION_TYPE_START]) {
+        module->has_start = true;
+        module->start_func = module->sections[SECTION_TYPE_START].count;
+    }
+
+    return true;
+}
+
+static void
+destroy_module(BundleModule *module)
+{
+    uint32 i;
+
+    if (module->types)
+        wasm_runtime_free(module->types);
+    if (module->imports)
+        wasm_runtime_free(module->imports);
+    for (i = 0; i < BUNDLE_IMPORT_KIND_NUM; i++)
+        if (module->kind_imports[i])
+            wasm_runtime_free(module->kind_imports[i]);
+    if (module->func_types)
+        wasm_runtime_free(module->func_types);
+    if (module->globals)
+        wasm_runtime_free(module->globals);
+    if (module->exports)
+        wasm_runtime_free(module->exports);
+    for (i = 0; i < BUNDLE_INDEX_NUM; i++)
+        if (module->maps[i])
+            wasm_runtime_free(module->maps[i]);
+}
+
+static int32
+find_module(const BundleContext *ctx, const uint8 *name, uint32 name_len)
+{
+    const char *module_name;
+    uint32 i;
+
+    for (i = 0; i < ctx->module_count; i++) {
+        module_name = ctx->modules[i].module->name;
+        if (module_name && strlen(module_name) == name_len
+            && !memcmp(module_name, name, name_len))
+            return (int32)i;
+    }
+    return -1;
+}
+
+static uint32
+add_type(BundleContext *ctx, const BundleItem *type)
+{
+    uint32 i;
+
+    for (i = 0; i < ctx->type_count; i++) {
+        if (ctx->types[i].len == type->len
+            && !memcmp(ctx->types[i].buf, type->buf, type->len))
+            return i;
+    }
+    ctx->types[ctx->type_count] = *type;
+    return ctx->type_count++;
+}
+
+/* Add a host import, the same imports of the modules are merged */
+static uint32
+add_host_import(BundleContext *ctx, BundleModule *module,
+                BundleImport *import)
+{
+    BundleImport *import1;
+    uint32 i, index = 0;
+
+    for (i = 0; i < ctx->host_import_count; i++) {
+        import1 = ctx->host_imports[i];
+        if (import1->kind != import->kind)
+            continue;
+        if (import1->module_name_len == import->module_name_len
+            && import1->field_name_len == import->field_name_len
+            && !memcmp(import1->module_name, import->module_name,
+                       import->module_name_len)
+            && !memcmp(import1->field_name, import->field_name,
+                       import->field_name_len)
+            && (import->kind != IMPORT_KIND_FUNC
+                || import1->type_index
+                       == module->maps[BUNDLE_INDEX_TYPE][import->type_index]))
+            return index;
+        index++;
+    }
+
+    ctx->host_imports[ctx->host_import_count++] = import;
+    /* the type index of host import is the one of the bundle */
+    if (import->kind == IMPORT_KIND_FUNC)
+        import->type_index =
+            module->maps[BUNDLE_INDEX_TYPE][import->type_index];
+    return ctx->counts[import->kind]++;
+}
+
+static void
+get_global_type(const BundleModule *module, uint32 index, uint16 *p_type)
+{
+    const uint8 *buf;
+
+    if (index < module->kind_import_counts[IMPORT_KIND_GLOBAL])
+        buf = module->kind_imports[IMPORT_KIND_GLOBAL][index]->desc.buf;
+    else
+        buf = module
+                  ->globals[index
+                            - module->kind_import_counts[IMPORT_KIND_GLOBAL]]
+                  .buf;
+    /* value type and mutability */
+    *p_type = (uint16)((buf[0] << 8) | buf[1]);
+}
+
+static uint32
+get_func_type(const BundleModule *module, uint32 index)
+{
+    if (index < module->kind_import_counts[IMPORT_KIND_FUNC])
+        /* host import, its type index was set to the one of the bundle */
+        return module->kind_imports[IMPORT_KIND_FUNC][index]->type_index;
+    return module->maps[BUNDLE_INDEX_TYPE]
+                       [module->func_types
+                            [index
+                             - module->kind_import_counts[IMPORT_KIND_FUNC]]];
+}
+
+/* Resolve an import of a module to the export of another module, follow
+   the import chain until a defined item or a host import is reached */
+static bool
+resolve_import(BundleContext *ctx, uint32 module_idx, uint32 kind,
+               uint32 index)
+{
+    BundleModule *module = &ctx->modules[module_idx], *target = module;
+    BundleImport *import = module->kind_imports[kind][index];
+    BundleExport *export;
+    uint32 target_index = index, depth = 0, i;
+    uint16 global_type, global_type1;
+
+    while (target_index < target->kind_import_counts[kind]) {
+        BundleImport *import1 = target->kind_imports[kind][target_index];
+        if (import1->from_module < 0)
+            /* host import */
+            break;
+
+        if (depth++ > ctx->total_import_count) {
+            aot_set_last_error_v("circular import %.*s.%.*s found.",
+                                 import->module_name_len, import->module_name,
+                                 import->field_name_len, import->field_name);
+            return false;
+        }
+
+        target = &ctx->modules[import1->from_module];
+        for (i = 0, export = target->exports; i < target->export_count;
+             i++, export++) {
+            if (export->kind == kind
+                && export->name_len == import1->field_name_len
+                && !memcmp(export->name, import1->field_name,
+                           export->name_len))
+                break;
+        }
+        if (i == target->export_count) {
+            aot_set_last_error_v("unknown import %.*s.%.*s.",
+                                 import1->module_name_len,
+                                 import1->module_name,
+                                 import1->field_name_len,
+                                 import1->field_name);
+            return false;
+        }
+        target_index = export->index;
+    }
+
+    if (kind == IMPORT_KIND_FUNC
+        && module->maps[BUNDLE_INDEX_TYPE][import->type_index]
+               != get_func_type(target, target_index)) {
+        aot_set_last_error_v("incompatible import type of %.*s.%.*s.",
+                             import->module_name_len, import->module_name,
+                             import->field_name_len, import->field_name);
+        return false;
+    }
+    if (kind == IMPORT_KIND_GLOBAL) {
+        get_global_type(module, index, &global_type);
+        get_global_type(target, target_index, &global_type1);
+        if (global_type != global_type1) {
+            aot_set_last_error_v("incompatible import type of %.*s.%.*s.",
+                                 import->module_name_len, import->module_name,
+                                 import->field_name_len, import->field_name);
+            return false;
+        }
+    }
+
+    module->maps[kind][index] = target->maps[kind][target_index];
+    return true;
+}
+
+static bool
+link_modules(BundleContext *ctx)
+{
+    BundleModule *module;
+    BundleImport *import;
+    uint32 i, j, kind, type_count = 0, memory_count;
+
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        type_count += module->type_count;
+        ctx->total_import_count += module->import_count;
+
+        module->map_sizes[BUNDLE_INDEX_TYPE] = module->type_count;
+        for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++)
+            module->map_sizes[kind] = module->kind_import_counts[kind]
+                                      + module->kind_defined_counts[kind];
+        module->map_sizes[BUNDLE_INDEX_ELEM] =
+            module->sections[SECTION_TYPE_ELEM].count;
+        module->map_sizes[BUNDLE_INDEX_DATA] =
+            module->sections[SECTION_TYPE_DATA].count;
+        for (kind = 0; kind < BUNDLE_INDEX_NUM; kind++) {
+            if (module->map_sizes[kind] > 0
+                && !(module->maps[kind] = bundle_calloc(
+                         (uint64)sizeof(uint32) * module->map_sizes[kind])))
+                return false;
+        }
+
+        for (j = 0; j < module->import_count; j++) {
+            import = &module->imports[j];
+            import->from_module = find_module(ctx, import->module_name,
+                                              import->module_name_len);
+        }
+    }
+
+    /* one more type for the start function */
+    if (!(ctx->types =
+              bundle_calloc((uint64)sizeof(BundleItem) * (type_count + 1))))
+        return false;
+    if (ctx->total_import_count > 0
+        && !(ctx->host_imports = bundle_calloc((uint64)sizeof(BundleImport *)
+                                               * ctx->total_import_count)))
+        return false;
+
+    /* merge the types */
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        for (j = 0; j < module->type_count; j++)
+            module->maps[BUNDLE_INDEX_TYPE][j] =
+                add_type(ctx, &module->types[j]);
+    }
+
+    /* the host imports are placed before the defined items */
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++) {
+            for (j = 0; j < module->kind_import_counts[kind]; j++) {
+                import = module->kind_imports[kind][j];
+                if (import->from_module < 0)
+                    module->maps[kind][j] =
+                        add_host_import(ctx, module, import);
+            }
+        }
+    }
+    for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++)
+        ctx->import_counts[kind] = ctx->counts[kind];
+
+    /* the defined items and the segments in the order of the modules */
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++) {
+            for (j = 0; j < module->kind_defined_counts[kind]; j++)
+                module->maps[kind][module->kind_import_counts[kind] + j] =
+                    ctx->counts[kind]++;
+        }
+        for (kind = BUNDLE_INDEX_ELEM; kind <= BUNDLE_INDEX_DATA; kind++) {
+            for (j = 0; j < module->map_sizes[kind]; j++)
+                module->maps[kind][j] = ctx->counts[kind]++;
+        }
+        if (module->has_section[SECTION_TYPE_DATACOUNT])
+            ctx->has_data_count = true;
+    }
+
+    /* resolve the imports between the modules */
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        for (kind = 0; kind < BUNDLE_IMPORT_KIND_NUM; kind++) {
+            for (j = 0; j < module->kind_import_counts[kind]; j++) {
+                if (module->kind_imports[kind][j]->from_module >= 0
+                    && !resolve_import(ctx, i, kind, j))
+                    return false;
+            }
+        }
+    }
+
+    memory_count = ctx->counts[BUNDLE_INDEX_MEMORY];
+    if (memory_count > 1) {
+        aot_set_last_error("the bundled modules must share one linear "
+                           "memory, import it from the module which "
+                           "defines it.");
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+emit_section(BundleBuf *out, uint8 section_type, BundleBuf *section)
+{
+    bool ret = bundle_buf_append_u8(out, section_type)
+               && bundle_buf_append_leb(out, section->size)
+               && bundle_buf_append(out, section->data, section->size);
+
+    section->size = 0;
+    return ret;
+}
+
+static bool
+emit_import_section(BundleContext *ctx, BundleBuf *section)
+{
+    BundleImport *import;
+    uint32 i;
+
+    if (!bundle_buf_append_leb(section, ctx->host_import_count))
+        return false;
+
+    for (i = 0; i < ctx->host_import_count; i++) {
+        import = ctx->host_imports[i];
+        if (!bundle_buf_append_leb(section, import->module_name_len)
+            || !bundle_buf_append(section, import->module_name,
+                                  import->module_name_len)
+            || !bundle_buf_append_leb(section, import->field_name_len)
+            || !bundle_buf_append(section, import->field_name,
+                                  import->field_name_len)
+            || !bundle_buf_append_u8(section, import->kind))
+            return false;
+        if (import->kind == IMPORT_KIND_FUNC) {
+            if (!bundle_buf_append_leb(section, import->type_index))
+                return false;
+        }
+        else if (!bundle_buf_append(section, import->desc.buf,
+                                    import->desc.len))
+            return false;
+    }
+    return true;
+}
+
+static bool
+emit_func_vec(BundleModule *module, const uint8 **p_buf, const uint8 *buf_end,
+              BundleBuf *section)
+{
+    const uint8 *p = *p_buf, *copy_from;
+    uint32 count, i;
+
+    if (!read_u32(&p, buf_end, &count)
+        || !bundle_buf_append_leb(section, count))
+        return false;
+
+    for (i = 0; i < count; i++) {
+        copy_from = p;
+        if (!remap_index(module, BUNDLE_INDEX_FUNC, &p, buf_end, &copy_from,
+                         section))
+            return false;
+    }
+
+    *p_buf = p;
+    return true;
+}
+
+static bool
+emit_expr_vec(BundleModule *module, const uint8 **p_buf, const uint8 *buf_end,
+              BundleBuf *section)
+{
+    const uint8 *p = *p_buf;
+    uint32 count, i;
+
+    if (!read_u32(&p, buf_end, &count)
+        || !bundle_buf_append_leb(section, count))
+        return false;
+
+    for (i = 0; i < count; i++) {
+        if (!rewrite_expr(module, &p, buf_end, section))
+            return false;
+    }
+
+    *p_buf = p;
+    return true;
+}
+
+
+static bool
+emit_elem_segments(BundleModule *module, BundleBuf *section)
+{
+    BundleSection *elem_section = &module->sections[SECTION_TYPE_ELEM];
+    const uint8 *p = elem_section->buf, *buf_end = elem_section->buf_end;
+    uint32 i, flags, flags_new, table_index = 0;
+
+    for (i = 0; i < elem_section->count; i++) {
+        if (!read_u32(&p, buf_end, &flags))
+            return false;
+        if (flags > 7) {
+            aot_set_last_error("invalid elem segment in wasm module.");
+            return false;
+        }
+
+        flags_new = flags;
+        if (!(flags & 1)) {
+            /* active segment */
+            table_index = 0;
+            if ((flags & 2) && !read_u32(&p, buf_end, &table_index))
+                return false;
+            if (table_index >= module->map_sizes[BUNDLE_INDEX_TABLE]) {
+                aot_set_last_error("unknown table in wasm module.");
+                return false;
+            }
+            table_index = module->maps[BUNDLE_INDEX_TABLE][table_index];
+            /* the table index must be given if it isn't 0 */
+            if (table_index != 0)
+                flags_new |= 2;
+        }
+
+        if (!bundle_buf_append_leb(section, flags_new)
+            || ((flags_new & 3) == 2
+                && !bundle_buf_append_leb(section, table_index))
+            || (!(flags & 1) && !rewrite_expr(module, &p, buf_end, section)))
+            return false;
+
+        if (flags & 3) {
+            /* elem kind or reference type */
+            if (!check_buf(p, buf_end, 1)
+                || !bundle_buf_append_u8(section, *p++))
+                return false;
+        }
+        else if (flags_new & 2) {
+            /* the implicit elem kind or reference type becomes explicit */
+            if (!bundle_buf_append_u8(section,
+                                      (flags & 4) ? VALUE_TYPE_FUNCREF : 0))
+                return false;
+        }
+
+        if (!((flags & 4) ? emit_expr_vec(module, &p, buf_end, section)
+                          : emit_func_vec(module, &p, buf_end, section)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+emit_data_segments(BundleModule *module, BundleBuf *section)
+{
+    BundleSection *data_section = &module->sections[SECTION_TYPE_DATA];
+    const uint8 *p = data_section->buf, *buf_end = data_section->buf_end;
+    uint32 i, flags, size;
+
+    for (i = 0; i < data_section->count; i++) {
+        if (!read_u32(&p, buf_end, &flags))
+            return false;
+        if (flags > 2) {
+            aot_set_last_error("invalid data segment in wasm module.");
+            return false;
+        }
+        /* the bundle has only one memory, so the memory index is 0 */
+        if (flags == 2 && !read_leb(&p, buf_end, 32, NULL))
+            return false;
+
+        if (!bundle_buf_append_leb(section, flags == 1 ? 1 : 0)
+            || (flags != 1 && !rewrite_expr(module, &p, buf_end, section))
+            || !read_u32(&p, buf_end, &size) || !check_buf(p, buf_end, size)
+            || !bundle_buf_append_leb(section, size)
+            || !bundle_buf_append(section, p, size))
+            return false;
+        p += size;
+    }
+
+    return true;
+}
+
+static bool
+emit_globals(BundleModule *module, BundleBuf *section)
+{
+    const uint8 *p;
+    uint32 i;
+
+    for (i = 0; i < module->kind_defined_counts[IMPORT_KIND_GLOBAL]; i++) {
+        p = module->globals[i].buf;
+        /* value type and mutability */
+        if (!bundle_buf_append(section, p, 2))
+            return false;
+        p += 2;
+        if (!rewrite_expr(module, &p,
+                          module->globals[i].buf + module->globals[i].len,
+                          section))
+            return false;
+    }
+    return true;
+}
+
+static bool
+emit_func_bodies(BundleModule *module, BundleBuf *section, BundleBuf *body)
+{
+    BundleSection *code_section = &module->sections[SECTION_TYPE_CODE];
+    const uint8 *p = code_section->buf, *buf_end = code_section->buf_end;
+    const uint8 *p_code, *p_code_end;
+    uint32 i, j, size, local_count;
+
+    for (i = 0; i < code_section->count; i++) {
+        if (!read_u32(&p, buf_end, &size) || !check_buf(p, buf_end, size))
+            return false;
+        p_code = p;
+        p_code_end = p + size;
+
+        /* the local declarations are kept */
+        if (!read_u32(&p_code, p_code_end, &local_count))
+            return false;
+        for (j = 0; j < local_count; j++) {
+            if (!read_leb(&p_code, p_code_end, 32, NULL)
+                || !check_buf(p_code, p_code_end, 1))
+                return false;
+            p_code++;
+        }
+
+        body->size = 0;
+        if (!bundle_buf_append(body, p, (uint32)(p_code - p))
+            || !rewrite_expr(module, &p_code, p_code_end, body))
+            return false;
+        if (p_code != p_code_end) {
+            aot_set_last_error("section size mismatch in wasm module.");
+            return false;
+        }
+
+        if (!bundle_buf_append_leb(section, body->size)
+            || !bundle_buf_append(section, body->data, body->size))
+            return false;
+        p = p_code_end;
+    }
+
+    return true;
+}
+
+static bool
+emit_exports(BundleModule *module, BundleBuf *section)
+{
+    BundleExport *export = module->exports;
+    uint32 i;
+
+    if (!bundle_buf_append_leb(section, module->export_count))
+        return false;
+
+    for (i = 0; i < module->export_count; i++, export++) {
+        if (!bundle_buf_append_leb(section, export->name_len)
+            || !bundle_buf_append(section, export->name, export->name_len)
+            || !bundle_buf_append_u8(section, export->kind)
+            || !bundle_buf_append_leb(
+                section, module->maps[export->kind][export->index]))
+            return false;
+    }
+    return true;
+}
+
+static bool
+emit_defined_items(BundleContext *ctx, uint8 section_type, uint32 kind,
+                   BundleBuf *section, BundleBuf *out)
+{
+    BundleSection *section1;
+    uint32 i;
+
+    if (ctx->counts[kind] == ctx->import_counts[kind])
+        return true;
+
+    if (!bundle_buf_append_leb(section,
+                               ctx->counts[kind] - ctx->import_counts[kind]))
+        return false;
+
+    for (i = 0; i < ctx->module_count; i++) {
+        section1 = &ctx->modules[i].sections[section_type];
+        if (section1->count == 0)
+            continue;
+        if (kind == IMPORT_KIND_GLOBAL) {
+            if (!emit_globals(&ctx->modules[i], section))
+                return false;
+        }
+        else if (!bundle_buf_append(section, section1->buf,
+                                    (uint32)(section1->buf_end
+                                             - section1->buf)))
+            /* the table and memory types are copied */
+            return false;
+    }
+
+    return emit_section(out, section_type, section);
+}
+
+static bool
+emit_bundle(BundleContext *ctx, BundleBuf *out)
+{
+    static const uint8 wasm_header[] = { 0x00, 0x61, 0x73, 0x6D,
+                                         0x01, 0x00, 0x00, 0x00 };
+    /* type of the function calling the start functions: () -> () */
+    static const uint8 start_func_type[] = { 0x60, 0x00, 0x00 };
+    BundleItem start_type = { start_func_type, sizeof(start_func_type) };
+    BundleBuf section = { 0 }, body = { 0 };
+    BundleModule *module;
+    uint32 i, j, start_func_num = 0, start_func = 0, start_type_index = 0;
+    bool ret = false;
+
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        if (module->has_start) {
+            if (module->start_func >= module->map_sizes[BUNDLE_INDEX_FUNC]) {
+                aot_set_last_error("unknown start function in wasm module.");
+                return false;
+            }
+            start_func = module->maps[BUNDLE_INDEX_FUNC][module->start_func];
+            start_func_num++;
+        }
+    }
+    if (start_func_num > 1) {
+        /* add a function to call the start functions in order */
+        start_type_index = add_type(ctx, &start_type);
+        start_func = ctx->counts[BUNDLE_INDEX_FUNC]++;
+    }
+
+    if (!bundle_buf_append(out, wasm_header, sizeof(wasm_header)))
+        goto fail;
+
+    /* type section */
+    if (!bundle_buf_append_leb(&section, ctx->type_count))
+        goto fail;
+    for (i = 0; i < ctx->type_count; i++) {
+        if (!bundle_buf_append(&section, ctx->types[i].buf,
+                               ctx->types[i].len))
+            goto fail;
+    }
+    if (!emit_section(out, SECTION_TYPE_TYPE, &section))
+        goto fail;
+
+    /* import section */
+    if (ctx->host_import_count > 0
+        && (!emit_import_section(ctx, &section)
+            || !emit_section(out, SECTION_TYPE_IMPORT, &section)))
+        goto fail;
+
+    /* function section */
+    if (!bundle_buf_append_leb(&section,
+                               ctx->counts[BUNDLE_INDEX_FUNC]
+                                   - ctx->import_counts[BUNDLE_INDEX_FUNC]))
+        goto fail;
+    for (i = 0; i < ctx->module_count; i++) {
+        module = &ctx->modules[i];
+        for (j = 0; j < module->kind_defined_counts[IMPORT_KIND_FUNC]; j++) {
+            if (!bundle_buf_append_leb(
+                    &section, module->maps[BUNDLE_INDEX_TYPE]
+                                          [module->func_types[j]]))
+                goto fail;
+        }
+    }
+    if (start_func_num > 1
+        && !bundle_buf_append_leb(&section, start_type_index))
+        goto fail;
+    if (!emit_section(out, SECTION_TYPE_FUNC, &section))
+        goto fail;
+
+    if (!emit_defined_items(ctx, SECTION_TYPE_TABLE, IMPORT_KIND_TABLE,
+                            &section, out)
+        || !emit_defined_items(ctx, SECTION_TYPE_MEMORY, IMPORT_KIND_MEMORY,
+                               &section, out)
+        || !emit_defined_items(ctx, SECTION_TYPE_GLOBAL, IMPORT_KIND_GLOBAL,
+                               &section, out))
+        goto fail;
+
+    /* export section, only the exports of the main module are kept */
+    if (!emit_exports(&ctx->modules[ctx->module_count - 1], &section)
+        || !emit_section(out, SECTION_TYPE_EXPORT, &section))
+        goto fail;
+
+    /* start section */
+    if (start_func_num > 0
+        && (!bundle_buf_append_leb(&section, start_func)
+            || !emit_section(out, SECTION_TYPE_START, &section)))
+        goto fail;
+
+    /* elem section */
+    if (ctx->counts[BUNDLE_INDEX_ELEM] > 0) {
+        if (!bundle_buf_append_leb(&section, ctx->counts[BUNDLE_INDEX_ELEM]))
+            goto fail;
+        for (i = 0; i < ctx->module_count; i++) {
+            if (!emit_elem_segments(&ctx->modules[i], &section))
+                goto fail;
+        }
+        if (!emit_section(out, SECTION_TYPE_ELEM, &section))
+            goto fail;
+    }
+
+    /* data count section */
+    if (ctx->has_data_count
+        && (!bundle_buf_append_leb(&section, ctx->counts[BUNDLE_INDEX_DATA])
+            || !emit_section(out, SECTION_TYPE_DATACOUNT, &section)))
+        goto fail;
+
+    /* code section */
+    if (!bundle_buf_append_leb(&section,
+                               ctx->counts[BUNDLE_INDEX_FUNC]
+                                   - ctx->import_counts[BUNDLE_INDEX_FUNC]))
+        goto fail;
+    for (i = 0; i < ctx->module_count; i++) {
+        if (!emit_func_bodies(&ctx->modules[i], &section, &body))
+            goto fail;
+    }
+    if (start_func_num > 1) {
+        /* no local, call the start functions and end */
+        body.size = 0;
+        if (!bundle_buf_append_u8(&body, 0))
+            goto fail;
+        for (i = 0; i < ctx->module_count; i++) {
+            module = &ctx->modules[i];
+            if (module->has_start
+                && (!bundle_buf_append_u8(&body, WASM_OP_CALL)
+                    || !bundle_buf_append_leb(
+                        &body,
+                        module->maps[BUNDLE_INDEX_FUNC][module->start_func])))
+                goto fail;
+        }
+        if (!bundle_buf_append_u8(&body, WASM_OP_END)
+            || !bundle_buf_append_leb(&section, body.size)
+            || !bundle_buf_append(&section, body.data, body.size))
+            goto fail;
+    }
+    if (!emit_section(out, SECTION_TYPE_CODE, &section))
+        goto fail;
+
+    /* data section */
+    if (ctx->counts[BUNDLE_INDEX_DATA] > 0) {
+        if (!bundle_buf_append_leb(&section, ctx->counts[BUNDLE_INDEX_DATA]))
+            goto fail;
+        for (i = 0; i < ctx->module_count; i++) {
+            if (!emit_data_segments(&ctx->modules[i], &section))
+                goto fail;
+        }
+        if (!emit_section(out, SECTION_TYPE_DATA, &section))
+            goto fail;
+    }
+
+    ret = true;
+fail:
+    bundle_buf_destroy(&section);
+    bundle_buf_destroy(&body);
+    return ret;
+}
+
+uint8 *
+aot_bundle_wasm_modules(const AOTBundleModule *modules, uint32 module_count,
+                        uint32 *p_bundle_size)
+{
+    BundleContext ctx = { 0 };
+    BundleBuf out = { 0 };
+    uint8 *bundle = NULL;
+    char error_buf[128];
+    const char *error;
+    uint32 i, j;
+
+    bh_assert(module_count > 0);
+
+    for (i = 0; i < module_count; i++) {
+        for (j = 0; j < i; j++) {
+            if (modules[i].name && modules[j].name
+                && !strcmp(modules[i].name, modules[j].name)) {
+                aot_set_last_error_v("duplicated bundled module %s.",
+                                     modules[i].name);
+                return NULL;
+            }
+        }
+    }
+
+    if (!(ctx.modules =
+              bundle_calloc((uint64)sizeof(BundleModule) * module_count)))
+        return NULL;
+    ctx.module_count = module_count;
+
+    for (i = 0; i < module_count; i++) {
+        ctx.modules[i].module = &modules[i];
+        if (!load_module(&ctx.modules[i])) {
+            error = aot_get_last_error();
+            if (!strncmp(error, "Error: ", 7))
+                error += 7;
+            snprintf(error_buf, sizeof(error_buf), "%s", error);
+            aot_set_last_error_v("load wasm module %s failed: %s",
+                                 modules[i].name ? modules[i].name : "main",
+                                 error_buf);
+            goto fail;
+        }
+    }
+
+    if (!link_modules(&ctx) || !emit_bundle(&ctx, &out))
+        goto fail;
+
+    bundle = out.data;
+    LOG_VERBOSE("Bundle %u wasm modules into %u bytes, with %u functions "
+                "and %u imports.",
+                module_count, out.size, ctx.counts[BUNDLE_INDEX_FUNC],
+                ctx.host_import_count);
+
+    *p_bundle_size = out.size;
+    memset(&out, 0, sizeof(BundleBuf));
+
+fail:
+    bundle_buf_destroy(&out);
+    for (i = 0; i < module_count; i++)
+        destroy_module(&ctx.modules[i]);
+    wasm_runtime_free(ctx.modules);
+    if (ctx.types)
+        wasm_runtime_free(ctx.types);
+    if (ctx.host_imports)
+        wasm_runtime_free(ctx.host_imports);
+    return bundle;
+}
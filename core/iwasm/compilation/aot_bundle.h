@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _AOT_BUNDLE_H_
+#define _AOT_BUNDLE_H_
+
+#include "aot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AOTBundleModule {
+    /* The module name which the other modules import it with,
+       NULL if the module isn't imported by the others */
+    const char *name;
+    const uint8 *buf;
+    uint32 size;
+} AOTBundleModule;
+
+/**
+ * Link several wasm modules into one wasm module, the imports of a module
+ * whose module name is the name of another module in the bundle are
+ * resolved to the exports of that module, so that the cross-module calls
+ * become direct calls after the bundle is compiled. The other imports are
+ * kept as the imports of the bundle.
+ *
+ * The modules are instantiated in the given order, and the last one is
+ * the main module whose exports are kept as the exports of the bundle.
+ *
+ * @param modules the wasm modules to link
+ * @param module_count the number of the modules
+ * @param p_bundle_size return the size of the bundle
+ *
+ * @return the bundle allocated with wasm_runtime_malloc if success,
+ *         NULL otherwise, and the error can be got by aot_get_last_error
+ */
+uint8 *
+aot_bundle_wasm_modules(const AOTBundleModule *modules, uint32 module_count,
+                        uint32 *p_bundle_size);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif /* end of _AOT_BUNDLE_H_ */
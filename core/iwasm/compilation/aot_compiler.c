@@ -15,6 +15,7 @@
 #include "aot_emit_function.h"
 #include "aot_emit_parametric.h"
 #include "aot_emit_table.h"
+#include "aot_emit_pgo.h"
 #include "simd/simd_access_lanes.h"
 #include "simd/simd_bitmask_extracts.h"
 #include "simd/simd_bit_shifts.h"
@@ -189,6 +190,9 @@ aot_compile_func(AOTCompContext *comp_ctx, uint32 func_index)
     LLVMPositionBuilderAtEnd(
         comp_ctx->builder,
         func_ctx->block_stack.block_list_head->llvm_entry_block);
+
+    if (!aot_pgo_compile_func_entry(comp_ctx, func_ctx))
+        return false;
     while (frame_ip < frame_ip_end) {
         opcode = *frame_ip++;
 
@@ -2650,7 +2654,7 @@ aot_require_lower_switch_pass(AOTCompContext *comp_ctx)
 }
 
 static bool
-apply_passes_for_indirect_mode(AOTCompContext *comp_ctx)
+apply_passes_for_indirect_mode(AOTCompContext *comp_ctx, LLVMModuleRef module)
 {
     LLVMPassManagerRef common_pass_mgr;
 
@@ -2667,12 +2671,318 @@ apply_passes_for_indirect_mode(AOTCompContext *comp_ctx)
     if (aot_require_lower_switch_pass(comp_ctx))
         LLVMAddLowerSwitchPass(common_pass_mgr);
 
-    LLVMRunPassManager(common_pass_mgr, comp_ctx->module);
+    LLVMRunPassManager(common_pass_mgr, module);
 
     LLVMDisposePassManager(common_pass_mgr);
     return true;
 }
 
+typedef struct AOTModulePart {
+    LLVMMemoryBufferRef bitcode_buf;
+    LLVMMemoryBufferRef obj_buf;
+    /* Key of the object file in the cache directory */
+    char cache_key[AOT_CACHE_KEY_SIZE];
+} AOTModulePart;
+
+typedef struct AOTCompileWorker {
+    AOTCompContext *comp_ctx;
+    LLVMTargetMachineRef target_machine;
+    /* The worker compiles the parts to_compile[i] of the worker_index +
+       k * worker_count indexes */
+    AOTModulePart **to_compile;
+    uint32 to_compile_count;
+    uint32 worker_index;
+    uint32 worker_count;
+    const char *error;
+    korp_tid tid;
+} AOTCompileWorker;
+
+static bool
+compile_module_part(AOTCompileWorker *worker, AOTModulePart *part)
+{
+    AOTCompContext *comp_ctx = worker->comp_ctx;
+    LLVMContextRef context;
+    LLVMModuleRef module;
+    char *err = NULL;
+    bool ret = false;
+
+    if (!(context = LLVMContextCreate())) {
+        worker->error = "create LLVM context failed.";
+        return false;
+    }
+
+    if (LLVMParseBitcodeInContext2(context, part->bitcode_buf, &module)) {
+        worker->error = "load module bitcode failed.";
+        goto fail;
+    }
+
+    if (comp_ctx->is_indirect_mode
+        && !apply_passes_for_indirect_mode(comp_ctx, module)) {
+        worker->error = "run optimization passes for indirect mode failed.";
+        goto fail;
+    }
+
+    aot_apply_llvm_new_pass_manager(comp_ctx, worker->target_machine, module);
+
+    if (LLVMTargetMachineEmitToMemoryBuffer(worker->target_machine, module,
+                                            LLVMObjectFile, &err,
+                                            &part->obj_buf)
+        != 0) {
+        if (err)
+            LLVMDisposeMessage(err);
+        worker->error = "llvm emit to memory buffer failed.";
+        goto fail;
+    }
+
+    ret = true;
+
+fail:
+    /* The module is disposed together with the context */
+    LLVMContextDispose(context);
+    return ret;
+}
+
+static void *
+compile_module_parts_worker(void *arg)
+{
+    AOTCompileWorker *worker = (AOTCompileWorker *)arg;
+    uint32 i;
+
+    for (i = worker->worker_index; i < worker->to_compile_count;
+         i += worker->worker_count) {
+        if (!compile_module_part(worker, worker->to_compile[i]))
+            break;
+    }
+    return NULL;
+}
+
+/* Return the path of the cached object file of a part, which must be
+   freed by the caller */
+static char *
+get_cache_file_path(AOTCompContext *comp_ctx, AOTModulePart *part)
+{
+    /* "/" + key + ".o" */
+    uint32 size = (uint32)strlen(comp_ctx->cache_dir) + AOT_CACHE_KEY_SIZE + 3;
+    char *path;
+
+    if (!(path = wasm_runtime_malloc(size))) {
+        aot_set_last_error("allocate memory failed.");
+        return NULL;
+    }
+
+    snprintf(path, size, "%s/%s.o", comp_ctx->cache_dir, part->cache_key);
+    return path;
+}
+
+static bool
+load_cached_module_part(AOTCompContext *comp_ctx, AOTModulePart *part)
+{
+    char *path, *err = NULL;
+
+    if (!aot_get_module_cache_key(comp_ctx, part->bitcode_buf,
+                                  part->cache_key, sizeof(part->cache_key)))
+        return false;
+
+    if (!(path = get_cache_file_path(comp_ctx, part)))
+        return false;
+
+    /* The object file isn't cached if it can't be read */
+    if (LLVMCreateMemoryBufferWithContentsOfFile(path, &part->obj_buf, &err)
+        != 0) {
+        if (err)
+            LLVMDisposeMessage(err);
+        part->obj_buf = NULL;
+    }
+
+    wasm_runtime_free(path);
+    return true;
+}
+
+static void
+save_cached_module_part(AOTCompContext *comp_ctx, AOTModulePart *part)
+{
+    const char *buf = LLVMGetBufferStart(part->obj_buf);
+    size_t size = LLVMGetBufferSize(part->obj_buf);
+    char *path, *tmp_path = NULL;
+    uint32 tmp_path_size;
+    FILE *file;
+
+    if (!(path = get_cache_file_path(comp_ctx, part)))
+        return;
+
+    /* Write a temporary file and rename it, so that other processes
+       compiling with the same cache directory never read a partially
+       written file */
+    tmp_path_size = (uint32)strlen(path) + 32;
+    if (!(tmp_path = wasm_runtime_malloc(tmp_path_size)))
+        goto fail;
+    snprintf(tmp_path, tmp_path_size, "%s.%p.tmp", path, (void *)part);
+
+    if (!(file = fopen(tmp_path, "wb")))
+        goto fail;
+
+    if (fwrite(buf, 1, size, file) != size) {
+        fclose(file);
+        remove(tmp_path);
+        goto fail;
+    }
+
+    if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        goto fail;
+    }
+
+    wasm_runtime_free(tmp_path);
+    wasm_runtime_free(path);
+    return;
+
+fail:
+    /* The object file is still used even if it isn't cached */
+    LOG_WARNING("failed to save %s into the cache directory", path);
+    if (tmp_path)
+        wasm_runtime_free(tmp_path);
+    wasm_runtime_free(path);
+}
+
+/**
+ * Split the functions into comp_ctx->thread_num modules, and optimize
+ * and codegen them in parallel, each module is compiled by a thread in
+ * its own LLVM context and with its own target machine. If the cache
+ * directory is set, each cluster of functions is split into its own
+ * module instead, and only the modules whose object files aren't found
+ * in the cache directory are compiled.
+ */
+static bool
+compile_module_parts(AOTCompContext *comp_ctx)
+{
+    AOTModulePart *parts = NULL, **to_compile = NULL;
+    AOTCompileWorker *workers = NULL;
+    LLVMMemoryBufferRef *bitcode_bufs;
+    uint32 part_count = comp_ctx->thread_num, worker_count;
+    uint32 to_compile_count = 0, thread_count, i;
+    uint64 size;
+    bool ret = false;
+
+    if (comp_ctx->cache_dir)
+        part_count = 0;
+    else if (part_count > comp_ctx->func_ctx_count)
+        part_count = comp_ctx->func_ctx_count;
+
+    bh_print_time("Begin to split LLVM module");
+    if (!aot_split_module(comp_ctx, part_count, &bitcode_bufs, &part_count))
+        return false;
+
+    size = (sizeof(AOTModulePart) + sizeof(AOTModulePart *))
+           * (uint64)part_count;
+    if (size >= UINT32_MAX || !(parts = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        goto fail;
+    }
+    memset(parts, 0, (uint32)size);
+    to_compile = (AOTModulePart **)(parts + part_count);
+
+    for (i = 0; i < part_count; i++) {
+        parts[i].bitcode_buf = bitcode_bufs[i];
+        bitcode_bufs[i] = NULL;
+        if (comp_ctx->cache_dir
+            && !load_cached_module_part(comp_ctx, parts + i))
+            goto fail;
+        if (!parts[i].obj_buf)
+            to_compile[to_compile_count++] = parts + i;
+    }
+
+    if (comp_ctx->cache_dir)
+        LOG_VERBOSE("%u of %u modules are found in the cache directory",
+                    part_count - to_compile_count, part_count);
+
+    worker_count = comp_ctx->thread_num > 1 ? comp_ctx->thread_num : 1;
+    if (worker_count > to_compile_count)
+        worker_count = to_compile_count;
+
+    if (worker_count > 0) {
+        size = sizeof(AOTCompileWorker) * (uint64)worker_count;
+        if (!(workers = wasm_runtime_malloc((uint32)size))) {
+            aot_set_last_error("allocate memory failed.");
+            goto fail;
+        }
+        memset(workers, 0, (uint32)size);
+    }
+
+    for (i = 0; i < worker_count; i++) {
+        workers[i].comp_ctx = comp_ctx;
+        workers[i].to_compile = to_compile;
+        workers[i].to_compile_count = to_compile_count;
+        workers[i].worker_index = i;
+        workers[i].worker_count = worker_count;
+        if (!(workers[i].target_machine =
+                  aot_clone_target_machine(comp_ctx->target_machine))) {
+            aot_set_last_error("create LLVM target machine failed.");
+            goto fail;
+        }
+    }
+
+    bh_print_time("Begin to optimize and codegen LLVM modules");
+    for (i = 0; i < worker_count; i++) {
+        /* LLVM optimization and codegen require a large stack */
+        if (os_thread_create(&workers[i].tid, compile_module_parts_worker,
+                             workers + i, APP_THREAD_STACK_SIZE_MAX)
+            != 0) {
+            aot_set_last_error("create compile thread failed.");
+            break;
+        }
+    }
+    thread_count = i;
+    for (i = 0; i < thread_count; i++)
+        os_thread_join(workers[i].tid, NULL);
+    if (thread_count < worker_count)
+        goto fail;
+
+    for (i = 0; i < worker_count; i++) {
+        if (workers[i].error) {
+            aot_set_last_error(workers[i].error);
+            goto fail;
+        }
+    }
+
+    if (comp_ctx->cache_dir) {
+        for (i = 0; i < to_compile_count; i++)
+            save_cached_module_part(comp_ctx, to_compile[i]);
+    }
+
+    /* The object files are linked when emitting the AOT file */
+    size = sizeof(LLVMMemoryBufferRef) * (uint64)part_count;
+    if (!(comp_ctx->part_obj_bufs = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        goto fail;
+    }
+    for (i = 0; i < part_count; i++) {
+        comp_ctx->part_obj_bufs[i] = parts[i].obj_buf;
+        parts[i].obj_buf = NULL;
+    }
+    comp_ctx->part_obj_buf_count = part_count;
+    ret = true;
+
+fail:
+    if (workers) {
+        for (i = 0; i < worker_count; i++)
+            if (workers[i].target_machine)
+                LLVMDisposeTargetMachine(workers[i].target_machine);
+        wasm_runtime_free(workers);
+    }
+    for (i = 0; i < part_count; i++) {
+        if (bitcode_bufs[i])
+            LLVMDisposeMemoryBuffer(bitcode_bufs[i]);
+        if (parts && parts[i].bitcode_buf)
+            LLVMDisposeMemoryBuffer(parts[i].bitcode_buf);
+        if (parts && parts[i].obj_buf)
+            LLVMDisposeMemoryBuffer(parts[i].obj_buf);
+    }
+    wasm_runtime_free(bitcode_bufs);
+    if (parts)
+        wasm_runtime_free(parts);
+    return ret;
+}
+
 bool
 aot_compile_wasm(AOTCompContext *comp_ctx)
 {
@@ -2689,6 +2999,14 @@ aot_compile_wasm(AOTCompContext *comp_ctx)
         }
     }
 
+    if (!aot_pgo_check_prof_counters(comp_ctx))
+        return false;
+
+    /* Let LLVM regard the functions and blocks as hot or cold according
+       to the profile data */
+    if (comp_ctx->pgo_prof_counters)
+        aot_set_pgo_prof_summary(comp_ctx->module);
+
 #if WASM_ENABLE_DEBUG_AOT != 0
     LLVMDIBuilderFinalize(comp_ctx->debug_builder);
 #endif
@@ -2704,11 +3022,20 @@ aot_compile_wasm(AOTCompContext *comp_ctx)
 
     /* Run IR optimization before feeding in ORCJIT and AOT codegen */
     if (comp_ctx->optimize) {
+        if (!comp_ctx->is_jit_mode
+            && (comp_ctx->thread_num > 1 || comp_ctx->cache_dir)
+            && comp_ctx->func_ctx_count > 1) {
+            if (!compile_module_parts(comp_ctx))
+                return false;
+            bh_print_time("Finish compiling LLVM modules");
+            return true;
+        }
+
         /* Run specific passes for AOT indirect mode */
         if (!comp_ctx->is_jit_mode && comp_ctx->is_indirect_mode) {
             bh_print_time("Begin to run optimization passes "
                           "for indirect mode");
-            if (!apply_passes_for_indirect_mode(comp_ctx)) {
+            if (!apply_passes_for_indirect_mode(comp_ctx, comp_ctx->module)) {
                 return false;
             }
         }
@@ -2720,7 +3047,8 @@ aot_compile_wasm(AOTCompContext *comp_ctx)
            JIT: one is memory leak in do_ir_transform, the other is
            possible core dump. */
         bh_print_time("Begin to run llvm optimization passes");
-        aot_apply_llvm_new_pass_manager(comp_ctx, comp_ctx->module);
+        aot_apply_llvm_new_pass_manager(comp_ctx, comp_ctx->target_machine,
+                                        comp_ctx->module);
         bh_print_time("Finish llvm optimization passes");
     }
 
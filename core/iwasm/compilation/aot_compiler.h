@@ -313,19 +313,7 @@ check_type_compatible(uint8 src_type, uint8 dst_type)
             aot_set_last_error("llvm add function type failed.");           \
             goto fail;                                                      \
         }                                                                   \
-        if (comp_ctx->is_jit_mode) {                                        \
-            /* JIT mode, call the function directly */                      \
-            if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {         \
-                aot_set_last_error("llvm add pointer type failed.");        \
-                goto fail;                                                  \
-            }                                                               \
-            if (!(value = I64_CONST((uint64)(uintptr_t)name))               \
-                || !(func = LLVMConstIntToPtr(value, func_ptr_type))) {     \
-                aot_set_last_error("create LLVM value failed.");            \
-                goto fail;                                                  \
-            }                                                               \
-        }                                                                   \
-        else if (comp_ctx->is_indirect_mode) {                              \
+        if (comp_ctx->is_indirect_mode) {                                   \
             int32 func_index;                                               \
             if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {         \
                 aot_set_last_error("create LLVM function type failed.");    \
@@ -344,7 +332,8 @@ check_type_compatible(uint8 src_type, uint8 dst_type)
         }                                                                   \
         else {                                                              \
             char *func_name = #name;                                        \
-            /* AOT mode, delcare the function */                            \
+            /* AOT/JIT mode, declare the function, in JIT mode it is        \
+               resolved to the absolute symbol defined in the JIT */        \
             if (!(func = LLVMGetNamedFunction(func_ctx->module, func_name)) \
                 && !(func = LLVMAddFunction(func_ctx->module, func_name,    \
                                             func_type))) {                  \
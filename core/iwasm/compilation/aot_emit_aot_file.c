@@ -118,6 +118,13 @@ typedef struct AOTObjectData {
 
     void *text;
     uint32 text_size;
+    /* Whether the text is allocated, e.g. merged from the split modules or
+       folded with the read-only data sections */
+    bool is_text_allocated;
+    /* Alignment of the code in the AOT file if it isn't 0, the literal is
+       padded with text_padding bytes to align it */
+    uint32 text_align;
+    uint32 text_padding;
 
     /* literal data and size */
     void *literal;
@@ -132,6 +139,12 @@ typedef struct AOTObjectData {
     AOTSymbolList symbol_list;
     AOTRelocationGroup *relocation_groups;
     uint32 relocation_group_count;
+
+    /* Object data of the split modules compiled by multiple threads,
+       their text, data sections, functions and relocations are merged
+       into this object data */
+    struct AOTObjectData **parts;
+    uint32 part_count;
 } AOTObjectData;
 
 #if 0
@@ -558,7 +571,8 @@ get_init_data_section_size(AOTCompContext *comp_ctx, AOTCompData *comp_data,
 static uint32
 get_text_section_size(AOTObjectData *obj_data)
 {
-    return (sizeof(uint32) + obj_data->literal_size + obj_data->text_size + 3)
+    return (sizeof(uint32) + obj_data->literal_size + obj_data->text_padding
+            + obj_data->text_size + 3)
            & ~3;
 }
 
@@ -882,7 +896,7 @@ static uint32
 get_aot_file_size(AOTCompContext *comp_ctx, AOTCompData *comp_data,
                   AOTObjectData *obj_data)
 {
-    uint32 size = 0;
+    uint32 size = 0, code_offset;
     uint32 size_custom_section = 0;
 
     /* aot file header */
@@ -904,6 +918,12 @@ get_aot_file_size(AOTCompContext *comp_ctx, AOTCompData *comp_data,
     size = align_uint(size, 4);
     /* section id + section size */
     size += (uint32)sizeof(uint32) * 2;
+    if (obj_data->text_align > 0) {
+        /* literal size + literal */
+        code_offset = size + (uint32)sizeof(uint32) + obj_data->literal_size;
+        obj_data->text_padding =
+            align_uint(code_offset, obj_data->text_align) - code_offset;
+    }
     size += get_text_section_size(obj_data);
 
     /* function section */
@@ -941,6 +961,14 @@ get_aot_file_size(AOTCompContext *comp_ctx, AOTCompData *comp_data,
                      get_name_section_size(comp_data));
     }
 
+    if (comp_ctx->enable_llvm_pgo) {
+        /* custom pgo section */
+        size = align_uint(size, 4);
+        /* section id + section size + sub section id + counter count
+           + module hash */
+        size += (uint32)sizeof(uint32) * 4 + (uint32)sizeof(uint64);
+    }
+
     size_custom_section = get_custom_sections_size(comp_ctx, comp_data);
     if (size_custom_section > 0) {
         size = align_uint(size, 4);
@@ -1694,16 +1722,18 @@ aot_emit_text_section(uint8 *buf, uint8 *buf_end, uint32 *p_offset,
                       AOTCompData *comp_data, AOTObjectData *obj_data)
 {
     uint32 section_size = get_text_section_size(obj_data);
-    uint32 offset = *p_offset;
+    uint32 offset = *p_offset, i;
     uint8 placeholder = 0;
 
     *p_offset = offset = align_uint(offset, 4);
 
     EMIT_U32(AOT_SECTION_TYPE_TEXT);
     EMIT_U32(section_size);
-    EMIT_U32(obj_data->literal_size);
+    EMIT_U32(obj_data->literal_size + obj_data->text_padding);
     if (obj_data->literal_size > 0)
         EMIT_BUF(obj_data->literal, obj_data->literal_size);
+    for (i = 0; i < obj_data->text_padding; i++)
+        EMIT_BUF(&placeholder, 1);
     EMIT_BUF(obj_data->text, obj_data->text_size);
 
     while (offset & 3)
@@ -1939,6 +1969,28 @@ aot_emit_name_section(uint8 *buf, uint8 *buf_end, uint32 *p_offset,
     return true;
 }
 
+static bool
+aot_emit_pgo_section(uint8 *buf, uint8 *buf_end, uint32 *p_offset,
+                     AOTCompContext *comp_ctx)
+{
+    if (comp_ctx->enable_llvm_pgo) {
+        uint32 offset = *p_offset;
+
+        *p_offset = offset = align_uint(offset, 4);
+
+        EMIT_U32(AOT_SECTION_TYPE_CUSTOM);
+        /* sub section id + counter count + module hash */
+        EMIT_U32(sizeof(uint32) * 2 + sizeof(uint64));
+        EMIT_U32(AOT_CUSTOM_SECTION_PGO);
+        EMIT_U32(comp_ctx->pgo_counter_count);
+        EMIT_U64(comp_ctx->pgo_module_hash);
+
+        *p_offset = offset;
+    }
+
+    return true;
+}
+
 static bool
 aot_emit_custom_sections(uint8 *buf, uint8 *buf_end, uint32 *p_offset,
                          AOTCompData *comp_data, AOTCompContext *comp_ctx)
@@ -2336,6 +2388,20 @@ aot_resolve_object_data_sections(AOTObjectData *obj_data)
     return true;
 }
 
+static bool
+is_defined_symbol(AOTObjectData *obj_data, LLVMSymbolIteratorRef sym_itr)
+{
+    LLVMSectionIteratorRef sec_itr;
+    bool ret;
+
+    if (!(sec_itr = LLVMObjectFileCopySectionIterator(obj_data->binary)))
+        return false;
+    LLVMMoveToContainingSection(sec_itr, sym_itr);
+    ret = !LLVMObjectFileIsSectionIteratorAtEnd(obj_data->binary, sec_itr);
+    LLVMDisposeSectionIterator(sec_itr);
+    return ret;
+}
+
 static bool
 aot_resolve_functions(AOTCompContext *comp_ctx, AOTObjectData *obj_data)
 {
@@ -2362,7 +2428,9 @@ aot_resolve_functions(AOTCompContext *comp_ctx, AOTObjectData *obj_data)
 
     while (!LLVMObjectFileIsSymbolIteratorAtEnd(obj_data->binary, sym_itr)) {
         if ((name = (char *)LLVMGetSymbolName(sym_itr))
-            && str_starts_with(name, prefix)) {
+            && str_starts_with(name, prefix)
+            /* Skip the functions defined in other split modules */
+            && is_defined_symbol(obj_data, sym_itr)) {
             func_index = (uint32)atoi(name + strlen(prefix));
             if (func_index < obj_data->func_count) {
                 func = obj_data->funcs + func_index;
@@ -2658,6 +2726,20 @@ destroy_relocation_symbol_list(AOTSymbolList *symbol_list)
 static void
 aot_obj_data_destroy(AOTObjectData *obj_data)
 {
+    uint32 i;
+
+    if (obj_data->is_text_allocated && obj_data->text)
+        wasm_runtime_free(obj_data->text);
+    if (obj_data->parts) {
+        /* The data sections are merged into new buffers */
+        for (i = 0; i < obj_data->data_sections_count; i++)
+            if (obj_data->data_sections[i].data)
+                wasm_runtime_free(obj_data->data_sections[i].data);
+        for (i = 0; i < obj_data->part_count; i++)
+            if (obj_data->parts[i])
+                aot_obj_data_destroy(obj_data->parts[i]);
+        wasm_runtime_free(obj_data->parts);
+    }
     if (obj_data->binary)
         LLVMDisposeBinary(obj_data->binary);
     if (obj_data->mem_buf)
@@ -2674,6 +2756,570 @@ aot_obj_data_destroy(AOTObjectData *obj_data)
     wasm_runtime_free(obj_data);
 }
 
+static bool
+aot_resolve_object_data(AOTCompContext *comp_ctx, AOTObjectData *obj_data)
+{
+    char *err = NULL;
+
+    if (!(obj_data->binary = LLVMCreateBinary(obj_data->mem_buf, NULL, &err))) {
+        if (err) {
+            LLVMDisposeMessage(err);
+            err = NULL;
+        }
+        aot_set_last_error("llvm create binary failed.");
+        return false;
+    }
+
+    bh_print_time("Begin to resolve object file info");
+
+    /* resolve target info/text/relocations/functions */
+    if (!aot_resolve_target_info(comp_ctx, obj_data)
+        || !aot_resolve_text(obj_data) || !aot_resolve_literal(obj_data)
+        || !aot_resolve_object_data_sections(obj_data)
+        || !aot_resolve_object_relocation_groups(obj_data)
+        || !aot_resolve_functions(comp_ctx, obj_data))
+        return false;
+
+    return true;
+}
+
+/* Alignment of the text and data sections of each split module in the
+   merged sections */
+#define OBJ_DATA_PART_ALIGN 64
+
+static AOTObjectDataSection *
+find_data_section(AOTObjectDataSection *data_sections, uint32 count,
+                  const char *name)
+{
+    uint32 i;
+
+    for (i = 0; i < count; i++)
+        if (!strcmp(data_sections[i].name, name))
+            return data_sections + i;
+    return NULL;
+}
+
+static AOTRelocationGroup *
+find_relocation_group(AOTRelocationGroup *groups, uint32 count,
+                      const char *name)
+{
+    uint32 i;
+
+    for (i = 0; i < count; i++)
+        if (!strcmp(groups[i].section_name, name))
+            return groups + i;
+    return NULL;
+}
+
+/* Get the offset of a part's text or data section in the merged
+   section, return -1 if the name isn't a section of the part */
+static int64
+get_part_section_offset(AOTObjectData *part, uint32 *part_data_offsets,
+                        const char *name)
+{
+    uint32 i;
+
+    if (!strcmp(name, ".text"))
+        return part_data_offsets[0];
+    for (i = 0; i < part->data_sections_count; i++)
+        if (!strcmp(part->data_sections[i].name, name))
+            return part_data_offsets[i + 1];
+    return -1;
+}
+
+/**
+ * Link the object files of the split modules: the text and the data
+ * sections with the same name are concatenated, and the offsets and
+ * addends of the relocations are adjusted to the merged sections. The
+ * calls between the split modules are relocated by the function symbol
+ * names like the calls in one module.
+ */
+static bool
+aot_merge_object_data(AOTCompContext *comp_ctx, AOTObjectData *obj_data)
+{
+    AOTObjectData *part;
+    AOTObjectDataSection *data_section, *part_data_section;
+    AOTRelocationGroup *group, *part_group;
+    AOTRelocation *relocation;
+    uint32 **data_offsets, *offsets, count, i, j, k;
+    uint64 size;
+    int64 section_offset, symbol_offset;
+    bool ret = false;
+
+    part = obj_data->parts[0];
+    obj_data->target_info = part->target_info;
+
+    /* The offsets of each part's text and data sections in the merged
+       sections */
+    size = sizeof(uint32 *) * (uint64)obj_data->part_count;
+    for (i = 0; i < obj_data->part_count; i++)
+        size += sizeof(uint32)
+                * (1 + (uint64)obj_data->parts[i]->data_sections_count);
+    if (size >= UINT32_MAX
+        || !(data_offsets = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        return false;
+    }
+    offsets = (uint32 *)(data_offsets + obj_data->part_count);
+    for (i = 0; i < obj_data->part_count; i++) {
+        data_offsets[i] = offsets;
+        offsets += 1 + obj_data->parts[i]->data_sections_count;
+    }
+
+    /* Merge the text and count the merged data sections */
+    count = 0;
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        /* Relocations with implicit addends and literal sections (xtensa)
+           can't be merged, they aren't generated for the targets which
+           support compiling with multiple threads */
+        if (obj_data->target_info.bin_type > 3 || part->literal_size > 0) {
+            aot_set_last_error("link object files of the target failed.");
+            goto fail;
+        }
+        obj_data->text_size =
+            align_uint(obj_data->text_size, OBJ_DATA_PART_ALIGN);
+        data_offsets[i][0] = obj_data->text_size;
+        obj_data->text_size += part->text_size;
+        count += part->data_sections_count;
+    }
+
+    if (obj_data->text_size > 0) {
+        if (!(obj_data->text = wasm_runtime_malloc(obj_data->text_size))) {
+            aot_set_last_error("allocate memory for text failed.");
+            goto fail;
+        }
+        memset(obj_data->text, 0, obj_data->text_size);
+        obj_data->is_text_allocated = true;
+        for (i = 0; i < obj_data->part_count; i++) {
+            part = obj_data->parts[i];
+            if (part->text_size > 0)
+                bh_memcpy_s((uint8 *)obj_data->text + data_offsets[i][0],
+                            obj_data->text_size - data_offsets[i][0],
+                            part->text, part->text_size);
+        }
+    }
+
+    /* Merge the data sections with the same name */
+    if (count > 0) {
+        size = sizeof(AOTObjectDataSection) * (uint64)count;
+        if (!(obj_data->data_sections = wasm_runtime_malloc((uint32)size))) {
+            aot_set_last_error("allocate memory for data sections failed.");
+            goto fail;
+        }
+        memset(obj_data->data_sections, 0, (uint32)size);
+    }
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        for (j = 0; j < part->data_sections_count; j++) {
+            part_data_section = part->data_sections + j;
+            if (!(data_section = find_data_section(
+                      obj_data->data_sections, obj_data->data_sections_count,
+                      part_data_section->name))) {
+                data_section =
+                    obj_data->data_sections + obj_data->data_sections_count++;
+                data_section->name = part_data_section->name;
+            }
+            data_section->size =
+                align_uint(data_section->size, OBJ_DATA_PART_ALIGN);
+            data_offsets[i][j + 1] = data_section->size;
+            data_section->size += part_data_section->size;
+        }
+    }
+    for (i = 0; i < obj_data->data_sections_count; i++) {
+        data_section = obj_data->data_sections + i;
+        if (data_section->size > 0) {
+            if (!(data_section->data =
+                      wasm_runtime_malloc(data_section->size))) {
+                aot_set_last_error("allocate memory for data section failed.");
+                goto fail;
+            }
+            memset(data_section->data, 0, data_section->size);
+        }
+    }
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        for (j = 0; j < part->data_sections_count; j++) {
+            part_data_section = part->data_sections + j;
+            data_section =
+                find_data_section(obj_data->data_sections,
+                                  obj_data->data_sections_count,
+                                  part_data_section->name);
+            if (part_data_section->size > 0)
+                bh_memcpy_s(data_section->data + data_offsets[i][j + 1],
+                            data_section->size - data_offsets[i][j + 1],
+                            part_data_section->data, part_data_section->size);
+        }
+    }
+
+    /* Merge the functions */
+    obj_data->func_count = comp_ctx->comp_data->func_count;
+    if (obj_data->func_count > 0) {
+        size = sizeof(AOTObjectFunc) * (uint64)obj_data->func_count;
+        if (!(obj_data->funcs = wasm_runtime_malloc((uint32)size))) {
+            aot_set_last_error("allocate memory for functions failed.");
+            goto fail;
+        }
+        memset(obj_data->funcs, 0, (uint32)size);
+    }
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        for (j = 0; j < part->func_count; j++) {
+            if (part->funcs[j].func_name) {
+                obj_data->funcs[j].func_name = part->funcs[j].func_name;
+                obj_data->funcs[j].text_offset =
+                    part->funcs[j].text_offset + data_offsets[i][0];
+            }
+        }
+    }
+
+    /* Merge the relocation groups with the same name */
+    count = 0;
+    for (i = 0; i < obj_data->part_count; i++)
+        count += obj_data->parts[i]->relocation_group_count;
+    if (count > 0) {
+        size = sizeof(AOTRelocationGroup) * (uint64)count;
+        if (!(obj_data->relocation_groups =
+                  wasm_runtime_malloc((uint32)size))) {
+            aot_set_last_error("allocate memory for relocation groups failed.");
+            goto fail;
+        }
+        memset(obj_data->relocation_groups, 0, (uint32)size);
+    }
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        for (j = 0; j < part->relocation_group_count; j++) {
+            part_group = part->relocation_groups + j;
+            if (!(group = find_relocation_group(
+                      obj_data->relocation_groups,
+                      obj_data->relocation_group_count,
+                      part_group->section_name))) {
+                group = obj_data->relocation_groups
+                        + obj_data->relocation_group_count++;
+                group->section_name = part_group->section_name;
+            }
+            group->relocation_count += part_group->relocation_count;
+        }
+    }
+    for (i = 0; i < obj_data->relocation_group_count; i++) {
+        group = obj_data->relocation_groups + i;
+        size = sizeof(AOTRelocation) * (uint64)group->relocation_count;
+        if (size >= UINT32_MAX
+            || !(group->relocations = wasm_runtime_malloc((uint32)size))) {
+            aot_set_last_error("allocate memory for relocations failed.");
+            goto fail;
+        }
+        /* Count the relocations again when copying them */
+        group->relocation_count = 0;
+    }
+    for (i = 0; i < obj_data->part_count; i++) {
+        part = obj_data->parts[i];
+        for (j = 0; j < part->relocation_group_count; j++) {
+            part_group = part->relocation_groups + j;
+            group = find_relocation_group(obj_data->relocation_groups,
+                                          obj_data->relocation_group_count,
+                                          part_group->section_name);
+
+            /* Offset of the relocated section, e.g. ".text" of
+               ".rela.text", in the merged section */
+            section_offset = -1;
+            if (str_starts_with(part_group->section_name, ".rela."))
+                section_offset = get_part_section_offset(
+                    part, data_offsets[i],
+                    part_group->section_name + strlen(".rela"));
+            if (section_offset < 0) {
+                aot_set_last_error("link object files of the target failed.");
+                goto fail;
+            }
+
+            for (k = 0; k < part_group->relocation_count; k++) {
+                relocation = group->relocations + group->relocation_count++;
+                *relocation = part_group->relocations[k];
+                relocation->relocation_offset += (uint64)section_offset;
+
+                /* Relocation to a section, including the ones converted
+                   from the local symbols, e.g. ".LCPIxxx" */
+                if (relocation->symbol_name
+                    && (symbol_offset = get_part_section_offset(
+                            part, data_offsets[i], relocation->symbol_name))
+                           > 0)
+                    relocation->relocation_addend += symbol_offset;
+            }
+        }
+    }
+
+    ret = true;
+
+fail:
+    wasm_runtime_free(data_offsets);
+    return ret;
+}
+
+/* Relocation types of x86_64 resolved when folding the read-only data
+   sections into the text section */
+#define R_X86_64_PC32 2
+#define R_X86_64_PC64 24
+
+/* Alignment of the read-only data sections folded into the text section,
+   the code of the AOT file is also aligned with it */
+#define OBJ_RODATA_FOLD_ALIGN 64
+
+static bool
+is_foldable_data_section(const char *name)
+{
+    return !strcmp(name, ".rodata")
+           /* ".rodata.cst4/8/16/.." */
+           || str_starts_with(name, ".rodata.cst")
+           /* ".rodata.strn.m" */
+           || str_starts_with(name, ".rodata.str");
+}
+
+/* Get the offset of the text or a folded data section in the folded text
+   section, return -1 if the name isn't one of them */
+static int64
+get_folded_section_offset(AOTObjectData *obj_data, uint32 *fold_offsets,
+                          const char *name)
+{
+    uint32 i;
+
+    if (!name)
+        return -1;
+    if (!strcmp(name, ".text"))
+        return 0;
+    for (i = 0; i < obj_data->data_sections_count; i++)
+        if (fold_offsets[i] > 0
+            && !strcmp(obj_data->data_sections[i].name, name))
+            return fold_offsets[i];
+    return -1;
+}
+
+static bool
+is_pc_relative_relocation(const AOTRelocation *relocation)
+{
+    return relocation->relocation_type == R_X86_64_PC32
+           || relocation->relocation_type == R_X86_64_PC64;
+}
+
+/**
+ * Fold the read-only data sections of the XIP file into the text section
+ * and resolve the PC-relative relocations between them, so that the code
+ * needn't be patched when it is loaded and the pages of a mapped AOT file
+ * can be shared by the processes. Only done for x86_64, whose code refers
+ * to the read-only data with PC-relative relocations when compiled as
+ * position independent code, and the read-only data sections are kept
+ * unchanged if any of them has a relocation which can't be resolved.
+ */
+static bool
+aot_fold_rodata_into_text(AOTCompContext *comp_ctx, AOTObjectData *obj_data)
+{
+    AOTObjectDataSection *data_section;
+    AOTRelocationGroup *group;
+    AOTRelocation *relocation;
+    uint32 *fold_offsets = NULL, i, j, k;
+    uint64 text_size, size;
+    int64 section_offset, symbol_offset, value;
+    uint8 *text = NULL, *p;
+    bool ret = false;
+
+#if WASM_ENABLE_DEBUG_AOT != 0
+    /* The text is the whole object file */
+    return true;
+#endif
+
+    /* Only for ELF64 little-endian binary of x86_64 */
+    if (!comp_ctx->is_indirect_mode
+        || strcmp(comp_ctx->target_arch, "x86_64")
+        || obj_data->target_info.bin_type
+               != LLVMBinaryTypeELF64L - LLVMBinaryTypeELF32L
+        || obj_data->literal_size > 0 || obj_data->text_size == 0
+        || obj_data->data_sections_count == 0)
+        return true;
+
+    size = sizeof(uint32) * (uint64)obj_data->data_sections_count;
+    if (!(fold_offsets = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        return false;
+    }
+    memset(fold_offsets, 0, (uint32)size);
+
+    /* Layout the folded data sections after the code */
+    text_size = obj_data->text_size;
+    for (i = 0; i < obj_data->data_sections_count; i++) {
+        data_section = obj_data->data_sections + i;
+        if (is_foldable_data_section(data_section->name)) {
+            text_size = (text_size + OBJ_RODATA_FOLD_ALIGN - 1)
+                        & ~(uint64)(OBJ_RODATA_FOLD_ALIGN - 1);
+            fold_offsets[i] = (uint32)text_size;
+            text_size += data_section->size;
+        }
+    }
+    if (text_size == obj_data->text_size || text_size >= INT32_MAX) {
+        ret = true;
+        goto fail;
+    }
+
+    /* All the relocations of the folded data sections must be resolved */
+    for (i = 0; i < obj_data->relocation_group_count; i++) {
+        group = obj_data->relocation_groups + i;
+        if (!str_starts_with(group->section_name, ".rela.")
+            || get_folded_section_offset(obj_data, fold_offsets,
+                                         group->section_name
+                                             + strlen(".rela"))
+                   <= 0)
+            continue;
+        for (j = 0; j < group->relocation_count; j++) {
+            relocation = group->relocations + j;
+            if (!is_pc_relative_relocation(relocation)
+                || get_folded_section_offset(obj_data, fold_offsets,
+                                             relocation->symbol_name)
+                       < 0) {
+                ret = true;
+                goto fail;
+            }
+        }
+    }
+
+    if (!(text = wasm_runtime_malloc((uint32)text_size))) {
+        aot_set_last_error("allocate memory for text failed.");
+        goto fail;
+    }
+    memset(text, 0, (uint32)text_size);
+    bh_memcpy_s(text, (uint32)text_size, obj_data->text, obj_data->text_size);
+    for (i = 0; i < obj_data->data_sections_count; i++) {
+        data_section = obj_data->data_sections + i;
+        if (fold_offsets[i] > 0 && data_section->size > 0)
+            bh_memcpy_s(text + fold_offsets[i],
+                        (uint32)text_size - fold_offsets[i],
+                        data_section->data, data_section->size);
+    }
+
+    for (i = 0; i < obj_data->relocation_group_count; i++) {
+        group = obj_data->relocation_groups + i;
+        section_offset = -1;
+        if (str_starts_with(group->section_name, ".rela."))
+            section_offset = get_folded_section_offset(
+                obj_data, fold_offsets,
+                group->section_name + strlen(".rela"));
+
+        for (j = k = 0; j < group->relocation_count; j++) {
+            relocation = group->relocations + j;
+            symbol_offset = get_folded_section_offset(obj_data, fold_offsets,
+                                                      relocation->symbol_name);
+
+            if (section_offset >= 0 && symbol_offset >= 0
+                && is_pc_relative_relocation(relocation)) {
+                /* Resolve it in the folded text: S + A - P */
+                p = text + section_offset + relocation->relocation_offset;
+                value = symbol_offset + relocation->relocation_addend
+                        - (section_offset
+                           + (int64)relocation->relocation_offset);
+                if (relocation->relocation_type == R_X86_64_PC32) {
+                    int32 value32 = (int32)value;
+                    if (!is_little_endian())
+                        exchange_uint32((uint8 *)&value32);
+                    bh_memcpy_s(p, sizeof(int32), &value32, sizeof(int32));
+                }
+                else {
+                    if (!is_little_endian())
+                        exchange_uint64((uint8 *)&value);
+                    bh_memcpy_s(p, sizeof(int64), &value, sizeof(int64));
+                }
+                continue;
+            }
+
+            /* Keep the relocation, which refers to the folded data
+               section with the text section now */
+            if (symbol_offset > 0) {
+                relocation->symbol_name = (char *)".text";
+                relocation->relocation_addend += symbol_offset;
+            }
+            group->relocations[k++] = *relocation;
+        }
+        group->relocation_count = k;
+    }
+
+    /* Remove the empty relocation groups and the folded data sections */
+    for (i = j = 0; i < obj_data->relocation_group_count; i++) {
+        group = obj_data->relocation_groups + i;
+        if (group->relocation_count > 0)
+            obj_data->relocation_groups[j++] = *group;
+        else if (group->relocations)
+            wasm_runtime_free(group->relocations);
+    }
+    obj_data->relocation_group_count = j;
+
+    for (i = j = 0; i < obj_data->data_sections_count; i++) {
+        data_section = obj_data->data_sections + i;
+        if (fold_offsets[i] == 0)
+            obj_data->data_sections[j++] = *data_section;
+        /* The data of the merged sections is allocated */
+        else if (obj_data->parts && data_section->data)
+            wasm_runtime_free(data_section->data);
+    }
+    obj_data->data_sections_count = j;
+
+    if (obj_data->is_text_allocated)
+        wasm_runtime_free(obj_data->text);
+    obj_data->text = text;
+    obj_data->text_size = (uint32)text_size;
+    obj_data->is_text_allocated = true;
+    obj_data->text_align = OBJ_RODATA_FOLD_ALIGN;
+    text = NULL;
+    ret = true;
+
+fail:
+    if (text)
+        wasm_runtime_free(text);
+    wasm_runtime_free(fold_offsets);
+    return ret;
+}
+
+static AOTObjectData *
+aot_obj_data_create_from_parts(AOTCompContext *comp_ctx)
+{
+    AOTObjectData *obj_data;
+    uint32 i;
+
+    if (!(obj_data = wasm_runtime_malloc(sizeof(AOTObjectData)))) {
+        aot_set_last_error("allocate memory failed.");
+        return NULL;
+    }
+    memset(obj_data, 0, sizeof(AOTObjectData));
+
+    if (!(obj_data->parts = wasm_runtime_malloc(
+              sizeof(AOTObjectData *) * comp_ctx->part_obj_buf_count))) {
+        aot_set_last_error("allocate memory failed.");
+        goto fail;
+    }
+    memset(obj_data->parts, 0,
+           sizeof(AOTObjectData *) * comp_ctx->part_obj_buf_count);
+    obj_data->part_count = comp_ctx->part_obj_buf_count;
+
+    for (i = 0; i < obj_data->part_count; i++) {
+        if (!(obj_data->parts[i] = wasm_runtime_malloc(sizeof(AOTObjectData)))) {
+            aot_set_last_error("allocate memory failed.");
+            goto fail;
+        }
+        memset(obj_data->parts[i], 0, sizeof(AOTObjectData));
+
+        /* The object data takes the ownership of the object file */
+        obj_data->parts[i]->mem_buf = comp_ctx->part_obj_bufs[i];
+        comp_ctx->part_obj_bufs[i] = NULL;
+        if (!aot_resolve_object_data(comp_ctx, obj_data->parts[i]))
+            goto fail;
+    }
+
+    bh_print_time("Begin to link object files");
+    if (!aot_merge_object_data(comp_ctx, obj_data))
+        goto fail;
+
+    return obj_data;
+
+fail:
+    aot_obj_data_destroy(obj_data);
+    return NULL;
+}
+
 static AOTObjectData *
 aot_obj_data_create(AOTCompContext *comp_ctx)
 {
@@ -2681,6 +3327,9 @@ aot_obj_data_create(AOTCompContext *comp_ctx)
     AOTObjectData *obj_data;
     LLVMTargetRef target = LLVMGetTargetMachineTarget(comp_ctx->target_machine);
 
+    if (comp_ctx->part_obj_buf_count > 0)
+        return aot_obj_data_create_from_parts(comp_ctx);
+
     bh_print_time("Begin to emit object file to buffer");
 
     if (!(obj_data = wasm_runtime_malloc(sizeof(AOTObjectData)))) {
@@ -2806,23 +3455,7 @@ aot_obj_data_create(AOTCompContext *comp_ctx)
         }
     }
 
-    if (!(obj_data->binary = LLVMCreateBinary(obj_data->mem_buf, NULL, &err))) {
-        if (err) {
-            LLVMDisposeMessage(err);
-            err = NULL;
-        }
-        aot_set_last_error("llvm create binary failed.");
-        goto fail;
-    }
-
-    bh_print_time("Begin to resolve object file info");
-
-    /* resolve target info/text/relocations/functions */
-    if (!aot_resolve_target_info(comp_ctx, obj_data)
-        || !aot_resolve_text(obj_data) || !aot_resolve_literal(obj_data)
-        || !aot_resolve_object_data_sections(obj_data)
-        || !aot_resolve_object_relocation_groups(obj_data)
-        || !aot_resolve_functions(comp_ctx, obj_data))
+    if (!aot_resolve_object_data(comp_ctx, obj_data))
         goto fail;
 
     return obj_data;
@@ -2843,6 +3476,9 @@ aot_emit_aot_file_buf(AOTCompContext *comp_ctx, AOTCompData *comp_data,
     if (!obj_data)
         return NULL;
 
+    if (!aot_fold_rodata_into_text(comp_ctx, obj_data))
+        goto fail1;
+
     aot_file_size = get_aot_file_size(comp_ctx, comp_data, obj_data);
 
     if (!(buf = aot_file_buf = wasm_runtime_malloc(aot_file_size))) {
@@ -2866,6 +3502,7 @@ aot_emit_aot_file_buf(AOTCompContext *comp_ctx, AOTCompData *comp_data,
                                         comp_data, obj_data)
         || !aot_emit_native_symbol(buf, buf_end, &offset, comp_ctx)
         || !aot_emit_name_section(buf, buf_end, &offset, comp_data, comp_ctx)
+        || !aot_emit_pgo_section(buf, buf_end, &offset, comp_ctx)
         || !aot_emit_custom_sections(buf, buf_end, &offset, comp_data,
                                      comp_ctx))
         goto fail2;
@@ -5,6 +5,7 @@
 
 #include "aot_emit_control.h"
 #include "aot_emit_exception.h"
+#include "aot_emit_pgo.h"
 #include "../aot/aot_runtime.h"
 #include "../interpreter/wasm_loader.h"
 
@@ -383,6 +384,7 @@ aot_compile_op_block(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     AOTBlock *block;
     uint8 *else_addr, *end_addr;
     LLVMValueRef value;
+    uint32 pgo_counter_idx = 0;
     char name[32];
 
     /* Check block stack */
@@ -467,6 +469,10 @@ aot_compile_op_block(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
         }
 
         if (!LLVMIsConstant(value)) {
+            if (!aot_pgo_compile_cond_br(comp_ctx, func_ctx, value,
+                                         &pgo_counter_idx))
+                goto fail;
+
             /* Compare value is not constant, create condition br IR */
             /* Create entry block */
             format_block_name(name, sizeof(name), block->block_index,
@@ -497,6 +503,10 @@ aot_compile_op_block(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                               block->llvm_end_block);
                 block->is_reachable = true;
             }
+            if (!aot_pgo_set_cond_br_weights(
+                    comp_ctx, LLVMGetBasicBlockTerminator(CURR_BLOCK()),
+                    pgo_counter_idx))
+                goto fail;
             if (!push_aot_block_to_stack_and_pass_params(comp_ctx, func_ctx,
                                                          block))
                 goto fail;
@@ -809,7 +819,7 @@ aot_compile_op_br_if(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     LLVMValueRef value_cmp, value, *values = NULL;
     LLVMBasicBlockRef llvm_else_block, next_llvm_end_block;
     char name[32];
-    uint32 i, param_index, result_index;
+    uint32 i, param_index, result_index, pgo_counter_idx = 0;
     uint64 size;
 
 #if WASM_ENABLE_THREAD_MGR != 0
@@ -840,6 +850,10 @@ aot_compile_op_br_if(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
             return false;
         }
 
+        if (!aot_pgo_compile_cond_br(comp_ctx, func_ctx, value_cmp,
+                                     &pgo_counter_idx))
+            goto fail;
+
         /* Create llvm else block */
         CREATE_BLOCK(llvm_else_block, "br_if_else");
         MOVE_BLOCK_AFTER_CURR(llvm_else_block);
@@ -869,6 +883,10 @@ aot_compile_op_br_if(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
 
             BUILD_COND_BR(value_cmp, block_dst->llvm_entry_block,
                           llvm_else_block);
+            if (!aot_pgo_set_cond_br_weights(
+                    comp_ctx, LLVMGetBasicBlockTerminator(CURR_BLOCK()),
+                    pgo_counter_idx))
+                goto fail;
 
             /* Move builder to else block */
             SET_BUILDER_POS(llvm_else_block);
@@ -913,6 +931,10 @@ aot_compile_op_br_if(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
             /* Condition jump to end block */
             BUILD_COND_BR(value_cmp, block_dst->llvm_end_block,
                           llvm_else_block);
+            if (!aot_pgo_set_cond_br_weights(
+                    comp_ctx, LLVMGetBasicBlockTerminator(CURR_BLOCK()),
+                    pgo_counter_idx))
+                goto fail;
 
             /* Move builder to else block */
             SET_BUILDER_POS(llvm_else_block);
@@ -945,7 +967,7 @@ aot_compile_op_br_table(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     LLVMBasicBlockRef next_llvm_end_block;
     AOTBlock *target_block;
     uint32 br_depth, depth_idx;
-    uint32 param_index, result_index;
+    uint32 param_index, result_index, pgo_counter_idx = 0;
     uint64 size;
     char name[32];
 
@@ -972,6 +994,10 @@ aot_compile_op_br_table(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     }
 
     if (!LLVMIsConstant(value_cmp)) {
+        if (!aot_pgo_compile_br_table(comp_ctx, func_ctx, value_cmp, br_count,
+                                      &pgo_counter_idx))
+            return false;
+
         /* Compare value is not constant, create switch IR */
         for (i = 0; i <= br_count; i++) {
             target_block = get_target_block(func_ctx, br_depths[i]);
@@ -1062,6 +1088,10 @@ aot_compile_op_br_table(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
             LLVMAddCase(value_switch, value_case, target_llvm_block);
         }
 
+        if (!aot_pgo_set_switch_weights(comp_ctx, value_switch,
+                                        pgo_counter_idx, br_count))
+            return false;
+
         return handle_next_reachable_block(comp_ctx, func_ctx, p_frame_ip);
     }
     else {
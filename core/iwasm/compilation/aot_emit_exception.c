@@ -13,7 +13,7 @@ aot_emit_exception(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                    LLVMBasicBlockRef cond_br_else_block)
 {
     LLVMBasicBlockRef block_curr = LLVMGetInsertBlock(comp_ctx->builder);
-    LLVMValueRef exce_id = I32_CONST((uint32)exception_id), func_const, func;
+    LLVMValueRef exce_id = I32_CONST((uint32)exception_id), func;
     LLVMTypeRef param_types[2], ret_type, func_type, func_ptr_type;
     LLVMValueRef param_values[2];
 
@@ -50,21 +50,7 @@ aot_emit_exception(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
             return false;
         }
 
-        if (comp_ctx->is_jit_mode) {
-            /* Create function type */
-            if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
-                aot_set_last_error("create LLVM function type failed.");
-                return false;
-            }
-            /* Create LLVM function with const function pointer */
-            if (!(func_const =
-                      I64_CONST((uint64)(uintptr_t)jit_set_exception_with_id))
-                || !(func = LLVMConstIntToPtr(func_const, func_ptr_type))) {
-                aot_set_last_error("create LLVM value failed.");
-                return false;
-            }
-        }
-        else if (comp_ctx->is_indirect_mode) {
+        if (comp_ctx->is_indirect_mode) {
             int32 func_index;
             if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
                 aot_set_last_error("create LLVM function type failed.");
@@ -83,11 +69,14 @@ aot_emit_exception(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
             }
         }
         else {
-            /* Create LLVM function with external function pointer */
-            if (!(func = LLVMGetNamedFunction(func_ctx->module,
-                                              "aot_set_exception_with_id"))
-                && !(func = LLVMAddFunction(func_ctx->module,
-                                            "aot_set_exception_with_id",
+            /* Create LLVM function with external function pointer, in JIT
+               mode it is resolved to the absolute symbol defined in the
+               JIT */
+            const char *func_name = comp_ctx->is_jit_mode
+                                        ? "jit_set_exception_with_id"
+                                        : "aot_set_exception_with_id";
+            if (!(func = LLVMGetNamedFunction(func_ctx->module, func_name))
+                && !(func = LLVMAddFunction(func_ctx->module, func_name,
                                             func_type))) {
                 aot_set_last_error("add LLVM function failed.");
                 return false;
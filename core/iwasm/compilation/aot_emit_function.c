@@ -7,6 +7,7 @@
 #include "aot_emit_exception.h"
 #include "aot_emit_control.h"
 #include "aot_emit_table.h"
+#include "aot_emit_pgo.h"
 #include "../aot/aot_runtime.h"
 
 #define ADD_BASIC_BLOCK(block, name)                                          \
@@ -154,21 +155,13 @@ call_aot_invoke_native_func(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
         return false;
     }
 
-    /* prepare function pointer */
-    if (comp_ctx->is_jit_mode) {
-        if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
-            aot_set_last_error("create LLVM function type failed.");
-            return false;
-        }
+    /* JIT mode, call the function through its symbol, which is defined
+       as an absolute symbol in the JIT */
+    if (comp_ctx->is_jit_mode)
+        func_name = "llvm_jit_invoke_native";
 
-        /* JIT mode, call the function directly */
-        if (!(func = I64_CONST((uint64)(uintptr_t)llvm_jit_invoke_native))
-            || !(func = LLVMConstIntToPtr(func, func_ptr_type))) {
-            aot_set_last_error("create LLVM value failed.");
-            return false;
-        }
-    }
-    else if (comp_ctx->is_indirect_mode) {
+    /* prepare function pointer */
+    if (comp_ctx->is_indirect_mode) {
         int32 func_index;
         if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
             aot_set_last_error("create LLVM function type failed.");
@@ -272,7 +265,7 @@ static bool
 call_aot_alloc_frame_func(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                           LLVMValueRef func_idx)
 {
-    LLVMValueRef param_values[2], ret_value, value, func;
+    LLVMValueRef param_values[2], ret_value, func;
     LLVMTypeRef param_types[2], ret_type, func_type, func_ptr_type;
     LLVMBasicBlockRef block_curr = LLVMGetInsertBlock(comp_ctx->builder);
     LLVMBasicBlockRef frame_alloc_fail, frame_alloc_success;
@@ -333,7 +326,7 @@ fail:
 static bool
 call_aot_free_frame_func(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
 {
-    LLVMValueRef param_values[1], ret_value, value, func;
+    LLVMValueRef param_values[1], ret_value, func;
     LLVMTypeRef param_types[1], ret_type, func_type, func_ptr_type;
 
     param_types[0] = comp_ctx->exec_env_type;
@@ -429,22 +422,13 @@ check_app_addr_and_convert(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
         return false;
     }
 
-    /* prepare function pointer */
-    if (comp_ctx->is_jit_mode) {
-        if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
-            aot_set_last_error("create LLVM function type failed.");
-            return false;
-        }
+    /* JIT mode, call the function through its symbol, which is defined
+       as an absolute symbol in the JIT */
+    if (comp_ctx->is_jit_mode)
+        func_name = "jit_check_app_addr_and_convert";
 
-        /* JIT mode, call the function directly */
-        if (!(func =
-                  I64_CONST((uint64)(uintptr_t)jit_check_app_addr_and_convert))
-            || !(func = LLVMConstIntToPtr(func, func_ptr_type))) {
-            aot_set_last_error("create LLVM value failed.");
-            return false;
-        }
-    }
-    else if (comp_ctx->is_indirect_mode) {
+    /* prepare function pointer */
+    if (comp_ctx->is_indirect_mode) {
         int32 func_index;
         if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
             aot_set_last_error("create LLVM function type failed.");
@@ -890,21 +874,13 @@ call_aot_call_indirect_func(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
         return false;
     }
 
-    /* prepare function pointer */
-    if (comp_ctx->is_jit_mode) {
-        if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
-            aot_set_last_error("create LLVM function type failed.");
-            return false;
-        }
+    /* JIT mode, call the function through its symbol, which is defined
+       as an absolute symbol in the JIT */
+    if (comp_ctx->is_jit_mode)
+        func_name = "llvm_jit_call_indirect";
 
-        /* JIT mode, call the function directly */
-        if (!(func = I64_CONST((uint64)(uintptr_t)llvm_jit_call_indirect))
-            || !(func = LLVMConstIntToPtr(func, func_ptr_type))) {
-            aot_set_last_error("create LLVM value failed.");
-            return false;
-        }
-    }
-    else if (comp_ctx->is_indirect_mode) {
+    /* prepare function pointer */
+    if (comp_ctx->is_indirect_mode) {
         int32 func_index;
         if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
             aot_set_last_error("create LLVM function type failed.");
@@ -1016,6 +992,115 @@ call_aot_call_indirect_func(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     return true;
 }
 
+/* The max number of targets of a call_indirect which are called
+   directly after comparing the function index with them */
+#define MAX_DIRECT_CALL_TARGET_NUM 3
+
+static bool
+is_direct_call_target(const AOTCompContext *comp_ctx, uint32 func_idx,
+                      uint32 type_idx)
+{
+    const AOTCompData *comp_data = comp_ctx->comp_data;
+    uint32 import_func_count = comp_data->import_func_count;
+
+    /* Same as the check of the function type index at runtime */
+    return func_idx >= import_func_count
+           && func_idx < import_func_count + comp_data->func_count
+           && comp_data->funcs[func_idx - import_func_count]->func_type_index
+                  == type_idx;
+}
+
+/**
+ * Get all the possible targets of a call_indirect from the element
+ * segments if the table is never changed after instantiation, return 0
+ * if the targets are unknown or there are too many targets
+ */
+static uint32
+get_static_call_indirect_targets(const AOTCompContext *comp_ctx,
+                                 uint32 tbl_idx, uint32 type_idx,
+                                 uint32 *func_idxes)
+{
+    const AOTCompData *comp_data = comp_ctx->comp_data;
+    const WASMModule *wasm_module = comp_data->wasm_module;
+    AOTTableInitData *init_data;
+    uint32 target_count = 0, func_idx, i, j, k;
+
+    /* The imported or exported table may be changed by the host or
+       other modules */
+    if (tbl_idx < comp_data->import_table_count
+        || wasm_module->possible_table_mutation)
+        return 0;
+
+    for (i = 0; i < wasm_module->export_count; i++) {
+        if (wasm_module->exports[i].kind == EXPORT_KIND_TABLE
+            && wasm_module->exports[i].index == tbl_idx)
+            return 0;
+    }
+
+    for (i = 0; i < comp_data->table_init_data_count; i++) {
+        init_data = comp_data->table_init_data_list[i];
+
+#if WASM_ENABLE_REF_TYPES != 0
+        if (!wasm_elem_is_active(init_data->mode))
+            continue;
+#endif
+        if (init_data->table_index != tbl_idx)
+            continue;
+
+        for (j = 0; j < init_data->func_index_count; j++) {
+            func_idx = init_data->func_indexes[j];
+            /* The other elements trap in the slow path */
+            if (!is_direct_call_target(comp_ctx, func_idx, type_idx))
+                continue;
+
+            for (k = 0; k < target_count; k++) {
+                if (func_idxes[k] == func_idx)
+                    break;
+            }
+            if (k < target_count)
+                continue;
+
+            if (target_count == MAX_DIRECT_CALL_TARGET_NUM)
+                return 0;
+            func_idxes[target_count++] = func_idx;
+        }
+    }
+
+    return target_count;
+}
+
+static bool
+add_call_result_incomings(AOTCompContext *comp_ctx, AOTFuncType *func_type,
+                          LLVMValueRef value_ret, LLVMValueRef *param_values,
+                          LLVMValueRef *result_phis)
+{
+    LLVMBasicBlockRef block_curr = LLVMGetInsertBlock(comp_ctx->builder);
+    LLVMValueRef ext_ret;
+    LLVMTypeRef ret_type;
+    uint32 func_param_count = func_type->param_count, i;
+    char buf[32];
+
+    if (func_type->result_count == 0)
+        return true;
+
+    /* Push the first result to stack */
+    LLVMAddIncoming(result_phis[0], &value_ret, &block_curr, 1);
+
+    /* Load extra result from its address and push to stack */
+    for (i = 1; i < func_type->result_count; i++) {
+        ret_type = TO_LLVM_TYPE(func_type->types[func_param_count + i]);
+        snprintf(buf, sizeof(buf), "ext_ret%d", i - 1);
+        if (!(ext_ret =
+                  LLVMBuildLoad2(comp_ctx->builder, ret_type,
+                                 param_values[func_param_count + i], buf))) {
+            aot_set_last_error("llvm build load failed.");
+            return false;
+        }
+        LLVMAddIncoming(result_phis[i], &ext_ret, &block_curr, 1);
+    }
+    return true;
+}
+
 bool
 aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                              uint32 type_idx, uint32 tbl_idx)
@@ -1025,7 +1110,7 @@ aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     LLVMValueRef ftype_idx_ptr, ftype_idx, ftype_idx_const;
     LLVMValueRef cmp_elem_idx, cmp_func_idx, cmp_ftype_idx;
     LLVMValueRef func, func_ptr, table_size_const;
-    LLVMValueRef ext_ret_offset, ext_ret_ptr, ext_ret, res;
+    LLVMValueRef ext_ret_offset, ext_ret_ptr, res;
     LLVMValueRef *param_values = NULL, *value_rets = NULL;
     LLVMValueRef *result_phis = NULL, value_ret, import_func_count;
     LLVMTypeRef *param_types = NULL, ret_type;
@@ -1034,9 +1119,15 @@ aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     LLVMBasicBlockRef check_elem_idx_succ, check_ftype_idx_succ;
     LLVMBasicBlockRef check_func_idx_succ, block_return, block_curr;
     LLVMBasicBlockRef block_call_import, block_call_non_import;
-    LLVMValueRef offset;
+    LLVMBasicBlockRef block_call_slow;
+    LLVMBasicBlockRef block_call_directs[MAX_DIRECT_CALL_TARGET_NUM];
+    LLVMValueRef offset, value_switch, target_func_idx;
+    AOTFuncContext *callee_ctx;
     uint32 total_param_count, func_param_count, func_result_count;
     uint32 ext_cell_num, param_cell_num, i, j;
+    uint32 pgo_counter_idx = 0, target_count = 0;
+    uint32 target_func_idxes[MAX_DIRECT_CALL_TARGET_NUM];
+    uint64 target_counts[MAX_DIRECT_CALL_TARGET_NUM], total_count = 0;
     uint8 wasm_ret_type, *wasm_ret_types;
     uint64 total_size;
     char buf[32];
@@ -1169,42 +1260,6 @@ aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                              true, cmp_func_idx, check_func_idx_succ)))
         goto fail;
 
-    /* Load function type index */
-    if (!(ftype_idx_ptr = LLVMBuildInBoundsGEP2(
-              comp_ctx->builder, I32_TYPE, func_ctx->func_type_indexes,
-              &func_idx, 1, "ftype_idx_ptr"))) {
-        aot_set_last_error("llvm build inbounds gep failed.");
-        goto fail;
-    }
-
-    if (!(ftype_idx = LLVMBuildLoad2(comp_ctx->builder, I32_TYPE, ftype_idx_ptr,
-                                     "ftype_idx"))) {
-        aot_set_last_error("llvm build load failed.");
-        goto fail;
-    }
-
-    /* Check if function type index not equal */
-    if (!(cmp_ftype_idx = LLVMBuildICmp(comp_ctx->builder, LLVMIntNE, ftype_idx,
-                                        ftype_idx_const, "cmp_ftype_idx"))) {
-        aot_set_last_error("llvm build icmp failed.");
-        goto fail;
-    }
-
-    /* Throw exception if ftype_idx != ftype_idx_const */
-    if (!(check_ftype_idx_succ = LLVMAppendBasicBlockInContext(
-              comp_ctx->context, func_ctx->func, "check_ftype_idx_succ"))) {
-        aot_set_last_error("llvm add basic block failed.");
-        goto fail;
-    }
-
-    LLVMMoveBasicBlockAfter(check_ftype_idx_succ,
-                            LLVMGetInsertBlock(comp_ctx->builder));
-
-    if (!(aot_emit_exception(comp_ctx, func_ctx,
-                             EXCE_INVALID_FUNCTION_TYPE_INDEX, true,
-                             cmp_ftype_idx, check_ftype_idx_succ)))
-        goto fail;
-
     /* Initialize parameter types of the LLVM function */
     total_param_count = 1 + func_param_count;
 
@@ -1301,6 +1356,96 @@ aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     }
 #endif
 
+    /* Record the call target for PGO */
+    if (!aot_pgo_compile_call_indirect(comp_ctx, func_ctx, func_idx,
+                                       &pgo_counter_idx))
+        goto fail;
+
+    /* Speculatively devirtualize the call: compare func_idx with the known
+       targets and call them directly so that they can be inlined. They are
+       all the possible targets if the table is never changed, or else the
+       hot targets in the profile data, other targets go to the slow path */
+    if (!comp_ctx->is_indirect_mode) {
+        target_count = get_static_call_indirect_targets(
+            comp_ctx, tbl_idx, type_idx, target_func_idxes);
+        if (target_count == 0) {
+            target_count = aot_pgo_get_call_indirect_targets(
+                comp_ctx, pgo_counter_idx, target_func_idxes, target_counts,
+                MAX_DIRECT_CALL_TARGET_NUM, &total_count);
+            for (i = 0, j = 0; i < target_count; i++) {
+                if (is_direct_call_target(comp_ctx, target_func_idxes[i],
+                                          type_idx)) {
+                    target_func_idxes[j] = target_func_idxes[i];
+                    target_counts[j++] = target_counts[i];
+                }
+            }
+            target_count = j;
+        }
+    }
+
+    if (target_count > 0) {
+        ADD_BASIC_BLOCK(block_call_slow, "call_indirect_slow");
+        LLVMMoveBasicBlockAfter(block_call_slow,
+                                LLVMGetInsertBlock(comp_ctx->builder));
+
+        if (!(value_switch = LLVMBuildSwitch(comp_ctx->builder, func_idx,
+                                             block_call_slow, target_count))) {
+            aot_set_last_error("llvm build switch failed.");
+            goto fail;
+        }
+
+        for (i = 0; i < target_count; i++) {
+            ADD_BASIC_BLOCK(block_call_directs[i], "call_direct");
+            target_func_idx = I32_CONST(target_func_idxes[i]);
+            CHECK_LLVM_CONST(target_func_idx);
+            LLVMAddCase(value_switch, target_func_idx, block_call_directs[i]);
+        }
+
+        if (total_count > 0
+            && !aot_pgo_set_call_indirect_weights(comp_ctx, value_switch,
+                                                  target_counts, target_count,
+                                                  total_count))
+            goto fail;
+
+        LLVMPositionBuilderAtEnd(comp_ctx->builder, block_call_slow);
+    }
+
+    /* Load function type index */
+    if (!(ftype_idx_ptr = LLVMBuildInBoundsGEP2(
+              comp_ctx->builder, I32_TYPE, func_ctx->func_type_indexes,
+              &func_idx, 1, "ftype_idx_ptr"))) {
+        aot_set_last_error("llvm build inbounds gep failed.");
+        goto fail;
+    }
+
+    if (!(ftype_idx = LLVMBuildLoad2(comp_ctx->builder, I32_TYPE, ftype_idx_ptr,
+                                     "ftype_idx"))) {
+        aot_set_last_error("llvm build load failed.");
+        goto fail;
+    }
+
+    /* Check if function type index not equal */
+    if (!(cmp_ftype_idx = LLVMBuildICmp(comp_ctx->builder, LLVMIntNE, ftype_idx,
+                                        ftype_idx_const, "cmp_ftype_idx"))) {
+        aot_set_last_error("llvm build icmp failed.");
+        goto fail;
+    }
+
+    /* Throw exception if ftype_idx != ftype_idx_const */
+    if (!(check_ftype_idx_succ = LLVMAppendBasicBlockInContext(
+              comp_ctx->context, func_ctx->func, "check_ftype_idx_succ"))) {
+        aot_set_last_error("llvm add basic block failed.");
+        goto fail;
+    }
+
+    LLVMMoveBasicBlockAfter(check_ftype_idx_succ,
+                            LLVMGetInsertBlock(comp_ctx->builder));
+
+    if (!(aot_emit_exception(comp_ctx, func_ctx,
+                             EXCE_INVALID_FUNCTION_TYPE_INDEX, true,
+                             cmp_ftype_idx, check_ftype_idx_succ)))
+        goto fail;
+
 #if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
     if (comp_ctx->enable_aux_stack_frame) {
         if (!call_aot_alloc_frame_func(comp_ctx, func_ctx, func_idx))
@@ -1457,29 +1602,64 @@ aot_compile_op_call_indirect(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
     if (!check_exception_thrown(comp_ctx, func_ctx))
         goto fail;
 
-    if (func_result_count > 0) {
-        block_curr = LLVMGetInsertBlock(comp_ctx->builder);
+    if (!add_call_result_incomings(comp_ctx, func_type, value_ret,
+                                   param_values, result_phis))
+        goto fail;
 
-        /* Push the first result to stack */
-        LLVMAddIncoming(result_phis[0], &value_ret, &block_curr, 1);
+    if (!LLVMBuildBr(comp_ctx->builder, block_return)) {
+        aot_set_last_error("llvm build br failed.");
+        goto fail;
+    }
 
-        /* Load extra result from its address and push to stack */
-        for (i = 1; i < func_result_count; i++) {
-            ret_type = TO_LLVM_TYPE(func_type->types[func_param_count + i]);
-            snprintf(buf, sizeof(buf), "ext_ret%d", i - 1);
-            if (!(ext_ret = LLVMBuildLoad2(comp_ctx->builder, ret_type,
-                                           param_values[func_param_count + i],
-                                           buf))) {
-                aot_set_last_error("llvm build load failed.");
+    /* Translate direct call blocks */
+    for (i = 0; i < target_count; i++) {
+        callee_ctx =
+            comp_ctx->func_ctxes[target_func_idxes[i]
+                                 - comp_ctx->comp_data->import_func_count];
+
+        LLVMMoveBasicBlockBefore(block_call_directs[i], block_return);
+        LLVMPositionBuilderAtEnd(comp_ctx->builder, block_call_directs[i]);
+
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+        if (comp_ctx->enable_aux_stack_frame) {
+            target_func_idx = I32_CONST(target_func_idxes[i]);
+            CHECK_LLVM_CONST(target_func_idx);
+            if (!call_aot_alloc_frame_func(comp_ctx, func_ctx,
+                                           target_func_idx))
                 goto fail;
-            }
-            LLVMAddIncoming(result_phis[i], &ext_ret, &block_curr, 1);
         }
-    }
+#endif
 
-    if (!LLVMBuildBr(comp_ctx->builder, block_return)) {
-        aot_set_last_error("llvm build br failed.");
-        goto fail;
+        if (comp_ctx->enable_bound_check
+            && !check_stack_boundary(comp_ctx, func_ctx,
+                                     callee_ctx->aot_func->param_cell_num
+                                         + callee_ctx->aot_func->local_cell_num
+                                         + 1))
+            goto fail;
+
+        if (!(value_ret = LLVMBuildCall2(
+                  comp_ctx->builder, callee_ctx->func_type, callee_ctx->func,
+                  param_values, total_param_count,
+                  func_result_count > 0 ? "ret" : ""))) {
+            aot_set_last_error("llvm build call failed.");
+            goto fail;
+        }
+
+        LLVMSetInstructionCallConv(value_ret,
+                                   LLVMGetFunctionCallConv(callee_ctx->func));
+
+        /* Check whether exception was thrown when executing the function */
+        if (!check_exception_thrown(comp_ctx, func_ctx))
+            goto fail;
+
+        if (!add_call_result_incomings(comp_ctx, func_type, value_ret,
+                                       param_values, result_phis))
+            goto fail;
+
+        if (!LLVMBuildBr(comp_ctx->builder, block_return)) {
+            aot_set_last_error("llvm build br failed.");
+            goto fail;
+        }
     }
 
     /* Translate function return block */
@@ -78,6 +78,30 @@ get_memory_check_bound(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
 static LLVMValueRef
 get_memory_curr_page_count(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx);
 
+/* Mark the conditional branch of the bounds check, so that the LLVM
+   bounds check optimization pass can find it */
+static bool
+set_bounds_check_metadata(AOTCompContext *comp_ctx, LLVMBasicBlockRef block,
+                          uint32 bytes)
+{
+    LLVMValueRef cond_br = LLVMGetBasicBlockTerminator(block);
+    LLVMValueRef bytes_const = I32_CONST(bytes), md_node;
+
+    if (!cond_br || !bytes_const
+        || !(md_node = LLVMMDNodeInContext(comp_ctx->context, &bytes_const,
+                                           1))) {
+        aot_set_last_error("llvm build metadata failed.");
+        return false;
+    }
+
+    LLVMSetMetadata(cond_br,
+                    LLVMGetMDKindIDInContext(comp_ctx->context,
+                                             AOT_BOUNDS_CHECK_MD,
+                                             strlen(AOT_BOUNDS_CHECK_MD)),
+                    md_node);
+    return true;
+}
+
 LLVMValueRef
 aot_check_memory_overflow(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                           uint32 offset, uint32 bytes)
@@ -230,7 +254,8 @@ aot_check_memory_overflow(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
 
         if (!aot_emit_exception(comp_ctx, func_ctx,
                                 EXCE_OUT_OF_BOUNDS_MEMORY_ACCESS, true, cmp,
-                                check_succ)) {
+                                check_succ)
+            || !set_bounds_check_metadata(comp_ctx, block_curr, bytes)) {
             goto fail;
         }
 
@@ -693,7 +718,7 @@ bool
 aot_compile_op_memory_grow(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
 {
     LLVMValueRef mem_size = get_memory_curr_page_count(comp_ctx, func_ctx);
-    LLVMValueRef delta, param_values[2], ret_value, func, value;
+    LLVMValueRef delta, param_values[2], ret_value, func;
     LLVMTypeRef param_types[2], ret_type, func_type, func_ptr_type;
     int32 func_index;
 
@@ -712,19 +737,7 @@ aot_compile_op_memory_grow(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
         return false;
     }
 
-    if (comp_ctx->is_jit_mode) {
-        /* JIT mode, call the function directly */
-        if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
-            aot_set_last_error("llvm add pointer type failed.");
-            return false;
-        }
-        if (!(value = I64_CONST((uint64)(uintptr_t)wasm_enlarge_memory))
-            || !(func = LLVMConstIntToPtr(value, func_ptr_type))) {
-            aot_set_last_error("create LLVM value failed.");
-            return false;
-        }
-    }
-    else if (comp_ctx->is_indirect_mode) {
+    if (comp_ctx->is_indirect_mode) {
         if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
             aot_set_last_error("create LLVM function type failed.");
             return false;
@@ -740,8 +753,10 @@ aot_compile_op_memory_grow(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
         }
     }
     else {
-        char *func_name = "aot_enlarge_memory";
-        /* AOT mode, delcare the function */
+        /* AOT/JIT mode, declare the function, in JIT mode it is resolved
+           to the absolute symbol defined in the JIT */
+        char *func_name = comp_ctx->is_jit_mode ? "wasm_enlarge_memory"
+                                                : "aot_enlarge_memory";
         if (!(func = LLVMGetNamedFunction(func_ctx->module, func_name))
             && !(func =
                      LLVMAddFunction(func_ctx->module, func_name, func_type))) {
@@ -880,7 +895,7 @@ bool
 aot_compile_op_memory_init(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                            uint32 seg_index)
 {
-    LLVMValueRef seg, offset, dst, len, param_values[5], ret_value, func, value;
+    LLVMValueRef seg, offset, dst, len, param_values[5], ret_value, func;
     LLVMTypeRef param_types[5], ret_type, func_type, func_ptr_type;
     AOTFuncType *aot_func_type = func_ctx->aot_func->func_type;
     LLVMBasicBlockRef block_curr = LLVMGetInsertBlock(comp_ctx->builder);
@@ -948,7 +963,7 @@ bool
 aot_compile_op_data_drop(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                          uint32 seg_index)
 {
-    LLVMValueRef seg, param_values[2], ret_value, func, value;
+    LLVMValueRef seg, param_values[2], ret_value, func;
     LLVMTypeRef param_types[2], ret_type, func_type, func_ptr_type;
 
     seg = I32_CONST(seg_index);
@@ -1014,9 +1029,11 @@ aot_compile_op_memory_copy(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
         }
 
         if (comp_ctx->is_jit_mode) {
-            if (!(func = I64_CONST((uint64)(uintptr_t)aot_memmove))
-                || !(func = LLVMConstIntToPtr(func, func_ptr_type))) {
-                aot_set_last_error("create LLVM value failed.");
+            /* Resolved to the absolute symbol defined in the JIT */
+            if (!(func = LLVMGetNamedFunction(func_ctx->module, "aot_memmove"))
+                && !(func = LLVMAddFunction(func_ctx->module, "aot_memmove",
+                                            func_type))) {
+                aot_set_last_error("llvm add function failed.");
                 return false;
             }
         }
@@ -1055,7 +1072,7 @@ fail:
     return false;
 }
 
-static void *
+void *
 jit_memset(void *s, int c, size_t n)
 {
     return memset(s, c, n);
@@ -1090,14 +1107,7 @@ aot_compile_op_memory_fill(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
         return false;
     }
 
-    if (comp_ctx->is_jit_mode) {
-        if (!(func = I64_CONST((uint64)(uintptr_t)jit_memset))
-            || !(func = LLVMConstIntToPtr(func, func_ptr_type))) {
-            aot_set_last_error("create LLVM value failed.");
-            return false;
-        }
-    }
-    else if (comp_ctx->is_indirect_mode) {
+    if (comp_ctx->is_indirect_mode) {
         int32 func_index;
         func_index = aot_get_native_symbol_index(comp_ctx, "memset");
         if (func_index < 0) {
@@ -1109,9 +1119,12 @@ aot_compile_op_memory_fill(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
         }
     }
     else {
-        if (!(func = LLVMGetNamedFunction(func_ctx->module, "memset"))
+        /* In JIT mode, it is resolved to the absolute symbol defined in
+           the JIT */
+        const char *func_name = comp_ctx->is_jit_mode ? "jit_memset" : "memset";
+        if (!(func = LLVMGetNamedFunction(func_ctx->module, func_name))
             && !(func =
-                     LLVMAddFunction(func_ctx->module, "memset", func_type))) {
+                     LLVMAddFunction(func_ctx->module, func_name, func_type))) {
             aot_set_last_error("llvm add function failed.");
             return false;
         }
@@ -1294,7 +1307,7 @@ aot_compile_op_atomic_wait(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
                            uint8 op_type, uint32 align, uint32 offset,
                            uint32 bytes)
 {
-    LLVMValueRef maddr, value, timeout, expect, cmp;
+    LLVMValueRef maddr, timeout, expect, cmp;
     LLVMValueRef param_values[5], ret_value, func, is_wait64;
     LLVMTypeRef param_types[5], ret_type, func_type, func_ptr_type;
     LLVMBasicBlockRef wait_fail, wait_success;
@@ -1378,7 +1391,7 @@ aot_compiler_op_atomic_notify(AOTCompContext *comp_ctx,
                               AOTFuncContext *func_ctx, uint32 align,
                               uint32 offset, uint32 bytes)
 {
-    LLVMValueRef maddr, value, count;
+    LLVMValueRef maddr, count;
     LLVMValueRef param_values[3], ret_value, func;
     LLVMTypeRef param_types[3], ret_type, func_type, func_ptr_type;
 
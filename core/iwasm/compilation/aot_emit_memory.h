@@ -75,6 +75,9 @@ aot_compile_op_memory_copy(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx);
 
 bool
 aot_compile_op_memory_fill(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx);
+
+void *
+jit_memset(void *s, int c, size_t n);
 #endif
 
 #if WASM_ENABLE_SHARED_MEMORY != 0
@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "aot_emit_pgo.h"
+#include "../aot/aot_runtime.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64
+hash_bytes(uint64 hash, const uint8 *buf, uint32 len)
+{
+    uint32 i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= buf[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64
+hash_uint32(uint64 hash, uint32 value)
+{
+    uint8 buf[4];
+
+    buf[0] = (uint8)value;
+    buf[1] = (uint8)(value >> 8);
+    buf[2] = (uint8)(value >> 16);
+    buf[3] = (uint8)(value >> 24);
+    return hash_bytes(hash, buf, 4);
+}
+
+uint64
+aot_pgo_calc_module_hash(const AOTCompData *comp_data)
+{
+    uint64 hash = FNV_OFFSET_BASIS;
+    AOTFunc *func;
+    uint32 i;
+
+    hash = hash_uint32(hash, comp_data->import_func_count);
+    hash = hash_uint32(hash, comp_data->func_count);
+    for (i = 0; i < comp_data->func_count; i++) {
+        func = comp_data->funcs[i];
+        hash = hash_uint32(hash, func->code_size);
+        hash = hash_bytes(hash, func->code, func->code_size);
+    }
+    return hash;
+}
+
+static uint32
+swap_uint32(uint32 value)
+{
+    return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8)
+           | ((value >> 8) & 0xFF00) | (value >> 24);
+}
+
+static uint64
+swap_uint64(uint64 value)
+{
+    return ((uint64)swap_uint32((uint32)value) << 32)
+           | swap_uint32((uint32)(value >> 32));
+}
+
+bool
+aot_pgo_load_prof_file(AOTCompContext *comp_ctx, const char *file_name)
+{
+    AOTPGOProfHeader header;
+    uint64 *counters = NULL, size;
+    FILE *file;
+    bool swap_bytes;
+    uint32 i;
+
+    if (!(file = fopen(file_name, "rb"))) {
+        aot_set_last_error_v("open profile file %s failed.", file_name);
+        return false;
+    }
+
+    if (fread(&header, sizeof(AOTPGOProfHeader), 1, file) != 1) {
+        goto invalid_file;
+    }
+
+    /* The profile data is dumped in the byte order of the target */
+    swap_bytes = header.magic == swap_uint32(AOT_PGO_PROF_MAGIC);
+    if (swap_bytes) {
+        header.magic = swap_uint32(header.magic);
+        header.version = swap_uint32(header.version);
+        header.module_hash = swap_uint64(header.module_hash);
+        header.func_count = swap_uint32(header.func_count);
+        header.counter_count = swap_uint32(header.counter_count);
+    }
+
+    if (header.magic != AOT_PGO_PROF_MAGIC
+        || header.version != AOT_PGO_PROF_VERSION) {
+        goto invalid_file;
+    }
+
+    if (header.func_count != comp_ctx->comp_data->func_count
+        || header.module_hash
+               != aot_pgo_calc_module_hash(comp_ctx->comp_data)) {
+        aot_set_last_error_v("profile file %s doesn't match the wasm file.",
+                             file_name);
+        goto fail;
+    }
+
+    if (header.counter_count == 0) {
+        fclose(file);
+        return true;
+    }
+
+    size = sizeof(uint64) * (uint64)header.counter_count;
+    if (size >= UINT32_MAX || !(counters = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        goto fail;
+    }
+
+    if (fread(counters, sizeof(uint64), header.counter_count, file)
+        != header.counter_count) {
+        goto invalid_file;
+    }
+
+    if (swap_bytes) {
+        for (i = 0; i < header.counter_count; i++)
+            counters[i] = swap_uint64(counters[i]);
+    }
+
+    fclose(file);
+    comp_ctx->pgo_prof_counters = counters;
+    comp_ctx->pgo_prof_counter_count = header.counter_count;
+    return true;
+
+invalid_file:
+    aot_set_last_error_v("invalid profile file %s.", file_name);
+fail:
+    if (counters)
+        wasm_runtime_free(counters);
+    fclose(file);
+    return false;
+}
+
+static bool
+is_pgo_enabled(const AOTCompContext *comp_ctx)
+{
+    return comp_ctx->enable_llvm_pgo || comp_ctx->pgo_prof_counters;
+}
+
+static uint32
+alloc_counters(AOTCompContext *comp_ctx, uint32 count)
+{
+    uint32 counter_idx = comp_ctx->pgo_counter_count;
+
+    comp_ctx->pgo_counter_count += count;
+    return counter_idx;
+}
+
+static uint64
+get_prof_count(const AOTCompContext *comp_ctx, uint32 counter_idx)
+{
+    if (counter_idx < comp_ctx->pgo_prof_counter_count)
+        return comp_ctx->pgo_prof_counters[counter_idx];
+    return 0;
+}
+
+static bool
+emit_counter_inc(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
+                 LLVMValueRef counter_idx)
+{
+    LLVMValueRef counter_addr, counter;
+
+    if (!(counter_addr = LLVMBuildInBoundsGEP2(
+              comp_ctx->builder, I64_TYPE, func_ctx->pgo_counters,
+              &counter_idx, 1, "pgo_counter_addr"))) {
+        aot_set_last_error("llvm build inbounds gep failed.");
+        return false;
+    }
+
+    if (!(counter = LLVMBuildLoad2(comp_ctx->builder, I64_TYPE, counter_addr,
+                                   "pgo_counter"))) {
+        aot_set_last_error("llvm build load failed.");
+        return false;
+    }
+
+    if (!(counter = LLVMBuildAdd(comp_ctx->builder, counter, I64_CONST(1),
+                                 "pgo_counter_inc"))) {
+        aot_set_last_error("llvm build add failed.");
+        return false;
+    }
+
+    if (!LLVMBuildStore(comp_ctx->builder, counter, counter_addr)) {
+        aot_set_last_error("llvm build store failed.");
+        return false;
+    }
+    return true;
+}
+
+static bool
+set_branch_weights(AOTCompContext *comp_ctx, LLVMValueRef inst,
+                   const uint64 *counts, uint32 count)
+{
+    LLVMMetadataRef *mds;
+    LLVMValueRef weight;
+    uint64 max_count = 0, scale, size;
+    uint32 i;
+
+    for (i = 0; i < count; i++) {
+        if (counts[i] > max_count)
+            max_count = counts[i];
+    }
+
+    /* The branch isn't executed during profiling */
+    if (max_count == 0)
+        return true;
+
+    size = sizeof(LLVMMetadataRef) * ((uint64)count + 1);
+    if (size >= UINT32_MAX || !(mds = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        return false;
+    }
+
+    /* Scale the counts to fit in the 32-bit weights, and add one to
+       each of them so that a never taken edge isn't regarded as
+       impossible */
+    scale = max_count / UINT32_MAX + 1;
+    mds[0] = LLVMMDStringInContext2(comp_ctx->context, "branch_weights", 14);
+    for (i = 0; i < count; i++) {
+        weight = LLVMConstInt(I32_TYPE, counts[i] / scale + 1, false);
+        mds[i + 1] = LLVMValueAsMetadata(weight);
+    }
+
+    LLVMSetMetadata(inst, LLVMGetMDKindIDInContext(comp_ctx->context, "prof", 4),
+                    LLVMMetadataAsValue(comp_ctx->context,
+                                        LLVMMDNodeInContext2(comp_ctx->context,
+                                                             mds, count + 1)));
+    wasm_runtime_free(mds);
+    return true;
+}
+
+bool
+aot_pgo_compile_func_entry(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
+{
+    LLVMMetadataRef mds[2];
+    uint32 counter_idx;
+
+    if (!is_pgo_enabled(comp_ctx))
+        return true;
+
+    counter_idx = alloc_counters(comp_ctx, 1);
+
+    if (comp_ctx->enable_llvm_pgo
+        && !emit_counter_inc(comp_ctx, func_ctx, I32_CONST(counter_idx)))
+        return false;
+
+    if (comp_ctx->pgo_prof_counters) {
+        mds[0] = LLVMMDStringInContext2(comp_ctx->context,
+                                        "function_entry_count", 20);
+        mds[1] = LLVMValueAsMetadata(
+            LLVMConstInt(I64_TYPE, get_prof_count(comp_ctx, counter_idx),
+                         false));
+        LLVMGlobalSetMetadata(
+            func_ctx->func,
+            LLVMGetMDKindIDInContext(comp_ctx->context, "prof", 4),
+            LLVMMDNodeInContext2(comp_ctx->context, mds, 2));
+    }
+    return true;
+}
+
+bool
+aot_pgo_compile_cond_br(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
+                        LLVMValueRef cond, uint32 *p_counter_idx)
+{
+    LLVMValueRef counter_idx;
+
+    if (!is_pgo_enabled(comp_ctx))
+        return true;
+
+    *p_counter_idx = alloc_counters(comp_ctx, 2);
+
+    if (comp_ctx->enable_llvm_pgo) {
+        /* counters[idx] for the false edge, counters[idx + 1] for the
+           true edge */
+        if (!(counter_idx = LLVMBuildZExt(comp_ctx->builder, cond, I32_TYPE,
+                                          "pgo_cond"))
+            || !(counter_idx =
+                     LLVMBuildAdd(comp_ctx->builder, counter_idx,
+                                  I32_CONST(*p_counter_idx), "pgo_idx"))) {
+            aot_set_last_error("llvm build instruction failed.");
+            return false;
+        }
+        if (!emit_counter_inc(comp_ctx, func_ctx, counter_idx))
+            return false;
+    }
+    return true;
+}
+
+bool
+aot_pgo_set_cond_br_weights(AOTCompContext *comp_ctx, LLVMValueRef cond_br,
+                            uint32 counter_idx)
+{
+    uint64 counts[2];
+
+    if (!comp_ctx->pgo_prof_counters)
+        return true;
+
+    /* The successors of the cond br are the true and false blocks */
+    counts[0] = get_prof_count(comp_ctx, counter_idx + 1);
+    counts[1] = get_prof_count(comp_ctx, counter_idx);
+    return set_branch_weights(comp_ctx, cond_br, counts, 2);
+}
+
+bool
+aot_pgo_compile_br_table(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
+                         LLVMValueRef value, uint32 br_count,
+                         uint32 *p_counter_idx)
+{
+    LLVMValueRef cmp, counter_idx;
+
+    if (!is_pgo_enabled(comp_ctx))
+        return true;
+
+    *p_counter_idx = alloc_counters(comp_ctx, br_count + 1);
+
+    if (comp_ctx->enable_llvm_pgo) {
+        /* counters[idx + br_count] for the default target */
+        if (!(cmp = LLVMBuildICmp(comp_ctx->builder, LLVMIntULT, value,
+                                  I32_CONST(br_count), "pgo_cmp"))
+            || !(counter_idx =
+                     LLVMBuildSelect(comp_ctx->builder, cmp, value,
+                                     I32_CONST(br_count), "pgo_target"))
+            || !(counter_idx =
+                     LLVMBuildAdd(comp_ctx->builder, counter_idx,
+                                  I32_CONST(*p_counter_idx), "pgo_idx"))) {
+            aot_set_last_error("llvm build instruction failed.");
+            return false;
+        }
+        if (!emit_counter_inc(comp_ctx, func_ctx, counter_idx))
+            return false;
+    }
+    return true;
+}
+
+bool
+aot_pgo_set_switch_weights(AOTCompContext *comp_ctx, LLVMValueRef value_switch,
+                           uint32 counter_idx, uint32 br_count)
+{
+    uint64 *counts, size;
+    uint32 i;
+    bool ret;
+
+    if (!comp_ctx->pgo_prof_counters)
+        return true;
+
+    size = sizeof(uint64) * ((uint64)br_count + 1);
+    if (size >= UINT32_MAX || !(counts = wasm_runtime_malloc((uint32)size))) {
+        aot_set_last_error("allocate memory failed.");
+        return false;
+    }
+
+    /* The first successor of the switch is the default block */
+    counts[0] = get_prof_count(comp_ctx, counter_idx + br_count);
+    for (i = 0; i < br_count; i++)
+        counts[i + 1] = get_prof_count(comp_ctx, counter_idx + i);
+
+    ret = set_branch_weights(comp_ctx, value_switch, counts, br_count + 1);
+    wasm_runtime_free(counts);
+    return ret;
+}
+
+bool
+aot_pgo_compile_call_indirect(AOTCompContext *comp_ctx,
+                              AOTFuncContext *func_ctx, LLVMValueRef func_idx,
+                              uint32 *p_counter_idx)
+{
+    const char *func_name = "aot_pgo_record_indirect_call";
+    LLVMTypeRef param_types[2], func_type, func_ptr_type;
+    LLVMValueRef param_values[2], counter_idx, func;
+    uint32 site_counter_idx;
+    int32 native_func_idx;
+
+    if (!is_pgo_enabled(comp_ctx))
+        return true;
+
+    site_counter_idx = alloc_counters(comp_ctx, AOT_PGO_ICALL_COUNTER_NUM);
+    *p_counter_idx = site_counter_idx;
+
+    if (!comp_ctx->enable_llvm_pgo)
+        return true;
+
+    param_types[0] = INT64_PTR_TYPE;
+    param_types[1] = I32_TYPE;
+    if (!(func_type = LLVMFunctionType(VOID_TYPE, param_types, 2, false))) {
+        aot_set_last_error("llvm add function type failed.");
+        return false;
+    }
+
+    if (comp_ctx->is_indirect_mode) {
+        if (!(func_ptr_type = LLVMPointerType(func_type, 0))) {
+            aot_set_last_error("llvm add pointer type failed.");
+            return false;
+        }
+        native_func_idx = aot_get_native_symbol_index(comp_ctx, func_name);
+        if (native_func_idx < 0)
+            return false;
+        if (!(func = aot_get_func_from_table(comp_ctx, func_ctx->native_symbol,
+                                             func_ptr_type, native_func_idx)))
+            return false;
+    }
+    else if (!(func = LLVMGetNamedFunction(func_ctx->module, func_name))
+             && !(func =
+                      LLVMAddFunction(func_ctx->module, func_name, func_type))) {
+        aot_set_last_error("llvm add function failed.");
+        return false;
+    }
+
+    counter_idx = I32_CONST(site_counter_idx);
+    if (!(param_values[0] = LLVMBuildInBoundsGEP2(
+              comp_ctx->builder, I64_TYPE, func_ctx->pgo_counters,
+              &counter_idx, 1, "pgo_icall_counters"))) {
+        aot_set_last_error("llvm build inbounds gep failed.");
+        return false;
+    }
+    param_values[1] = func_idx;
+
+    if (!LLVMBuildCall2(comp_ctx->builder, func_type, func, param_values, 2,
+                        "")) {
+        aot_set_last_error("llvm build call failed.");
+        return false;
+    }
+    return true;
+}
+
+uint32
+aot_pgo_get_call_indirect_targets(const AOTCompContext *comp_ctx,
+                                  uint32 counter_idx, uint32 *func_idxes,
+                                  uint64 *counts, uint32 max_target_count,
+                                  uint64 *p_total_count)
+{
+    uint64 total_count, count;
+    uint32 target_count = 0, func_idx, i, j;
+
+    *p_total_count = 0;
+    if (!comp_ctx->pgo_prof_counters)
+        return 0;
+
+    /* counters[idx + i * 2] is func_idx + 1 of the i-th recorded target
+       and counters[idx + i * 2 + 1] is its call count, the last counter
+       is the call count of the targets which weren't recorded */
+    total_count =
+        get_prof_count(comp_ctx, counter_idx + AOT_PGO_ICALL_TARGET_NUM * 2);
+    for (i = 0; i < AOT_PGO_ICALL_TARGET_NUM; i++)
+        total_count += get_prof_count(comp_ctx, counter_idx + i * 2 + 1);
+    *p_total_count = total_count;
+
+    for (i = 0; i < AOT_PGO_ICALL_TARGET_NUM; i++) {
+        func_idx = (uint32)get_prof_count(comp_ctx, counter_idx + i * 2);
+        count = get_prof_count(comp_ctx, counter_idx + i * 2 + 1);
+        /* Only the targets taking at least 1/8 of the calls are hot */
+        if (func_idx == 0 || count == 0 || count < total_count / 8)
+            continue;
+
+        /* Insert the target by its call count in descending order */
+        for (j = target_count; j > 0 && counts[j - 1] < count; j--) {
+            if (j < max_target_count) {
+                func_idxes[j] = func_idxes[j - 1];
+                counts[j] = counts[j - 1];
+            }
+        }
+        if (j < max_target_count) {
+            func_idxes[j] = func_idx - 1;
+            counts[j] = count;
+            if (target_count < max_target_count)
+                target_count++;
+        }
+    }
+    return target_count;
+}
+
+bool
+aot_pgo_set_call_indirect_weights(AOTCompContext *comp_ctx,
+                                  LLVMValueRef value_switch,
+                                  const uint64 *counts, uint32 target_count,
+                                  uint64 total_count)
+{
+    uint64 weights[AOT_PGO_ICALL_TARGET_NUM + 1];
+    uint32 i;
+
+    bh_assert(target_count <= AOT_PGO_ICALL_TARGET_NUM);
+
+    /* The first successor of the switch is the slow path, which takes
+       the calls of the other targets */
+    weights[0] = total_count;
+    for (i = 0; i < target_count; i++) {
+        weights[i + 1] = counts[i];
+        weights[0] -= counts[i];
+    }
+    return set_branch_weights(comp_ctx, value_switch, weights,
+                              target_count + 1);
+}
+
+bool
+aot_pgo_check_prof_counters(AOTCompContext *comp_ctx)
+{
+    if (comp_ctx->pgo_prof_counters
+        && comp_ctx->pgo_counter_count != comp_ctx->pgo_prof_counter_count) {
+        aot_set_last_error("the counters of the profile file don't match the "
+                           "wasm file, please regenerate the profile file.");
+        return false;
+    }
+    return true;
+}
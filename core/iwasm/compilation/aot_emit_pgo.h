@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2019 Intel Corporation. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _AOT_EMIT_PGO_H_
+#define _AOT_EMIT_PGO_H_
+
+#include "aot_compiler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The counters are allocated in the order of the profiled sites in the
+ * wasm bytecode: one counter for each function entry, two counters for
+ * the false and true edges of each if/br_if, br_count + 1 counters for
+ * the targets of each br_table, and AOT_PGO_ICALL_COUNTER_NUM counters
+ * for the targets of each call_indirect. So the instrumented compilation
+ * (wamrc --enable-llvm-pgo) and the optimized compilation (wamrc
+ * --use-prof=<file>) of the same wasm file get the same counter indexes.
+ */
+
+uint64
+aot_pgo_calc_module_hash(const AOTCompData *comp_data);
+
+bool
+aot_pgo_load_prof_file(AOTCompContext *comp_ctx, const char *file_name);
+
+bool
+aot_pgo_compile_func_entry(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx);
+
+bool
+aot_pgo_compile_cond_br(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
+                        LLVMValueRef cond, uint32 *p_counter_idx);
+
+bool
+aot_pgo_set_cond_br_weights(AOTCompContext *comp_ctx, LLVMValueRef cond_br,
+                            uint32 counter_idx);
+
+bool
+aot_pgo_compile_br_table(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx,
+                         LLVMValueRef value, uint32 br_count,
+                         uint32 *p_counter_idx);
+
+bool
+aot_pgo_set_switch_weights(AOTCompContext *comp_ctx, LLVMValueRef value_switch,
+                           uint32 counter_idx, uint32 br_count);
+
+bool
+aot_pgo_compile_call_indirect(AOTCompContext *comp_ctx,
+                              AOTFuncContext *func_ctx, LLVMValueRef func_idx,
+                              uint32 *p_counter_idx);
+
+/**
+ * Get the hot targets of a call_indirect site from the profile data, the
+ * targets are sorted by their call counts in descending order.
+ *
+ * @param comp_ctx the compilation context
+ * @param counter_idx the first counter index of the call_indirect site
+ * @param func_idxes the buffer to return the function indexes of targets
+ * @param counts the buffer to return the call counts of targets
+ * @param max_target_count the max number of targets to return
+ * @param p_total_count return the total call count of the site
+ *
+ * @return the number of hot targets returned
+ */
+uint32
+aot_pgo_get_call_indirect_targets(const AOTCompContext *comp_ctx,
+                                  uint32 counter_idx, uint32 *func_idxes,
+                                  uint64 *counts, uint32 max_target_count,
+                                  uint64 *p_total_count);
+
+bool
+aot_pgo_set_call_indirect_weights(AOTCompContext *comp_ctx,
+                                  LLVMValueRef value_switch,
+                                  const uint64 *counts, uint32 target_count,
+                                  uint64 total_count);
+
+bool
+aot_pgo_check_prof_counters(AOTCompContext *comp_ctx);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+#endif /* end of _AOT_EMIT_PGO_H_ */
@@ -6,6 +6,8 @@
 #include "aot_llvm.h"
 #include "aot_compiler.h"
 #include "aot_emit_exception.h"
+#include "aot_emit_pgo.h"
+#include "aot_emit_memory.h"
 #include "../aot/aot_runtime.h"
 #include "../aot/aot_intrinsic.h"
 
@@ -644,6 +646,41 @@ create_func_ptrs(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
     return true;
 }
 
+static bool
+create_pgo_counters(AOTCompContext *comp_ctx, AOTFuncContext *func_ctx)
+{
+    LLVMValueRef offset, pgo_counters_ptr;
+    LLVMTypeRef int64_pptr_type;
+
+    offset = I32_CONST(offsetof(AOTModuleInstance, pgo_counters));
+    if (!(pgo_counters_ptr = LLVMBuildInBoundsGEP2(
+              comp_ctx->builder, INT8_TYPE, func_ctx->aot_inst, &offset, 1,
+              "pgo_counters_offset"))) {
+        aot_set_last_error("llvm build in bounds gep failed.");
+        return false;
+    }
+
+    if (!(int64_pptr_type = LLVMPointerType(INT64_PTR_TYPE, 0))) {
+        aot_set_last_error("llvm get pointer type failed.");
+        return false;
+    }
+
+    if (!(pgo_counters_ptr =
+              LLVMBuildBitCast(comp_ctx->builder, pgo_counters_ptr,
+                               int64_pptr_type, "pgo_counters_ptr"))) {
+        aot_set_last_error("llvm build bit cast failed.");
+        return false;
+    }
+
+    if (!(func_ctx->pgo_counters =
+              LLVMBuildLoad2(comp_ctx->builder, INT64_PTR_TYPE,
+                             pgo_counters_ptr, "pgo_counters"))) {
+        aot_set_last_error("llvm build load failed.");
+        return false;
+    }
+    return true;
+}
+
 /**
  * Create function compiler context
  */
@@ -922,6 +959,10 @@ aot_create_func_context(AOTCompData *comp_data, AOTCompContext *comp_ctx,
     if (!create_func_ptrs(comp_ctx, func_ctx))
         goto fail;
 
+    /* Load PGO counters */
+    if (comp_ctx->enable_llvm_pgo && !create_pgo_counters(comp_ctx, func_ctx))
+        goto fail;
+
     return func_ctx;
 
 fail:
@@ -1290,7 +1331,8 @@ run_pass(void *ctx, LLVMModuleRef module)
                 LLVMGetModuleIdentifier(module, &len), pthread_self());
 
     /* TODO: enable this for JIT mode after fixing LLVM issues */
-    /*aot_apply_llvm_new_pass_manager(comp_ctx, module);*/
+    /*aot_apply_llvm_new_pass_manager(comp_ctx, comp_ctx->target_machine,
+                                      module);*/
 
     bh_print_time("Begin to generate machine code");
     return LLVMErrorSuccess;
@@ -1385,13 +1427,90 @@ fail:
     return ret;
 }
 
+typedef struct JITRuntimeSymbol {
+    const char *name;
+    void *addr;
+} JITRuntimeSymbol;
+
+#define REG_JIT_SYMBOL(func) \
+    {                        \
+        #func, (void *)func  \
+    }
+
+/* The runtime functions called by the JIT code, they are called through
+   their names but not their addresses, so that the object files compiled
+   don't depend on the load addresses of the runtime and can be cached */
+static const JITRuntimeSymbol jit_runtime_symbols[] = {
+    REG_JIT_SYMBOL(llvm_jit_invoke_native),
+    REG_JIT_SYMBOL(llvm_jit_call_indirect),
+    REG_JIT_SYMBOL(jit_check_app_addr_and_convert),
+    REG_JIT_SYMBOL(jit_set_exception_with_id),
+    REG_JIT_SYMBOL(wasm_enlarge_memory),
+#if WASM_ENABLE_BULK_MEMORY != 0
+    REG_JIT_SYMBOL(llvm_jit_memory_init),
+    REG_JIT_SYMBOL(llvm_jit_data_drop),
+    REG_JIT_SYMBOL(aot_memmove),
+    REG_JIT_SYMBOL(jit_memset),
+#endif
+#if WASM_ENABLE_REF_TYPES != 0
+    REG_JIT_SYMBOL(llvm_jit_drop_table_seg),
+    REG_JIT_SYMBOL(llvm_jit_table_init),
+    REG_JIT_SYMBOL(llvm_jit_table_copy),
+    REG_JIT_SYMBOL(llvm_jit_table_fill),
+    REG_JIT_SYMBOL(llvm_jit_table_grow),
+#endif
+#if WASM_ENABLE_DUMP_CALL_STACK != 0 || WASM_ENABLE_PERF_PROFILING != 0 \
+    || WASM_ENABLE_SAMPLING_PROFILER != 0
+    REG_JIT_SYMBOL(llvm_jit_alloc_frame),
+    REG_JIT_SYMBOL(llvm_jit_free_frame),
+#endif
+#if WASM_ENABLE_SHARED_MEMORY != 0
+    REG_JIT_SYMBOL(wasm_runtime_atomic_wait),
+    REG_JIT_SYMBOL(wasm_runtime_atomic_notify),
+#endif
+};
+
 static bool
-orc_jit_create(AOTCompContext *comp_ctx)
+orc_jit_define_runtime_symbols(LLVMOrcLLLazyJITRef orc_jit)
+{
+    LLVMJITCSymbolMapPair
+        symbols[sizeof(jit_runtime_symbols) / sizeof(JITRuntimeSymbol)];
+    LLVMOrcMaterializationUnitRef mu;
+    LLVMErrorRef err;
+    uint32 i, count = sizeof(symbols) / sizeof(LLVMJITCSymbolMapPair);
+
+    for (i = 0; i < count; i++) {
+        symbols[i].Name = LLVMOrcLLLazyJITMangleAndIntern(
+            orc_jit, jit_runtime_symbols[i].name);
+        symbols[i].Sym.Address =
+            (LLVMOrcJITTargetAddress)(uintptr_t)jit_runtime_symbols[i].addr;
+        symbols[i].Sym.Flags.GenericFlags =
+            LLVMJITSymbolGenericFlagsExported
+            | LLVMJITSymbolGenericFlagsCallable;
+        symbols[i].Sym.Flags.TargetFlags = 0;
+    }
+
+    /* Ownership transfer: symbols -> LLVMOrcMaterializationUnitRef */
+    mu = LLVMOrcAbsoluteSymbols(symbols, count);
+    err = LLVMOrcJITDylibDefine(LLVMOrcLLLazyJITGetMainJITDylib(orc_jit), mu);
+    if (err != LLVMErrorSuccess) {
+        aot_handle_llvm_errmsg("failed to define the runtime symbols", err);
+        return false;
+    }
+    return true;
+}
+
+static bool
+orc_jit_create(AOTCompContext *comp_ctx, char *cache_dir)
 {
     LLVMErrorRef err;
     LLVMOrcLLLazyJITRef orc_jit = NULL;
     LLVMOrcLLLazyJITBuilderRef builder = NULL;
     LLVMOrcJITTargetMachineBuilderRef jtmb = NULL;
+#if WASM_ENABLE_JIT != 0
+    WASMModule *wasm_module = comp_ctx->comp_data->wasm_module;
+    char cache_key[AOT_CACHE_KEY_SIZE];
+#endif
     bool ret = false;
 
     builder = LLVMOrcCreateLLLazyJITBuilder();
@@ -1413,6 +1532,25 @@ orc_jit_create(AOTCompContext *comp_ctx)
     /* Ownership transfer:
        LLVMOrcJITTargetMachineBuilderRef -> LLVMOrcLLJITBuilderRef */
     LLVMOrcLLLazyJITBuilderSetJITTargetMachineBuilder(builder, jtmb);
+
+#if WASM_ENABLE_JIT != 0
+    /* Cache the object files compiled, the module is identified by the
+       hash of its content, the compile options and the runtime build */
+    if (cache_dir && wasm_module->load_addr) {
+        if (!aot_get_jit_module_cache_key(comp_ctx, wasm_module->load_addr,
+                                          wasm_module->load_size, cache_key,
+                                          sizeof(cache_key)))
+            goto fail;
+
+        LLVMOrcLLLazyJITBuilderSetObjectCache(builder, cache_dir, cache_key);
+        comp_ctx->cache_dir = cache_dir;
+        LOG_VERBOSE("Cache the JIT object files of module %s in %s\n",
+                    cache_key, cache_dir);
+    }
+#else
+    (void)cache_dir;
+#endif
+
     err = LLVMOrcCreateLLLazyJIT(&orc_jit, builder);
     if (err != LLVMErrorSuccess) {
         aot_handle_llvm_errmsg("quited to create llvm lazy orcjit instance",
@@ -1422,6 +1560,9 @@ orc_jit_create(AOTCompContext *comp_ctx)
     /* Ownership transfer: LLVMOrcLLJITBuilderRef -> LLVMOrcLLJITRef */
     builder = NULL;
 
+    if (!orc_jit_define_runtime_symbols(orc_jit))
+        goto fail;
+
 #ifndef NDEBUG
     /* Setup TransformLayer */
     LLVMOrcIRTransformLayerSetTransform(
@@ -1460,6 +1601,7 @@ aot_create_comp_context(AOTCompData *comp_data, aot_comp_option_t option)
     char triple_buf[32] = { 0 }, features_buf[128] = { 0 };
     uint32 opt_level, size_level, i;
     LLVMCodeModel code_model;
+    LLVMRelocMode reloc_mode = LLVMRelocStatic;
     LLVMTargetDataRef target_data_ref;
 
     /* Initialize LLVM environment */
@@ -1577,15 +1719,15 @@ aot_create_comp_context(AOTCompData *comp_data, aot_comp_option_t option)
         if (!create_target_machine_detect_host(comp_ctx))
             goto fail;
 
-        /* Create LLJIT Instance */
-        if (!orc_jit_create(comp_ctx))
-            goto fail;
-
 #ifndef OS_ENABLE_HW_BOUND_CHECK
         comp_ctx->enable_bound_check = true;
 #else
         comp_ctx->enable_bound_check = false;
 #endif
+
+        /* Create LLJIT Instance */
+        if (!orc_jit_create(comp_ctx, option->cache_dir))
+            goto fail;
     }
     else {
         /* Create LLVM target machine */
@@ -1947,13 +2089,43 @@ aot_create_comp_context(AOTCompData *comp_data, aot_comp_option_t option)
         else
             code_model = LLVMCodeModelSmall;
 
+        /* Generate position independent code for the XIP file on x86_64,
+           its text then refers to the read-only data only with PC-relative
+           relocations, which are resolved when wamrc folds the read-only
+           data sections into the text section */
+        if (comp_ctx->is_indirect_mode && code_model == LLVMCodeModelSmall
+            && !strcmp(comp_ctx->target_arch, "x86_64"))
+            reloc_mode = LLVMRelocPIC;
+
         /* Create the target machine */
         if (!(comp_ctx->target_machine = LLVMCreateTargetMachine(
-                  target, triple_norm, cpu, features, opt_level,
-                  LLVMRelocStatic, code_model))) {
+                  target, triple_norm, cpu, features, opt_level, reloc_mode,
+                  code_model))) {
             aot_set_last_error("create LLVM target machine failed.");
             goto fail;
         }
+
+        if (option->thread_num > 1 || option->cache_dir) {
+            /* The object files of the split modules are linked when
+               emitting the AOT file, which supports the ELF files of
+               x86-64 and aarch64 targets only */
+#if WASM_ENABLE_DEBUG_AOT == 0
+            if (option->output_format == AOT_FORMAT_FILE
+                && !comp_ctx->external_llc_compiler
+                && !comp_ctx->external_asm_compiler
+                && (!strcmp(comp_ctx->target_arch, "x86_64")
+                    || !strncmp(comp_ctx->target_arch, "aarch64", 7))
+                && !strstr(triple_norm, "windows")) {
+                comp_ctx->thread_num = option->thread_num;
+                comp_ctx->cache_dir = option->cache_dir;
+            }
+            else
+#endif
+                LOG_WARNING("Compile with multiple threads or the cache "
+                            "isn't supported for this target or output "
+                            "format, fallback to compile with one thread "
+                            "and without the cache");
+        }
     }
 
     if (option->enable_simd && strcmp(comp_ctx->target_arch, "x86_64") != 0
@@ -2021,6 +2193,17 @@ aot_create_comp_context(AOTCompData *comp_data, aot_comp_option_t option)
     /* set aot_inst data type to int8* */
     comp_ctx->aot_inst_type = INT8_PTR_TYPE;
 
+    if (!comp_ctx->is_jit_mode) {
+        if (option->enable_llvm_pgo) {
+            comp_ctx->enable_llvm_pgo = true;
+            comp_ctx->pgo_module_hash = aot_pgo_calc_module_hash(comp_data);
+        }
+
+        if (option->use_prof_file
+            && !aot_pgo_load_prof_file(comp_ctx, option->use_prof_file))
+            goto fail;
+    }
+
     /* Create function context for each function */
     comp_ctx->func_ctx_count = comp_data->func_count;
     if (comp_data->func_count > 0
@@ -2059,12 +2242,24 @@ fail:
 void
 aot_destroy_comp_context(AOTCompContext *comp_ctx)
 {
+    uint32 i;
+
     if (!comp_ctx)
         return;
 
     if (comp_ctx->target_machine)
         LLVMDisposeTargetMachine(comp_ctx->target_machine);
 
+    if (comp_ctx->part_obj_bufs) {
+        for (i = 0; i < comp_ctx->part_obj_buf_count; i++)
+            if (comp_ctx->part_obj_bufs[i])
+                LLVMDisposeMemoryBuffer(comp_ctx->part_obj_bufs[i]);
+        wasm_runtime_free(comp_ctx->part_obj_bufs);
+    }
+
+    if (comp_ctx->pgo_prof_counters)
+        wasm_runtime_free(comp_ctx->pgo_prof_counters);
+
     if (comp_ctx->builder)
         LLVMDisposeBuilder(comp_ctx->builder);
 
@@ -2334,8 +2529,11 @@ aot_checked_addr_list_find(AOTFuncContext *func_ctx, uint32 local_idx,
     AOTCheckedAddr *node = func_ctx->checked_addr_list;
 
     while (node) {
-        if (node->local_idx == local_idx && node->offset == offset
-            && node->bytes >= bytes) {
+        /* The previous check of local + node->offset + node->bytes
+           also covers the smaller end address of this access */
+        if (node->local_idx == local_idx
+            && (uint64)offset + bytes
+                   <= (uint64)node->offset + node->bytes) {
             return true;
         }
         node = node->next;
@@ -14,6 +14,7 @@
 #include "llvm-c/Object.h"
 #include "llvm-c/ExecutionEngine.h"
 #include "llvm-c/Analysis.h"
+#include "llvm-c/BitReader.h"
 #include "llvm-c/BitWriter.h"
 #include "llvm-c/Transforms/Utils.h"
 #include "llvm-c/Transforms/Scalar.h"
@@ -50,6 +51,11 @@ extern "C" {
 #define OPQ_PTR_TYPE INT8_PTR_TYPE
 #endif
 
+/* Name of the metadata which marks the conditional branches of the
+   software bounds checks of linear memory, its operand is the byte
+   count of the memory access */
+#define AOT_BOUNDS_CHECK_MD "aot.bounds_check"
+
 #ifndef NDEBUG
 #undef DEBUG_PASS
 #undef DUMP_MODULE
@@ -180,6 +186,7 @@ typedef struct AOTFuncContext {
     LLVMBasicBlockRef func_return_block;
     LLVMValueRef exception_id_phi;
     LLVMValueRef func_type_indexes;
+    LLVMValueRef pgo_counters;
 #if WASM_ENABLE_DEBUG_AOT != 0
     LLVMMetadataRef debug_func;
 #endif
@@ -340,6 +347,30 @@ typedef struct AOTCompContext {
     uint32 opt_level;
     uint32 size_level;
 
+    /* Number of threads to optimize and codegen the module, if it is
+       larger than 1, the functions are split into thread_num modules
+       which are compiled in parallel, and their object files are linked
+       into the AOT file */
+    uint32 thread_num;
+    /* Directory to cache the object files of the split modules by their
+       content, each cluster of functions is split into its own module and
+       only the modules not found in the cache are compiled. In JIT mode,
+       the object files compiled by ORC JIT are cached instead */
+    char *cache_dir;
+    /* Object files of the split modules generated by aot_compile_wasm */
+    LLVMMemoryBufferRef *part_obj_bufs;
+    uint32 part_obj_buf_count;
+
+    /* Instrument the code to record the profile data for PGO */
+    bool enable_llvm_pgo;
+    /* Hash of the wasm functions, saved with the profile data */
+    uint64 pgo_module_hash;
+    /* Number of the counters allocated for the profiled sites */
+    uint32 pgo_counter_count;
+    /* Profile counters loaded from the file of wamrc --use-prof */
+    uint64 *pgo_prof_counters;
+    uint32 pgo_prof_counter_count;
+
     /* LLVM floating-point rounding mode metadata */
     LLVMValueRef fp_rounding_mode;
 
@@ -406,6 +437,10 @@ typedef struct AOTCompOption {
     uint32 bounds_checks;
     char **custom_sections;
     uint32 custom_sections_count;
+    uint32 thread_num;
+    char *cache_dir;
+    bool enable_llvm_pgo;
+    char *use_prof_file;
 } AOTCompOption, *aot_comp_option_t;
 
 AOTCompContext *
@@ -498,7 +533,75 @@ void
 aot_add_simple_loop_unswitch_pass(LLVMPassManagerRef pass);
 
 void
-aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx, LLVMModuleRef module);
+aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx,
+                                LLVMTargetMachineRef target_machine,
+                                LLVMModuleRef module);
+
+LLVMTargetMachineRef
+aot_clone_target_machine(LLVMTargetMachineRef target_machine);
+
+/**
+ * Split the functions of comp_ctx->module into modules, the callers and
+ * their small callees are kept in the same module so that they can still
+ * be inlined.
+ *
+ * @param comp_ctx the compilation context
+ * @param part_count the number of modules to split into, or 0 to split
+ *        each cluster of the callers and callees into its own module, so
+ *        that the modules can be cached by their content
+ * @param p_bitcode_bufs returns the bitcode of the modules, which can be
+ *        loaded into other LLVM contexts, the array should be freed with
+ *        wasm_runtime_free after the buffers are disposed
+ * @param p_part_count returns the number of the modules
+ *
+ * @return true if succeeded, false otherwise
+ */
+bool
+aot_split_module(AOTCompContext *comp_ctx, uint32 part_count,
+                 LLVMMemoryBufferRef **p_bitcode_bufs, uint32 *p_part_count);
+
+/* Size of the key of a module in the cache directory, the SHA-1 hash in
+   hexadecimal with the terminating null character */
+#define AOT_CACHE_KEY_SIZE 41
+
+/**
+ * Get the key of a split module in the cache directory, which is the
+ * hash of its bitcode, the compiler version and the options affecting
+ * its optimization and codegen.
+ *
+ * @param comp_ctx the compilation context
+ * @param bitcode_buf the bitcode of the module
+ * @param key_buf returns the key, in hexadecimal
+ * @param key_buf_size the size of key_buf, AOT_CACHE_KEY_SIZE at least
+ *
+ * @return true if succeeded, false otherwise
+ */
+bool
+aot_get_module_cache_key(AOTCompContext *comp_ctx,
+                         LLVMMemoryBufferRef bitcode_buf, char *key_buf,
+                         uint32 key_buf_size);
+
+/**
+ * Get the key of a wasm module compiled by LLVM JIT, which is the hash of
+ * the module content, the runtime build and the options affecting the
+ * optimization and codegen. The object files compiled by ORC JIT are
+ * cached by it and the symbols they define.
+ *
+ * @param comp_ctx the compilation context
+ * @param wasm_buf the content of the wasm module
+ * @param wasm_size the size of the wasm module
+ * @param key_buf returns the key, in hexadecimal
+ * @param key_buf_size the size of key_buf, AOT_CACHE_KEY_SIZE at least
+ *
+ * @return true if succeeded, false otherwise
+ */
+bool
+aot_get_jit_module_cache_key(AOTCompContext *comp_ctx, const uint8 *wasm_buf,
+                             uint32 wasm_size, char *key_buf,
+                             uint32 key_buf_size);
+
+void
+aot_set_pgo_prof_summary(LLVMModuleRef module);
 
 void
 aot_handle_llvm_errmsg(const char *string, LLVMErrorRef err);
@@ -6,6 +6,7 @@
 #include <llvm/Passes/StandardInstrumentations.h>
 #include <llvm/Support/Error.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/Triple.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
@@ -25,12 +26,17 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/ProfileCommon.h>
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/SHA1.h>
 #include <llvm/Target/CodeGenCWrappers.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 #include <llvm/Transforms/Utils/LowerMemIntrinsics.h>
 #include <llvm/Transforms/Vectorize/LoopVectorize.h>
 #include <llvm/Transforms/Vectorize/LoadStoreVectorizer.h>
@@ -39,14 +45,33 @@
 #include <llvm/Transforms/Scalar/SimpleLoopUnswitch.h>
 #include <llvm/Transforms/Scalar/LICM.h>
 #include <llvm/Transforms/Scalar/GVN.h>
+#include <llvm/Transforms/Utils/Mem2Reg.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+#include <llvm/Transforms/Utils/LoopSimplify.h>
+#include <llvm/Transforms/Utils/LoopUtils.h>
+#include <llvm/Transforms/Utils/ScalarEvolutionExpander.h>
+#include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/PatternMatch.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #if LLVM_VERSION_MAJOR >= 12
 #include <llvm/Analysis/AliasAnalysis.h>
 #endif
+#if LLVM_VERSION_MAJOR >= 14
+#include <llvm/MC/TargetRegistry.h>
+#else
+#include <llvm/Support/TargetRegistry.h>
+#endif
 
+#include <algorithm>
 #include <cstring>
 #include "../aot/aot_runtime.h"
+#include "../../version.h"
 #include "aot_llvm.h"
 
 using namespace llvm;
@@ -64,7 +89,29 @@ void
 aot_add_simple_loop_unswitch_pass(LLVMPassManagerRef pass);
 
 void
-aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx, LLVMModuleRef module);
+aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx,
+                                LLVMTargetMachineRef target_machine,
+                                LLVMModuleRef module);
+
+LLVMTargetMachineRef
+aot_clone_target_machine(LLVMTargetMachineRef target_machine);
+
+bool
+aot_split_module(AOTCompContext *comp_ctx, uint32 part_count,
+                 LLVMMemoryBufferRef **p_bitcode_bufs, uint32 *p_part_count);
+
+bool
+aot_get_module_cache_key(AOTCompContext *comp_ctx,
+                         LLVMMemoryBufferRef bitcode_buf, char *key_buf,
+                         uint32 key_buf_size);
+
+bool
+aot_get_jit_module_cache_key(AOTCompContext *comp_ctx, const uint8 *wasm_buf,
+                             uint32 wasm_size, char *key_buf,
+                             uint32 key_buf_size);
+
+void
+aot_set_pgo_prof_summary(LLVMModuleRef module);
 
 LLVM_C_EXTERN_C_END
 
@@ -181,6 +228,427 @@ aot_add_simple_loop_unswitch_pass(LLVMPassManagerRef pass)
         createSimpleLoopUnswitchLegacyPass());
 }
 
+/* The bounds check of a linear memory access emitted by
+   aot_check_memory_overflow, which is
+     br (icmp ugt (add Offset, zext Addr), Bound), got_exception, succ
+   on 64-bit targets, and
+     br (or (icmp ult (add Offset, Addr), Addr),
+            (icmp ugt (add Offset, Addr), Bound)), got_exception, succ
+   on 32-bit targets, where Bound is the memory data size - Bytes */
+struct BoundsCheck {
+    BranchInst *BI;
+    Value *Addr;
+    Value *AddrExt;
+    Value *Offset;
+    Value *Bound;
+    uint64_t Bytes;
+    bool Is64;
+};
+
+/* Max instruction count of the loop to version */
+static const unsigned MaxVersionLoopSize = 1000;
+/* Max basic block count to walk when merging the checks */
+static const unsigned MaxMergeBlockCount = 64;
+
+class BoundsCheckOptPass : public PassInfoMixin<BoundsCheckOptPass>
+{
+  public:
+    BoundsCheckOptPass(uint64_t MinMemSize)
+      : MinMemSize(MinMemSize)
+    {}
+
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM);
+
+  private:
+    bool parseBoundsCheck(Instruction *I, BoundsCheck &BC);
+    void removeBoundsCheck(BranchInst *BI);
+    bool removeInRangeChecks(Function &F, ScalarEvolution &SE);
+    bool mergeAdjacentChecks(Function &F);
+    bool versionLoop(Loop *L, DominatorTree &DT, LoopInfo &LI,
+                     ScalarEvolution &SE, AssumptionCache &AC);
+
+    uint64_t MinMemSize;
+    unsigned MDKind;
+};
+
+bool
+BoundsCheckOptPass::parseBoundsCheck(Instruction *I, BoundsCheck &BC)
+{
+    using namespace PatternMatch;
+    BranchInst *BI = dyn_cast_or_null<BranchInst>(I);
+    ICmpInst::Predicate Pred, Pred1;
+    Value *Offset1, *Offset2;
+    MDNode *MD;
+
+    if (!BI || !BI->isConditional() || !(MD = BI->getMetadata(MDKind))
+        || MD->getNumOperands() != 1)
+        return false;
+
+    BC.BI = BI;
+    BC.Bytes = mdconst::extract<ConstantInt>(MD->getOperand(0))->getZExtValue();
+
+    if (match(BI->getCondition(),
+              m_ICmp(Pred, m_Value(Offset1), m_Value(BC.Bound)))
+        && Pred == ICmpInst::ICMP_UGT
+        && match(Offset1, m_c_Add(m_Value(BC.Offset),
+                                  m_CombineAnd(m_ZExt(m_Value(BC.Addr)),
+                                               m_Value(BC.AddrExt))))) {
+        BC.Is64 = true;
+        return true;
+    }
+
+    if (match(BI->getCondition(),
+              m_Or(m_ICmp(Pred1, m_Value(Offset1), m_Value(BC.Addr)),
+                   m_ICmp(Pred, m_Value(Offset2), m_Value(BC.Bound))))
+        && Pred1 == ICmpInst::ICMP_ULT && Pred == ICmpInst::ICMP_UGT
+        && Offset1 == Offset2
+        && match(Offset1, m_c_Add(m_Value(BC.Offset), m_Specific(BC.Addr)))) {
+        BC.AddrExt = BC.Addr;
+        BC.Is64 = false;
+        return true;
+    }
+
+    return false;
+}
+
+void
+BoundsCheckOptPass::removeBoundsCheck(BranchInst *BI)
+{
+    /* The dead branch and the compare instructions are removed by
+       the later passes */
+    BI->setCondition(ConstantInt::getFalse(BI->getContext()));
+    BI->setMetadata(MDKind, nullptr);
+}
+
+/* Remove the checks whose max end address is in the minimum memory size,
+   the value ranges of the address come from the scalar evolution, e.g.
+   the range of the induction variable of a counted loop */
+bool
+BoundsCheckOptPass::removeInRangeChecks(Function &F, ScalarEvolution &SE)
+{
+    bool Changed = false;
+
+    for (BasicBlock &BB : F) {
+        BoundsCheck BC;
+
+        if (!parseBoundsCheck(BB.getTerminator(), BC))
+            continue;
+
+        APInt AddrMax = SE.getUnsignedRangeMax(SE.getSCEV(BC.Addr));
+        APInt OffsetMax = SE.getUnsignedRangeMax(SE.getSCEV(BC.Offset));
+        if (AddrMax.getActiveBits() > 32 || OffsetMax.getActiveBits() > 32)
+            continue;
+
+        if (AddrMax.getZExtValue() + OffsetMax.getZExtValue() + BC.Bytes
+            <= MinMemSize) {
+            removeBoundsCheck(BC.BI);
+            Changed = true;
+        }
+    }
+
+    return Changed;
+}
+
+/* Merge the checks of the same address with the constant offsets into
+   the first one, which checks the max end address instead. The checks
+   must be in a straight-line code without side effects between them,
+   so that throwing the exception earlier can't be observed */
+bool
+BoundsCheckOptPass::mergeAdjacentChecks(Function &F)
+{
+    bool Changed = false;
+
+    for (BasicBlock &BB : F) {
+        SmallVector<BranchInst *, 8> Merged;
+        ConstantInt *Offset;
+        BoundsCheck BC, BC1;
+        uint64_t EndMax;
+
+        if (!parseBoundsCheck(BB.getTerminator(), BC)
+            || !(Offset = dyn_cast<ConstantInt>(BC.Offset)))
+            continue;
+
+        EndMax = Offset->getZExtValue() + BC.Bytes;
+
+        BasicBlock *Next = BC.BI->getSuccessor(1);
+        for (unsigned i = 0; i < MaxMergeBlockCount; i++) {
+            /* Stop at the merge point of the control flow, e.g. the
+               loop header */
+            if (!Next->getSinglePredecessor())
+                break;
+
+            bool HasSideEffects = false;
+            for (Instruction &I : *Next) {
+                if (I.mayWriteToMemory()
+                    || (isa<CallBase>(I) && !isa<IntrinsicInst>(I))) {
+                    HasSideEffects = true;
+                    break;
+                }
+            }
+            if (HasSideEffects)
+                break;
+
+            BranchInst *Term = dyn_cast<BranchInst>(Next->getTerminator());
+            if (!Term)
+                break;
+            if (Term->isUnconditional()) {
+                Next = Term->getSuccessor(0);
+                continue;
+            }
+
+            /* Other exceptions may be thrown here */
+            if (!parseBoundsCheck(Term, BC1))
+                break;
+
+            if (BC1.Addr == BC.Addr && BC1.Is64 == BC.Is64
+                && (Offset = dyn_cast<ConstantInt>(BC1.Offset))) {
+                EndMax = std::max(EndMax, Offset->getZExtValue() + BC1.Bytes);
+                Merged.push_back(Term);
+            }
+            Next = Term->getSuccessor(1);
+        }
+
+        if (Merged.empty())
+            continue;
+
+        /* New offset of the first check: EndMax - BC.Bytes */
+        uint64_t NewOffset = EndMax - BC.Bytes;
+        if (!BC.Is64 && NewOffset > UINT32_MAX)
+            continue;
+
+        IRBuilder<> Builder(BC.BI);
+        Value *Offset1 = Builder.CreateAdd(
+            ConstantInt::get(BC.AddrExt->getType(), NewOffset), BC.AddrExt,
+            "offset1_merged");
+        Value *Cond = Builder.CreateICmpUGT(Offset1, BC.Bound, "cmp_merged");
+        if (!BC.Is64)
+            Cond = Builder.CreateOr(
+                Builder.CreateICmpULT(Offset1, BC.Addr, "cmp1_merged"), Cond,
+                "cmp_merged");
+        BC.BI->setCondition(Cond);
+
+        for (BranchInst *BI : Merged)
+            removeBoundsCheck(BI);
+        Changed = true;
+    }
+
+    return Changed;
+}
+
+/* Version the loop if the addresses of its checks are the affine
+   induction variables or invariants of the loop: check the first and
+   the last addresses once in the preheader, and run a copy of the loop
+   without these checks if all of them are in range, or else run the
+   original loop, which throws the exception at the right iteration.
+   Return true if the loop is changed */
+bool
+BoundsCheckOptPass::versionLoop(Loop *L, DominatorTree &DT, LoopInfo &LI,
+                                ScalarEvolution &SE, AssumptionCache &AC)
+{
+    SmallVector<BoundsCheck, 8> Checks;
+    const SCEV *BTC = nullptr;
+    bool HasCalls = false, Changed = false;
+    unsigned Size = 0;
+
+    for (BasicBlock *BB : L->blocks()) {
+        for (Instruction &I : *BB) {
+            if (isa<CallBase>(I) && !isa<IntrinsicInst>(I))
+                HasCalls = true;
+            Size++;
+        }
+    }
+    if (Size > MaxVersionLoopSize)
+        return false;
+
+    if (!L->isLoopSimplifyForm()
+        && simplifyLoop(L, &DT, &LI, &SE, &AC, nullptr, false))
+        Changed = true;
+    if (!L->isLoopSimplifyForm())
+        return Changed;
+    if (formLCSSA(*L, DT, &LI, &SE))
+        Changed = true;
+
+#if LLVM_VERSION_MAJOR >= 13
+    BTC = SE.getSymbolicMaxBackedgeTakenCount(L);
+#else
+    BTC = SE.getBackedgeTakenCount(L);
+#endif
+    if (isa<SCEVCouldNotCompute>(BTC)
+        || SE.getUnsignedRangeMax(BTC).getActiveBits() > 32)
+        BTC = nullptr;
+
+    for (BasicBlock *BB : L->blocks()) {
+        BoundsCheck BC;
+
+        if (!parseBoundsCheck(BB->getTerminator(), BC)
+            || !L->isLoopInvariant(BC.Offset))
+            continue;
+
+        /* The bound is loaded from the memory instance if the memory
+           may grow, which is only done by the calls */
+        if (!L->isLoopInvariant(BC.Bound)) {
+            LoadInst *Load = dyn_cast<LoadInst>(BC.Bound);
+            if (HasCalls || !Load
+                || !L->isLoopInvariant(Load->getPointerOperand()))
+                continue;
+        }
+
+        const SCEV *Addr = SE.getSCEV(BC.Addr);
+        const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(Addr);
+        if (AR && AR->getLoop() == L && AR->isAffine()) {
+            if (!BTC || !isSafeToExpand(AR->getStart(), SE)
+                || !isSafeToExpand(AR->getStepRecurrence(SE), SE))
+                continue;
+        }
+        else if (!SE.isLoopInvariant(Addr, L) || !isSafeToExpand(Addr, SE))
+            continue;
+
+        Checks.push_back(BC);
+    }
+
+    if (Checks.empty())
+        return Changed;
+
+    BasicBlock *CheckBB = L->getLoopPreheader();
+    Instruction *InsertPt = CheckBB->getTerminator();
+    const DataLayout &DL = CheckBB->getModule()->getDataLayout();
+    Type *I64Ty = Type::getInt64Ty(CheckBB->getContext());
+    SCEVExpander Expander(SE, DL, "bounds_check");
+    IRBuilder<> Builder(InsertPt);
+    Value *AllInRange = nullptr;
+
+    for (BoundsCheck &BC : Checks) {
+        const SCEV *Addr = SE.getSCEV(BC.Addr);
+        const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(Addr);
+        Value *First, *Last, *Max, *Offset, *Bound, *InRange;
+
+        if (AR && AR->getLoop() == L) {
+            /* The addresses are linear in the iterations, if the last
+               one calculated in i64 is in [0, UINT32_MAX], the address
+               doesn't wrap and the first and the last ones are the
+               min and max addresses */
+            First = Expander.expandCodeFor(
+                SE.getZeroExtendExpr(AR->getStart(), I64Ty), I64Ty, InsertPt);
+            Value *Step = Expander.expandCodeFor(
+                SE.getSignExtendExpr(AR->getStepRecurrence(SE), I64Ty), I64Ty,
+                InsertPt);
+            Value *Count = Expander.expandCodeFor(
+                SE.getTruncateOrZeroExtend(BTC, I64Ty), I64Ty, InsertPt);
+            Last = Builder.CreateAdd(First, Builder.CreateMul(Step, Count));
+            Max = Builder.CreateSelect(Builder.CreateICmpSGT(Last, First),
+                                       Last, First);
+            InRange = Builder.CreateAnd(
+                Builder.CreateICmpSGE(Last, ConstantInt::get(I64Ty, 0)),
+                Builder.CreateICmpSLE(Last,
+                                      ConstantInt::get(I64Ty, UINT32_MAX)));
+        }
+        else {
+            Max = Expander.expandCodeFor(SE.getZeroExtendExpr(Addr, I64Ty),
+                                         I64Ty, InsertPt);
+            InRange = nullptr;
+        }
+
+        if (L->isLoopInvariant(BC.Bound))
+            Bound = BC.Bound;
+        else
+            Bound = Builder.CreateLoad(
+                BC.Bound->getType(),
+                cast<LoadInst>(BC.Bound)->getPointerOperand(), "mem_bound");
+
+        Offset = Builder.CreateZExt(BC.Offset, I64Ty);
+        Bound = Builder.CreateZExt(Bound, I64Ty);
+        Value *Cmp = Builder.CreateICmpULE(Builder.CreateAdd(Max, Offset),
+                                           Bound);
+        if (InRange)
+            Cmp = Builder.CreateAnd(InRange, Cmp);
+        AllInRange = AllInRange ? Builder.CreateAnd(AllInRange, Cmp) : Cmp;
+    }
+
+    /* Clone the loop with the preheader, the same as LoopVersioning */
+    SmallVector<BasicBlock *, 8> ExitBlocks;
+    L->getUniqueExitBlocks(ExitBlocks);
+
+    BasicBlock *PH =
+        SplitBlock(CheckBB, CheckBB->getTerminator(), &DT, &LI, nullptr,
+                   L->getHeader()->getName() + ".ph");
+    ValueToValueMapTy VMap;
+    SmallVector<BasicBlock *, 8> NewBlocks;
+    Loop *NewLoop = cloneLoopWithPreheader(PH, CheckBB, L, VMap, ".unchecked",
+                                           &LI, &DT, NewBlocks);
+    remapInstructionsInBlocks(NewBlocks, VMap);
+
+    /* The values used outside the loop are all in the LCSSA phis of the
+       exit blocks, add the incoming values from the new loop */
+    for (BasicBlock *Exit : ExitBlocks) {
+        for (PHINode &PN : Exit->phis()) {
+            for (unsigned i = 0, e = PN.getNumIncomingValues(); i < e; i++) {
+                if (!L->contains(PN.getIncomingBlock(i)))
+                    continue;
+                Value *V = PN.getIncomingValue(i);
+                ValueToValueMapTy::iterator It = VMap.find(V);
+                PN.addIncoming(It != VMap.end() ? (Value *)It->second : V,
+                               cast<BasicBlock>(VMap[PN.getIncomingBlock(i)]));
+            }
+        }
+    }
+
+    Instruction *Term = CheckBB->getTerminator();
+    BranchInst::Create(NewLoop->getLoopPreheader(), PH, AllInRange, Term);
+    Term->eraseFromParent();
+
+    for (BoundsCheck &BC : Checks) {
+        removeBoundsCheck(cast<BranchInst>(VMap[BC.BI]));
+        BC.BI->setMetadata(MDKind, nullptr);
+    }
+
+    return true;
+}
+
+PreservedAnalyses
+BoundsCheckOptPass::run(Function &F, FunctionAnalysisManager &FAM)
+{
+    TargetLibraryInfo &TLI = FAM.getResult<TargetLibraryAnalysis>(F);
+    AssumptionCache &AC = FAM.getResult<AssumptionAnalysis>(F);
+    std::unique_ptr<DominatorTree> DT(new DominatorTree(F));
+    std::unique_ptr<LoopInfo> LI(new LoopInfo(*DT));
+    std::unique_ptr<ScalarEvolution> SE(
+        new ScalarEvolution(F, TLI, AC, *DT, *LI));
+    SmallVector<BasicBlock *, 8> Headers;
+    bool Changed = false, Rebuild = false;
+
+    MDKind = F.getContext().getMDKindID(AOT_BOUNDS_CHECK_MD);
+
+    if (removeInRangeChecks(F, *SE))
+        Changed = true;
+    if (mergeAdjacentChecks(F))
+        Changed = Rebuild = true;
+
+    for (Loop *L : LI->getLoopsInPreorder()) {
+        if (L->getSubLoops().empty())
+            Headers.push_back(L->getHeader());
+    }
+
+    for (BasicBlock *Header : Headers) {
+        if (Rebuild) {
+            /* The CFG or the values were changed, analyze them again */
+            SE.reset();
+            DT.reset(new DominatorTree(F));
+            LI.reset(new LoopInfo(*DT));
+            SE.reset(new ScalarEvolution(F, TLI, AC, *DT, *LI));
+            Rebuild = false;
+        }
+
+        Loop *L = LI->getLoopFor(Header);
+        if (!L || L->getHeader() != Header || !L->getSubLoops().empty())
+            continue;
+
+        if (versionLoop(L, *DT, *LI, *SE, AC))
+            Changed = Rebuild = true;
+    }
+
+    return Changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
 bool
 aot_check_simd_compatibility(const char *arch_c_str, const char *cpu_c_str)
 {
@@ -223,10 +691,11 @@ aot_check_simd_compatibility(const char *arch_c_str, const char *cpu_c_str)
 }
 
 void
-aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx, LLVMModuleRef module)
+aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx,
+                                LLVMTargetMachineRef target_machine,
+                                LLVMModuleRef module)
 {
-    TargetMachine *TM =
-        reinterpret_cast<TargetMachine *>(comp_ctx->target_machine);
+    TargetMachine *TM = reinterpret_cast<TargetMachine *>(target_machine);
     PipelineTuningOptions PTO;
     PTO.LoopVectorization = true;
     PTO.SLPVectorization = true;
@@ -321,6 +790,23 @@ aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx, LLVMModuleRef module)
     }
 
     ModulePassManager MPM;
+
+    if (comp_ctx->enable_bound_check) {
+        AOTCompData *comp_data = comp_ctx->comp_data;
+        uint64_t min_mem_size = 0;
+        FunctionPassManager FPM;
+
+        if (comp_data->memory_count > 0)
+            min_mem_size = (uint64_t)comp_data->memories[0].num_bytes_per_page
+                           * comp_data->memories[0].mem_init_page_count;
+
+        /* Promote the wasm locals to SSA values, so that the bounds checks
+           can be analyzed by the scalar evolution */
+        FPM.addPass(PromotePass());
+        FPM.addPass(BoundsCheckOptPass(min_mem_size));
+        MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+    }
+
     if (comp_ctx->is_jit_mode) {
         const char *Passes =
             "mem2reg,instcombine,simplifycfg,jump-threading,indvars";
@@ -356,4 +842,448 @@ aot_apply_llvm_new_pass_manager(AOTCompContext *comp_ctx, LLVMModuleRef module)
     }
 
     MPM.run(*M, MAM);
+
+    if (!comp_ctx->is_jit_mode && comp_ctx->pgo_prof_counters) {
+        bool is_macho = TM->getTargetTriple().isOSBinFormatMachO();
+        std::vector<Function *> ColdFuncs;
+
+        for (Function &F : *M) {
+            if (F.isDeclaration())
+                continue;
+            /* Keep the functions in the .text section, or the codegen
+               puts the hot and cold functions into the .text.hot and
+               .text.unlikely sections according to the profile data */
+            if (!is_macho)
+                F.setSection(".text");
+            if (F.hasFnAttribute(Attribute::Cold))
+                ColdFuncs.push_back(&F);
+        }
+
+        /* Emit the cold functions after the others, so as to split them
+           from the hot code in the text section */
+        for (Function *F : ColdFuncs) {
+            F->removeFromParent();
+            M->getFunctionList().push_back(F);
+        }
+    }
+}
+
+LLVMTargetMachineRef
+aot_clone_target_machine(LLVMTargetMachineRef target_machine)
+{
+    TargetMachine *TM = reinterpret_cast<TargetMachine *>(target_machine);
+
+    return reinterpret_cast<LLVMTargetMachineRef>(
+        TM->getTarget().createTargetMachine(
+            TM->getTargetTriple().str(), TM->getTargetCPU(),
+            TM->getTargetFeatureString(), TM->Options,
+            TM->getRelocationModel(), TM->getCodeModel(), TM->getOptLevel()));
+}
+
+/* Callees with no more IR instructions than it are regarded as the
+   candidates to be inlined, and are kept in the same module with their
+   callers when splitting the module */
+#define SPLIT_INLINE_CANDIDATE_SIZE 128
+
+/* Max IR instructions of a cluster when each cluster is split into its
+   own module to be cached, a larger cluster is invalidated more often */
+#define SPLIT_CACHE_CLUSTER_SIZE 4096
+
+static uint32
+find_cluster(std::vector<uint32> &parents, uint32 i)
+{
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+/* Declare the functions referred by a split module on demand */
+class PartDeclMaterializer : public ValueMaterializer
+{
+  public:
+    PartDeclMaterializer(Module &M)
+      : M(M)
+    {}
+
+    Value *materialize(Value *V) override
+    {
+        Function *F = dyn_cast<Function>(V);
+        Function *NewF;
+
+        if (!F)
+            return nullptr;
+        NewF = Function::Create(F->getFunctionType(),
+                                GlobalValue::ExternalLinkage,
+                                F->getAddressSpace(), F->getName(), &M);
+        NewF->copyAttributesFrom(F);
+        return NewF;
+    }
+
+  private:
+    Module &M;
+};
+
+/* Clone the functions of a split module, only the functions it refers
+   are declared, so that its bitcode doesn't change with the other
+   functions, and that cloning a module doesn't cost the time of
+   declaring all the functions */
+static std::unique_ptr<Module>
+clone_module_part(Module &M, const std::vector<Function *> &funcs)
+{
+    std::unique_ptr<Module> New =
+        std::make_unique<Module>(M.getModuleIdentifier(), M.getContext());
+    PartDeclMaterializer Materializer(*New);
+    ValueToValueMapTy VMap;
+
+    New->setSourceFileName(M.getSourceFileName());
+    New->setDataLayout(M.getDataLayout());
+    New->setTargetTriple(M.getTargetTriple());
+    New->setModuleInlineAsm(M.getModuleInlineAsm());
+
+    for (Function *F : funcs) {
+        Function *NewF =
+            Function::Create(F->getFunctionType(), F->getLinkage(),
+                             F->getAddressSpace(), F->getName(), New.get());
+        NewF->copyAttributesFrom(F);
+        VMap[F] = NewF;
+    }
+
+    for (Function *F : funcs) {
+        Function *NewF = cast<Function>(VMap[F]);
+        Function::arg_iterator DestI = NewF->arg_begin();
+        SmallVector<ReturnInst *, 8> Returns;
+
+        for (const Argument &Arg : F->args()) {
+            DestI->setName(Arg.getName());
+            VMap[&Arg] = &*DestI++;
+        }
+#if LLVM_VERSION_MAJOR >= 13
+        CloneFunctionInto(NewF, F, VMap,
+                          CloneFunctionChangeType::DifferentModule, Returns,
+                          "", nullptr, nullptr, &Materializer);
+#else
+        CloneFunctionInto(NewF, F, VMap, true, Returns, "", nullptr, nullptr,
+                          &Materializer);
+#endif
+    }
+
+    for (const NamedMDNode &NMD : M.named_metadata()) {
+        NamedMDNode *NewNMD = New->getOrInsertNamedMetadata(NMD.getName());
+        for (const MDNode *N : NMD.operands())
+            NewNMD->addOperand(
+                MapMetadata(N, VMap, RF_None, nullptr, &Materializer));
+    }
+
+    return New;
+}
+
+bool
+aot_split_module(AOTCompContext *comp_ctx, uint32 part_count,
+                 LLVMMemoryBufferRef **p_bitcode_bufs, uint32 *p_part_count)
+{
+    Module *M = reinterpret_cast<Module *>(comp_ctx->module);
+    DenseMap<const GlobalValue *, uint32> func_indices;
+    std::vector<Function *> funcs;
+    std::vector<uint64> sizes, part_sizes;
+    std::vector<uint32> parents, roots, func_parts;
+    std::vector<std::pair<uint32, uint32>> edges;
+    LLVMMemoryBufferRef *bitcode_bufs;
+    uint64 total_size = 0, max_cluster_size;
+    uint32 i, j;
+
+    for (Function &F : *M) {
+        if (F.isDeclaration())
+            continue;
+        func_indices[&F] = (uint32)funcs.size();
+        parents.push_back((uint32)funcs.size());
+        funcs.push_back(&F);
+        sizes.push_back(F.getInstructionCount());
+        total_size += sizes.back();
+    }
+
+    /* Collect the direct calls to the inline candidates */
+    for (i = 0; i < funcs.size(); i++) {
+        for (Instruction &I : instructions(funcs[i])) {
+            CallBase *call = dyn_cast<CallBase>(&I);
+            Function *callee = call ? call->getCalledFunction() : NULL;
+
+            if (callee && callee != funcs[i]) {
+                auto it = func_indices.find(callee);
+                if (it != func_indices.end()
+                    && sizes[it->second] <= SPLIT_INLINE_CANDIDATE_SIZE)
+                    edges.push_back(std::make_pair(i, it->second));
+            }
+        }
+    }
+
+    /* Cluster the callers with their callees, starting from the smallest
+       callees, and limit the cluster size to keep the modules balanced */
+    std::stable_sort(edges.begin(), edges.end(),
+                     [&](const std::pair<uint32, uint32> &a,
+                         const std::pair<uint32, uint32> &b) {
+                         return sizes[a.second] < sizes[b.second];
+                     });
+    if (part_count > 0)
+        max_cluster_size = (total_size + part_count - 1) / part_count;
+    else
+        max_cluster_size = SPLIT_CACHE_CLUSTER_SIZE;
+    std::vector<uint64> cluster_sizes(sizes);
+    for (auto &edge : edges) {
+        uint32 caller = find_cluster(parents, edge.first);
+        uint32 callee = find_cluster(parents, edge.second);
+
+        if (caller != callee
+            && cluster_sizes[caller] + cluster_sizes[callee]
+                   <= max_cluster_size) {
+            parents[callee] = caller;
+            cluster_sizes[caller] += cluster_sizes[callee];
+        }
+    }
+
+    for (i = 0; i < funcs.size(); i++) {
+        if (find_cluster(parents, i) == i)
+            roots.push_back(i);
+    }
+    func_parts.resize(funcs.size());
+    if (part_count == 0) {
+        /* Each cluster is a module, in the order of the functions */
+        part_count = (uint32)roots.size();
+        for (j = 0; j < part_count; j++)
+            func_parts[roots[j]] = j;
+    }
+    else {
+        /* Assign the clusters to the least loaded module, from the
+           largest cluster to the smallest one */
+        std::stable_sort(roots.begin(), roots.end(), [&](uint32 a, uint32 b) {
+            return cluster_sizes[a] > cluster_sizes[b];
+        });
+        part_sizes.resize(part_count, 0);
+        for (uint32 root : roots) {
+            j = (uint32)(std::min_element(part_sizes.begin(), part_sizes.end())
+                         - part_sizes.begin());
+            func_parts[root] = j;
+            part_sizes[j] += cluster_sizes[root];
+        }
+    }
+    for (i = 0; i < funcs.size(); i++)
+        func_parts[i] = func_parts[find_cluster(parents, i)];
+
+    if (part_count == 0
+        || !(bitcode_bufs = (LLVMMemoryBufferRef *)wasm_runtime_malloc(
+                 sizeof(LLVMMemoryBufferRef) * part_count))) {
+        aot_set_last_error("allocate memory failed.");
+        return false;
+    }
+
+    std::vector<std::vector<Function *>> part_funcs(part_count);
+    for (i = 0; i < funcs.size(); i++)
+        part_funcs[func_parts[i]].push_back(funcs[i]);
+
+    /* Clone the module for each part, the functions of other parts are
+       cloned as declarations, and are resolved by their symbol names */
+    for (j = 0; j < part_count; j++) {
+        std::unique_ptr<Module> part;
+
+        if (M->global_empty() && M->alias_empty() && M->ifunc_empty())
+            part = clone_module_part(*M, part_funcs[j]);
+        else {
+            ValueToValueMapTy VMap;
+            part = CloneModule(*M, VMap, [&](const GlobalValue *GV) {
+                auto it = func_indices.find(GV);
+                return it == func_indices.end() || func_parts[it->second] == j;
+            });
+
+            /* Remove the declarations not called by the part */
+            for (auto it = part->begin(); it != part->end();) {
+                Function &F = *it++;
+                if (F.isDeclaration() && F.use_empty())
+                    F.eraseFromParent();
+            }
+        }
+
+        /* The cloning adds an empty "llvm.dbg.cu", for which LLVM warns
+           that the debug info is ignored when loading the bitcode */
+        NamedMDNode *NMD = part->getNamedMetadata("llvm.dbg.cu");
+        if (NMD && NMD->getNumOperands() == 0)
+            part->eraseNamedMetadata(NMD);
+
+        if (!(bitcode_bufs[j] = LLVMWriteBitcodeToMemoryBuffer(
+                  reinterpret_cast<LLVMModuleRef>(part.get())))) {
+            aot_set_last_error("write module bitcode to buffer failed.");
+            while (j > 0)
+                LLVMDisposeMemoryBuffer(bitcode_bufs[--j]);
+            wasm_runtime_free(bitcode_bufs);
+            return false;
+        }
+    }
+
+    *p_bitcode_bufs = bitcode_bufs;
+    *p_part_count = part_count;
+    return true;
+}
+
+/* Hash the compiler version and the options which affect the
+   optimization and codegen but aren't recorded in the bitcode */
+static void
+hash_compile_options(AOTCompContext *comp_ctx, SHA1 &Hasher)
+{
+    TargetMachine *TM =
+        reinterpret_cast<TargetMachine *>(comp_ctx->target_machine);
+    AOTCompData *comp_data = comp_ctx->comp_data;
+    uint64 min_mem_size = 0;
+
+    if (comp_data->memory_count > 0)
+        min_mem_size = (uint64)comp_data->memories[0].num_bytes_per_page
+                       * comp_data->memories[0].mem_init_page_count;
+
+    uint64 options[] = { WAMR_VERSION_MAJOR,
+                         WAMR_VERSION_MINOR,
+                         WAMR_VERSION_PATCH,
+                         AOT_CURRENT_VERSION,
+                         (uint64)TM->getRelocationModel(),
+                         (uint64)TM->getCodeModel(),
+                         (uint64)TM->getOptLevel(),
+                         comp_ctx->opt_level,
+                         comp_ctx->size_level,
+                         comp_ctx->is_indirect_mode,
+                         comp_ctx->disable_llvm_lto,
+                         comp_ctx->enable_bound_check,
+                         min_mem_size,
+                         comp_ctx->pgo_prof_counters ? 1U : 0U };
+    std::string Strs[] = { LLVM_VERSION_STRING, TM->getTargetTriple().str(),
+                           TM->getTargetCPU().str(),
+                           TM->getTargetFeatureString().str() };
+
+    Hasher.update(ArrayRef<uint8_t>((const uint8_t *)options, sizeof(options)));
+    for (std::string &Str : Strs) {
+        /* Include the terminating null characters to separate them */
+        Hasher.update(StringRef(Str.c_str(), Str.size() + 1));
+    }
+}
+
+static bool
+get_cache_key(SHA1 &Hasher, char *key_buf, uint32 key_buf_size)
+{
+    std::string Key = toHex(Hasher.result(), true);
+
+    if (Key.size() >= key_buf_size) {
+        aot_set_last_error("cache key buffer too small.");
+        return false;
+    }
+    bh_memcpy_s(key_buf, key_buf_size, Key.c_str(), (uint32)Key.size() + 1);
+    return true;
+}
+
+bool
+aot_get_module_cache_key(AOTCompContext *comp_ctx,
+                         LLVMMemoryBufferRef bitcode_buf, char *key_buf,
+                         uint32 key_buf_size)
+{
+    SHA1 Hasher;
+
+    hash_compile_options(comp_ctx, Hasher);
+    Hasher.update(StringRef(LLVMGetBufferStart(bitcode_buf),
+                            LLVMGetBufferSize(bitcode_buf)));
+    return get_cache_key(Hasher, key_buf, key_buf_size);
+}
+
+bool
+aot_get_jit_module_cache_key(AOTCompContext *comp_ctx, const uint8 *wasm_buf,
+                             uint32 wasm_size, char *key_buf,
+                             uint32 key_buf_size)
+{
+    /* The IR generated for JIT depends on the features and the struct
+       layouts of the runtime, which may change when the runtime is
+       rebuilt, so the object files of another build aren't reused */
+    const char *build_time = __DATE__ " " __TIME__;
+    uint32 features[] = { comp_ctx->enable_bulk_memory,
+                          comp_ctx->enable_thread_mgr,
+                          comp_ctx->enable_tail_call,
+                          comp_ctx->enable_simd,
+                          comp_ctx->enable_ref_types,
+                          comp_ctx->enable_aux_stack_check,
+                          comp_ctx->enable_aux_stack_frame,
+                          (uint32)sizeof(AOTModuleInstance),
+                          (uint32)sizeof(AOTMemoryInstance),
+                          (uint32)sizeof(WASMExecEnv) };
+    SHA1 Hasher;
+
+    hash_compile_options(comp_ctx, Hasher);
+    Hasher.update(StringRef(build_time, strlen(build_time) + 1));
+    Hasher.update(
+        ArrayRef<uint8_t>((const uint8_t *)features, sizeof(features)));
+    Hasher.update(ArrayRef<uint8_t>(wasm_buf, wasm_size));
+    return get_cache_key(Hasher, key_buf, key_buf_size);
+}
+
+/* Get the counts from the "function_entry_count" or "branch_weights"
+   profile metadata */
+static void
+get_prof_md_counts(MDNode *MD, const char *name, std::vector<uint64_t> &counts)
+{
+    MDString *MDName;
+
+    if (!MD || MD->getNumOperands() < 2
+        || !(MDName = dyn_cast<MDString>(MD->getOperand(0)))
+        || !MDName->getString().equals(name))
+        return;
+
+    for (unsigned i = 1; i < MD->getNumOperands(); i++) {
+        if (ConstantInt *CI = mdconst::dyn_extract<ConstantInt>(MD->getOperand(i)))
+            counts.push_back(CI->getZExtValue());
+    }
+}
+
+void
+aot_set_pgo_prof_summary(LLVMModuleRef module)
+{
+    Module *M = reinterpret_cast<Module *>(module);
+    InstrProfSummaryBuilder Builder(ProfileSummaryBuilder::DefaultCutoffs.vec());
+    std::vector<std::pair<Function *, InstrProfRecord>> Records;
+
+    for (Function &F : *M) {
+        InstrProfRecord Record;
+
+        if (F.isDeclaration())
+            continue;
+
+        /* The first count of the record is the entry count, and the
+           others are the counts of the branch edges */
+        get_prof_md_counts(F.getMetadata(LLVMContext::MD_prof),
+                           "function_entry_count", Record.Counts);
+        if (Record.Counts.size() != 1)
+            continue;
+
+        for (Instruction &I : instructions(F))
+            get_prof_md_counts(I.getMetadata(LLVMContext::MD_prof),
+                               "branch_weights", Record.Counts);
+
+        Builder.addRecord(Record);
+        Records.push_back(std::make_pair(&F, std::move(Record)));
+    }
+
+    std::unique_ptr<ProfileSummary> Summary = Builder.getSummary();
+    uint64_t HotThreshold = ProfileSummaryBuilder::getHotCountThreshold(
+        Summary->getDetailedSummary());
+    uint64_t ColdThreshold = ProfileSummaryBuilder::getColdCountThreshold(
+        Summary->getDetailedSummary());
+
+    M->setProfileSummary(Summary->getMD(M->getContext()),
+                         ProfileSummary::PSK_Instr);
+
+    /* Like the PGO instrumentation use pass, hint the inliner with the
+       functions whose entry count is hot, and mark the functions whose
+       max count is cold as cold, so that they are optimized for size and
+       split from the hot code */
+    for (auto &R : Records) {
+        std::vector<uint64_t> &Counts = R.second.Counts;
+        uint64_t MaxCount = *std::max_element(Counts.begin(), Counts.end());
+
+        if (Counts[0] >= HotThreshold)
+            R.first->addFnAttr(Attribute::InlineHint);
+        else if (MaxCount <= ColdThreshold)
+            R.first->addFnAttr(Attribute::Cold);
+    }
 }
@@ -8,6 +8,9 @@
 #include "llvm-c/OrcEE.h"
 #include "llvm-c/TargetMachine.h"
 
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
@@ -15,6 +18,9 @@
 #include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/CBindingWrapping.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA1.h"
 
 #include "aot_orc_extra.h"
 #include "aot.h"
@@ -141,6 +147,104 @@ LLVMOrcLLLazyJITBuilderSetJITTargetMachineBuilder(
     LLVMOrcDisposeJITTargetMachineBuilder(JTMP);
 }
 
+/* Cache the object files of the modules partitioned by the LLLazyJIT, a
+   module is identified by the key of the wasm module and the names of
+   the symbols it defines, which don't change between the runs */
+class JITObjectCache : public ObjectCache
+{
+  public:
+    JITObjectCache(StringRef CacheDir, StringRef ModuleKey)
+      : CacheDir(CacheDir.str())
+      , ModuleKey(ModuleKey.str())
+    {}
+
+    void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override
+    {
+        std::string Path = getCachePath(M);
+        SmallString<256> TmpPath;
+        int FD;
+
+        /* Write a temporary file and rename it, so that other processes
+           running with the same cache directory never read a partially
+           written file */
+        if (!sys::fs::createUniqueFile(Path + ".%%%%%%.tmp", FD, TmpPath)) {
+            raw_fd_ostream OS(FD, true);
+            OS << Obj.getBuffer();
+            OS.close();
+            if (!OS.has_error() && !sys::fs::rename(TmpPath, Path))
+                return;
+            OS.clear_error();
+            sys::fs::remove(TmpPath);
+        }
+        /* The object file is still used even if it isn't cached */
+        LOG_WARNING("failed to save %s into the cache directory",
+                    Path.c_str());
+    }
+
+    std::unique_ptr<MemoryBuffer> getObject(const Module *M) override
+    {
+        auto Buf = MemoryBuffer::getFile(getCachePath(M), false, false);
+
+        /* The object file isn't cached if it can't be read */
+        if (!Buf)
+            return nullptr;
+        return std::move(*Buf);
+    }
+
+  private:
+    std::string getCachePath(const Module *M)
+    {
+        std::vector<StringRef> Names;
+        SHA1 Hasher;
+
+        for (const GlobalValue &GV : M->global_values()) {
+            if (!GV.isDeclaration())
+                Names.push_back(GV.getName());
+        }
+        llvm::sort(Names);
+
+        Hasher.update(ModuleKey);
+        for (StringRef Name : Names) {
+            /* Include the terminating null characters to separate them */
+            Hasher.update(Name);
+            Hasher.update(ArrayRef<uint8_t>((const uint8_t *)"", 1));
+        }
+        return CacheDir + "/" + toHex(Hasher.result(), true) + ".o";
+    }
+
+    std::string CacheDir;
+    std::string ModuleKey;
+};
+
+/* The IR compiler of the LLLazyJIT which owns its object cache */
+class CachingIRCompiler : public ConcurrentIRCompiler
+{
+  public:
+    CachingIRCompiler(JITTargetMachineBuilder JTMB,
+                      std::unique_ptr<ObjectCache> ObjCache)
+      : ConcurrentIRCompiler(std::move(JTMB), ObjCache.get())
+      , ObjCache(std::move(ObjCache))
+    {}
+
+  private:
+    std::unique_ptr<ObjectCache> ObjCache;
+};
+
+void
+LLVMOrcLLLazyJITBuilderSetObjectCache(LLVMOrcLLLazyJITBuilderRef Builder,
+                                      const char *CacheDir,
+                                      const char *ModuleKey)
+{
+    std::string Dir(CacheDir), Key(ModuleKey);
+
+    unwrap(Builder)->setCompileFunctionCreator(
+        [Dir, Key](JITTargetMachineBuilder JTMB)
+            -> Expected<std::unique_ptr<IRCompileLayer::IRCompiler>> {
+            return std::make_unique<CachingIRCompiler>(
+                std::move(JTMB), std::make_unique<JITObjectCache>(Dir, Key));
+        });
+}
+
 static Optional<CompileOnDemandLayer::GlobalValueSet>
 PartitionFunction(GlobalValueSet Requested)
 {
@@ -37,6 +37,13 @@ void
 LLVMOrcLLLazyJITBuilderSetNumCompileThreads(LLVMOrcLLLazyJITBuilderRef Builder,
                                             unsigned NumCompileThreads);
 
+// Cache the object files compiled by the LLLazyJIT in CacheDir, each one
+// is keyed by ModuleKey and the symbols defined by the compiled module
+void
+LLVMOrcLLLazyJITBuilderSetObjectCache(LLVMOrcLLLazyJITBuilderRef Builder,
+                                      const char *CacheDir,
+                                      const char *ModuleKey);
+
 LLVMErrorRef
 LLVMOrcCreateLLLazyJIT(LLVMOrcLLLazyJITRef *Result,
                        LLVMOrcLLLazyJITBuilderRef Builder);
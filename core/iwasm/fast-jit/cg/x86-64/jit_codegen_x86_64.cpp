@@ -7,6 +7,7 @@
 #include "jit_codecache.h"
 #include "jit_compiler.h"
 #include "jit_dump.h"
+#include "../interpreter/wasm_interp.h"
 
 #include <asmjit/core.h>
 #include <asmjit/x86.h>
@@ -21,6 +22,9 @@ using namespace asmjit;
 
 static char *code_block_switch_to_jitted_from_interp = NULL;
 static char *code_block_return_to_interp_from_jitted = NULL;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+static char *code_block_call_to_interp_from_jitted = NULL;
+#endif
 
 typedef enum {
     REG_EBP_IDX = 0,
@@ -338,6 +342,38 @@ typedef struct JmpInfo {
     } dst_info;
 } JmpInfo;
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+/**
+ * Record the relocation of the imm64 of the `MOV r64, imm64` just
+ * emitted, asmjit encodes the mov with a shorter instruction if the
+ * imm fits in 32 bits, and then the code can't be relocated
+ *
+ * @param cc the compiler context
+ * @param a the assembler which emitted the mov
+ * @param mov_offset the code offset of the mov
+ * @param type the JitRelocType of the imm
+ */
+static void
+record_imm64_reloc(JitCompContext *cc, x86::Assembler &a, uint32 mov_offset,
+                   uint32 type)
+{
+    uint32 offset = (uint32)a.code()->sectionById(0)->buffer().size();
+
+    /* REX.W + B8+r + imm64 */
+    if (offset - mov_offset != 10) {
+        cc->relocatable = false;
+        return;
+    }
+    jit_cc_add_reloc(cc, offset - 8, type);
+}
+
+/* The absolute address of a memory operand whose base is a constant
+   isn't relocated */
+#define CLEAR_RELOCATABLE() (cc->relocatable = false)
+#else
+#define CLEAR_RELOCATABLE() (void)0
+#endif
+
 static bool
 label_is_neighboring(JitCompContext *cc, int32 label_prev, int32 label_succ)
 {
@@ -4511,8 +4547,10 @@ cmp_r_imm_to_r_f64(x86::Assembler &a, int32 reg_no_dst, int32 reg_no1_src,
                                                                               \
         reg_no_dst = jit_reg_no(r0);                                          \
         CHECK_REG_NO(reg_no_dst, jit_reg_kind(r0));                           \
-        if (jit_reg_is_const(r1))                                             \
+        if (jit_reg_is_const(r1)) {                                           \
             base = jit_cc_get_const_I32(cc, r1);                              \
+            CLEAR_RELOCATABLE();                                              \
+        }                                                                     \
         else {                                                                \
             reg_no_base = jit_reg_no(r1);                                     \
             CHECK_REG_NO(reg_no_base, jit_reg_kind(r1));                      \
@@ -4577,8 +4615,10 @@ cmp_r_imm_to_r_f64(x86::Assembler &a, int32 reg_no_dst, int32 reg_no1_src,
             reg_no_src = jit_reg_no(r0);                                      \
             CHECK_REG_NO(reg_no_src, jit_reg_kind(r0));                       \
         }                                                                     \
-        if (jit_reg_is_const(r1))                                             \
+        if (jit_reg_is_const(r1)) {                                           \
             base = jit_cc_get_const_I32(cc, r1);                              \
+            CLEAR_RELOCATABLE();                                              \
+        }                                                                     \
         else {                                                                \
             reg_no_base = jit_reg_no(r1);                                     \
             CHECK_REG_NO(reg_no_base, jit_reg_kind(r1));                      \
@@ -5733,6 +5773,9 @@ lower_callnative(JitCompContext *cc, x86::Assembler &a, JitInsn *insn)
     Imm imm;
     uint32 i, opnd_num;
     int32 integer_reg_index = 0, floatpoint_reg_index = 0;
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    uint32 mov_offset;
+#endif
 
     ret_reg = *(jit_insn_opndv(insn, 0));
     func_reg = *(jit_insn_opndv(insn, 1));
@@ -5819,7 +5862,13 @@ lower_callnative(JitCompContext *cc, x86::Assembler &a, JitInsn *insn)
     }
 
     imm.setValue((uint64)func_ptr);
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    mov_offset = (uint32)a.code()->sectionById(0)->buffer().size();
+#endif
     a.mov(regs_i64[REG_RAX_IDX], imm);
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    record_imm64_reloc(cc, a, mov_offset, JIT_RELOC_RUNTIME_FUNC);
+#endif
     a.call(regs_i64[REG_RAX_IDX]);
 
     if (ret_reg) {
@@ -5981,7 +6030,13 @@ lower_return(JitCompContext *cc, x86::Assembler &a, JitInsn *insn)
         a.mov(x86::eax, imm);
 
         imm.setValue((uintptr_t)code_block_return_to_interp_from_jitted);
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+        uint32 mov_offset = (uint32)a.code()->sectionById(0)->buffer().size();
+#endif
         a.mov(regs_i64[REG_I64_FREE_IDX], imm);
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+        record_imm64_reloc(cc, a, mov_offset, JIT_RELOC_RETURN_TO_INTERP);
+#endif
         a.jmp(regs_i64[REG_I64_FREE_IDX]);
     }
     return true;
@@ -6035,6 +6090,11 @@ patch_jmp_info_list(JitCompContext *cc, bh_list *jmp_info_list)
             *(uintptr_t *)stream = (uintptr_t)stream + 11;
         }
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+        if (jmp_info->type != JMP_DST_LABEL_REL)
+            jit_cc_add_reloc(cc, jmp_info->offset, JIT_RELOC_CODE);
+#endif
+
         jmp_info = jmp_info_next;
     }
 }
@@ -6876,10 +6936,71 @@ jit_codegen_init()
     bh_memcpy_s(stream, code_size, code_buf, code_size);
     code_block_return_to_interp_from_jitted = stream;
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+    a.setOffset(0);
+
+    /* The stub is jumped to by CALLBC of the jitted caller when the
+       callee hasn't been compiled, all the registers except fp_reg and
+       exec_env_reg are caller-saved for CALLBC, and the callee's index
+       was saved in exec_env->jit_cache by the caller */
+    {
+        Label label_thrown = a.newLabel();
+        x86::Mem m_cache(regs_i64[hreg_info->exec_env_hreg_index],
+                         offsetof(WASMExecEnv, jit_cache));
+        x86::Mem m_ret_addr(x86::rbp,
+                            offsetof(WASMInterpFrame, jitted_return_addr));
+        Imm imm;
+
+        /* fast_jit_call_interp_func(exec_env, fp_reg) */
+        a.mov(x86::rdi, regs_i64[hreg_info->exec_env_hreg_index]);
+        a.mov(x86::rsi, x86::rbp);
+        imm.setValue((uint64)(uintptr_t)fast_jit_call_interp_func);
+        a.mov(x86::rax, imm);
+        a.call(x86::rax);
+
+        /* Return to interpreter if exception was thrown */
+        a.test(x86::al, x86::al);
+        a.je(label_thrown);
+
+        /* rdx = xmm0 = the first result saved in exec_env->jit_cache */
+        a.mov(x86::rdx, m_cache);
+        a.movsd(x86::xmm0, m_cache);
+        /* Return to the jitted caller as RETURNBC does */
+        a.mov(x86::eax, Imm(JIT_INTERP_ACTION_NORMAL));
+        a.jmp(m_ret_addr);
+
+        a.bind(label_thrown);
+        a.mov(x86::eax, Imm(JIT_INTERP_ACTION_THROWN));
+        imm.setValue(
+            (uint64)(uintptr_t)code_block_return_to_interp_from_jitted);
+        a.mov(regs_i64[REG_I64_FREE_IDX], imm);
+        a.jmp(regs_i64[REG_I64_FREE_IDX]);
+    }
+
+    if (err_handler.err)
+        goto fail2;
+
+    code_buf = (char *)code.sectionById(0)->buffer().data();
+    code_size = code.sectionById(0)->buffer().size();
+    stream = (char *)jit_code_cache_alloc(code_size);
+    if (!stream)
+        goto fail2;
+
+    bh_memcpy_s(stream, code_size, code_buf, code_size);
+    code_block_call_to_interp_from_jitted = stream;
+
+    jit_globals->call_to_interp_from_jitted =
+        code_block_call_to_interp_from_jitted;
+#endif
+
     jit_globals->return_to_interp_from_jitted =
         code_block_return_to_interp_from_jitted;
     return true;
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+fail2:
+    jit_code_cache_free(code_block_return_to_interp_from_jitted);
+#endif
 fail1:
     jit_code_cache_free(code_block_switch_to_jitted_from_interp);
     return false;
@@ -6890,6 +7011,9 @@ jit_codegen_destroy()
 {
     jit_code_cache_free(code_block_switch_to_jitted_from_interp);
     jit_code_cache_free(code_block_return_to_interp_from_jitted);
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+    jit_code_cache_free(code_block_call_to_interp_from_jitted);
+#endif
 }
 
 /* clang-format off */
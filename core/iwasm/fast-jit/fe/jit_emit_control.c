@@ -5,6 +5,7 @@
 
 #include "jit_emit_control.h"
 #include "jit_emit_exception.h"
+#include "jit_emit_function.h"
 #include "../jit_frontend.h"
 #include "../interpreter/wasm_loader.h"
 
@@ -194,6 +195,66 @@ get_last_cmp_and_selectcc(JitCompContext *cc, JitReg cond, JitInsn **p_insn_cmp,
     }
 }
 
+#if WASM_ENABLE_JIT != 0
+bool
+jit_compile_llvm_jit_hotness_check(JitCompContext *cc)
+{
+    JitBasicBlock *request_block = NULL, *cont_block = NULL;
+    WASMModule *module = cc->cur_wasm_module;
+    JitReg hotness_addr = jit_cc_new_reg_ptr(cc);
+    JitReg hotness = jit_cc_new_reg_I32(cc);
+    JitReg args[2];
+    uint8 *bcip =
+        *(jit_annl_begin_bcip(cc, jit_basic_block_label(cc->cur_basic_block)));
+
+    CREATE_BASIC_BLOCK(request_block);
+    CREATE_BASIC_BLOCK(cont_block);
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    /* The addresses of the function and the module are only valid in
+       this run, don't save the code into the disk cache */
+    cc->relocatable = false;
+#endif
+
+    /* ++func->llvm_jit_hotness */
+    GEN_INSN(MOV, hotness_addr,
+             NEW_CONST(PTR, (uintptr_t)&cc->cur_wasm_func->llvm_jit_hotness));
+    GEN_INSN(LDI32, hotness, hotness_addr, NEW_CONST(I32, 0));
+    GEN_INSN(ADD, hotness, hotness, NEW_CONST(I32, 1));
+    GEN_INSN(STI32, hotness, hotness_addr, NEW_CONST(I32, 0));
+    /* Check equality so as to request only once */
+    GEN_INSN(CMP, cc->cmp_reg, hotness,
+             NEW_CONST(I32, LLVM_JIT_DEFAULT_TIER_UP_THRESHOLD));
+    if (!GEN_INSN(BEQ, cc->cmp_reg, jit_basic_block_label(request_block),
+                  jit_basic_block_label(cont_block))) {
+        jit_set_last_error(cc, "generate beq insn failed");
+        goto fail;
+    }
+    SET_BB_END_BCIP(cc->cur_basic_block, bcip);
+
+    SET_BUILDER_POS(request_block);
+    SET_BB_BEGIN_BCIP(request_block, bcip);
+    args[0] = jit_cc_new_reg_ptr(cc);
+    args[1] = jit_cc_new_reg_I32(cc);
+    GEN_INSN(MOV, args[0], NEW_CONST(PTR, (uintptr_t)module));
+    GEN_INSN(MOV, args[1],
+             NEW_CONST(I32, cc->cur_wasm_func_idx
+                                - module->import_function_count));
+    if (!jit_emit_callnative(cc, fast_jit_request_llvm_jit_tier_up, 0, args,
+                             2)) {
+        goto fail;
+    }
+    BUILD_BR(cont_block);
+    SET_BB_END_BCIP(request_block, bcip);
+
+    SET_BUILDER_POS(cont_block);
+    SET_BB_BEGIN_BCIP(cont_block, bcip);
+    return true;
+fail:
+    return false;
+}
+#endif
+
 static bool
 push_jit_block_to_stack_and_pass_params(JitCompContext *cc, JitBlock *block,
                                         JitBasicBlock *basic_block, JitReg cond,
@@ -12,6 +12,22 @@
 extern "C" {
 #endif
 
+#if WASM_ENABLE_JIT != 0
+/**
+ * Count the calls of the function at its entry, and request LLVM JIT to
+ * compile the function in background once the count reaches the
+ * threshold. The later calls then switch to the LLVM jitted code, a
+ * running call isn't transferred, as there is no OSR entry into the LLVM
+ * jitted code.
+ *
+ * @param cc the compiler context
+ *
+ * @return true if success, false otherwise
+ */
+bool
+jit_compile_llvm_jit_hotness_check(JitCompContext *cc);
+#endif
+
 bool
 jit_compile_op_block(JitCompContext *cc, uint8 **p_frame_ip,
                      uint8 *frame_ip_end, uint32 label_type, uint32 param_count,
@@ -228,6 +228,14 @@ jit_compile_op_call(JitCompContext *cc, uint32 func_idx, bool tail_call)
             }
         }
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+        /* The callee may not have been compiled or may have been compiled
+           by LLVM JIT, save the function index for the stub which calls
+           the function in interpreter or LLVM jitted code */
+        GEN_INSN(STI32, NEW_CONST(I32, func_idx), cc->exec_env_reg,
+                 NEW_CONST(I32, offsetof(WASMExecEnv, jit_cache)));
+#endif
+
         GEN_INSN(CALLBC, res, 0, jitted_code);
 
         if (!post_return(cc, func_type, res)) {
@@ -1450,6 +1450,39 @@ neg(float64 f64)
     return -f64;
 }
 
+/* The jitted code calls the libm functions through these wrappers, so
+   that all the native functions it calls are in the runtime image and
+   their addresses can be relocated by the disk cache */
+#define DEF_LIBM_WRAPPER(type, name) \
+    static type local_##name(type x) { return name(x); }
+
+DEF_LIBM_WRAPPER(float32, fabsf)
+DEF_LIBM_WRAPPER(float64, fabs)
+DEF_LIBM_WRAPPER(float32, ceilf)
+DEF_LIBM_WRAPPER(float64, ceil)
+DEF_LIBM_WRAPPER(float32, floorf)
+DEF_LIBM_WRAPPER(float64, floor)
+DEF_LIBM_WRAPPER(float32, truncf)
+DEF_LIBM_WRAPPER(float64, trunc)
+DEF_LIBM_WRAPPER(float32, rintf)
+DEF_LIBM_WRAPPER(float64, rint)
+DEF_LIBM_WRAPPER(float32, sqrtf)
+DEF_LIBM_WRAPPER(float64, sqrt)
+
+#undef DEF_LIBM_WRAPPER
+
+static float32
+local_copysignf(float32 x, float32 y)
+{
+    return copysignf(x, y);
+}
+
+static float64
+local_copysign(float64 x, float64 y)
+{
+    return copysign(x, y);
+}
+
 static bool
 compile_op_float_math(JitCompContext *cc, FloatMath math_op, bool is_f32)
 {
@@ -1469,26 +1502,26 @@ compile_op_float_math(JitCompContext *cc, FloatMath math_op, bool is_f32)
     switch (math_op) {
         case FLOAT_ABS:
             /* TODO: andps 0x7fffffffffffffff */
-            func = is_f32 ? (void *)fabsf : (void *)fabs;
+            func = is_f32 ? (void *)local_fabsf : (void *)local_fabs;
             break;
         case FLOAT_NEG:
             /* TODO: xorps 0x8000000000000000 */
             func = is_f32 ? (void *)negf : (void *)neg;
             break;
         case FLOAT_CEIL:
-            func = is_f32 ? (void *)ceilf : (void *)ceil;
+            func = is_f32 ? (void *)local_ceilf : (void *)local_ceil;
             break;
         case FLOAT_FLOOR:
-            func = is_f32 ? (void *)floorf : (void *)floor;
+            func = is_f32 ? (void *)local_floorf : (void *)local_floor;
             break;
         case FLOAT_TRUNC:
-            func = is_f32 ? (void *)truncf : (void *)trunc;
+            func = is_f32 ? (void *)local_truncf : (void *)local_trunc;
             break;
         case FLOAT_NEAREST:
-            func = is_f32 ? (void *)rintf : (void *)rint;
+            func = is_f32 ? (void *)local_rintf : (void *)local_rint;
             break;
         case FLOAT_SQRT:
-            func = is_f32 ? (void *)sqrtf : (void *)sqrt;
+            func = is_f32 ? (void *)local_sqrtf : (void *)local_sqrt;
             break;
         default:
             bh_assert(0);
@@ -1671,7 +1704,7 @@ jit_compile_op_f32_copysign(JitCompContext *cc)
     POP_F32(args[0]);
 
     res = jit_cc_new_reg_F32(cc);
-    if (!jit_emit_callnative(cc, copysignf, res, args, 2))
+    if (!jit_emit_callnative(cc, local_copysignf, res, args, 2))
         goto fail;
 
     PUSH_F32(res);
@@ -1691,7 +1724,7 @@ jit_compile_op_f64_copysign(JitCompContext *cc)
     POP_F64(args[0]);
 
     res = jit_cc_new_reg_F64(cc);
-    if (!jit_emit_callnative(cc, copysign, res, args, 2))
+    if (!jit_emit_callnative(cc, local_copysign, res, args, 2))
         goto fail;
 
     PUSH_F64(res);
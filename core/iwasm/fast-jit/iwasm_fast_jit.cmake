@@ -7,6 +7,13 @@ add_definitions(-DWASM_ENABLE_FAST_JIT=1)
 if (WAMR_BUILD_FAST_JIT_DUMP EQUAL 1)
     add_definitions(-DWASM_ENABLE_FAST_JIT_DUMP=1)
 endif ()
+if (WAMR_BUILD_FAST_JIT_DISK_CACHE EQUAL 1)
+    add_definitions(-DWASM_ENABLE_FAST_JIT_DISK_CACHE=1)
+endif ()
+
+if (WAMR_BUILD_FAST_JIT_LINEAR_SCAN EQUAL 1)
+    add_definitions(-DWASM_ENABLE_FAST_JIT_LINEAR_SCAN=1)
+endif ()
 
 include_directories (${IWASM_FAST_JIT_DIR})
 
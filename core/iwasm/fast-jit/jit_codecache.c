@@ -6,11 +6,57 @@
 #include "jit_codecache.h"
 #include "mem_alloc.h"
 #include "jit_compiler.h"
+#include "../common/wasm_exec_env.h"
+
+/* The header of each block allocated from the code cache, the jitted
+   code of functions is linked in the order of compilation, so that the
+   oldest code is evicted first when the code cache is full */
+typedef struct JitCodeBlock {
+    struct JitCodeBlock *prev;
+    struct JitCodeBlock *next;
+    /* The module of the function, NULL if the block isn't the jitted
+       code of a function or the function has been evicted */
+    WASMModule *module;
+    uint32 func_idx;
+    /* Size of the block, including the header */
+    uint32 size;
+    /* The code cache epoch when the block was evicted */
+    uint64 retired_epoch;
+} JitCodeBlock;
+
+/* Keep the code following the header 8-byte aligned */
+#define CODE_BLOCK_HEADER_SIZE (((uint32)sizeof(JitCodeBlock) + 7) & ~7U)
+
+#define CODE_BLOCK_OF(code) \
+    ((JitCodeBlock *)((uint8 *)(code)-CODE_BLOCK_HEADER_SIZE))
 
 static void *code_cache_pool = NULL;
 static uint32 code_cache_pool_size = 0;
 static mem_allocator_t code_cache_pool_allocator = NULL;
 
+/* Lock for the lists and the statistics below */
+static korp_mutex code_cache_lock;
+
+/* The jitted code of functions, from the oldest to the newest */
+static JitCodeBlock *jitted_code_list_head = NULL;
+static JitCodeBlock *jitted_code_list_tail = NULL;
+static uint32 jitted_func_count = 0;
+static uint32 jitted_code_size = 0;
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+/* The evicted code which may be still running in some thread */
+static JitCodeBlock *retired_code_list = NULL;
+static uint32 retired_code_size = 0;
+static uint32 evicted_func_count = 0;
+/* Increased each time jitted code is evicted. A thread entering the
+   jitted code records the current epoch, and it can only reference the
+   code evicted at or after that epoch, since the code evicted earlier
+   had been unlinked from the func ptrs before. */
+static uint64 code_cache_epoch = 0;
+/* The threads running jitted code */
+static WASMExecEnv *pinned_exec_env_list = NULL;
+#endif
+
 bool
 jit_code_cache_init(uint32 code_cache_size)
 {
@@ -24,42 +70,341 @@ jit_code_cache_init(uint32 code_cache_size)
 
     if (!(code_cache_pool_allocator =
               mem_allocator_create(code_cache_pool, code_cache_size))) {
-        os_munmap(code_cache_pool, code_cache_size);
-        code_cache_pool = NULL;
-        return false;
+        goto fail1;
     }
 
+    if (os_mutex_init(&code_cache_lock) != 0)
+        goto fail2;
+
     code_cache_pool_size = code_cache_size;
     return true;
+
+fail2:
+    mem_allocator_destroy(code_cache_pool_allocator);
+    code_cache_pool_allocator = NULL;
+fail1:
+    os_munmap(code_cache_pool, code_cache_size);
+    code_cache_pool = NULL;
+    return false;
 }
 
 void
 jit_code_cache_destroy()
 {
+    os_mutex_destroy(&code_cache_lock);
     mem_allocator_destroy(code_cache_pool_allocator);
     os_munmap(code_cache_pool, code_cache_pool_size);
+
+    jitted_code_list_head = jitted_code_list_tail = NULL;
+    jitted_func_count = jitted_code_size = 0;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    retired_code_list = NULL;
+    retired_code_size = evicted_func_count = 0;
+    code_cache_epoch = 0;
+    pinned_exec_env_list = NULL;
+#endif
+}
+
+static void
+link_code_block(JitCodeBlock *block, WASMModule *module, uint32 func_idx)
+{
+    block->module = module;
+    block->func_idx = func_idx;
+    block->prev = jitted_code_list_tail;
+    block->next = NULL;
+    if (jitted_code_list_tail)
+        jitted_code_list_tail->next = block;
+    else
+        jitted_code_list_head = block;
+    jitted_code_list_tail = block;
+
+    jitted_func_count++;
+    jitted_code_size += block->size;
+    module->fast_jit_code_size += block->size;
+}
+
+static void
+unlink_code_block(JitCodeBlock *block)
+{
+    if (block->prev)
+        block->prev->next = block->next;
+    else
+        jitted_code_list_head = block->next;
+    if (block->next)
+        block->next->prev = block->prev;
+    else
+        jitted_code_list_tail = block->prev;
+
+    jitted_func_count--;
+    jitted_code_size -= block->size;
+    block->module->fast_jit_code_size -= block->size;
+    block->module = NULL;
+    block->prev = block->next = NULL;
+}
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+/* Free the evicted code which no running thread may reference, i.e.
+   which was evicted before all the running threads entered the jitted
+   code, return the size freed */
+static uint32
+free_retired_code()
+{
+    JitCodeBlock *block, **p_block = &retired_code_list;
+    WASMExecEnv *exec_env;
+    uint64 min_epoch = UINT64_MAX;
+    uint32 freed_size = 0;
+
+    for (exec_env = pinned_exec_env_list; exec_env;
+         exec_env = exec_env->jit_code_cache_next) {
+        if (exec_env->jit_code_cache_epoch < min_epoch)
+            min_epoch = exec_env->jit_code_cache_epoch;
+    }
+
+    while ((block = *p_block)) {
+        if (block->retired_epoch < min_epoch) {
+            *p_block = block->next;
+            freed_size += block->size;
+            mem_allocator_free(code_cache_pool_allocator, block);
+        }
+        else {
+            p_block = &block->next;
+        }
+    }
+
+    retired_code_size -= freed_size;
+    return freed_size;
+}
+
+/* Evict the oldest jitted code back to the interpreter until at least
+   size bytes are retired, return false if nothing can be evicted */
+static bool
+evict_jitted_code(uint32 size)
+{
+    JitGlobals *jit_globals = jit_compiler_get_jit_globals();
+    JitCodeBlock *block = jitted_code_list_head, *next;
+    WASMModule *module;
+    WASMFunction *func;
+    uint32 jit_func_idx, evicted_size = 0;
+
+    while (block && evicted_size < size) {
+        next = block->next;
+        module = block->module;
+        jit_func_idx = block->func_idx - module->import_function_count;
+        func = module->functions[jit_func_idx];
+
+        /* The later calls go to the interpreter, and the function may
+           be compiled again after it becomes hot again */
+        module->fast_jit_func_ptrs[jit_func_idx] =
+            jit_globals->call_to_interp_from_jitted;
+        func->fast_jit_jitted_code = NULL;
+        func->hotness = 0;
+
+        unlink_code_block(block);
+        block->retired_epoch = code_cache_epoch;
+        block->next = retired_code_list;
+        retired_code_list = block;
+        retired_code_size += block->size;
+        evicted_size += block->size;
+        evicted_func_count++;
+
+        LOG_VERBOSE("JIT: evict function %u from code cache\n",
+                    block->func_idx);
+        block = next;
+    }
+
+    if (evicted_size == 0)
+        return false;
+
+    code_cache_epoch++;
+    return true;
 }
+#endif
 
 void *
 jit_code_cache_alloc(uint32 size)
 {
-    return mem_allocator_malloc(code_cache_pool_allocator, size);
+    uint32 total_size = CODE_BLOCK_HEADER_SIZE + size;
+    JitCodeBlock *block;
+
+    if (total_size < size)
+        return NULL;
+
+    os_mutex_lock(&code_cache_lock);
+    block = mem_allocator_malloc(code_cache_pool_allocator, total_size);
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    while (!block) {
+        if (retired_code_size < total_size
+            && !evict_jitted_code(total_size - retired_code_size))
+            break;
+        /* The evicted code still referenced by some threads is freed
+           after they leave the jitted code */
+        if (!free_retired_code())
+            break;
+        block = mem_allocator_malloc(code_cache_pool_allocator, total_size);
+    }
+#endif
+    os_mutex_unlock(&code_cache_lock);
+
+    if (!block)
+        return NULL;
+
+    memset(block, 0, sizeof(JitCodeBlock));
+    block->size = total_size;
+    return (uint8 *)block + CODE_BLOCK_HEADER_SIZE;
 }
 
 void
 jit_code_cache_free(void *ptr)
 {
-    if (ptr)
-        mem_allocator_free(code_cache_pool_allocator, ptr);
+    JitCodeBlock *block;
+
+    if (ptr) {
+        block = CODE_BLOCK_OF(ptr);
+        os_mutex_lock(&code_cache_lock);
+        if (block->module)
+            unlink_code_block(block);
+        mem_allocator_free(code_cache_pool_allocator, block);
+        os_mutex_unlock(&code_cache_lock);
+    }
+}
+
+void
+jit_code_cache_free_module(WASMModule *module)
+{
+    JitCodeBlock *block, *next;
+
+    os_mutex_lock(&code_cache_lock);
+    block = jitted_code_list_head;
+    while (block) {
+        next = block->next;
+        if (block->module == module) {
+            module->functions[block->func_idx - module->import_function_count]
+                ->fast_jit_jitted_code = NULL;
+            unlink_code_block(block);
+            mem_allocator_free(code_cache_pool_allocator, block);
+        }
+        block = next;
+    }
+    os_mutex_unlock(&code_cache_lock);
+}
+
+void
+jit_code_cache_get_info(fast_jit_code_cache_info_t *info)
+{
+    mem_alloc_info_t mem_alloc_info;
+
+    memset(info, 0, sizeof(fast_jit_code_cache_info_t));
+
+    os_mutex_lock(&code_cache_lock);
+    mem_allocator_get_alloc_info(code_cache_pool_allocator, &mem_alloc_info);
+    info->total_size = code_cache_pool_size;
+    info->total_free_size = mem_alloc_info.total_free_size;
+    info->max_free_size =
+        mem_allocator_get_max_free_size(code_cache_pool_allocator);
+    if (info->max_free_size > info->total_free_size)
+        info->max_free_size = info->total_free_size;
+    if (info->total_free_size > 0)
+        info->fragmentation =
+            100
+            - (uint32)((uint64)info->max_free_size * 100
+                       / info->total_free_size);
+    info->jitted_func_count = jitted_func_count;
+    info->jitted_code_size = jitted_code_size;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    info->evicted_func_count = evicted_func_count;
+    info->retired_code_size = retired_code_size;
+#endif
+    os_mutex_unlock(&code_cache_lock);
+}
+
+uint32
+jit_code_cache_get_module_code_size(WASMModule *module)
+{
+    uint32 size;
+
+    os_mutex_lock(&code_cache_lock);
+    size = module->fast_jit_code_size;
+    os_mutex_unlock(&code_cache_lock);
+    return size;
+}
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+uint32
+jit_code_cache_pin(WASMExecEnv *exec_env)
+{
+    uint32 depth = exec_env->jit_code_cache_pins;
+
+    /* Only the outermost call into the jitted code is recorded, the
+       nested calls can't reference the code evicted before it */
+    if (depth == 0) {
+        os_mutex_lock(&code_cache_lock);
+        exec_env->jit_code_cache_epoch = code_cache_epoch;
+        exec_env->jit_code_cache_prev = NULL;
+        exec_env->jit_code_cache_next = pinned_exec_env_list;
+        if (pinned_exec_env_list)
+            pinned_exec_env_list->jit_code_cache_prev = exec_env;
+        pinned_exec_env_list = exec_env;
+        os_mutex_unlock(&code_cache_lock);
+    }
+    exec_env->jit_code_cache_pins++;
+    return depth;
+}
+
+void
+jit_code_cache_unpin(WASMExecEnv *exec_env, uint32 depth)
+{
+    if (exec_env->jit_code_cache_pins <= depth)
+        return;
+
+    exec_env->jit_code_cache_pins = depth;
+    if (depth > 0)
+        return;
+
+    /* The thread has left the jitted code */
+    os_mutex_lock(&code_cache_lock);
+    if (exec_env->jit_code_cache_prev)
+        exec_env->jit_code_cache_prev->jit_code_cache_next =
+            exec_env->jit_code_cache_next;
+    else
+        pinned_exec_env_list = exec_env->jit_code_cache_next;
+    if (exec_env->jit_code_cache_next)
+        exec_env->jit_code_cache_next->jit_code_cache_prev =
+            exec_env->jit_code_cache_prev;
+    exec_env->jit_code_cache_prev = exec_env->jit_code_cache_next = NULL;
+    if (retired_code_list)
+        free_retired_code();
+    os_mutex_unlock(&code_cache_lock);
 }
 
+bool
+jit_code_cache_reclaim_pending()
+{
+    bool ret;
+
+    os_mutex_lock(&code_cache_lock);
+    ret = retired_code_list != NULL;
+    os_mutex_unlock(&code_cache_lock);
+    return ret;
+}
+#endif
+
 bool
 jit_pass_register_jitted_code(JitCompContext *cc)
 {
     uint32 jit_func_idx =
         cc->cur_wasm_func_idx - cc->cur_wasm_module->import_function_count;
+
+    os_mutex_lock(&code_cache_lock);
+    link_code_block(CODE_BLOCK_OF(cc->jitted_addr_begin),
+                    cc->cur_wasm_module, cc->cur_wasm_func_idx);
     cc->cur_wasm_func->fast_jit_jitted_code = cc->jitted_addr_begin;
-    cc->cur_wasm_module->fast_jit_func_ptrs[jit_func_idx] =
-        cc->jitted_addr_begin;
+#if WASM_ENABLE_JIT != 0
+    /* Keep calling the LLVM jitted code if it is ready */
+    if (!cc->cur_wasm_module->func_ptrs_compiled
+        || !cc->cur_wasm_module->func_ptrs_compiled[jit_func_idx])
+#endif
+        cc->cur_wasm_module->fast_jit_func_ptrs[jit_func_idx] =
+            cc->jitted_addr_begin;
+    os_mutex_unlock(&code_cache_lock);
     return true;
 }
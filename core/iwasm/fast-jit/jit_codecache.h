@@ -7,11 +7,15 @@
 #define _JIT_CODE_CACHE_H_
 
 #include "bh_platform.h"
+#include "wasm_export.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct WASMModule;
+struct WASMExecEnv;
+
 bool
 jit_code_cache_init(uint32 code_cache_size);
 
@@ -24,6 +28,70 @@ jit_code_cache_alloc(uint32 size);
 void
 jit_code_cache_free(void *ptr);
 
+/**
+ * Free the jitted code of all the functions of a module, called when
+ * the module is unloaded.
+ *
+ * @param module the module to free the jitted code
+ */
+void
+jit_code_cache_free_module(struct WASMModule *module);
+
+/**
+ * Get the occupancy and fragmentation info of the code cache.
+ *
+ * @param info [out] the code cache info
+ */
+void
+jit_code_cache_get_info(fast_jit_code_cache_info_t *info);
+
+/**
+ * Get the total size of the jitted code of a module in the code cache.
+ *
+ * @param module the module to query
+ *
+ * @return the size of the jitted code
+ */
+uint32
+jit_code_cache_get_module_code_size(struct WASMModule *module);
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+/**
+ * Pin the jitted code before calling into it from the interpreter, the
+ * code evicted from the code cache is only freed after all the threads
+ * which were running jitted code when it was evicted leave the jitted
+ * code.
+ *
+ * @param exec_env the execution environment of the current thread
+ *
+ * @return the pin depth before pinning, to be passed to
+ *         jit_code_cache_unpin
+ */
+uint32
+jit_code_cache_pin(struct WASMExecEnv *exec_env);
+
+/**
+ * Release the pins of the current thread until its pin depth drops to
+ * the given depth, and free the evicted code which is no longer
+ * referenced if the thread leaves the jitted code.
+ *
+ * @param exec_env the execution environment of the current thread
+ * @param depth the pin depth to restore
+ */
+void
+jit_code_cache_unpin(struct WASMExecEnv *exec_env, uint32 depth);
+
+/**
+ * Check whether there is evicted code waiting to be freed, the
+ * compilation failed due to lack of code cache space may succeed
+ * after it is freed.
+ *
+ * @return true if there is evicted code not freed, false otherwise
+ */
+bool
+jit_code_cache_reclaim_pending();
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
 
 #include "jit_compiler.h"
 #include "jit_codegen.h"
+#include "jit_disk_cache.h"
 
 bool
 jit_pass_lower_cg(JitCompContext *cc)
@@ -18,5 +19,13 @@ jit_pass_codegen(JitCompContext *cc)
     if (!jit_annl_enable_jitted_addr(cc))
         return false;
 
-    return jit_codegen_gen_native(cc);
+    if (!jit_codegen_gen_native(cc))
+        return false;
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    /* Save the code before it is registered, after which it may be
+       evicted from the code cache by other threads */
+    jit_disk_cache_save(cc);
+#endif
+    return true;
 }
@@ -7,6 +7,7 @@
 #include "jit_ir.h"
 #include "jit_codegen.h"
 #include "jit_codecache.h"
+#include "jit_disk_cache.h"
 #include "../interpreter/wasm.h"
 
 typedef struct JitCompilerPass {
@@ -26,7 +27,14 @@ static JitCompilerPass compiler_passes[] = {
     REG_PASS(lower_cg),
     REG_PASS(regalloc),
     REG_PASS(codegen),
-    REG_PASS(register_jitted_code)
+    REG_PASS(register_jitted_code),
+    REG_PASS(const_fold),
+    REG_PASS(cse),
+    REG_PASS(dce),
+    REG_PASS(bound_check_elim),
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    REG_PASS(regalloc_linear_scan),
+#endif
 #undef REG_PASS
 };
 
@@ -37,11 +45,38 @@ static JitCompilerPass compiler_passes[] = {
 static const uint8 compiler_passes_without_dump[] = {
     3, 4, 5, 6, 7, 0
 };
+
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+static const uint8 compiler_passes_linear_scan_without_dump[] = {
+    3, 4, 12, 6, 7, 0
+};
+#endif
 #else
 static const uint8 compiler_passes_with_dump[] = {
     3, 2, 1, 4, 1, 5, 1, 6, 1, 7, 0
 };
+
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+static const uint8 compiler_passes_linear_scan_with_dump[] = {
+    3, 2, 1, 4, 1, 12, 1, 6, 1, 7, 0
+};
 #endif
+#endif
+
+/* The optional optimization passes and the order they are applied in
+   after the frontend pass */
+static const struct {
+    uint32 flag;
+    uint8 pass_no;
+} opt_passes[] = {
+    { FAST_JIT_OPT_CONST_FOLD, 8 },
+    { FAST_JIT_OPT_CSE, 9 },
+    { FAST_JIT_OPT_BOUND_CHECK_ELIM, 11 },
+    { FAST_JIT_OPT_DCE, 10 },
+};
+
+/* The pass sequence with the enabled optimization passes inserted */
+static uint8 compiler_passes_with_opt[24];
 
 /* The exported global data of JIT compiler.  */
 static JitGlobals jit_globals = {
@@ -50,21 +85,88 @@ static JitGlobals jit_globals = {
 #else
     .passes = compiler_passes_with_dump,
 #endif
-    .return_to_interp_from_jitted = NULL
+    .return_to_interp_from_jitted = NULL,
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+    .call_to_interp_from_jitted = NULL,
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    .tier_up_threshold = FAST_JIT_DEFAULT_TIER_UP_THRESHOLD,
+#endif
+    .linear_scan_regalloc = false,
+    .opt_passes = 0,
 };
 /* clang-format on */
 
+/* Statistics of each compiler pass */
+static struct {
+    uint32 run_count;
+    uint64 total_time_us;
+    uint64 change_count;
+} pass_stats[COMPILER_PASS_NUM];
+/* Lock for the statistics which are updated by the compilation threads */
+static korp_mutex pass_stats_lock;
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+/* Serialize the compilations triggered by the hot functions */
+static korp_mutex tier_up_lock;
+#endif
+
+/* A function to be compiled by the compilation threads */
+typedef struct JitCompileTask {
+    struct JitCompileTask *next;
+    WASMModule *module;
+    uint32 func_idx;
+    /* The batch the function belongs to if the loader waits for it,
+       NULL if it is a hot function in tier-up mode */
+    struct JitCompileBatch *batch;
+} JitCompileTask;
+
+/* The functions compiled when loading a module */
+typedef struct JitCompileBatch {
+    uint32 pending_count;
+    bool failed;
+} JitCompileBatch;
+
+/* Number of the compilation threads, 0 if the functions are compiled
+   in the thread which loads the module or runs the hot function */
+static uint32 compile_thread_num = 0;
+static korp_tid compile_threads[FAST_JIT_MAX_COMPILE_THREAD_NUM];
+/* The module of the function being compiled by each thread */
+static WASMModule *compiling_modules[FAST_JIT_MAX_COMPILE_THREAD_NUM];
+static bool compile_threads_exit = false;
+/* Lock for the compile queue and the data above */
+static korp_mutex compile_queue_lock;
+/* Signaled when a task is queued or the threads should exit */
+static korp_cond compile_queue_cond;
+/* Signaled when a task is finished */
+static korp_cond compile_done_cond;
+static JitCompileTask *compile_queue_head = NULL;
+static JitCompileTask *compile_queue_tail = NULL;
+
 static bool
 apply_compiler_passes(JitCompContext *cc)
 {
     const uint8 *p = jit_globals.passes;
+    uint64 begin_time;
+    bool ret;
 
     for (; *p; p++) {
         /* Set the pass NO.  */
         cc->cur_pass_no = p - jit_globals.passes;
         bh_assert(*p < COMPILER_PASS_NUM);
 
-        if (!compiler_passes[*p].run(cc) || jit_get_last_error(cc)) {
+        cc->pass_change_count = 0;
+        begin_time = os_time_get_boot_microsecond();
+        ret = compiler_passes[*p].run(cc) && !jit_get_last_error(cc);
+
+        os_mutex_lock(&pass_stats_lock);
+        pass_stats[*p].run_count++;
+        pass_stats[*p].total_time_us +=
+            os_time_get_boot_microsecond() - begin_time;
+        pass_stats[*p].change_count += cc->pass_change_count;
+        os_mutex_unlock(&pass_stats_lock);
+
+        if (!ret) {
             LOG_VERBOSE("JIT: compilation failed at pass[%td] = %s\n",
                         p - jit_globals.passes, compiler_passes[*p].name);
             return false;
@@ -74,6 +176,250 @@ apply_compiler_passes(JitCompContext *cc)
     return true;
 }
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+static WASMFunction *
+get_hot_function(WASMModule *module, uint32 func_idx)
+{
+    return module->functions[func_idx - module->import_function_count];
+}
+
+/* Compile a hot function which is run by the interpreter, the caller
+   has set its tier_up_queued flag and clears it after the call */
+static bool
+compile_hot_function(WASMModule *module, uint32 func_idx)
+{
+    WASMFunction *func = get_hot_function(module, func_idx);
+    bool ret = true;
+
+    /* The function may have been compiled by another thread */
+    if (!func->fast_jit_jitted_code) {
+        LOG_VERBOSE("JIT: tier up function %u, hotness: %u\n", func_idx,
+                    func->hotness);
+        ret = jit_compiler_compile(module, func_idx);
+        if (!ret) {
+            /* The code cache may be full of the evicted code which is
+               still running, retry after the function becomes hot
+               again, otherwise don't try to compile it any more */
+            if (jit_code_cache_reclaim_pending())
+                func->hotness = 0;
+            else
+                func->tier_up_failed = true;
+        }
+    }
+
+    return ret;
+}
+#endif
+
+static void *
+compile_thread_callback(void *arg)
+{
+    uint32 thread_idx = (uint32)(uintptr_t)arg;
+    JitCompileTask *task;
+    bool ret;
+
+    os_mutex_lock(&compile_queue_lock);
+    while (true) {
+        while (!compile_queue_head && !compile_threads_exit)
+            os_cond_wait(&compile_queue_cond, &compile_queue_lock);
+        if (compile_threads_exit)
+            break;
+
+        task = compile_queue_head;
+        compile_queue_head = task->next;
+        if (!compile_queue_head)
+            compile_queue_tail = NULL;
+        compiling_modules[thread_idx] = task->module;
+        os_mutex_unlock(&compile_queue_lock);
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+        if (!task->batch)
+            ret = compile_hot_function(task->module, task->func_idx);
+        else
+#endif
+            ret = jit_compiler_compile(task->module, task->func_idx);
+
+        os_mutex_lock(&compile_queue_lock);
+        compiling_modules[thread_idx] = NULL;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+        if (!task->batch)
+            get_hot_function(task->module, task->func_idx)->tier_up_queued =
+                false;
+#endif
+        if (task->batch) {
+            task->batch->pending_count--;
+            if (!ret)
+                task->batch->failed = true;
+        }
+        os_cond_broadcast(&compile_done_cond);
+        jit_free(task);
+    }
+    os_mutex_unlock(&compile_queue_lock);
+
+    return NULL;
+}
+
+/* Queue a function to be compiled, compile_queue_lock must be held */
+static bool
+push_compile_task(WASMModule *module, uint32 func_idx, JitCompileBatch *batch)
+{
+    JitCompileTask *task;
+
+    if (!(task = jit_calloc(sizeof(JitCompileTask))))
+        return false;
+
+    task->module = module;
+    task->func_idx = func_idx;
+    task->batch = batch;
+    if (compile_queue_tail)
+        compile_queue_tail->next = task;
+    else
+        compile_queue_head = task;
+    compile_queue_tail = task;
+
+    os_cond_signal(&compile_queue_cond);
+    return true;
+}
+
+static void
+destroy_compile_threads()
+{
+    JitCompileTask *task, *next;
+    uint32 i;
+
+    os_mutex_lock(&compile_queue_lock);
+    compile_threads_exit = true;
+    os_cond_broadcast(&compile_queue_cond);
+    os_mutex_unlock(&compile_queue_lock);
+
+    for (i = 0; i < compile_thread_num; i++)
+        os_thread_join(compile_threads[i], NULL);
+
+    for (task = compile_queue_head; task; task = next) {
+        next = task->next;
+        jit_free(task);
+    }
+    compile_queue_head = compile_queue_tail = NULL;
+
+    os_cond_destroy(&compile_done_cond);
+    os_cond_destroy(&compile_queue_cond);
+    os_mutex_destroy(&compile_queue_lock);
+    compile_thread_num = 0;
+    compile_threads_exit = false;
+}
+
+static bool
+create_compile_threads(uint32 thread_num)
+{
+    if (thread_num > FAST_JIT_MAX_COMPILE_THREAD_NUM)
+        thread_num = FAST_JIT_MAX_COMPILE_THREAD_NUM;
+
+    if (os_mutex_init(&compile_queue_lock) != 0)
+        return false;
+    if (os_cond_init(&compile_queue_cond) != 0)
+        goto fail1;
+    if (os_cond_init(&compile_done_cond) != 0)
+        goto fail2;
+
+    for (compile_thread_num = 0; compile_thread_num < thread_num;
+         compile_thread_num++) {
+        if (os_thread_create(&compile_threads[compile_thread_num],
+                             compile_thread_callback,
+                             (void *)(uintptr_t)compile_thread_num,
+                             APP_THREAD_STACK_SIZE_DEFAULT)
+            != 0) {
+            /* Destroy the created threads and the lock and conds */
+            destroy_compile_threads();
+            return false;
+        }
+    }
+
+    LOG_VERBOSE("JIT: %u compilation threads created\n", compile_thread_num);
+    return true;
+
+fail2:
+    os_cond_destroy(&compile_queue_cond);
+fail1:
+    os_mutex_destroy(&compile_queue_lock);
+    return false;
+}
+
+static bool
+is_module_compiling(WASMModule *module)
+{
+    uint32 i;
+
+    for (i = 0; i < compile_thread_num; i++) {
+        if (compiling_modules[i] == module)
+            return true;
+    }
+    return false;
+}
+
+void
+jit_compiler_cancel_compilation(WASMModule *module)
+{
+    JitCompileTask *task, *prev = NULL, *next;
+
+    if (compile_thread_num == 0)
+        return;
+
+    os_mutex_lock(&compile_queue_lock);
+    for (task = compile_queue_head; task; task = next) {
+        next = task->next;
+        if (task->module == module) {
+            if (prev)
+                prev->next = next;
+            else
+                compile_queue_head = next;
+            if (compile_queue_tail == task)
+                compile_queue_tail = prev;
+            jit_free(task);
+        }
+        else {
+            prev = task;
+        }
+    }
+    while (is_module_compiling(module))
+        os_cond_wait(&compile_done_cond, &compile_queue_lock);
+    os_mutex_unlock(&compile_queue_lock);
+}
+
+/**
+ * Insert the enabled optimization passes after the frontend pass (and
+ * the dump of its result) into the current pass sequence.
+ */
+static void
+insert_opt_passes(uint32 flags)
+{
+    const uint8 *p = jit_globals.passes;
+    uint8 *q = compiler_passes_with_opt;
+    uint32 i;
+
+    /* frontend */
+    *q++ = *p++;
+#if WASM_ENABLE_FAST_JIT_DUMP != 0
+    /* update_cfg and dump */
+    *q++ = *p++;
+    *q++ = *p++;
+#endif
+
+    for (i = 0; i < sizeof(opt_passes) / sizeof(opt_passes[0]); i++) {
+        if (flags & opt_passes[i].flag) {
+            *q++ = opt_passes[i].pass_no;
+#if WASM_ENABLE_FAST_JIT_DUMP != 0
+            *q++ = 1;
+#endif
+        }
+    }
+
+    while ((*q++ = *p++))
+        ;
+    bh_assert(q <= compiler_passes_with_opt + sizeof(compiler_passes_with_opt));
+
+    jit_globals.passes = compiler_passes_with_opt;
+}
+
 bool
 jit_compiler_init(const JitCompOptions *options)
 {
@@ -90,8 +436,75 @@ jit_compiler_init(const JitCompOptions *options)
     if (!jit_codegen_init())
         goto fail1;
 
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    if (options->linear_scan_regalloc) {
+        jit_globals.linear_scan_regalloc = true;
+#if WASM_ENABLE_FAST_JIT_DUMP == 0
+        jit_globals.passes = compiler_passes_linear_scan_without_dump;
+#else
+        jit_globals.passes = compiler_passes_linear_scan_with_dump;
+#endif
+        LOG_VERBOSE("JIT: use linear scan register allocator\n");
+    }
+    else {
+        /* Reset the sequence which may have been changed by the last
+           initialization */
+        jit_globals.linear_scan_regalloc = false;
+#if WASM_ENABLE_FAST_JIT_DUMP == 0
+        jit_globals.passes = compiler_passes_without_dump;
+#else
+        jit_globals.passes = compiler_passes_with_dump;
+#endif
+    }
+#else
+    if (options->linear_scan_regalloc)
+        LOG_WARNING("JIT: linear scan register allocator isn't enabled in "
+                    "this build, ignore it\n");
+#endif
+
+    jit_globals.opt_passes = options->opt_passes & FAST_JIT_OPT_ALL;
+    if (jit_globals.opt_passes) {
+        insert_opt_passes(jit_globals.opt_passes);
+        LOG_VERBOSE("JIT: optimization passes: 0x%x\n", jit_globals.opt_passes);
+    }
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    if (options->tier_up_threshold > 0)
+        jit_globals.tier_up_threshold = options->tier_up_threshold;
+
+    LOG_VERBOSE("JIT: tier-up threshold: %u\n", jit_globals.tier_up_threshold);
+
+    if (os_mutex_init(&tier_up_lock) != 0)
+        goto fail2;
+#endif
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    if (!jit_disk_cache_init(options->disk_cache_dir))
+        goto fail3;
+#endif
+
+    memset(pass_stats, 0, sizeof(pass_stats));
+    if (os_mutex_init(&pass_stats_lock) != 0)
+        goto fail4;
+
+    if (options->compile_thread_num > 0
+        && !create_compile_threads(options->compile_thread_num))
+        goto fail5;
+
     return true;
 
+fail5:
+    os_mutex_destroy(&pass_stats_lock);
+fail4:
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    jit_disk_cache_destroy();
+fail3:
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    os_mutex_destroy(&tier_up_lock);
+fail2:
+#endif
+    jit_codegen_destroy();
 fail1:
     jit_code_cache_destroy();
     return false;
@@ -100,6 +513,19 @@ fail1:
 void
 jit_compiler_destroy()
 {
+    if (compile_thread_num > 0)
+        destroy_compile_threads();
+
+    os_mutex_destroy(&pass_stats_lock);
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    jit_disk_cache_destroy();
+#endif
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    os_mutex_destroy(&tier_up_lock);
+#endif
+
     jit_codegen_destroy();
 
     jit_code_cache_destroy();
@@ -117,6 +543,27 @@ jit_compiler_get_pass_name(unsigned i)
     return i < COMPILER_PASS_NUM ? compiler_passes[i].name : NULL;
 }
 
+uint32
+jit_compiler_get_pass_stats(fast_jit_pass_stats_t *stats, uint32 count)
+{
+    uint32 i;
+
+    if (!stats)
+        return COMPILER_PASS_NUM - 1;
+
+    os_mutex_lock(&pass_stats_lock);
+    /* Skip the NULL pass */
+    for (i = 0; i < COMPILER_PASS_NUM - 1 && i < count; i++) {
+        stats[i].name = compiler_passes[i + 1].name;
+        stats[i].run_count = pass_stats[i + 1].run_count;
+        stats[i].total_time_us = pass_stats[i + 1].total_time_us;
+        stats[i].change_count = pass_stats[i + 1].change_count;
+    }
+    os_mutex_unlock(&pass_stats_lock);
+
+    return COMPILER_PASS_NUM - 1;
+}
+
 bool
 jit_compiler_compile(WASMModule *module, uint32 func_idx)
 {
@@ -140,6 +587,17 @@ jit_compiler_compile(WASMModule *module, uint32 func_idx)
     cc->mem_space_unchanged = (!cc->cur_wasm_func->has_op_memory_grow
                                && !cc->cur_wasm_func->has_op_func_call)
                               || (!module->possible_memory_grow);
+    cc->keep_invariant_regs = jit_globals.linear_scan_regalloc;
+    cc->keep_local_regs = jit_globals.linear_scan_regalloc;
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    /* Reuse the code saved by a previous run */
+    if (jit_disk_cache_load(cc)) {
+        jit_pass_register_jitted_code(cc);
+        jit_cc_delete(cc);
+        return true;
+    }
+#endif
 
     /* Apply compiler passes.  */
     if (!apply_compiler_passes(cc) || jit_get_last_error(cc)) {
@@ -158,8 +616,27 @@ jit_compiler_compile(WASMModule *module, uint32 func_idx)
 bool
 jit_compiler_compile_all(WASMModule *module)
 {
+    JitCompileBatch batch = { 0 };
     uint32 i;
 
+    if (compile_thread_num > 0) {
+        /* Compile the functions in the compilation threads in parallel
+           and wait for them to finish */
+        os_mutex_lock(&compile_queue_lock);
+        for (i = 0; i < module->function_count; i++) {
+            if (!push_compile_task(module, module->import_function_count + i,
+                                   &batch)) {
+                batch.failed = true;
+                break;
+            }
+            batch.pending_count++;
+        }
+        while (batch.pending_count > 0)
+            os_cond_wait(&compile_done_cond, &compile_queue_lock);
+        os_mutex_unlock(&compile_queue_lock);
+        return !batch.failed;
+    }
+
     for (i = 0; i < module->function_count; i++) {
         if (!jit_compiler_compile(module, module->import_function_count + i)) {
             return false;
@@ -169,6 +646,49 @@ jit_compiler_compile_all(WASMModule *module)
     return true;
 }
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+bool
+jit_compiler_tier_up(WASMModule *module, uint32 func_idx)
+{
+    WASMFunction *func = get_hot_function(module, func_idx);
+    bool ret = true;
+
+    if (compile_thread_num > 0) {
+        /* Keep running the function in interpreter until the jitted
+           code is published by the compilation thread */
+        os_mutex_lock(&compile_queue_lock);
+        if (!func->tier_up_queued && !func->tier_up_failed
+            && !func->fast_jit_jitted_code) {
+            func->tier_up_queued = true;
+            if (!(ret = push_compile_task(module, func_idx, NULL)))
+                func->tier_up_queued = false;
+        }
+        os_mutex_unlock(&compile_queue_lock);
+        return ret;
+    }
+
+    os_mutex_lock(&tier_up_lock);
+    if (!func->tier_up_queued && !func->tier_up_failed) {
+        func->tier_up_queued = true;
+        ret = compile_hot_function(module, func_idx);
+        func->tier_up_queued = false;
+    }
+    os_mutex_unlock(&tier_up_lock);
+
+    return ret;
+}
+
+void
+jit_compiler_init_func_ptrs(WASMModule *module)
+{
+    uint32 i;
+
+    for (i = 0; i < module->function_count; i++) {
+        module->fast_jit_func_ptrs[i] = jit_globals.call_to_interp_from_jitted;
+    }
+}
+#endif
+
 int
 jit_interp_switch_to_jitted(void *exec_env, JitInterpSwitchInfo *info, void *pc)
 {
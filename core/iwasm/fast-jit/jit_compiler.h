@@ -18,6 +18,20 @@ typedef struct JitGlobals {
     /* Compiler pass sequence, the last element must be 0 */
     const uint8 *passes;
     char *return_to_interp_from_jitted;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+    /* The stub that fast_jit_func_ptrs of not-yet-compiled functions
+       (or functions compiled by LLVM JIT) point to, it calls the
+       function in interpreter (or LLVM jitted code) from jitted code */
+    char *call_to_interp_from_jitted;
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Hotness threshold to trigger the compilation of a function */
+    uint32 tier_up_threshold;
+#endif
+    /* Whether the linear scan register allocator is used */
+    bool linear_scan_regalloc;
+    /* The enabled optional optimization passes, FAST_JIT_OPT_XXX */
+    uint32 opt_passes;
 } JitGlobals;
 
 /**
@@ -67,6 +81,23 @@ typedef struct JitInterpSwitchInfo {
 typedef struct JitCompOptions {
     uint32 code_cache_size;
     uint32 opt_level;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    uint32 tier_up_threshold;
+#endif
+    /* Number of the threads to compile functions in background, 0 means
+       compiling in the thread which loads the module or runs the hot
+       function */
+    uint32 compile_thread_num;
+    /* Use the global linear scan register allocator instead of the
+       basic block local one */
+    bool linear_scan_regalloc;
+    /* Directory to save the jitted code of functions into and load it
+       from, only used when WASM_ENABLE_FAST_JIT_DISK_CACHE is defined,
+       NULL means the disk cache is disabled */
+    const char *disk_cache_dir;
+    /* The optional IR optimization passes to apply, a combination of
+       FAST_JIT_OPT_XXX, 0 means none */
+    uint32 opt_passes;
 } JitCompOptions;
 
 bool
@@ -81,12 +112,60 @@ jit_compiler_get_jit_globals();
 const char *
 jit_compiler_get_pass_name(unsigned i);
 
+/**
+ * Get the statistics of the compiler passes accumulated since the
+ * compiler was initialized.
+ *
+ * @param stats the array to receive the statistics
+ * @param count the number of elements of the array
+ *
+ * @return the number of the compiler passes, which may be larger than
+ *         the count
+ */
+uint32
+jit_compiler_get_pass_stats(fast_jit_pass_stats_t *stats, uint32 count);
+
 bool
 jit_compiler_compile(WASMModule *module, uint32 func_idx);
 
 bool
 jit_compiler_compile_all(WASMModule *module);
 
+/**
+ * Remove the queued compilation tasks of a module and wait for the
+ * compilation threads to finish compiling its functions, called before
+ * the module is unloaded.
+ *
+ * @param module the wasm module
+ */
+void
+jit_compiler_cancel_compilation(WASMModule *module);
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+/**
+ * Compile a hot function which is currently run by the interpreter,
+ * do nothing if it was already compiled by another thread. If there
+ * are compilation threads, the function is queued to be compiled by
+ * them and keeps running in the interpreter until its jitted code is
+ * published.
+ *
+ * @param module the wasm module
+ * @param func_idx the function index, including the imported functions
+ *
+ * @return true if the function has been compiled or queued, false
+ *         otherwise
+ */
+bool
+jit_compiler_tier_up(WASMModule *module, uint32 func_idx);
+
+/**
+ * Initialize the func pointers of Fast JIT of a module to the stub
+ * which calls the function in interpreter.
+ */
+void
+jit_compiler_init_func_ptrs(WASMModule *module);
+#endif
+
 int
 jit_interp_switch_to_jitted(void *self, JitInterpSwitchInfo *info, void *pc);
 
@@ -124,6 +203,45 @@ jit_pass_lower_cg(JitCompContext *cc);
 bool
 jit_pass_regalloc(JitCompContext *cc);
 
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+/**
+ * Register allocation with global linear scan: virtual registers live
+ * across basic blocks are allocated to hard registers for their whole
+ * live intervals, and the others are allocated locally in each basic
+ * block like jit_pass_regalloc.
+ */
+bool
+jit_pass_regalloc_linear_scan(JitCompContext *cc);
+#endif
+
+/**
+ * Fold the instructions whose operands are constants and simplify the
+ * ones with identity operands, e.g. "x + 0".
+ */
+bool
+jit_pass_const_fold(JitCompContext *cc);
+
+/**
+ * Local common subexpression elimination: reuse the result of an
+ * earlier pure instruction in the same basic block.
+ */
+bool
+jit_pass_cse(JitCompContext *cc);
+
+/**
+ * Dead code elimination: remove the pure instructions whose results
+ * are never used.
+ */
+bool
+jit_pass_dce(JitCompContext *cc);
+
+/**
+ * Remove the linear memory bounds checks which are implied by an
+ * earlier check of the same address in the same basic block.
+ */
+bool
+jit_pass_bound_check_elim(JitCompContext *cc);
+
 /**
  * Native code generation.
  */
@@ -0,0 +1,375 @@
+/*
+ * Copyright (C) 2021 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "jit_disk_cache.h"
+#include "jit_compiler.h"
+#include "jit_codegen.h"
+#include "jit_codecache.h"
+#include "../interpreter/wasm.h"
+#include "../interpreter/wasm_interp.h"
+#include "../../version.h"
+
+#include <stdio.h>
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+
+/* "WFJC" in little endian */
+#define DISK_CACHE_MAGIC 0x434a4657
+#define DISK_CACHE_VERSION 1
+
+/* The runtime functions are relocated by their offsets to this one,
+   which doesn't change as long as the runtime isn't rebuilt */
+#define RUNTIME_FUNC_BASE ((uintptr_t)jit_compiler_compile)
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* The header of the file which saves the jitted code of a function,
+   followed by the code and the relocations */
+typedef struct DiskCacheHeader {
+    uint32 magic;
+    uint32 version;
+    uint64 build_id;
+    uint64 module_hash;
+    uint64 module_size;
+    uint32 func_idx;
+    uint32 code_size;
+    uint32 reloc_num;
+    uint32 reserved;
+    /* Hash of the code and the relocations */
+    uint64 checksum;
+} DiskCacheHeader;
+
+typedef struct DiskCacheReloc {
+    uint32 offset;
+    uint32 type;
+    /* Offset of the address to the code begin (JIT_RELOC_CODE) or to
+       RUNTIME_FUNC_BASE (JIT_RELOC_RUNTIME_FUNC) */
+    int64 addend;
+} DiskCacheReloc;
+
+static char *cache_dir = NULL;
+static uint64 build_id = 0;
+
+static uint64
+hash_data(uint64 hash, const void *data, uint32 size)
+{
+    const uint8 *p = (const uint8 *)data, *p_end = p + size;
+
+    /* FNV-1a */
+    while (p < p_end) {
+        hash ^= *p++;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/* The build ID changes when the runtime is rebuilt, so that the code
+   saved by another build isn't loaded */
+static uint64
+compute_build_id()
+{
+    JitGlobals *jit_globals = jit_compiler_get_jit_globals();
+    const char *build_time = __DATE__ " " __TIME__;
+    uint32 config[] = { WAMR_VERSION_MAJOR,
+                        WAMR_VERSION_MINOR,
+                        WAMR_VERSION_PATCH,
+                        (uint32)sizeof(void *),
+                        jit_globals->linear_scan_regalloc,
+                        jit_globals->opt_passes };
+    /* Functions in different object files, whose offsets to the base
+       change when the runtime is built with other code or options */
+    void *funcs[] = { (void *)wasm_runtime_malloc,
+                      (void *)wasm_interp_call_wasm,
+                      (void *)wasm_enlarge_memory,
+                      (void *)jit_set_exception_with_id,
+                      (void *)fast_jit_call_indirect,
+                      (void *)fast_jit_invoke_native,
+                      (void *)jit_codegen_gen_native,
+                      (void *)jit_code_cache_alloc };
+    int64 offset;
+    uint64 hash = FNV_OFFSET_BASIS;
+    uint32 i;
+
+    hash = hash_data(hash, build_time, (uint32)strlen(build_time));
+    hash = hash_data(hash, config, sizeof(config));
+    for (i = 0; i < sizeof(funcs) / sizeof(funcs[0]); i++) {
+        offset = (int64)((uintptr_t)funcs[i] - RUNTIME_FUNC_BASE);
+        hash = hash_data(hash, &offset, sizeof(offset));
+    }
+    return hash;
+}
+
+bool
+jit_disk_cache_init(const char *dir)
+{
+    uint32 size;
+
+    if (!dir)
+        return true;
+
+    size = (uint32)strlen(dir) + 1;
+    if (!(cache_dir = jit_malloc(size)))
+        return false;
+    bh_memcpy_s(cache_dir, size, dir, size);
+
+    build_id = compute_build_id();
+
+    LOG_VERBOSE("JIT: disk cache directory: %s, runtime base: %p\n",
+                cache_dir, (void *)RUNTIME_FUNC_BASE);
+    return true;
+}
+
+void
+jit_disk_cache_destroy()
+{
+    if (cache_dir) {
+        jit_free(cache_dir);
+        cache_dir = NULL;
+    }
+}
+
+void
+jit_disk_cache_init_module(WASMModule *module)
+{
+    uint64 hash;
+
+    if (!cache_dir || !module->load_addr)
+        return;
+
+    hash = hash_data(FNV_OFFSET_BASIS, module->load_addr,
+                     (uint32)module->load_size);
+    /* 0 means the module isn't cached */
+    module->fast_jit_module_hash = hash ? hash : 1;
+}
+
+/* Return the path of the file saving the jitted code of a function,
+   which must be freed by the caller */
+static char *
+get_cache_file_path(WASMModule *module, uint32 func_idx)
+{
+    /* "/" + 16 hex digits + "-" + 8 hex digits + "-" + func_idx + ".fjc" */
+    uint32 size = (uint32)strlen(cache_dir) + 48;
+    char *path;
+
+    if (!(path = jit_malloc(size)))
+        return NULL;
+
+    snprintf(path, size, "%s/%08x%08x-%08x-%u.fjc", cache_dir,
+             (uint32)(module->fast_jit_module_hash >> 32),
+             (uint32)module->fast_jit_module_hash, (uint32)module->load_size,
+             func_idx);
+    return path;
+}
+
+bool
+jit_disk_cache_load(JitCompContext *cc)
+{
+    WASMModule *module = cc->cur_wasm_module;
+    JitGlobals *jit_globals = jit_compiler_get_jit_globals();
+    DiskCacheHeader header;
+    DiskCacheReloc *relocs = NULL;
+    FILE *file;
+    char *path;
+    uint8 *code = NULL;
+    uintptr_t value = 0;
+    uint64 checksum;
+    uint32 i;
+    bool ret = false;
+
+    if (!cache_dir || !module->fast_jit_module_hash)
+        return false;
+
+    if (!(path = get_cache_file_path(module, cc->cur_wasm_func_idx)))
+        return false;
+
+    file = fopen(path, "rb");
+    jit_free(path);
+    if (!file)
+        return false;
+
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || header.magic != DISK_CACHE_MAGIC
+        || header.version != DISK_CACHE_VERSION
+        || header.build_id != build_id
+        || header.module_hash != module->fast_jit_module_hash
+        || header.module_size != module->load_size
+        || header.func_idx != cc->cur_wasm_func_idx || header.code_size == 0
+        || header.reloc_num > header.code_size / sizeof(uintptr_t))
+        goto fail;
+
+    if (header.reloc_num > 0
+        && !(relocs = jit_malloc(sizeof(DiskCacheReloc) * header.reloc_num)))
+        goto fail;
+
+    if (!(code = jit_code_cache_alloc(header.code_size)))
+        goto fail;
+
+    if (fread(code, 1, header.code_size, file) != header.code_size
+        || (header.reloc_num > 0
+            && fread(relocs, sizeof(DiskCacheReloc), header.reloc_num, file)
+                   != header.reloc_num))
+        goto fail;
+
+    checksum = hash_data(FNV_OFFSET_BASIS, code, header.code_size);
+    checksum = hash_data(checksum, relocs,
+                         sizeof(DiskCacheReloc) * header.reloc_num);
+    if (checksum != header.checksum)
+        goto fail;
+
+    for (i = 0; i < header.reloc_num; i++) {
+        if (relocs[i].offset > header.code_size - sizeof(uintptr_t))
+            goto fail;
+
+        switch (relocs[i].type) {
+            case JIT_RELOC_CODE:
+                if (relocs[i].addend < 0
+                    || relocs[i].addend > (int64)header.code_size)
+                    goto fail;
+                value = (uintptr_t)code + (uintptr_t)relocs[i].addend;
+                break;
+            case JIT_RELOC_RUNTIME_FUNC:
+                value = RUNTIME_FUNC_BASE + (uintptr_t)relocs[i].addend;
+                break;
+            case JIT_RELOC_RETURN_TO_INTERP:
+                value = (uintptr_t)jit_globals->return_to_interp_from_jitted;
+                break;
+            default:
+                goto fail;
+        }
+        *(uintptr_t *)(code + relocs[i].offset) = value;
+    }
+
+    cc->jitted_addr_begin = code;
+    cc->jitted_addr_end = code + header.code_size;
+    ret = true;
+
+    LOG_VERBOSE("JIT: load function %u from disk cache\n",
+                cc->cur_wasm_func_idx);
+
+fail:
+    if (!ret && code)
+        jit_code_cache_free(code);
+    if (relocs)
+        jit_free(relocs);
+    fclose(file);
+    return ret;
+}
+
+void
+jit_disk_cache_save(JitCompContext *cc)
+{
+    WASMModule *module = cc->cur_wasm_module;
+    JitGlobals *jit_globals = jit_compiler_get_jit_globals();
+    DiskCacheHeader header = { 0 };
+    DiskCacheReloc *relocs = NULL;
+    JitReloc *reloc;
+    FILE *file = NULL;
+    char *path = NULL, *tmp_path = NULL;
+    uint8 *code_begin = (uint8 *)cc->jitted_addr_begin, *code = NULL;
+    uint32 code_size = (uint32)((uint8 *)cc->jitted_addr_end - code_begin);
+    uint32 tmp_path_size, i;
+    uintptr_t value;
+    bool ret = false;
+
+    if (!cache_dir || !module->fast_jit_module_hash || !cc->relocatable)
+        return;
+
+    if (!(code = jit_malloc(code_size))
+        || (cc->reloc_num > 0
+            && !(relocs = jit_calloc(sizeof(DiskCacheReloc) * cc->reloc_num))))
+        goto fail;
+
+    /* The relocated addresses are cleared so that the saved code
+       doesn't depend on where it was loaded */
+    bh_memcpy_s(code, code_size, code_begin, code_size);
+    for (i = 0; i < cc->reloc_num; i++) {
+        reloc = cc->relocs + i;
+        bh_assert(reloc->offset <= code_size - sizeof(uintptr_t));
+        value = *(uintptr_t *)(code_begin + reloc->offset);
+
+        switch (reloc->type) {
+            case JIT_RELOC_CODE:
+                if (value < (uintptr_t)code_begin
+                    || value > (uintptr_t)code_begin + code_size)
+                    goto fail;
+                relocs[i].addend = (int64)(value - (uintptr_t)code_begin);
+                break;
+            case JIT_RELOC_RUNTIME_FUNC:
+                relocs[i].addend = (int64)(value - RUNTIME_FUNC_BASE);
+                break;
+            case JIT_RELOC_RETURN_TO_INTERP:
+                if (value
+                    != (uintptr_t)jit_globals->return_to_interp_from_jitted)
+                    goto fail;
+                break;
+            default:
+                bh_assert(0);
+                goto fail;
+        }
+        relocs[i].offset = reloc->offset;
+        relocs[i].type = reloc->type;
+        memset(code + reloc->offset, 0, sizeof(uintptr_t));
+    }
+
+    header.magic = DISK_CACHE_MAGIC;
+    header.version = DISK_CACHE_VERSION;
+    header.build_id = build_id;
+    header.module_hash = module->fast_jit_module_hash;
+    header.module_size = module->load_size;
+    header.func_idx = cc->cur_wasm_func_idx;
+    header.code_size = code_size;
+    header.reloc_num = cc->reloc_num;
+    header.checksum = hash_data(FNV_OFFSET_BASIS, code, code_size);
+    header.checksum = hash_data(header.checksum, relocs,
+                                sizeof(DiskCacheReloc) * cc->reloc_num);
+
+    if (!(path = get_cache_file_path(module, cc->cur_wasm_func_idx)))
+        goto fail;
+
+    /* Write a temporary file and rename it, so that other threads or
+       processes never read a partially written file */
+    tmp_path_size = (uint32)strlen(path) + 32;
+    if (!(tmp_path = jit_malloc(tmp_path_size)))
+        goto fail;
+    snprintf(tmp_path, tmp_path_size, "%s.%p.tmp", path, (void *)cc);
+
+    if (!(file = fopen(tmp_path, "wb")))
+        goto fail;
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1
+        || fwrite(code, 1, code_size, file) != code_size
+        || (cc->reloc_num > 0
+            && fwrite(relocs, sizeof(DiskCacheReloc), cc->reloc_num, file)
+                   != cc->reloc_num)) {
+        fclose(file);
+        remove(tmp_path);
+        goto fail;
+    }
+
+    if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        goto fail;
+    }
+
+    ret = true;
+    LOG_VERBOSE("JIT: save function %u into disk cache\n",
+                cc->cur_wasm_func_idx);
+
+fail:
+    if (!ret)
+        LOG_VERBOSE("JIT: failed to save function %u into disk cache\n",
+                    cc->cur_wasm_func_idx);
+    if (tmp_path)
+        jit_free(tmp_path);
+    if (path)
+        jit_free(path);
+    if (relocs)
+        jit_free(relocs);
+    if (code)
+        jit_free(code);
+}
+
+#endif /* end of WASM_ENABLE_FAST_JIT_DISK_CACHE != 0 */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2021 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _JIT_DISK_CACHE_H_
+#define _JIT_DISK_CACHE_H_
+
+#include "bh_platform.h"
+#include "jit_ir.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+struct WASMModule;
+
+/**
+ * Initialize the disk cache.
+ *
+ * @param cache_dir the directory to save the jitted code into, which
+ *        must exist, NULL to disable the disk cache
+ *
+ * @return true if succeeded, false otherwise
+ */
+bool
+jit_disk_cache_init(const char *cache_dir);
+
+void
+jit_disk_cache_destroy();
+
+/**
+ * Compute the hash of the module content which identifies the module
+ * in the disk cache, called after the module is loaded.
+ *
+ * @param module the wasm module
+ */
+void
+jit_disk_cache_init_module(struct WASMModule *module);
+
+/**
+ * Load the jitted code of the function being compiled from the disk
+ * cache into the code cache, and relocate it.
+ *
+ * @param cc the compilation context, the jitted code is returned in
+ *        cc->jitted_addr_begin and cc->jitted_addr_end
+ *
+ * @return true if the code is loaded, false if the function isn't
+ *         cached or the cached code is invalid
+ */
+bool
+jit_disk_cache_load(JitCompContext *cc);
+
+/**
+ * Save the jitted code of the function just generated by the pass
+ * codegen into the disk cache, do nothing if the code isn't
+ * relocatable.  Failing to save the code doesn't fail the compilation.
+ *
+ * @param cc the compilation context
+ */
+void
+jit_disk_cache_save(JitCompContext *cc);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of _JIT_DISK_CACHE_H_ */
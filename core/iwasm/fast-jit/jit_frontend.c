@@ -21,15 +21,39 @@
 #include "../interpreter/wasm_runtime.h"
 #include "../common/wasm_exec_env.h"
 
+/**
+ * Switch the current basic block to the cc entry block if the fixed
+ * virtual register to be loaded is invariant in the function and the
+ * invariant registers are kept alive across basic blocks, so that the
+ * register is loaded only once for the whole function.
+ *
+ * @param cc the compilation context
+ * @param invariant whether the register value is invariant
+ *
+ * @return the current basic block to switch back to after the load
+ */
+static JitBasicBlock *
+enter_invariant_load(JitCompContext *cc, bool invariant)
+{
+    JitBasicBlock *cur_basic_block = cc->cur_basic_block;
+
+    if (cc->keep_invariant_regs && invariant)
+        cc->cur_basic_block = jit_cc_entry_basic_block(cc);
+    return cur_basic_block;
+}
+
 JitReg
 get_module_inst_reg(JitFrame *frame)
 {
     JitCompContext *cc = frame->cc;
 
     if (!frame->module_inst_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->module_inst_reg = cc->module_inst_reg;
         GEN_INSN(LDPTR, frame->module_inst_reg, cc->exec_env_reg,
                  NEW_CONST(I32, offsetof(WASMExecEnv, module_inst)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->module_inst_reg;
 }
@@ -41,9 +65,12 @@ get_module_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->module_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->module_reg = cc->module_reg;
         GEN_INSN(LDPTR, frame->module_reg, module_inst_reg,
                  NEW_CONST(I32, offsetof(WASMModuleInstance, module)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->module_reg;
 }
@@ -55,10 +82,13 @@ get_import_func_ptrs_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->import_func_ptrs_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->import_func_ptrs_reg = cc->import_func_ptrs_reg;
         GEN_INSN(
             LDPTR, frame->import_func_ptrs_reg, module_inst_reg,
             NEW_CONST(I32, offsetof(WASMModuleInstance, import_func_ptrs)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->import_func_ptrs_reg;
 }
@@ -70,10 +100,13 @@ get_fast_jit_func_ptrs_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->fast_jit_func_ptrs_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->fast_jit_func_ptrs_reg = cc->fast_jit_func_ptrs_reg;
         GEN_INSN(
             LDPTR, frame->fast_jit_func_ptrs_reg, module_inst_reg,
             NEW_CONST(I32, offsetof(WASMModuleInstance, fast_jit_func_ptrs)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->fast_jit_func_ptrs_reg;
 }
@@ -85,10 +118,13 @@ get_func_type_indexes_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->func_type_indexes_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->func_type_indexes_reg = cc->func_type_indexes_reg;
         GEN_INSN(
             LDPTR, frame->func_type_indexes_reg, module_inst_reg,
             NEW_CONST(I32, offsetof(WASMModuleInstance, func_type_indexes)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->func_type_indexes_reg;
 }
@@ -100,9 +136,12 @@ get_global_data_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->global_data_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->global_data_reg = cc->global_data_reg;
         GEN_INSN(LDPTR, frame->global_data_reg, module_inst_reg,
                  NEW_CONST(I32, offsetof(WASMModuleInstance, global_data)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->global_data_reg;
 }
@@ -142,9 +181,12 @@ get_memories_reg(JitFrame *frame)
     JitReg module_inst_reg = get_module_inst_reg(frame);
 
     if (!frame->memories_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->memories_reg = cc->memories_reg;
         GEN_INSN(LDPTR, frame->memories_reg, module_inst_reg,
                  NEW_CONST(I32, offsetof(WASMModuleInstance, memories)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memories_reg;
 }
@@ -156,11 +198,14 @@ get_memory_inst_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memories_reg = get_memories_reg(frame);
 
     if (!frame->memory_regs[mem_idx].memory_inst) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->memory_regs[mem_idx].memory_inst =
             cc->memory_regs[mem_idx].memory_inst;
         GEN_INSN(
             LDPTR, frame->memory_regs[mem_idx].memory_inst, memories_reg,
             NEW_CONST(I32, (uint32)sizeof(WASMMemoryInstance *) * mem_idx));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].memory_inst;
 }
@@ -172,11 +217,15 @@ get_memory_data_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].memory_data) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].memory_data =
             cc->memory_regs[mem_idx].memory_data;
         GEN_INSN(LDPTR, frame->memory_regs[mem_idx].memory_data,
                  memory_inst_reg,
                  NEW_CONST(I32, offsetof(WASMMemoryInstance, memory_data)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].memory_data;
 }
@@ -188,11 +237,15 @@ get_memory_data_end_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].memory_data_end) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].memory_data_end =
             cc->memory_regs[mem_idx].memory_data_end;
         GEN_INSN(LDPTR, frame->memory_regs[mem_idx].memory_data_end,
                  memory_inst_reg,
                  NEW_CONST(I32, offsetof(WASMMemoryInstance, memory_data_end)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].memory_data_end;
 }
@@ -204,6 +257,9 @@ get_mem_bound_check_1byte_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].mem_bound_check_1byte) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].mem_bound_check_1byte =
             cc->memory_regs[mem_idx].mem_bound_check_1byte;
 #if UINTPTR_MAX == UINT64_MAX
@@ -217,6 +273,7 @@ get_mem_bound_check_1byte_reg(JitFrame *frame, uint32 mem_idx)
                  NEW_CONST(
                      I32, offsetof(WASMMemoryInstance, mem_bound_check_1byte)));
 #endif
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].mem_bound_check_1byte;
 }
@@ -228,6 +285,9 @@ get_mem_bound_check_2bytes_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].mem_bound_check_2bytes) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].mem_bound_check_2bytes =
             cc->memory_regs[mem_idx].mem_bound_check_2bytes;
 #if UINTPTR_MAX == UINT64_MAX
@@ -241,6 +301,7 @@ get_mem_bound_check_2bytes_reg(JitFrame *frame, uint32 mem_idx)
                  NEW_CONST(I32, offsetof(WASMMemoryInstance,
                                          mem_bound_check_2bytes)));
 #endif
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].mem_bound_check_2bytes;
 }
@@ -252,6 +313,9 @@ get_mem_bound_check_4bytes_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].mem_bound_check_4bytes) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].mem_bound_check_4bytes =
             cc->memory_regs[mem_idx].mem_bound_check_4bytes;
 #if UINTPTR_MAX == UINT64_MAX
@@ -265,6 +329,7 @@ get_mem_bound_check_4bytes_reg(JitFrame *frame, uint32 mem_idx)
                  NEW_CONST(I32, offsetof(WASMMemoryInstance,
                                          mem_bound_check_4bytes)));
 #endif
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].mem_bound_check_4bytes;
 }
@@ -276,6 +341,9 @@ get_mem_bound_check_8bytes_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].mem_bound_check_8bytes) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].mem_bound_check_8bytes =
             cc->memory_regs[mem_idx].mem_bound_check_8bytes;
 #if UINTPTR_MAX == UINT64_MAX
@@ -289,6 +357,7 @@ get_mem_bound_check_8bytes_reg(JitFrame *frame, uint32 mem_idx)
                  NEW_CONST(I32, offsetof(WASMMemoryInstance,
                                          mem_bound_check_8bytes)));
 #endif
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].mem_bound_check_8bytes;
 }
@@ -300,6 +369,9 @@ get_mem_bound_check_16bytes_reg(JitFrame *frame, uint32 mem_idx)
     JitReg memory_inst_reg = get_memory_inst_reg(frame, mem_idx);
 
     if (!frame->memory_regs[mem_idx].mem_bound_check_16bytes) {
+        JitBasicBlock *cur_basic_block =
+            enter_invariant_load(cc, cc->mem_space_unchanged);
+
         frame->memory_regs[mem_idx].mem_bound_check_16bytes =
             cc->memory_regs[mem_idx].mem_bound_check_16bytes;
 #if UINTPTR_MAX == UINT64_MAX
@@ -313,6 +385,7 @@ get_mem_bound_check_16bytes_reg(JitFrame *frame, uint32 mem_idx)
                  NEW_CONST(I32, offsetof(WASMMemoryInstance,
                                          mem_bound_check_16bytes)));
 #endif
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->memory_regs[mem_idx].mem_bound_check_16bytes;
 }
@@ -324,9 +397,12 @@ get_tables_reg(JitFrame *frame)
     JitReg inst_reg = get_module_inst_reg(frame);
 
     if (!frame->tables_reg) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->tables_reg = cc->tables_reg;
         GEN_INSN(LDPTR, frame->tables_reg, inst_reg,
                  NEW_CONST(I32, offsetof(WASMModuleInstance, tables)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->tables_reg;
 }
@@ -338,10 +414,13 @@ get_table_inst_reg(JitFrame *frame, uint32 tbl_idx)
     JitReg tables_reg = get_tables_reg(frame);
 
     if (!frame->table_regs[tbl_idx].table_inst) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->table_regs[tbl_idx].table_inst =
             cc->table_regs[tbl_idx].table_inst;
         GEN_INSN(LDPTR, frame->table_regs[tbl_idx].table_inst, tables_reg,
                  NEW_CONST(I32, sizeof(WASMTableInstance *) * tbl_idx));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->table_regs[tbl_idx].table_inst;
 }
@@ -353,10 +432,13 @@ get_table_data_reg(JitFrame *frame, uint32 tbl_idx)
     JitReg table_reg = get_table_inst_reg(frame, tbl_idx);
 
     if (!frame->table_regs[tbl_idx].table_data) {
+        JitBasicBlock *cur_basic_block = enter_invariant_load(cc, true);
+
         frame->table_regs[tbl_idx].table_data =
             cc->table_regs[tbl_idx].table_data;
         GEN_INSN(ADD, frame->table_regs[tbl_idx].table_data, table_reg,
                  NEW_CONST(I64, offsetof(WASMTableInstance, elems)));
+        cc->cur_basic_block = cur_basic_block;
     }
     return frame->table_regs[tbl_idx].table_data;
 }
@@ -382,34 +464,32 @@ clear_fixed_virtual_regs(JitFrame *frame)
     WASMModule *module = frame->cc->cur_wasm_module;
     uint32 count, i;
 
+    frame->aux_stack_bound_reg = 0;
+    frame->aux_stack_bottom_reg = 0;
+    clear_memory_regs(frame);
+    clear_table_regs(frame);
+
+    if (frame->cc->keep_invariant_regs)
+        /* The invariant registers were loaded in the entry block */
+        return;
+
     frame->module_inst_reg = 0;
     frame->module_reg = 0;
     frame->import_func_ptrs_reg = 0;
     frame->fast_jit_func_ptrs_reg = 0;
     frame->func_type_indexes_reg = 0;
     frame->global_data_reg = 0;
-    frame->aux_stack_bound_reg = 0;
-    frame->aux_stack_bottom_reg = 0;
     frame->memories_reg = 0;
     frame->tables_reg = 0;
 
     count = module->import_memory_count + module->memory_count;
-    for (i = 0; i < count; i++) {
+    for (i = 0; i < count; i++)
         frame->memory_regs[i].memory_inst = 0;
-        frame->memory_regs[i].memory_data = 0;
-        frame->memory_regs[i].memory_data_end = 0;
-        frame->memory_regs[i].mem_bound_check_1byte = 0;
-        frame->memory_regs[i].mem_bound_check_2bytes = 0;
-        frame->memory_regs[i].mem_bound_check_4bytes = 0;
-        frame->memory_regs[i].mem_bound_check_8bytes = 0;
-        frame->memory_regs[i].mem_bound_check_16bytes = 0;
-    }
 
     count = module->import_table_count + module->table_count;
     for (i = 0; i < count; i++) {
         frame->table_regs[i].table_inst = 0;
         frame->table_regs[i].table_data = 0;
-        frame->table_regs[i].table_cur_size = 0;
     }
 }
 
@@ -419,6 +499,10 @@ clear_memory_regs(JitFrame *frame)
     WASMModule *module = frame->cc->cur_wasm_module;
     uint32 count, i;
 
+    if (frame->cc->keep_invariant_regs && frame->cc->mem_space_unchanged)
+        /* The memory regs were loaded in the entry block */
+        return;
+
     count = module->import_memory_count + module->memory_count;
     for (i = 0; i < count; i++) {
         frame->memory_regs[i].memory_data = 0;
@@ -535,6 +619,31 @@ gen_commit_values(JitFrame *frame, JitValueSlot *begin, JitValueSlot *end)
     }
 }
 
+void
+gen_set_local_reg(JitFrame *frame, unsigned n, JitReg val)
+{
+    JitCompContext *cc = frame->cc;
+    JitReg reg = frame->lp[n].reg, copy = 0;
+    JitValueSlot *p;
+
+    if (val == reg)
+        return;
+
+    /* The operand stack slots pushed by local.get share the register,
+       let them hold a copy of the old value */
+    for (p = frame->lp + frame->max_locals; p < frame->sp; p++) {
+        if (p->reg == reg) {
+            if (!copy) {
+                copy = jit_cc_new_reg(cc, jit_reg_kind(reg));
+                GEN_INSN(MOV, copy, reg);
+            }
+            p->reg = copy;
+        }
+    }
+
+    GEN_INSN(MOV, reg, val);
+}
+
 /**
  * Generate instructions to commit SP and IP pointers to the frame.
  *
@@ -725,6 +834,81 @@ jit_pass_frontend(JitCompContext *cc)
     return true;
 }
 
+/**
+ * Create the virtual registers of the wasm locals kept in registers in
+ * the entry block, load the parameters into them and set the other
+ * locals to 0.
+ */
+static void
+init_local_regs(JitFrame *jit_frame)
+{
+    JitCompContext *cc = jit_frame->cc;
+    WASMFunction *wasm_func = jit_frame->cur_wasm_func;
+    uint32 param_count = wasm_func->func_type->param_count;
+    uint32 local_count = param_count + wasm_func->local_count;
+    uint32 i, n, cell_num;
+    uint8 type;
+    JitReg reg;
+    bool is_param;
+
+    for (i = 0; i < local_count; i++) {
+        is_param = i < param_count;
+        type = is_param ? wasm_func->func_type->types[i]
+                        : wasm_func->local_types[i - param_count];
+        n = wasm_func->local_offsets[i];
+
+        switch (type) {
+            case VALUE_TYPE_I32:
+#if WASM_ENABLE_REF_TYPES != 0
+            case VALUE_TYPE_EXTERNREF:
+            case VALUE_TYPE_FUNCREF:
+#endif
+                reg = jit_cc_new_reg_I32(cc);
+                if (is_param)
+                    GEN_INSN(LDI32, reg, cc->fp_reg,
+                             NEW_CONST(I32, offset_of_local(n)));
+                else
+                    GEN_INSN(MOV, reg, NEW_CONST(I32, 0));
+                cell_num = 1;
+                break;
+            case VALUE_TYPE_I64:
+                reg = jit_cc_new_reg_I64(cc);
+                if (is_param)
+                    GEN_INSN(LDI64, reg, cc->fp_reg,
+                             NEW_CONST(I32, offset_of_local(n)));
+                else
+                    GEN_INSN(MOV, reg, NEW_CONST(I64, 0));
+                cell_num = 2;
+                break;
+            case VALUE_TYPE_F32:
+                reg = jit_cc_new_reg_F32(cc);
+                if (is_param)
+                    GEN_INSN(LDF32, reg, cc->fp_reg,
+                             NEW_CONST(I32, offset_of_local(n)));
+                else
+                    GEN_INSN(MOV, reg, NEW_CONST(F32, 0));
+                cell_num = 1;
+                break;
+            case VALUE_TYPE_F64:
+                reg = jit_cc_new_reg_F64(cc);
+                if (is_param)
+                    GEN_INSN(LDF64, reg, cc->fp_reg,
+                             NEW_CONST(I32, offset_of_local(n)));
+                else
+                    GEN_INSN(MOV, reg, NEW_CONST(F64, 0));
+                cell_num = 2;
+                break;
+            default:
+                continue;
+        }
+
+        for (; cell_num > 0; cell_num--, n++) {
+            jit_frame->lp[n].reg = reg;
+            jit_frame->lp[n].local_reg = 1;
+        }
+    }
+}
+
 static JitFrame *
 init_func_translation(JitCompContext *cc)
 {
@@ -794,6 +978,24 @@ init_func_translation(JitCompContext *cc)
     /* Set spill cache size according to max local cell num, max stack cell
        num and virtual fixed register num */
     cc->spill_cache_size = (max_locals + max_stacks) * 4 + sizeof(void *) * 4;
+    if (cc->keep_invariant_regs) {
+        /* Reserve the spill slots for the invariant registers kept alive
+           across basic blocks, which may be spilled by the linear scan
+           regalloc if there are not enough hard registers */
+        count = (cur_wasm_module->import_memory_count
+                 + cur_wasm_module->memory_count)
+                    * 8
+                + (cur_wasm_module->import_table_count
+                   + cur_wasm_module->table_count)
+                      * 2
+                + 8;
+        cc->spill_cache_size += (uint32)sizeof(void *) * count;
+    }
+    if (cc->keep_local_regs) {
+        /* Reserve the spill slots for the locals kept in registers, a
+           slot may need padding to be aligned to its size */
+        cc->spill_cache_size += max_locals * 4 * 2;
+    }
     cc->total_frame_size = cc->spill_cache_offset + cc->spill_cache_size;
     cc->jitted_return_address_offset =
         offsetof(WASMInterpFrame, jitted_return_addr);
@@ -839,11 +1041,31 @@ init_func_translation(JitCompContext *cc)
     /* frame->prev_frame = fp_reg */
     GEN_INSN(STPTR, cc->fp_reg, top,
              NEW_CONST(I32, offsetof(WASMInterpFrame, prev_frame)));
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    /* frame->function = module_inst->e->functions + cur_wasm_func_idx,
+       the sampling profiler walks the frames to get the call stack */
+    {
+        JitReg module_inst_e = jit_cc_new_reg_ptr(cc);
+        JitReg functions = jit_cc_new_reg_ptr(cc);
+        JitReg func_inst = jit_cc_new_reg_ptr(cc);
+
+        GEN_INSN(LDPTR, module_inst_e, get_module_inst_reg(jit_frame),
+                 NEW_CONST(I32, offsetof(WASMModuleInstance, e)));
+        GEN_INSN(LDPTR, functions, module_inst_e,
+                 NEW_CONST(I32, offsetof(WASMModuleInstanceExtra, functions)));
+        GEN_INSN(ADD, func_inst, functions,
+                 NEW_CONST(PTR, (uint32)sizeof(WASMFunctionInstance)
+                                    * cur_wasm_func_idx));
+        GEN_INSN(STPTR, func_inst, top,
+                 NEW_CONST(I32, offsetof(WASMInterpFrame, function)));
+    }
+#else
     /* TODO: do we need to set frame->function? */
     /*
     GEN_INSN(STPTR, func_inst, top,
              NEW_CONST(I32, offsetof(WASMInterpFrame, function)));
     */
+#endif
     /* exec_env->cur_frame = top */
     GEN_INSN(STPTR, top, cc->exec_env_reg,
              NEW_CONST(I32, offsetof(WASMExecEnv, cur_frame)));
@@ -862,6 +1084,9 @@ init_func_translation(JitCompContext *cc)
                  NEW_CONST(I32, local_off));
     }
 
+    if (cc->keep_local_regs)
+        init_local_regs(jit_frame);
+
     return jit_frame;
 }
 
@@ -2176,6 +2401,12 @@ jit_frontend_translate_func(JitCompContext *cc)
         return NULL;
     }
 
+#if WASM_ENABLE_JIT != 0
+    if (!jit_compile_llvm_jit_hotness_check(cc)) {
+        return NULL;
+    }
+#endif
+
     if (!jit_compile_func(cc)) {
         return NULL;
     }
@@ -312,6 +312,16 @@ gen_commit_values(JitFrame *frame, JitValueSlot *begin, JitValueSlot *end);
 void
 gen_commit_sp_ip(JitFrame *frame);
 
+/**
+ * Generate instructions to set a wasm local kept in register.
+ *
+ * @param frame the frame information
+ * @param n slot index to the local variable
+ * @param val the new value of the local variable
+ */
+void
+gen_set_local_reg(JitFrame *frame, unsigned n, JitReg val);
+
 /**
  * Generate commit instructions for the block end.
  *
@@ -352,7 +362,18 @@ clear_values(JitFrame *frame)
 {
     size_t total_size =
         sizeof(JitValueSlot) * (frame->max_locals + frame->max_stacks);
-    memset(frame->lp, 0, total_size);
+    uint32 i;
+
+    if (frame->cc->keep_local_regs) {
+        /* The locals kept in registers remain valid */
+        for (i = 0; i < frame->max_locals; i++)
+            if (!frame->lp[i].local_reg)
+                memset(&frame->lp[i], 0, sizeof(JitValueSlot));
+        memset(frame->lp + frame->max_locals, 0,
+               sizeof(JitValueSlot) * frame->max_stacks);
+    }
+    else
+        memset(frame->lp, 0, total_size);
     frame->committed_sp = NULL;
     frame->committed_ip = NULL;
     clear_fixed_virtual_regs(frame);
@@ -451,6 +472,11 @@ local_f64(JitFrame *frame, int n)
 static void
 set_local_i32(JitFrame *frame, int n, JitReg val)
 {
+    if (frame->lp[n].local_reg) {
+        gen_set_local_reg(frame, n, val);
+        return;
+    }
+
     frame->lp[n].reg = val;
     frame->lp[n].dirty = 1;
 }
@@ -458,6 +484,11 @@ set_local_i32(JitFrame *frame, int n, JitReg val)
 static void
 set_local_i64(JitFrame *frame, int n, JitReg val)
 {
+    if (frame->lp[n].local_reg) {
+        gen_set_local_reg(frame, n, val);
+        return;
+    }
+
     frame->lp[n].reg = val;
     frame->lp[n].dirty = 1;
     frame->lp[n + 1].reg = val;
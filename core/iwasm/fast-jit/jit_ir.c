@@ -422,6 +422,10 @@ jit_cc_init(JitCompContext *cc, unsigned htab_size)
         jit_reg_new(JIT_REG_KIND_PTR, cc->hreg_info->exec_env_hreg_index);
     cc->cmp_reg = jit_reg_new(JIT_REG_KIND_I32, cc->hreg_info->cmp_hreg_index);
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    cc->relocatable = true;
+#endif
+
     cc->_const_val._hash_table_size = htab_size;
 
     if (!(cc->_const_val._hash_table =
@@ -460,6 +464,11 @@ jit_cc_destroy(JitCompContext *cc)
 
     jit_free(cc->_const_val._hash_table);
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    if (cc->relocs)
+        jit_free(cc->relocs);
+#endif
+
     /* Release the instruction hash table.  */
     jit_cc_disable_insn_hash(cc);
 
@@ -516,6 +525,38 @@ jit_cc_delete(JitCompContext *cc)
     }
 }
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+void
+jit_cc_add_reloc(JitCompContext *cc, uint32 offset, uint32 type)
+{
+    JitReloc *relocs;
+    uint32 capacity;
+
+    if (!cc->relocatable)
+        return;
+
+    if (cc->reloc_num == cc->reloc_capacity) {
+        capacity = cc->reloc_capacity > 0 ? cc->reloc_capacity * 2 : 16;
+        if (!(relocs = jit_malloc(sizeof(JitReloc) * capacity))) {
+            /* Not fatal, the code just isn't saved */
+            cc->relocatable = false;
+            return;
+        }
+        if (cc->relocs) {
+            bh_memcpy_s(relocs, sizeof(JitReloc) * capacity, cc->relocs,
+                        sizeof(JitReloc) * cc->reloc_num);
+            jit_free(cc->relocs);
+        }
+        cc->relocs = relocs;
+        cc->reloc_capacity = capacity;
+    }
+
+    cc->relocs[cc->reloc_num].offset = offset;
+    cc->relocs[cc->reloc_num].type = type;
+    cc->reloc_num++;
+}
+#endif
+
 /*
  * Reallocate a memory block with the new_size.
  * TODO: replace this with imported jit_realloc when it's available.
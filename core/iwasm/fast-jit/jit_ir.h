@@ -853,6 +853,11 @@ typedef struct JitValueSlot {
     /* Committed reference flag.  0: unknown, 1: not-reference, 2:
        reference.  */
     uint32 committed_ref : 2;
+
+    /* Whether the slot is a wasm local whose value is kept in its own
+       virtual register across basic blocks and never committed to
+       memory, the register doesn't change in the function.  */
+    uint32 local_reg : 1;
 } JitValueSlot;
 
 typedef struct JitMemRegs {
@@ -990,6 +995,28 @@ typedef struct JitBlockStack {
     JitBlock *block_list_end;
 } JitBlockStack;
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+/**
+ * Types of the 8-byte absolute addresses in the jitted code which
+ * must be relocated when the code is loaded from the disk cache.
+ */
+typedef enum JitRelocType {
+    /* Address inside the jitted code of the function itself */
+    JIT_RELOC_CODE,
+    /* Address of a runtime function called by the jitted code */
+    JIT_RELOC_RUNTIME_FUNC,
+    /* Address of the stub which returns to the interpreter */
+    JIT_RELOC_RETURN_TO_INTERP,
+} JitRelocType;
+
+typedef struct JitReloc {
+    /* Offset of the address to the begin of the jitted code */
+    uint32 offset;
+    /* JitRelocType */
+    uint32 type;
+} JitReloc;
+#endif
+
 /**
  * The JIT compilation context for one compilation process of a
  * compilation unit.
@@ -1001,6 +1028,10 @@ typedef struct JitCompContext {
     /* No. of the pass to be applied. */
     uint8 cur_pass_no;
 
+    /* Number of the instructions changed or removed by the pass being
+       applied, which is collected into the pass statistics. */
+    uint32 pass_change_count;
+
     /* The current wasm module */
     WASMModule *cur_wasm_module;
     /* The current wasm function */
@@ -1012,6 +1043,18 @@ typedef struct JitCompContext {
 
     bool mem_space_unchanged;
 
+    /* Whether the fixed virtual registers whose values don't change in
+       the function are loaded only once in the entry block and kept
+       alive across basic blocks, which requires the global register
+       allocation of the linear scan regalloc pass. */
+    bool keep_invariant_regs;
+
+    /* Whether the wasm locals are kept in their own virtual registers
+       rather than committed to the frame at the basic block boundaries,
+       so that the loop-carried locals can stay in hard registers, which
+       also requires the linear scan regalloc pass. */
+    bool keep_local_regs;
+
     /* Entry and exit labels of the compilation unit, whose numbers must
        be 0 and 1 respectively (see JIT_FOREACH_BLOCK). */
     JitReg entry_label;
@@ -1073,6 +1116,18 @@ typedef struct JitCompContext {
     void *jitted_addr_begin;
     void *jitted_addr_end;
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    /* Relocations of the jitted code recorded by the pass codegen, used
+       to save the code into the disk cache. */
+    JitReloc *relocs;
+    uint32 reloc_num;
+    uint32 reloc_capacity;
+    /* Whether all the absolute addresses in the jitted code are in
+       relocs, it must be cleared by the frontend or the codegen when
+       some address isn't, so that the code isn't saved. */
+    bool relocatable;
+#endif
+
     char last_error[128];
 
     /* Below fields are all private.  Don't access them directly. */
@@ -1282,6 +1337,21 @@ jit_cc_inc_ref(JitCompContext *cc)
 void
 jit_cc_delete(JitCompContext *cc);
 
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+/**
+ * Record an 8-byte absolute address in the jitted code which must be
+ * relocated when the code is loaded from the disk cache.  If the
+ * relocation can't be recorded, the code is marked as not relocatable
+ * instead of failing the compilation.
+ *
+ * @param cc the compilation context
+ * @param offset offset of the address to the begin of the code
+ * @param type the JitRelocType of the address
+ */
+void
+jit_cc_add_reloc(JitCompContext *cc, uint32 offset, uint32 type);
+#endif
+
 char *
 jit_get_last_error(JitCompContext *cc);
 
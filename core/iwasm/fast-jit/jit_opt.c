@@ -0,0 +1,1033 @@
+/*
+ * Copyright (C) 2021 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+/**
+ * Optional optimization passes applied to the IR generated by the
+ * frontend: constant folding, local common subexpression elimination,
+ * redundant linear memory bounds check elimination and dead code
+ * elimination.
+ *
+ * The virtual registers aren't in SSA form, e.g. the register of a
+ * fixed value like the module instance is reloaded in each basic block.
+ * So a register is only treated as holding a known value if it has a
+ * single definition in the function, or in the basic block before it
+ * is redefined. Instructions with hard register operands are never
+ * changed, since the frontend uses hard registers for the operands
+ * whose locations are constrained by the code generator.
+ *
+ * Each pass increases cc->pass_change_count by the number of the
+ * instructions it changes or removes.
+ */
+
+#include "jit_compiler.h"
+#include "jit_ir.h"
+#include "jit_utils.h"
+
+/* Counters of the virtual registers of each kind */
+typedef struct RegCounter {
+    uint32 *count[JIT_REG_KIND_L32];
+} RegCounter;
+
+static void
+reg_counter_destroy(RegCounter *counter)
+{
+    unsigned kind;
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++) {
+        if (counter->count[kind]) {
+            jit_free(counter->count[kind]);
+            counter->count[kind] = NULL;
+        }
+    }
+}
+
+static bool
+reg_counter_init(JitCompContext *cc, RegCounter *counter)
+{
+    unsigned kind, num;
+
+    memset(counter, 0, sizeof(RegCounter));
+
+    for (kind = JIT_REG_KIND_I32; kind < JIT_REG_KIND_L32; kind++) {
+        if ((num = jit_cc_reg_num(cc, kind)) > 0
+            && !(counter->count[kind] = jit_calloc(sizeof(uint32) * num))) {
+            reg_counter_destroy(counter);
+            jit_set_last_error(cc, "allocate memory failed");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint32 *
+reg_counter_at(RegCounter *counter, JitReg reg)
+{
+    bh_assert(jit_reg_is_variable(reg));
+    return &counter->count[jit_reg_kind(reg)][jit_reg_no(reg)];
+}
+
+/**
+ * Count the definitions or the uses of the registers in all blocks.
+ */
+static void
+reg_counter_count(JitCompContext *cc, RegCounter *counter, bool count_defs)
+{
+    JitBasicBlock *block;
+    JitInsn *insn;
+    JitRegVec regvec;
+    JitReg *regp;
+    unsigned i, end, j, first_use;
+
+    JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, i, end, block)
+    {
+        JIT_FOREACH_INSN(block, insn)
+        {
+            regvec = jit_insn_opnd_regs(insn);
+            first_use = jit_insn_opnd_first_use(insn);
+
+            if (count_defs) {
+                JIT_REG_VEC_FOREACH_DEF(regvec, j, regp, first_use)
+                if (jit_reg_is_variable(*regp))
+                    (*reg_counter_at(counter, *regp))++;
+            }
+            else {
+                JIT_REG_VEC_FOREACH_USE(regvec, j, regp, first_use)
+                if (jit_reg_is_variable(*regp))
+                    (*reg_counter_at(counter, *regp))++;
+            }
+        }
+    }
+}
+
+static bool
+is_vreg(JitCompContext *cc, JitReg reg)
+{
+    return jit_reg_is_variable(reg) && !jit_cc_is_hreg(cc, reg);
+}
+
+static bool
+has_hreg_opnd(JitCompContext *cc, JitInsn *insn)
+{
+    JitRegVec regvec = jit_insn_opnd_regs(insn);
+    JitReg *regp;
+    unsigned i;
+
+    JIT_REG_VEC_FOREACH(regvec, i, regp)
+    if (jit_reg_is_variable(*regp) && jit_cc_is_hreg(cc, *regp))
+        return true;
+
+    return false;
+}
+
+/**
+ * Whether the instruction only computes its result, which is the
+ * first operand, from the other operands, so that it can be folded,
+ * reused or removed. It relies on the order of the opcodes in
+ * jit_ir.def. The division instructions are pure as the frontend
+ * checks the divisor before them, while the loads aren't as they may
+ * trap when the hardware bounds check is enabled.
+ */
+static bool
+is_pure_insn(JitCompContext *cc, JitInsn *insn)
+{
+    uint16 opcode = insn->opcode;
+
+    if (!(opcode == JIT_OP_MOV
+          || (opcode >= JIT_OP_I8TOI32 && opcode <= JIT_OP_NEG)
+          || (opcode >= JIT_OP_ADD && opcode <= JIT_OP_AND)
+          || (opcode >= JIT_OP_MAX && opcode <= JIT_OP_POPCNT)))
+        return false;
+
+    return is_vreg(cc, *(jit_insn_opnd(insn, 0)))
+           && !has_hreg_opnd(cc, insn);
+}
+
+/**
+ * Turn the instruction into "MOV dst, src" in place, which is valid as
+ * all the pure instructions have at least two operands.
+ */
+static void
+rewrite_to_mov(JitInsn *insn, JitReg dst, JitReg src)
+{
+    bh_assert(jit_insn_opnd_regs(insn).num >= 2);
+
+    insn->opcode = JIT_OP_MOV;
+    *(jit_insn_opnd(insn, 0)) = dst;
+    *(jit_insn_opnd(insn, 1)) = src;
+}
+
+/*
+ * Constant folding
+ */
+
+/**
+ * Get the constant value of an integer constant register.
+ *
+ * @return true if the register is an integer constant which can be
+ *         folded, false otherwise
+ */
+static bool
+get_const_int(JitCompContext *cc, JitReg reg, int64 *p_val)
+{
+    if (!jit_reg_is_const(reg))
+        return false;
+
+    if (jit_reg_is_kind(I32, reg)) {
+        /* Keep the constants with relocation info as they are */
+        if (jit_cc_get_const_I32_rel(cc, reg))
+            return false;
+        *p_val = jit_cc_get_const_I32(cc, reg);
+        return true;
+    }
+    if (jit_reg_is_kind(I64, reg)) {
+        *p_val = jit_cc_get_const_I64(cc, reg);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Get the known constant value of an operand, which is either a
+ * constant or a virtual register only defined by moving a constant.
+ *
+ * @return the constant register, 0 if the value isn't known
+ */
+static JitReg
+get_known_const(JitCompContext *cc, JitReg reg)
+{
+    JitInsn *def_insn;
+
+    if (jit_reg_is_const(reg))
+        return reg;
+
+    if (is_vreg(cc, reg) && (def_insn = *(jit_annr_def_insn(cc, reg)))
+        && def_insn->opcode == JIT_OP_MOV
+        && jit_reg_is_const(*(jit_insn_opnd(def_insn, 1))))
+        return *(jit_insn_opnd(def_insn, 1));
+
+    return 0;
+}
+
+static uint32
+count_leading_zeros(uint64 val, uint32 bits)
+{
+    uint32 n = 0;
+
+    while (n < bits && !(val & ((uint64)1 << (bits - 1 - n))))
+        n++;
+    return n;
+}
+
+static uint32
+count_trailing_zeros(uint64 val, uint32 bits)
+{
+    uint32 n = 0;
+
+    while (n < bits && !(val & ((uint64)1 << n)))
+        n++;
+    return n;
+}
+
+static uint32
+count_ones(uint64 val)
+{
+    uint32 n = 0;
+
+    for (; val; val &= val - 1)
+        n++;
+    return n;
+}
+
+/**
+ * Compute the result of an integer instruction whose operands are
+ * constants, the values of I32 operands are sign-extended.
+ *
+ * @return true if the instruction can be folded, false otherwise
+ */
+static bool
+compute_const_int(uint16 opcode, bool is_i32, int64 lhs, int64 rhs,
+                  int64 *p_res)
+{
+    uint32 bits = is_i32 ? 32 : 64;
+    uint64 a = is_i32 ? (uint64)(uint32)lhs : (uint64)lhs;
+    uint64 n = (uint64)rhs & (bits - 1);
+    uint64 res;
+
+    switch (opcode) {
+        case JIT_OP_MOV:
+            res = (uint64)lhs;
+            break;
+        case JIT_OP_I8TOI32:
+        case JIT_OP_I8TOI64:
+        case JIT_OP_I32TOI8:
+        case JIT_OP_I64TOI8:
+            res = (uint64)(int64)(int8)lhs;
+            break;
+        case JIT_OP_I16TOI32:
+        case JIT_OP_I16TOI64:
+        case JIT_OP_I32TOI16:
+        case JIT_OP_I64TOI16:
+            res = (uint64)(int64)(int16)lhs;
+            break;
+        case JIT_OP_I32TOU8:
+            res = (uint8)lhs;
+            break;
+        case JIT_OP_I32TOU16:
+            res = (uint16)lhs;
+            break;
+        case JIT_OP_I32TOI64:
+        case JIT_OP_I64TOI32:
+            res = (uint64)(int64)(int32)lhs;
+            break;
+        case JIT_OP_U32TOI64:
+            res = (uint32)lhs;
+            break;
+        case JIT_OP_NEG:
+            res = 0 - (uint64)lhs;
+            break;
+        case JIT_OP_ADD:
+            res = (uint64)lhs + (uint64)rhs;
+            break;
+        case JIT_OP_SUB:
+            res = (uint64)lhs - (uint64)rhs;
+            break;
+        case JIT_OP_MUL:
+            res = (uint64)lhs * (uint64)rhs;
+            break;
+        case JIT_OP_AND:
+            res = (uint64)lhs & (uint64)rhs;
+            break;
+        case JIT_OP_OR:
+            res = (uint64)lhs | (uint64)rhs;
+            break;
+        case JIT_OP_XOR:
+            res = (uint64)lhs ^ (uint64)rhs;
+            break;
+        /* The shift count is taken modulo the bit width like the
+           native shift instructions */
+        case JIT_OP_SHL:
+            res = a << n;
+            break;
+        case JIT_OP_SHRS:
+            res = is_i32 ? (uint64)((int32)lhs >> n) : (uint64)(lhs >> n);
+            break;
+        case JIT_OP_SHRU:
+            res = a >> n;
+            break;
+        case JIT_OP_ROTL:
+            res = n ? (a << n) | (a >> (bits - n)) : a;
+            break;
+        case JIT_OP_ROTR:
+            res = n ? (a >> n) | (a << (bits - n)) : a;
+            break;
+        case JIT_OP_CLZ:
+            res = count_leading_zeros(a, bits);
+            break;
+        case JIT_OP_CTZ:
+            res = count_trailing_zeros(a, bits);
+            break;
+        case JIT_OP_POPCNT:
+            res = count_ones(a);
+            break;
+        default:
+            return false;
+    }
+
+    *p_res = (int64)res;
+    return true;
+}
+
+/**
+ * Simplify an instruction with an identity operand, e.g. "x + 0", into
+ * moving the other operand.
+ *
+ * @return the register holding the result, 0 if it can't be simplified
+ */
+static JitReg
+simplify_identity(JitInsn *insn, JitReg lhs, JitReg rhs, bool lhs_known,
+                  int64 lhs_val, bool rhs_known, int64 rhs_val,
+                  uint32 bits)
+{
+    switch (insn->opcode) {
+        case JIT_OP_SHL:
+        case JIT_OP_SHRS:
+        case JIT_OP_SHRU:
+        case JIT_OP_ROTL:
+        case JIT_OP_ROTR:
+            rhs_val &= bits - 1;
+            /* fall through */
+        case JIT_OP_SUB:
+            if (rhs_known && rhs_val == 0)
+                return lhs;
+            break;
+        case JIT_OP_ADD:
+        case JIT_OP_OR:
+        case JIT_OP_XOR:
+            if (rhs_known && rhs_val == 0)
+                return lhs;
+            if (lhs_known && lhs_val == 0)
+                return rhs;
+            break;
+        case JIT_OP_MUL:
+            if (rhs_known && rhs_val == 1)
+                return lhs;
+            if (lhs_known && lhs_val == 1)
+                return rhs;
+            break;
+        case JIT_OP_AND:
+            if (rhs_known && rhs_val == -1)
+                return lhs;
+            if (lhs_known && lhs_val == -1)
+                return rhs;
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * Fold an instruction whose operands are known constants into moving
+ * the result, or simplify it if it has an identity operand.
+ *
+ * @return true if the instruction is changed, false otherwise
+ */
+static bool
+fold_insn(JitCompContext *cc, JitInsn *insn)
+{
+    JitReg dst, opnds[2] = { 0 }, result;
+    int64 vals[2] = { 0 }, res;
+    bool known[2] = { false, false }, is_i32;
+    unsigned opnd_num, i;
+
+    if (!is_pure_insn(cc, insn))
+        return false;
+
+    dst = *(jit_insn_opnd(insn, 0));
+    if (!jit_reg_is_kind(I32, dst) && !jit_reg_is_kind(I64, dst))
+        return false;
+    is_i32 = jit_reg_is_kind(I32, dst);
+
+    opnd_num = jit_insn_opnd_regs(insn).num - 1;
+    bh_assert(opnd_num >= 1 && opnd_num <= 2);
+
+    for (i = 0; i < opnd_num; i++) {
+        opnds[i] = *(jit_insn_opnd(insn, i + 1));
+        known[i] = get_const_int(cc, get_known_const(cc, opnds[i]), &vals[i]);
+    }
+
+    if (known[0] && (opnd_num == 1 || known[1])) {
+        /* Nothing to fold for moving a constant */
+        if (insn->opcode == JIT_OP_MOV && jit_reg_is_const(opnds[0]))
+            return false;
+
+        if (!compute_const_int(insn->opcode, is_i32, vals[0], vals[1], &res))
+            return false;
+
+        result = is_i32 ? NEW_CONST(I32, (int32)res) : NEW_CONST(I64, res);
+        if (!result)
+            return false;
+
+        rewrite_to_mov(insn, dst, result);
+        return true;
+    }
+
+    if (opnd_num == 2
+        && (result = simplify_identity(insn, opnds[0], opnds[1], known[0],
+                                       vals[0], known[1], vals[1],
+                                       is_i32 ? 32 : 64))) {
+        if (jit_reg_kind(result) != jit_reg_kind(dst))
+            return false;
+        rewrite_to_mov(insn, dst, result);
+        return true;
+    }
+
+    return false;
+}
+
+bool
+jit_pass_const_fold(JitCompContext *cc)
+{
+    RegCounter defs;
+    JitBasicBlock *block;
+    JitInsn *insn;
+    JitRegVec regvec;
+    JitReg *regp;
+    unsigned i, end, j, first_use;
+    bool changed;
+
+    if (!jit_annr_enable_def_insn(cc) || !reg_counter_init(cc, &defs))
+        return false;
+
+    /* Record the defining instruction of the virtual registers with a
+       single definition, the constants they hold can be propagated */
+    reg_counter_count(cc, &defs, true);
+    JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, i, end, block)
+    {
+        JIT_FOREACH_INSN(block, insn)
+        {
+            regvec = jit_insn_opnd_regs(insn);
+            first_use = jit_insn_opnd_first_use(insn);
+
+            JIT_REG_VEC_FOREACH_DEF(regvec, j, regp, first_use)
+            if (is_vreg(cc, *regp))
+                *(jit_annr_def_insn(cc, *regp)) =
+                    *reg_counter_at(&defs, *regp) == 1 ? insn : NULL;
+        }
+    }
+    reg_counter_destroy(&defs);
+
+    /* An instruction folded into moving a constant may make the users
+       of its result foldable, which may be visited earlier */
+    do {
+        changed = false;
+        JIT_FOREACH_BLOCK(cc, i, end, block)
+        {
+            JIT_FOREACH_INSN(block, insn)
+            {
+                if (fold_insn(cc, insn)) {
+                    cc->pass_change_count++;
+                    changed = true;
+                }
+            }
+        }
+    } while (changed && !jit_get_last_error(cc));
+
+    return !jit_get_last_error(cc);
+}
+
+/*
+ * Local common subexpression elimination
+ */
+
+/* Size of the hash table of the available expressions */
+#define CSE_HASH_SIZE 127
+
+/* An instruction whose result is available in the current block */
+typedef struct CseEntry {
+    JitInsn *insn;
+    /* Position of the instruction in the function */
+    uint32 pos;
+    struct CseEntry *next;
+} CseEntry;
+
+static bool
+is_cse_candidate(JitCompContext *cc, JitInsn *insn)
+{
+    return insn->opcode != JIT_OP_MOV && is_pure_insn(cc, insn);
+}
+
+/**
+ * Check whether the result of an earlier instruction is still
+ * available, i.e. neither its result nor its operands have been
+ * redefined since it.
+ */
+static bool
+is_entry_available(CseEntry *entry, RegCounter *last_def)
+{
+    JitRegVec regvec = jit_insn_opnd_regs(entry->insn);
+    JitReg *regp;
+    unsigned i, first_use = jit_insn_opnd_first_use(entry->insn);
+
+    if (*reg_counter_at(last_def, *(jit_insn_opnd(entry->insn, 0)))
+        != entry->pos)
+        return false;
+
+    JIT_REG_VEC_FOREACH_USE(regvec, i, regp, first_use)
+    if (jit_reg_is_variable(*regp)
+        && *reg_counter_at(last_def, *regp) >= entry->pos)
+        return false;
+
+    return true;
+}
+
+bool
+jit_pass_cse(JitCompContext *cc)
+{
+    RegCounter last_def;
+    CseEntry *table[CSE_HASH_SIZE], *entries = NULL, *entry;
+    JitBasicBlock *block;
+    JitInsn *insn;
+    JitRegVec regvec;
+    JitReg *regp, dst;
+    unsigned i, end, j, first_use, slot;
+    uint32 insn_num, max_insn_num = 0, entry_num, pos = 0;
+
+    JIT_FOREACH_BLOCK(cc, i, end, block)
+    {
+        insn_num = 0;
+        JIT_FOREACH_INSN(block, insn)
+        {
+            insn_num++;
+        }
+        if (insn_num > max_insn_num)
+            max_insn_num = insn_num;
+    }
+
+    if (max_insn_num == 0)
+        return true;
+
+    if (!reg_counter_init(cc, &last_def))
+        return false;
+
+    if (!(entries = jit_malloc(sizeof(CseEntry) * max_insn_num))) {
+        jit_set_last_error(cc, "allocate memory failed");
+        reg_counter_destroy(&last_def);
+        return false;
+    }
+
+    JIT_FOREACH_BLOCK(cc, i, end, block)
+    {
+        memset(table, 0, sizeof(table));
+        entry_num = 0;
+
+        JIT_FOREACH_INSN(block, insn)
+        {
+            /* Positions start from 1, so that 0 means the register
+               hasn't been defined */
+            pos++;
+
+            if (is_cse_candidate(cc, insn)) {
+                slot = jit_insn_hash(insn) % CSE_HASH_SIZE;
+                for (entry = table[slot]; entry; entry = entry->next) {
+                    if (jit_insn_equal(entry->insn, insn)
+                        && is_entry_available(entry, &last_def))
+                        break;
+                }
+
+                dst = *(jit_insn_opnd(insn, 0));
+                if (entry
+                    && jit_reg_kind(*(jit_insn_opnd(entry->insn, 0)))
+                           == jit_reg_kind(dst)) {
+                    rewrite_to_mov(insn, dst, *(jit_insn_opnd(entry->insn, 0)));
+                    cc->pass_change_count++;
+                }
+                else {
+                    /* The newer entry is found first */
+                    entries[entry_num].insn = insn;
+                    entries[entry_num].pos = pos;
+                    entries[entry_num].next = table[slot];
+                    table[slot] = &entries[entry_num++];
+                }
+            }
+
+            regvec = jit_insn_opnd_regs(insn);
+            first_use = jit_insn_opnd_first_use(insn);
+            JIT_REG_VEC_FOREACH_DEF(regvec, j, regp, first_use)
+            if (jit_reg_is_variable(*regp))
+                *reg_counter_at(&last_def, *regp) = pos;
+        }
+    }
+
+    jit_free(entries);
+    reg_counter_destroy(&last_def);
+    return true;
+}
+
+/*
+ * Redundant bounds check elimination
+ */
+
+/* Maximum number of the address registers and of the passed bounds
+   checks tracked in a block, the oldest ones are dropped */
+#define BCE_MAX_ADDR_NUM 16
+#define BCE_MAX_CHECK_NUM 16
+
+/* A register holding a linear memory offset: (uint64)base + offset,
+   base is 0 if the offset is a constant */
+typedef struct BceAddr {
+    JitReg reg;
+    JitReg base;
+    uint64 offset;
+} BceAddr;
+
+/* A passed bounds check: the bytes below (uint64)base + end are in the
+   linear memory mem_idx */
+typedef struct BceCheck {
+    JitReg base;
+    uint32 mem_idx;
+    uint64 end;
+} BceCheck;
+
+typedef struct BceContext {
+    BceAddr addrs[BCE_MAX_ADDR_NUM];
+    uint32 addr_num;
+    BceCheck checks[BCE_MAX_CHECK_NUM];
+    uint32 check_num;
+} BceContext;
+
+static BceAddr *
+bce_find_addr(BceContext *ctx, JitReg reg)
+{
+    uint32 i;
+
+    for (i = 0; i < ctx->addr_num; i++)
+        if (ctx->addrs[i].reg == reg)
+            return &ctx->addrs[i];
+    return NULL;
+}
+
+static void
+bce_add_addr(BceContext *ctx, JitReg reg, JitReg base, uint64 offset)
+{
+    if (ctx->addr_num == BCE_MAX_ADDR_NUM) {
+        memmove(ctx->addrs, ctx->addrs + 1,
+                sizeof(BceAddr) * (BCE_MAX_ADDR_NUM - 1));
+        ctx->addr_num--;
+    }
+    ctx->addrs[ctx->addr_num].reg = reg;
+    ctx->addrs[ctx->addr_num].base = base;
+    ctx->addrs[ctx->addr_num].offset = offset;
+    ctx->addr_num++;
+}
+
+static void
+bce_add_check(BceContext *ctx, JitReg base, uint32 mem_idx, uint64 end)
+{
+    uint32 i;
+
+    for (i = 0; i < ctx->check_num; i++) {
+        if (ctx->checks[i].base == base && ctx->checks[i].mem_idx == mem_idx) {
+            if (ctx->checks[i].end < end)
+                ctx->checks[i].end = end;
+            return;
+        }
+    }
+
+    if (ctx->check_num == BCE_MAX_CHECK_NUM) {
+        memmove(ctx->checks, ctx->checks + 1,
+                sizeof(BceCheck) * (BCE_MAX_CHECK_NUM - 1));
+        ctx->check_num--;
+    }
+    ctx->checks[ctx->check_num].base = base;
+    ctx->checks[ctx->check_num].mem_idx = mem_idx;
+    ctx->checks[ctx->check_num].end = end;
+    ctx->check_num++;
+}
+
+/**
+ * Forget the addresses and the checks depending on a redefined
+ * register.
+ */
+static void
+bce_kill_reg(BceContext *ctx, JitReg reg)
+{
+    uint32 i, n;
+
+    for (i = n = 0; i < ctx->addr_num; i++)
+        if (ctx->addrs[i].reg != reg && ctx->addrs[i].base != reg)
+            ctx->addrs[n++] = ctx->addrs[i];
+    ctx->addr_num = n;
+
+    for (i = n = 0; i < ctx->check_num; i++)
+        if (ctx->checks[i].base != reg)
+            ctx->checks[n++] = ctx->checks[i];
+    ctx->check_num = n;
+}
+
+/**
+ * Track the linear memory offsets computed by check_and_seek of the
+ * frontend, which is "U32TOI64 long_addr, addr" and "ADD offset1,
+ * offset, long_addr" on 64-bit platforms and "ADD offset1, offset,
+ * addr" on 32-bit platforms.
+ */
+static void
+bce_track_addr(JitCompContext *cc, BceContext *ctx, JitInsn *insn)
+{
+    JitReg dst, src, lhs, rhs;
+    BceAddr *addr;
+    int64 val;
+
+    if (insn->opcode != JIT_OP_MOV && insn->opcode != JIT_OP_ADD
+#if UINTPTR_MAX == UINT64_MAX
+        && insn->opcode != JIT_OP_U32TOI64
+#endif
+    )
+        return;
+
+    dst = *(jit_insn_opnd(insn, 0));
+    if (!is_vreg(cc, dst) || jit_reg_kind(dst) != JIT_REG_KIND_PTR)
+        return;
+
+    switch (insn->opcode) {
+#if UINTPTR_MAX == UINT64_MAX
+        case JIT_OP_U32TOI64:
+            src = *(jit_insn_opnd(insn, 1));
+            if (get_const_int(cc, src, &val))
+                bce_add_addr(ctx, dst, 0, (uint32)val);
+            else if (is_vreg(cc, src))
+                bce_add_addr(ctx, dst, src, 0);
+            break;
+#endif
+        case JIT_OP_MOV:
+            src = *(jit_insn_opnd(insn, 1));
+            if ((addr = bce_find_addr(ctx, src)))
+                bce_add_addr(ctx, dst, addr->base, addr->offset);
+#if UINTPTR_MAX == UINT64_MAX
+            /* The offset folded by the pass const_fold */
+            else if (get_const_int(cc, src, &val) && val >= 0)
+                bce_add_addr(ctx, dst, 0, (uint64)val);
+#endif
+            break;
+        case JIT_OP_ADD:
+            lhs = *(jit_insn_opnd(insn, 1));
+            rhs = *(jit_insn_opnd(insn, 2));
+            if (!get_const_int(cc, lhs, &val)) {
+                src = lhs;
+                lhs = rhs;
+                rhs = src;
+                if (!get_const_int(cc, lhs, &val))
+                    return;
+            }
+            if (val < 0 || (uint64)val > UINT32_MAX)
+                return;
+#if UINTPTR_MAX == UINT64_MAX
+            if ((addr = bce_find_addr(ctx, rhs)))
+                bce_add_addr(ctx, dst, addr->base, addr->offset + (uint64)val);
+#else
+            /* The offset overflowing is checked before the bounds
+               check, see bce_get_bound_check */
+            if (is_vreg(cc, rhs))
+                bce_add_addr(ctx, dst, rhs, (uint32)val);
+#endif
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Get the memory index and the access size of a bounds check register.
+ */
+static bool
+bce_get_bound_reg_info(JitCompContext *cc, JitReg reg, uint32 *p_mem_idx,
+                       uint32 *p_bytes)
+{
+    WASMModule *module = cc->cur_wasm_module;
+    uint32 count = module->import_memory_count + module->memory_count;
+    uint32 i;
+
+    if (!cc->memory_regs)
+        return false;
+
+    for (i = 0; i < count; i++) {
+        JitMemRegs *regs = &cc->memory_regs[i];
+
+        if (reg == regs->mem_bound_check_1byte)
+            *p_bytes = 1;
+        else if (reg == regs->mem_bound_check_2bytes)
+            *p_bytes = 2;
+        else if (reg == regs->mem_bound_check_4bytes)
+            *p_bytes = 4;
+        else if (reg == regs->mem_bound_check_8bytes)
+            *p_bytes = 8;
+        else if (reg == regs->mem_bound_check_16bytes)
+            *p_bytes = 16;
+        else
+            continue;
+
+        *p_mem_idx = i;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Whether the compare result of the CMP instruction is no longer used
+ * after its conditional branch.
+ */
+static bool
+is_cmp_reg_dead_after(JitCompContext *cc, JitBasicBlock *block, JitInsn *insn)
+{
+    JitRegVec regvec;
+    JitReg *regp;
+    unsigned i, first_use;
+
+    for (insn = insn->next; insn != jit_basic_block_end_insn(block);
+         insn = insn->next) {
+        regvec = jit_insn_opnd_regs(insn);
+        first_use = jit_insn_opnd_first_use(insn);
+
+        JIT_REG_VEC_FOREACH_USE(regvec, i, regp, first_use)
+        if (*regp == cc->cmp_reg)
+            return false;
+        JIT_REG_VEC_FOREACH_DEF(regvec, i, regp, first_use)
+        if (*regp == cc->cmp_reg)
+            return true;
+    }
+    return true;
+}
+
+/**
+ * Match "CMP cmp_reg, offset1, boundary" followed by the exception
+ * branch "BGTU cmp_reg, exception_label, 0" generated by
+ * check_and_seek, and get the checked bytes.
+ */
+static bool
+bce_get_bound_check(JitCompContext *cc, BceContext *ctx, JitBasicBlock *block,
+                    JitInsn *insn, BceCheck *check)
+{
+    JitInsn *br = insn->next, *prev;
+    JitReg offset1, boundary;
+    BceAddr *addr;
+    uint32 mem_idx, bytes;
+
+    if (insn->opcode != JIT_OP_CMP || *(jit_insn_opnd(insn, 0)) != cc->cmp_reg
+        || br == jit_basic_block_end_insn(block) || br->opcode != JIT_OP_BGTU
+        || *(jit_insn_opnd(br, 0)) != cc->cmp_reg
+        || *(jit_insn_opnd(br, 2)) != 0)
+        return false;
+
+    offset1 = *(jit_insn_opnd(insn, 1));
+    boundary = *(jit_insn_opnd(insn, 2));
+    if (!bce_get_bound_reg_info(cc, boundary, &mem_idx, &bytes)
+        || !(addr = bce_find_addr(ctx, offset1)))
+        return false;
+
+#if UINTPTR_MAX != UINT64_MAX
+    /* "CMP cmp_reg, offset1, addr" and "BLTU" must have checked that
+       addr + offset doesn't overflow */
+    prev = insn->prev;
+    if (prev == block || prev->opcode != JIT_OP_BLTU)
+        return false;
+    prev = prev->prev;
+    if (prev == block || prev->opcode != JIT_OP_CMP
+        || *(jit_insn_opnd(prev, 1)) != offset1
+        || *(jit_insn_opnd(prev, 2)) != addr->base)
+        return false;
+#else
+    (void)prev;
+#endif
+
+    check->base = addr->base;
+    check->mem_idx = mem_idx;
+    check->end = addr->offset + bytes;
+    return true;
+}
+
+/**
+ * Whether a bounds check is implied by an earlier check in the block.
+ * The bounds check registers of a memory may be reloaded between the
+ * two checks, e.g. after memory.grow or a call, but the memory can
+ * only grow, so the earlier check still holds.
+ */
+static bool
+bce_is_check_redundant(BceContext *ctx, const BceCheck *check)
+{
+    uint32 i;
+
+    for (i = 0; i < ctx->check_num; i++)
+        if (ctx->checks[i].base == check->base
+            && ctx->checks[i].mem_idx == check->mem_idx
+            && ctx->checks[i].end >= check->end)
+            return true;
+    return false;
+}
+
+bool
+jit_pass_bound_check_elim(JitCompContext *cc)
+{
+    BceContext ctx;
+    BceCheck check;
+    JitBasicBlock *block;
+    JitInsn *insn, *br, *prev;
+    JitRegVec regvec;
+    JitReg *regp;
+    unsigned i, end, j, first_use;
+
+    if (!cc->memory_regs)
+        return true;
+
+    /* The offsets are reloaded from the frame in each block, so a check
+       can only be implied by the earlier ones in the same block */
+    JIT_FOREACH_BLOCK(cc, i, end, block)
+    {
+        ctx.addr_num = ctx.check_num = 0;
+
+        JIT_FOREACH_INSN(block, insn)
+        {
+            if (bce_get_bound_check(cc, &ctx, block, insn, &check)) {
+                br = insn->next;
+                if (bce_is_check_redundant(&ctx, &check)
+                    && is_cmp_reg_dead_after(cc, block, br)) {
+                    prev = insn->prev;
+                    jit_insn_unlink(insn);
+                    jit_insn_delete(insn);
+                    jit_insn_unlink(br);
+                    jit_insn_delete(br);
+                    cc->pass_change_count++;
+                    insn = prev;
+                    continue;
+                }
+                bce_add_check(&ctx, check.base, check.mem_idx, check.end);
+            }
+
+            regvec = jit_insn_opnd_regs(insn);
+            first_use = jit_insn_opnd_first_use(insn);
+            JIT_REG_VEC_FOREACH_DEF(regvec, j, regp, first_use)
+            if (jit_reg_is_variable(*regp))
+                bce_kill_reg(&ctx, *regp);
+
+            bce_track_addr(cc, &ctx, insn);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Dead code elimination
+ */
+
+bool
+jit_pass_dce(JitCompContext *cc)
+{
+    RegCounter uses;
+    JitBasicBlock *block;
+    JitInsn *insn, *next;
+    JitRegVec regvec;
+    JitReg *regp;
+    unsigned i, j, first_use;
+    bool changed;
+
+    if (!reg_counter_init(cc, &uses))
+        return false;
+
+    reg_counter_count(cc, &uses, false);
+
+    /* Visit the instructions backward so that the chain of the unused
+       instructions in a block is removed in one round */
+    do {
+        changed = false;
+        JIT_FOREACH_BLOCK_REVERSE(cc, i, block)
+        {
+            JIT_FOREACH_INSN_REVERSE(block, insn)
+            {
+                if (!is_pure_insn(cc, insn)
+                    || *reg_counter_at(&uses, *(jit_insn_opnd(insn, 0))) > 0)
+                    continue;
+
+                regvec = jit_insn_opnd_regs(insn);
+                first_use = jit_insn_opnd_first_use(insn);
+                JIT_REG_VEC_FOREACH_USE(regvec, j, regp, first_use)
+                if (jit_reg_is_variable(*regp))
+                    (*reg_counter_at(&uses, *regp))--;
+
+                next = insn->next;
+                jit_insn_unlink(insn);
+                jit_insn_delete(insn);
+                insn = next;
+
+                cc->pass_change_count++;
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    reg_counter_destroy(&uses);
+    return true;
+}
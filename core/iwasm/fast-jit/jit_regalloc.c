@@ -139,6 +139,10 @@ typedef struct RegallocContext {
 
     /* The last define-released hard register.  */
     JitReg last_def_released_hreg;
+
+    /* Whether hard registers have been allocated to global virtual
+       registers, which can be used before defined in a basic block.  */
+    bool has_global_hregs;
 } RegallocContext;
 
 /**
@@ -383,6 +387,9 @@ check_vreg_definition(RegallocContext *rc, JitInsn *insn)
         if (reg_defined == *regp)
             continue;
 
+        if (rc->has_global_hregs && jit_cc_is_hreg(rc->cc, *regp))
+            continue;
+
         vr = rc_get_vr(rc, *regp);
         bh_assert(vr->distances);
     }
@@ -791,8 +798,1022 @@ allocate_for_basic_block(RegallocContext *rc, JitBasicBlock *basic_block,
     return true;
 }
 
-bool
-jit_pass_regalloc(JitCompContext *cc)
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+/*
+ * The global linear scan register allocation.  Instructions are numbered
+ * in the order of their basic blocks, the uses of the n-th instruction
+ * are at position 2 * n and its definitions are at position 2 * n + 1.
+ * Virtual registers live across basic blocks (global virtual registers)
+ * get live intervals covering all their live positions, and are
+ * allocated hard registers with the linear scan algorithm of Poletto and
+ * Sarkar.  The remaining (local) virtual registers are then allocated by
+ * the local allocator above, which treats the global virtual registers
+ * as pre-colored ones.
+ */
+
+/**
+ * A range of positions.
+ */
+typedef struct LiveRange {
+    uint32 start;
+    uint32 end;
+} LiveRange;
+
+/**
+ * Ranges in which a hard register cannot be allocated to a global
+ * virtual register, because it is occupied by a pre-colored operand or
+ * clobbered by a call.
+ */
+typedef struct FixedRanges {
+    /* Number of elements in the ranges array.  */
+    uint32 num;
+
+    /* Capacity of the ranges array.  */
+    uint32 capacity;
+
+    /* The ranges.  */
+    LiveRange *ranges;
+} FixedRanges;
+
+/**
+ * Live interval of a global virtual register.
+ */
+typedef struct LiveInterval {
+    /* The global virtual register.  */
+    JitReg vreg;
+
+    /* Index of the virtual register in the liveness bitmaps.  */
+    uint32 index;
+
+    /* Positions from the first to the last live position.  */
+    LiveRange range;
+
+    /* Number of occurrences, the ones with fewer occurrences are
+       spilled first.  */
+    uint32 occurrence_num;
+
+    /* The hard register allocated, 0 if it is spilled.  */
+    JitReg hreg;
+
+    /* Frame offset of the spill slot if it is spilled.  */
+    JitReg slot_offset;
+} LiveInterval;
+
+typedef struct LinearScanContext {
+    /* The compiler context.  */
+    JitCompContext *cc;
+
+    /* Index of each virtual register in the liveness bitmaps, -1 if it
+       can't be live across basic blocks.  */
+    int32 *indexes[JIT_REG_KIND_L32];
+
+    /* Number of virtual registers in the liveness bitmaps.  */
+    uint32 index_num;
+
+    /* First and last positions of occurrences of virtual registers.  */
+    LiveRange *occurrences;
+
+    /* Number of occurrences of virtual registers.  */
+    uint32 *occurrence_nums;
+
+    /* Start and end positions of each basic block.  */
+    LiveRange *block_ranges;
+
+    /* Upward exposed uses, definitions, live-in and live-out virtual
+       registers of each basic block.  */
+    JitBitmap **use_sets;
+    JitBitmap **def_sets;
+    JitBitmap **live_in_sets;
+    JitBitmap **live_out_sets;
+
+    /* Live intervals of global virtual registers.  */
+    LiveInterval *intervals;
+    uint32 interval_num;
+
+    /* Fixed ranges of each hard register.  */
+    FixedRanges *fixed_ranges[JIT_REG_KIND_L32];
+} LinearScanContext;
+
+/**
+ * Number of hard registers of each kind kept for local virtual registers,
+ * so that the global ones don't take all registers in a basic block.
+ */
+#define LOCAL_RESERVED_HREG_NUM 3
+
+static void
+lsc_destroy(LinearScanContext *lsc)
+{
+    const unsigned label_num = jit_cc_label_num(lsc->cc);
+    unsigned i, j;
+
+    for (i = JIT_REG_KIND_VOID; i < JIT_REG_KIND_L32; i++) {
+        if (lsc->fixed_ranges[i])
+            for (j = 0; j < jit_cc_hreg_num(lsc->cc, i); j++)
+                jit_free(lsc->fixed_ranges[i][j].ranges);
+
+        jit_free(lsc->fixed_ranges[i]);
+        jit_free(lsc->indexes[i]);
+    }
+
+    for (i = 0; i < label_num; i++) {
+        if (lsc->use_sets)
+            jit_bitmap_delete(lsc->use_sets[i]);
+        if (lsc->def_sets)
+            jit_bitmap_delete(lsc->def_sets[i]);
+        if (lsc->live_in_sets)
+            jit_bitmap_delete(lsc->live_in_sets[i]);
+        if (lsc->live_out_sets)
+            jit_bitmap_delete(lsc->live_out_sets[i]);
+    }
+
+    jit_free(lsc->use_sets);
+    jit_free(lsc->def_sets);
+    jit_free(lsc->live_in_sets);
+    jit_free(lsc->live_out_sets);
+    jit_free(lsc->occurrences);
+    jit_free(lsc->occurrence_nums);
+    jit_free(lsc->block_ranges);
+    jit_free(lsc->intervals);
+}
+
+/**
+ * Get the pointer to the liveness bitmap index of the given register.
+ *
+ * @param lsc the linear scan context
+ * @param reg the register
+ *
+ * @return the pointer to the index, NULL if the register is not a
+ * virtual register allocatable by the linear scan
+ */
+static int32 *
+lsc_get_index_ptr(LinearScanContext *lsc, JitReg reg)
+{
+    if (!is_alloc_candidate(lsc->cc, reg) || jit_cc_is_hreg(lsc->cc, reg)
+        || !lsc->indexes[jit_reg_kind(reg)])
+        return NULL;
+
+    return &lsc->indexes[jit_reg_kind(reg)][jit_reg_no(reg)];
+}
+
+/**
+ * Check whether the hard register can be allocated to global virtual
+ * registers.
+ *
+ * @param cc the compilation context
+ * @param hreg the hard register
+ *
+ * @return true if the hard register is allocatable
+ */
+static bool
+is_global_allocatable(JitCompContext *cc, JitReg hreg)
+{
+    return !jit_cc_is_hreg_fixed(cc, hreg) && hreg != cc->exec_env_reg;
+}
+
+/**
+ * Get the targets of a branch instruction.  Unlike the successors of a
+ * basic block, the instruction can be in the middle of the basic block,
+ * e.g. a conditional branch to an exception basic block.
+ *
+ * @param insn the instruction
+ *
+ * @return the register vector of the targets
+ */
+static JitRegVec
+get_branch_targets(JitInsn *insn)
+{
+    JitRegVec vec;
+
+    vec.num = 0;
+    vec._base = NULL;
+    vec._stride = 1;
+
+    switch (insn->opcode) {
+        case JIT_OP_JMP:
+            vec.num = 1;
+            vec._base = jit_insn_opnd(insn, 0);
+            break;
+
+        case JIT_OP_BEQ:
+        case JIT_OP_BNE:
+        case JIT_OP_BGTS:
+        case JIT_OP_BGES:
+        case JIT_OP_BLTS:
+        case JIT_OP_BLES:
+        case JIT_OP_BGTU:
+        case JIT_OP_BGEU:
+        case JIT_OP_BLTU:
+        case JIT_OP_BLEU:
+            vec.num = 2;
+            vec._base = jit_insn_opnd(insn, 1);
+            break;
+
+        case JIT_OP_LOOKUPSWITCH:
+        {
+            JitOpndLookupSwitch *opnd = jit_insn_opndls(insn);
+            vec.num = opnd->match_pairs_num + 1;
+            vec._base = &opnd->default_target;
+            vec._stride = sizeof(opnd->match_pairs[0]) / sizeof(*vec._base);
+            break;
+        }
+
+        default:
+            vec._stride = 0;
+    }
+
+    return vec;
+}
+
+/**
+ * Number the instructions and find the virtual registers occurring in
+ * more than one basic block, which are the only ones that can be live
+ * across basic blocks.
+ *
+ * @param lsc the linear scan context
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_number_insns(LinearScanContext *lsc)
+{
+    JitCompContext *cc = lsc->cc;
+    unsigned label_index, end_label_index, kind, i;
+    JitBasicBlock *basic_block;
+    JitInsn *insn;
+    JitReg *regp;
+    int32 *index;
+    uint32 n = 0;
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++) {
+        const unsigned vreg_num = jit_cc_reg_num(cc, kind);
+
+        if (vreg_num == 0 || jit_cc_hreg_num(cc, kind) == 0)
+            continue;
+
+        if (!(lsc->indexes[kind] = jit_malloc(sizeof(int32) * vreg_num)))
+            return false;
+
+        for (i = 0; i < vreg_num; i++)
+            lsc->indexes[kind][i] = -1;
+    }
+
+    JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, label_index, end_label_index, basic_block)
+    {
+        /* Index -2 - label_index means occurring only in this block.  */
+        const int32 local_index = -2 - (int32)label_index;
+
+        lsc->block_ranges[label_index].start = 2 * (n + 1);
+
+        JIT_FOREACH_INSN(basic_block, insn)
+        {
+            JitRegVec regvec = jit_insn_opnd_regs(insn);
+
+            n++;
+
+            JIT_REG_VEC_FOREACH(regvec, i, regp)
+            if ((index = lsc_get_index_ptr(lsc, *regp))) {
+                if (*index == -1)
+                    *index = local_index;
+                else if (*index < -1 && *index != local_index)
+                    *index = lsc->index_num++;
+            }
+        }
+
+        lsc->block_ranges[label_index].end =
+            jit_basic_block_first_insn(basic_block) != basic_block
+                ? 2 * n + 1
+                : 2 * n + 2;
+    }
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++)
+        if (lsc->indexes[kind])
+            for (i = 0; i < jit_cc_reg_num(cc, kind); i++)
+                if (lsc->indexes[kind][i] < -1)
+                    lsc->indexes[kind][i] = -1;
+
+    return true;
+}
+
+/**
+ * Add a fixed range to the hard register and the hard register of the
+ * other kind sharing the same physical register, i.e. the I32 and I64
+ * (or F32 and F64) hard registers of the same number.
+ *
+ * @param lsc the linear scan context
+ * @param hreg the hard register
+ * @param start the start position of the range
+ * @param end the end position of the range
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_add_fixed_range(LinearScanContext *lsc, JitReg hreg, uint32 start,
+                    uint32 end)
+{
+    JitCompContext *cc = lsc->cc;
+    unsigned kind = jit_reg_kind(hreg), no = jit_reg_no(hreg), i;
+    unsigned kinds[2] = { kind, JIT_REG_KIND_VOID };
+
+    if (kind == JIT_REG_KIND_I32 || kind == JIT_REG_KIND_F32)
+        kinds[1] = kind + 1;
+    else if (kind == JIT_REG_KIND_I64 || kind == JIT_REG_KIND_F64)
+        kinds[1] = kind - 1;
+
+    for (i = 0; i < 2; i++) {
+        FixedRanges *fixed;
+
+        if (!lsc->fixed_ranges[kinds[i]]
+            || no >= jit_cc_hreg_num(cc, kinds[i])
+            || !is_global_allocatable(cc, jit_reg_new(kinds[i], no)))
+            continue;
+
+        fixed = &lsc->fixed_ranges[kinds[i]][no];
+
+        if (fixed->num == fixed->capacity) {
+            uint32 capacity = fixed->capacity ? fixed->capacity * 2 : 8;
+            LiveRange *ranges = jit_malloc(sizeof(LiveRange) * capacity);
+
+            if (!ranges)
+                return false;
+
+            if (fixed->ranges)
+                memcpy(ranges, fixed->ranges, sizeof(LiveRange) * fixed->num);
+
+            jit_free(fixed->ranges);
+            fixed->ranges = ranges;
+            fixed->capacity = capacity;
+        }
+
+        fixed->ranges[fixed->num].start = start;
+        fixed->ranges[fixed->num].end = end;
+        fixed->num++;
+    }
+
+    return true;
+}
+
+/**
+ * Add fixed ranges of the hard registers clobbered by a call.
+ *
+ * @param lsc the linear scan context
+ * @param is_native whether it's native ABI or JITed ABI
+ * @param pos the use position of the call instruction
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_clobber_hregs(LinearScanContext *lsc, bool is_native, uint32 pos)
+{
+    JitCompContext *cc = lsc->cc;
+    unsigned i, j;
+
+    for (i = JIT_REG_KIND_VOID; i < JIT_REG_KIND_L32; i++)
+        for (j = 0; j < jit_cc_hreg_num(cc, i); j++) {
+            JitReg hreg = jit_reg_new(i, j);
+            bool caller_saved =
+                (is_native ? jit_cc_is_hreg_caller_saved_native(cc, hreg)
+                           : jit_cc_is_hreg_caller_saved_jitted(cc, hreg));
+
+            if (caller_saved && !lsc_add_fixed_range(lsc, hreg, pos, pos + 1))
+                return false;
+        }
+
+    return true;
+}
+
+/**
+ * Collect the upward exposed uses, definitions and occurrence positions
+ * of virtual registers and the fixed ranges of hard registers in the
+ * given basic block.
+ *
+ * @param lsc the linear scan context
+ * @param basic_block the basic block
+ * @param label_index the label index of the basic block
+ * @param hreg_live_ends the last use positions of live hard registers,
+ * which must be all 0 on entry and will be all 0 on return
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_scan_basic_block(LinearScanContext *lsc, JitBasicBlock *basic_block,
+                     unsigned label_index, uint32 **hreg_live_ends)
+{
+    JitCompContext *cc = lsc->cc;
+    JitBitmap *use_set = lsc->use_sets[label_index];
+    JitBitmap *def_set = lsc->def_sets[label_index];
+    uint32 pos = lsc->block_ranges[label_index].start, kind, i;
+    JitInsn *insn;
+    JitReg *regp;
+    int32 *index;
+
+    JIT_FOREACH_INSN(basic_block, insn)
+    {
+        JitRegVec regvec = jit_insn_opnd_regs(insn);
+        unsigned first_use = jit_insn_opnd_first_use(insn);
+
+        JIT_REG_VEC_FOREACH_USE(regvec, i, regp, first_use)
+        if ((index = lsc_get_index_ptr(lsc, *regp)) && *index >= 0) {
+            if (!jit_bitmap_get_bit(def_set, *index))
+                jit_bitmap_set_bit(use_set, *index);
+            if (lsc->occurrences[*index].start > pos)
+                lsc->occurrences[*index].start = pos;
+            lsc->occurrences[*index].end = pos;
+            lsc->occurrence_nums[*index]++;
+        }
+
+        JIT_REG_VEC_FOREACH_DEF(regvec, i, regp, first_use)
+        if ((index = lsc_get_index_ptr(lsc, *regp)) && *index >= 0) {
+            jit_bitmap_set_bit(def_set, *index);
+            if (lsc->occurrences[*index].start > pos + 1)
+                lsc->occurrences[*index].start = pos + 1;
+            lsc->occurrences[*index].end = pos + 1;
+            lsc->occurrence_nums[*index]++;
+        }
+
+        pos += 2;
+    }
+
+    /* Scan backward to find the ranges of pre-colored operands.  */
+    JIT_FOREACH_INSN_REVERSE(basic_block, insn)
+    {
+        JitRegVec regvec = jit_insn_opnd_regs(insn);
+        unsigned first_use = jit_insn_opnd_first_use(insn);
+
+        pos -= 2;
+
+        JIT_REG_VEC_FOREACH_DEF(regvec, i, regp, first_use)
+        if (jit_reg_is_variable(*regp) && jit_cc_is_hreg(cc, *regp)) {
+            uint32 *live_end =
+                &hreg_live_ends[jit_reg_kind(*regp)][jit_reg_no(*regp)];
+
+            if (!lsc_add_fixed_range(lsc, *regp, pos + 1,
+                                     *live_end ? *live_end : pos + 1))
+                return false;
+            *live_end = 0;
+        }
+
+        if ((insn->opcode == JIT_OP_CALLBC || insn->opcode == JIT_OP_CALLNATIVE)
+            && !lsc_clobber_hregs(lsc, insn->opcode == JIT_OP_CALLNATIVE,
+                                  pos))
+            return false;
+
+        JIT_REG_VEC_FOREACH_USE(regvec, i, regp, first_use)
+        if (jit_reg_is_variable(*regp) && jit_cc_is_hreg(cc, *regp)) {
+            uint32 *live_end =
+                &hreg_live_ends[jit_reg_kind(*regp)][jit_reg_no(*regp)];
+
+            if (!*live_end)
+                *live_end = pos;
+        }
+    }
+
+    /* Hard registers used before defined in the block are live from the
+       beginning of the block.  */
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++)
+        for (i = 0; i < jit_cc_hreg_num(cc, kind); i++)
+            if (hreg_live_ends[kind][i]) {
+                if (!lsc_add_fixed_range(lsc, jit_reg_new(kind, i), pos,
+                                         hreg_live_ends[kind][i]))
+                    return false;
+                hreg_live_ends[kind][i] = 0;
+            }
+
+    return true;
+}
+
+/**
+ * Compute the live-in and live-out virtual registers of each basic block
+ * with the iterative backward data-flow analysis.
+ *
+ * @param lsc the linear scan context
+ */
+static void
+lsc_compute_liveness(LinearScanContext *lsc)
+{
+    JitCompContext *cc = lsc->cc;
+    const uint32 size = (lsc->index_num + 7) / 8;
+    unsigned label_index, i, j;
+    JitBasicBlock *basic_block;
+    JitInsn *insn;
+    JitReg *target;
+    bool changed;
+
+    do {
+        changed = false;
+
+        JIT_FOREACH_BLOCK_REVERSE_ENTRY_EXIT(cc, label_index, basic_block)
+        {
+            uint8 *use = lsc->use_sets[label_index - 1]->map;
+            uint8 *def = lsc->def_sets[label_index - 1]->map;
+            uint8 *live_in = lsc->live_in_sets[label_index - 1]->map;
+            uint8 *live_out = lsc->live_out_sets[label_index - 1]->map;
+
+            JIT_FOREACH_INSN(basic_block, insn)
+            {
+                JitRegVec targets = get_branch_targets(insn);
+
+                JIT_REG_VEC_FOREACH(targets, i, target)
+                if (jit_reg_is_kind(L32, *target)
+                    && *(jit_annl_basic_block(cc, *target))) {
+                    uint8 *succ_live_in =
+                        lsc->live_in_sets[jit_reg_no(*target)]->map;
+
+                    for (j = 0; j < size; j++)
+                        live_out[j] |= succ_live_in[j];
+                }
+            }
+
+            for (j = 0; j < size; j++) {
+                uint8 new_live_in = use[j] | (live_out[j] & ~def[j]);
+
+                if (new_live_in != live_in[j]) {
+                    live_in[j] = new_live_in;
+                    changed = true;
+                }
+            }
+        }
+    } while (changed);
+}
+
+/**
+ * Build the live intervals of the virtual registers live across basic
+ * blocks.
+ *
+ * @param lsc the linear scan context
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_build_intervals(LinearScanContext *lsc)
+{
+    JitCompContext *cc = lsc->cc;
+    unsigned label_index, end_label_index, kind, i;
+    JitBasicBlock *basic_block;
+    LiveInterval *interval;
+
+    if (!(lsc->intervals = jit_calloc(sizeof(LiveInterval) * lsc->index_num)))
+        return false;
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++) {
+        if (!lsc->indexes[kind])
+            continue;
+
+        for (i = 0; i < jit_cc_reg_num(cc, kind); i++) {
+            int32 index = lsc->indexes[kind][i];
+            bool is_global = false;
+
+            if (index < 0)
+                continue;
+
+            interval = &lsc->intervals[lsc->interval_num];
+            interval->vreg = jit_reg_new(kind, i);
+            interval->index = index;
+            interval->range = lsc->occurrences[index];
+            interval->occurrence_num = lsc->occurrence_nums[index];
+
+            JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, label_index, end_label_index,
+                                         basic_block)
+            {
+                LiveRange *block_range = &lsc->block_ranges[label_index];
+
+                if (jit_bitmap_get_bit(lsc->live_in_sets[label_index], index)
+                    || jit_bitmap_get_bit(lsc->live_out_sets[label_index],
+                                          index)) {
+                    is_global = true;
+                    if (interval->range.start > block_range->start)
+                        interval->range.start = block_range->start;
+                    if (interval->range.end < block_range->end)
+                        interval->range.end = block_range->end;
+                }
+            }
+
+            if (is_global)
+                lsc->interval_num++;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Check whether the hard register is occupied by its fixed ranges in
+ * the given range.
+ */
+static bool
+is_hreg_fixed_in_range(LinearScanContext *lsc, JitReg hreg,
+                       const LiveRange *range)
+{
+    const FixedRanges *fixed =
+        &lsc->fixed_ranges[jit_reg_kind(hreg)][jit_reg_no(hreg)];
+    uint32 i;
+
+    for (i = 0; i < fixed->num; i++)
+        if (fixed->ranges[i].start <= range->end
+            && range->start <= fixed->ranges[i].end)
+            return true;
+
+    return false;
+}
+
+static bool
+is_cheaper_to_spill(const LiveInterval *a, const LiveInterval *b)
+{
+    return a->occurrence_num < b->occurrence_num
+           || (a->occurrence_num == b->occurrence_num
+               && a->range.end > b->range.end);
+}
+
+static int
+compare_interval_start(const void *a, const void *b)
+{
+    uint32 start_a = ((const LiveInterval *)a)->range.start;
+    uint32 start_b = ((const LiveInterval *)b)->range.start;
+
+    return start_a < start_b ? -1 : (start_a > start_b ? 1 : 0);
+}
+
+/**
+ * Allocate hard registers to the live intervals, the intervals that
+ * can't get a hard register are spilled to the frame.
+ *
+ * @param lsc the linear scan context
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_allocate_intervals(LinearScanContext *lsc)
+{
+    JitCompContext *cc = lsc->cc;
+    LiveInterval **active, *cur, *spill;
+    uint32 active_num = 0, active_nums[JIT_REG_KIND_L32] = { 0 };
+    uint32 max_active_nums[JIT_REG_KIND_L32] = { 0 };
+    unsigned kind, i, j;
+
+    if (!(active = jit_malloc(sizeof(LiveInterval *) * lsc->interval_num)))
+        return false;
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++) {
+        for (i = 0; i < jit_cc_hreg_num(cc, kind); i++)
+            if (is_global_allocatable(cc, jit_reg_new(kind, i)))
+                max_active_nums[kind]++;
+
+        max_active_nums[kind] = max_active_nums[kind] > LOCAL_RESERVED_HREG_NUM
+                                    ? max_active_nums[kind]
+                                          - LOCAL_RESERVED_HREG_NUM
+                                    : 0;
+    }
+
+    qsort(lsc->intervals, lsc->interval_num, sizeof(LiveInterval),
+          compare_interval_start);
+
+    for (i = 0; i < lsc->interval_num; i++) {
+        JitReg hreg = 0;
+
+        cur = &lsc->intervals[i];
+        kind = jit_reg_kind(cur->vreg);
+
+        /* Expire the active intervals ending before the current one.  */
+        for (j = 0; j < active_num;) {
+            if (active[j]->range.end < cur->range.start) {
+                active_nums[jit_reg_kind(active[j]->vreg)]--;
+                active[j] = active[--active_num];
+            }
+            else
+                j++;
+        }
+
+        if (active_nums[kind] < max_active_nums[kind]) {
+            /* Find a hard register neither used by the active intervals
+               nor occupied by fixed ranges in the current interval.  */
+            for (j = 0; j < jit_cc_hreg_num(cc, kind) && !hreg; j++) {
+                unsigned k;
+
+                hreg = jit_reg_new(kind, j);
+
+                if (!is_global_allocatable(cc, hreg)
+                    || is_hreg_fixed_in_range(lsc, hreg, &cur->range)) {
+                    hreg = 0;
+                    continue;
+                }
+
+                for (k = 0; k < active_num; k++)
+                    if (active[k]->hreg == hreg) {
+                        hreg = 0;
+                        break;
+                    }
+            }
+        }
+
+        if (hreg) {
+            cur->hreg = hreg;
+            active[active_num++] = cur;
+            active_nums[kind]++;
+            continue;
+        }
+
+        /* Spill the interval with the fewest occurrences (the one ending
+           last if they are equal), whose hard register is taken by the
+           current one if it's not the current one.  */
+        spill = cur;
+        for (j = 0; j < active_num; j++)
+            if ((unsigned)jit_reg_kind(active[j]->vreg) == kind
+                && is_cheaper_to_spill(active[j], spill)
+                && !is_hreg_fixed_in_range(lsc, active[j]->hreg, &cur->range))
+                spill = active[j];
+
+        if (spill != cur) {
+            cur->hreg = spill->hreg;
+            spill->hreg = 0;
+            for (j = 0; active[j] != spill; j++)
+                ;
+            active[j] = cur;
+        }
+    }
+
+    jit_free(active);
+
+    /* Allocate spill slots from the end of the spill cache, and shrink
+       the spill cache for the local allocation accordingly.  */
+    for (i = 0; i < lsc->interval_num; i++) {
+        const unsigned stride = get_reg_stride(lsc->intervals[i].vreg);
+        uint32 slot = cc->spill_cache_size / 4;
+
+        if (lsc->intervals[i].hreg)
+            continue;
+
+        if (stride == 0 || slot < stride) {
+            jit_set_last_error(cc, "no frame space for spill slots");
+            return false;
+        }
+
+        slot = (slot - stride) & ~(stride - 1);
+        cc->spill_cache_size = slot * 4;
+        lsc->intervals[i].slot_offset =
+            jit_cc_new_const_I32(cc, cc->spill_cache_offset + slot * 4);
+    }
+
+    return true;
+}
+
+/**
+ * Create an instruction to load or store the spilled global virtual
+ * register from or to its spill slot.
+ */
+static JitInsn *
+new_spill_slot_insn(JitCompContext *cc, LiveInterval *interval, bool is_load)
+{
+    JitReg vreg = interval->vreg, fp_reg = cc->fp_reg;
+    JitReg offset = interval->slot_offset;
+
+    switch (jit_reg_kind(vreg)) {
+        case JIT_REG_KIND_I32:
+            if (is_load)
+                return jit_cc_new_insn(cc, LDI32, vreg, fp_reg, offset);
+            return jit_cc_new_insn(cc, STI32, vreg, fp_reg, offset);
+        case JIT_REG_KIND_I64:
+            if (is_load)
+                return jit_cc_new_insn(cc, LDI64, vreg, fp_reg, offset);
+            return jit_cc_new_insn(cc, STI64, vreg, fp_reg, offset);
+        case JIT_REG_KIND_F32:
+            if (is_load)
+                return jit_cc_new_insn(cc, LDF32, vreg, fp_reg, offset);
+            return jit_cc_new_insn(cc, STF32, vreg, fp_reg, offset);
+        case JIT_REG_KIND_F64:
+            if (is_load)
+                return jit_cc_new_insn(cc, LDF64, vreg, fp_reg, offset);
+            return jit_cc_new_insn(cc, STF64, vreg, fp_reg, offset);
+        default:
+            bh_assert(0);
+            return NULL;
+    }
+}
+
+/**
+ * Rewrite the global virtual registers in instructions: the allocated
+ * ones are replaced with their hard registers, and the spilled ones are
+ * loaded before each use and stored after each definition so that they
+ * become local virtual registers.
+ *
+ * @param lsc the linear scan context
+ * @param intervals the live interval of each liveness bitmap index
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_rewrite_insns(LinearScanContext *lsc, LiveInterval **intervals)
+{
+    JitCompContext *cc = lsc->cc;
+    unsigned label_index, end_label_index, i;
+    JitBasicBlock *basic_block;
+    JitInsn *insn, *new_insn;
+    JitReg *regp;
+    int32 *index;
+
+    JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, label_index, end_label_index, basic_block)
+    {
+        JIT_FOREACH_INSN(basic_block, insn)
+        {
+            JitRegVec regvec = jit_insn_opnd_regs(insn);
+            unsigned first_use = jit_insn_opnd_first_use(insn);
+            LiveInterval *spilled_def = NULL, *spilled_use = NULL;
+
+            JIT_REG_VEC_FOREACH(regvec, i, regp)
+            {
+                LiveInterval *interval;
+
+                if (!(index = lsc_get_index_ptr(lsc, *regp)) || *index < 0
+                    || !(interval = intervals[*index]))
+                    continue;
+
+                if (interval->hreg)
+                    *regp = interval->hreg;
+                else if (i < first_use)
+                    spilled_def = interval;
+                else if (spilled_use != interval) {
+                    if (!(new_insn = new_spill_slot_insn(cc, interval, true)))
+                        return false;
+                    jit_insn_insert_before(insn, new_insn);
+                    spilled_use = interval;
+                }
+            }
+
+            if (spilled_def) {
+                if (!(new_insn = new_spill_slot_insn(cc, spilled_def, false)))
+                    return false;
+                jit_insn_insert_after(insn, new_insn);
+                /* Skip the store instruction.  */
+                insn = new_insn;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Run the global part of the linear scan register allocation.
+ *
+ * @param lsc the linear scan context
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+lsc_allocate_global_vregs(LinearScanContext *lsc)
+{
+    JitCompContext *cc = lsc->cc;
+    const unsigned label_num = jit_cc_label_num(cc);
+    uint32 *hreg_live_ends[JIT_REG_KIND_L32] = { 0 };
+    LiveInterval **intervals = NULL;
+    unsigned label_index, end_label_index, kind, i;
+    JitBasicBlock *basic_block;
+    bool retval = false;
+
+    if (!(lsc->block_ranges = jit_calloc(sizeof(LiveRange) * label_num)))
+        return false;
+
+    if (!lsc_number_insns(lsc))
+        return false;
+
+    if (lsc->index_num == 0)
+        /* No virtual register can be live across basic blocks.  */
+        return true;
+
+    if (!(lsc->occurrences = jit_malloc(sizeof(LiveRange) * lsc->index_num))
+        || !(lsc->occurrence_nums =
+                 jit_calloc(sizeof(uint32) * lsc->index_num))
+        || !(lsc->use_sets = jit_calloc(sizeof(JitBitmap *) * label_num))
+        || !(lsc->def_sets = jit_calloc(sizeof(JitBitmap *) * label_num))
+        || !(lsc->live_in_sets = jit_calloc(sizeof(JitBitmap *) * label_num))
+        || !(lsc->live_out_sets = jit_calloc(sizeof(JitBitmap *) * label_num)))
+        return false;
+
+    for (i = 0; i < lsc->index_num; i++) {
+        lsc->occurrences[i].start = UINT32_MAX;
+        lsc->occurrences[i].end = 0;
+    }
+
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++) {
+        const unsigned hreg_num = jit_cc_hreg_num(cc, kind);
+
+        if (hreg_num > 0
+            && (!(lsc->fixed_ranges[kind] =
+                      jit_calloc(sizeof(FixedRanges) * hreg_num))
+                || !(hreg_live_ends[kind] =
+                         jit_calloc(sizeof(uint32) * hreg_num))))
+            goto cleanup_and_return;
+    }
+
+    JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, label_index, end_label_index, basic_block)
+    {
+        if (!(lsc->use_sets[label_index] = jit_bitmap_new(0, lsc->index_num))
+            || !(lsc->def_sets[label_index] =
+                     jit_bitmap_new(0, lsc->index_num))
+            || !(lsc->live_in_sets[label_index] =
+                     jit_bitmap_new(0, lsc->index_num))
+            || !(lsc->live_out_sets[label_index] =
+                     jit_bitmap_new(0, lsc->index_num)))
+            goto cleanup_and_return;
+
+        if (!lsc_scan_basic_block(lsc, basic_block, label_index,
+                                  hreg_live_ends))
+            goto cleanup_and_return;
+    }
+
+    lsc_compute_liveness(lsc);
+
+    if (!lsc_build_intervals(lsc) || !lsc_allocate_intervals(lsc))
+        goto cleanup_and_return;
+
+    if (!(intervals = jit_calloc(sizeof(LiveInterval *) * lsc->index_num)))
+        goto cleanup_and_return;
+
+    for (i = 0; i < lsc->interval_num; i++)
+        intervals[lsc->intervals[i].index] = &lsc->intervals[i];
+
+    retval = lsc_rewrite_insns(lsc, intervals);
+
+cleanup_and_return:
+    jit_free(intervals);
+    for (kind = JIT_REG_KIND_VOID; kind < JIT_REG_KIND_L32; kind++)
+        jit_free(hreg_live_ends[kind]);
+
+    return retval;
+}
+
+/**
+ * Occupy the hard registers allocated to the global virtual registers
+ * live out of the basic block before its local allocation.
+ */
+static void
+lsc_occupy_live_out_hregs(LinearScanContext *lsc, RegallocContext *rc,
+                          unsigned label_index)
+{
+    uint32 i;
+
+    for (i = 0; i < lsc->interval_num; i++) {
+        JitReg hreg = lsc->intervals[i].hreg;
+
+        if (hreg
+            && jit_bitmap_get_bit(lsc->live_out_sets[label_index],
+                                  lsc->intervals[i].index)) {
+            (rc_get_vr(rc, hreg))->hreg = hreg;
+            (rc_get_hr(rc, hreg))->vreg = hreg;
+        }
+    }
+}
+
+/**
+ * Release the hard registers allocated to the global virtual registers
+ * live into the basic block after its local allocation.  If such a
+ * register was evicted by local virtual registers in the block, it is
+ * spilled at the beginning of the block for the reloads.
+ */
+static bool
+lsc_release_live_in_hregs(LinearScanContext *lsc, RegallocContext *rc,
+                          JitBasicBlock *basic_block, unsigned label_index)
+{
+    uint32 i;
+
+    for (i = 0; i < lsc->interval_num; i++) {
+        JitReg hreg = lsc->intervals[i].hreg;
+        VirtualReg *vr;
+
+        if (!hreg
+            || !jit_bitmap_get_bit(lsc->live_in_sets[label_index],
+                                   lsc->intervals[i].index))
+            continue;
+
+        vr = rc_get_vr(rc, hreg);
+
+        if (vr->slot) {
+            vr->hreg = hreg;
+            if (!spill_vreg(rc, hreg, basic_block))
+                return false;
+            rc_free_spill_slot(rc, vr->slot);
+        }
+
+        if ((rc_get_hr(rc, hreg))->vreg == hreg)
+            (rc_get_hr(rc, hreg))->vreg = 0;
+        vr->hreg = vr->slot = 0;
+    }
+
+    return true;
+}
+#else
+typedef struct LinearScanContext LinearScanContext;
+#endif /* end of WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0 */
+
+/**
+ * Do local register allocation for all basic blocks.
+ *
+ * @param cc the compilation context
+ * @param lsc the linear scan context if global virtual registers have
+ * been allocated, NULL otherwise
+ *
+ * @return true if succeeds, false otherwise
+ */
+static bool
+allocate_for_basic_blocks(JitCompContext *cc, LinearScanContext *lsc)
 {
     RegallocContext rc = { 0 };
     unsigned label_index, end_label_index;
@@ -809,6 +1830,9 @@ jit_pass_regalloc(JitCompContext *cc)
     /* TODO: allocate hard registers for global virtual registers here.
        Currently, exec_env_reg is the only global virtual register.  */
     self_vr = rc_get_vr(&rc, cc->exec_env_reg);
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    rc.has_global_hregs = lsc && lsc->interval_num > 0;
+#endif
 
     JIT_FOREACH_BLOCK_ENTRY_EXIT(cc, label_index, end_label_index, basic_block)
     {
@@ -818,6 +1842,11 @@ jit_pass_regalloc(JitCompContext *cc)
         self_vr->hreg = self_vr->global_hreg;
         (rc_get_hr(&rc, cc->exec_env_reg))->vreg = cc->exec_env_reg;
 
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+        if (lsc && lsc->live_out_sets)
+            lsc_occupy_live_out_hregs(lsc, &rc, label_index);
+#endif
+
         /**
          * TODO: the allocation of a basic block keeps using vregs[]
          * and hregs[] from previous basic block
@@ -829,6 +1858,11 @@ jit_pass_regalloc(JitCompContext *cc)
             goto cleanup_and_return;
 
         /* TODO: generate necessary spills for live-in registers.  */
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+        if (lsc && lsc->live_in_sets
+            && !lsc_release_live_in_hregs(lsc, &rc, basic_block, label_index))
+            goto cleanup_and_return;
+#endif
     }
 
     retval = true;
@@ -838,3 +1872,27 @@ cleanup_and_return:
 
     return retval;
 }
+
+bool
+jit_pass_regalloc(JitCompContext *cc)
+{
+    return allocate_for_basic_blocks(cc, NULL);
+}
+
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+bool
+jit_pass_regalloc_linear_scan(JitCompContext *cc)
+{
+    LinearScanContext lsc = { 0 };
+    bool retval;
+
+    lsc.cc = cc;
+
+    retval = lsc_allocate_global_vregs(&lsc)
+             && allocate_for_basic_blocks(cc, &lsc);
+
+    lsc_destroy(&lsc);
+
+    return retval;
+}
+#endif
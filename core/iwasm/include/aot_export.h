@@ -61,6 +61,10 @@ typedef struct AOTCompOption {
     uint32_t bounds_checks;
     char **custom_sections;
     uint32_t custom_sections_count;
+    uint32_t thread_num;
+    char *cache_dir;
+    bool enable_llvm_pgo;
+    char *use_prof_file;
 } AOTCompOption, *aot_comp_option_t;
 
 aot_comp_context_t
@@ -85,6 +89,23 @@ aot_emit_aot_file(aot_comp_context_t comp_ctx, aot_comp_data_t comp_data,
 void
 aot_destroy_aot_file(uint8_t *aot_file);
 
+typedef struct AOTBundleModule {
+    /* The module name which the other modules import it with,
+       NULL if the module isn't imported by the others */
+    const char *name;
+    const uint8_t *buf;
+    uint32_t size;
+} AOTBundleModule;
+
+/**
+ * Link the wasm modules into one wasm module, the imports between them
+ * are resolved, and the last module is the main module whose exports are
+ * kept. The result is allocated with wasm_runtime_malloc.
+ */
+uint8_t *
+aot_bundle_wasm_modules(const AOTBundleModule *modules, uint32_t module_count,
+                        uint32_t *p_bundle_size);
+
 char *
 aot_get_last_error();
 
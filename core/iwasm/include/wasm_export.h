@@ -128,6 +128,54 @@ typedef struct mem_alloc_info_t {
     uint32_t highmark_size;
 } mem_alloc_info_t;
 
+/* Fast JIT code cache info */
+typedef struct fast_jit_code_cache_info_t {
+    /* Size of the code cache pool */
+    uint32_t total_size;
+    /* Total size of the free chunks in the pool */
+    uint32_t total_free_size;
+    /* Size of the largest free chunk, a function whose code is larger
+       can't be compiled without evicting other functions */
+    uint32_t max_free_size;
+    /* Percentage of the free space not in the largest free chunk */
+    uint32_t fragmentation;
+    /* Number of the functions whose jitted code is in the pool */
+    uint32_t jitted_func_count;
+    /* Total size of the jitted code of these functions */
+    uint32_t jitted_code_size;
+    /* Number of the functions evicted back to the interpreter, only
+       used when WASM_ENABLE_FAST_JIT_TIER_UP is defined */
+    uint32_t evicted_func_count;
+    /* Size of the evicted code which is still in use by some thread
+       and will be freed after the thread leaves the jitted code */
+    uint32_t retired_code_size;
+} fast_jit_code_cache_info_t;
+
+/* Optional IR optimization passes of Fast JIT, which can be combined
+   in RuntimeInitArgs.fast_jit_opt_passes */
+/* Fold the constant expressions */
+#define FAST_JIT_OPT_CONST_FOLD 0x1
+/* Reuse the values computed earlier in the same basic block */
+#define FAST_JIT_OPT_CSE 0x2
+/* Remove the computations whose results are unused */
+#define FAST_JIT_OPT_DCE 0x4
+/* Remove the linear memory bounds checks implied by earlier ones */
+#define FAST_JIT_OPT_BOUND_CHECK_ELIM 0x8
+#define FAST_JIT_OPT_ALL 0xF
+
+/* Statistics of a Fast JIT compiler pass */
+typedef struct fast_jit_pass_stats_t {
+    /* Name of the pass */
+    const char *name;
+    /* Number of the functions the pass was applied to */
+    uint32_t run_count;
+    /* Total time spent in the pass, in microseconds */
+    uint64_t total_time_us;
+    /* Total number of the instructions changed or removed by the pass,
+       always 0 for the passes which aren't optimizations */
+    uint64_t change_count;
+} fast_jit_pass_stats_t;
+
 /* WASM runtime initialize arguments */
 typedef struct RuntimeInitArgs {
     mem_alloc_type_t mem_alloc_type;
@@ -149,6 +197,43 @@ typedef struct RuntimeInitArgs {
 
     /* Fast JIT code cache size */
     uint32_t fast_jit_code_cache_size;
+
+    /* Hotness threshold of a function to trigger Fast JIT compilation,
+       only used when WASM_ENABLE_FAST_JIT_TIER_UP is defined, 0 means
+       using the default threshold */
+    uint32_t fast_jit_tier_up_threshold;
+
+    /* Number of the threads to compile functions with Fast JIT in
+       background, 0 means compiling in the thread which loads the module
+       or, in tier-up mode, runs the hot function */
+    uint32_t fast_jit_compile_thread_num;
+
+    /* Use the global linear scan register allocator of Fast JIT, which
+       keeps values live across basic blocks in hard registers, only used
+       when the runtime is built with WAMR_BUILD_FAST_JIT_LINEAR_SCAN=1 */
+    bool fast_jit_linear_scan_regalloc;
+
+    /* Existing directory to save the Fast JIT jitted code of functions
+       into and load it from in the later runs, only used when
+       WASM_ENABLE_FAST_JIT_DISK_CACHE is defined, NULL means disabled */
+    const char *fast_jit_disk_cache_dir;
+
+    /* Optional IR optimization passes of Fast JIT, a combination of
+       FAST_JIT_OPT_XXX, 0 means none */
+    uint32_t fast_jit_opt_passes;
+
+    /* Existing directory to save the object files compiled by LLVM JIT
+       into and load them from in the later runs, only used when
+       WASM_ENABLE_JIT is defined, NULL means disabled. The string isn't
+       copied and should be kept valid until the runtime is destroyed */
+    const char *llvm_jit_object_cache_dir;
+
+    /* Number of the threads to validate and prepare the function bodies
+       of a wasm file with in wasm_runtime_load, 0 or 1 means loading them
+       one by one in the calling thread. The result, including the error
+       message reported for an invalid module, is the same as loading
+       them one by one */
+    uint32_t loader_thread_num;
 } RuntimeInitArgs;
 
 #ifndef WASM_VALKIND_T_DEFINED
@@ -242,6 +327,44 @@ wasm_runtime_free(void *ptr);
 WASM_RUNTIME_API_EXTERN bool
 wasm_runtime_get_mem_alloc_info(mem_alloc_info_t *mem_alloc_info);
 
+/**
+ * Get the occupancy and fragmentation info of Fast JIT code cache.
+ *
+ * @param info [out] the code cache info
+ *
+ * @return true if success, false if Fast JIT isn't enabled
+ */
+WASM_RUNTIME_API_EXTERN bool
+wasm_runtime_get_fast_jit_code_cache_info(fast_jit_code_cache_info_t *info);
+
+/**
+ * Get the statistics of the Fast JIT compiler passes, which are
+ * accumulated since the runtime was initialized, to trade the
+ * compilation time off against the code quality of the optional
+ * optimization passes.
+ *
+ * @param stats [out] the array to receive the statistics of the passes
+ *        in the order they are registered, can be NULL
+ * @param count the number of elements of the array
+ *
+ * @return the number of the passes, which may be larger than count,
+ *         0 if Fast JIT isn't enabled
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_get_fast_jit_pass_stats(fast_jit_pass_stats_t *stats,
+                                     uint32_t count);
+
+/**
+ * Get the size of the Fast JIT code cache used by a module.
+ *
+ * @param module the WASM module
+ *
+ * @return the total size of the jitted code of the module's functions
+ *         which are in the code cache, 0 if Fast JIT isn't enabled
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_get_fast_jit_code_size(const wasm_module_t module);
+
 /**
  * Get the package type of a buffer.
  *
@@ -335,6 +458,24 @@ WASM_RUNTIME_API_EXTERN wasm_module_t
 wasm_runtime_load(uint8_t *buf, uint32_t size,
                   char *error_buf, uint32_t error_buf_size);
 
+/**
+ * Load a WASM module by mapping an AOT file into memory rather than
+ * reading it into a buffer. If the AOT file is generated by wamrc with
+ * --enable-indirect-mode, its code is executed in place from the mapped
+ * file, so the processes loading the same AOT file share one physical
+ * copy of the code. It is supported on Linux and MacOS currently.
+ *
+ * @param file_path the path of the AOT file, the file is unmapped
+ *        when wasm_runtime_unload is called
+ * @param error_buf output of the exception info
+ * @param error_buf_size the size of the exception string
+ *
+ * @return return WASM module loaded, NULL if failed
+ */
+WASM_RUNTIME_API_EXTERN wasm_module_t
+wasm_runtime_load_mapped_aot_file(const char *file_path,
+                                  char *error_buf, uint32_t error_buf_size);
+
 /**
  * Load a WASM module from a specified WASM or AOT section list.
  *
@@ -1021,6 +1162,75 @@ wasm_runtime_dump_mem_consumption(wasm_exec_env_t exec_env);
 WASM_RUNTIME_API_EXTERN void
 wasm_runtime_dump_perf_profiling(wasm_module_inst_t module_inst);
 
+/**
+ * Get the size of the profile data recorded by the PGO instrumented
+ * AOT module, which is generated by wamrc with --enable-llvm-pgo
+ *
+ * @param module_inst the AOT module instance
+ *
+ * @return the size of the profile data, 0 if the module isn't
+ *         instrumented
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_get_pgo_prof_data_size(wasm_module_inst_t module_inst);
+
+/**
+ * Dump the profile data recorded by the PGO instrumented AOT module
+ * to the buffer, the data can be saved to a file and then be used by
+ * wamrc with --use-prof=<file> to optimize the AOT module
+ *
+ * @param module_inst the AOT module instance
+ * @param buf the buffer to store the profile data
+ * @param len the length of the buffer
+ *
+ * @return the size of the profile data dumped, 0 if failed
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_dump_pgo_prof_data_to_buf(wasm_module_inst_t module_inst,
+                                       char *buf, uint32_t len);
+
+/**
+ * Start the sampling profiler, which samples the wasm call stacks of
+ * all the threads running wasm code periodically, the runtime must be
+ * built with WAMR_BUILD_SAMPLING_PROFILER=1
+ *
+ * @param interval_us the sampling interval in microseconds of the CPU
+ *        time, 0 to use the default interval
+ *
+ * @return true if success, false otherwise
+ */
+WASM_RUNTIME_API_EXTERN bool
+wasm_runtime_start_sampling_profiler(uint32_t interval_us);
+
+/**
+ * Stop the sampling profiler, the samples recorded are kept until the
+ * profiler is started again
+ */
+WASM_RUNTIME_API_EXTERN void
+wasm_runtime_stop_sampling_profiler(void);
+
+/**
+ * Get the size of the profile recorded by the sampling profiler
+ *
+ * @return the size of the profile, 0 if no sample is recorded
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_get_sampling_profile_size(void);
+
+/**
+ * Dump the profile recorded by the sampling profiler to the buffer in
+ * the folded stack format, each line is the function names from the
+ * outermost frame separated by ';', and then a space and the sample
+ * count, which can be used by flamegraph.pl to generate a flame graph
+ *
+ * @param buf the buffer to store the profile
+ * @param len the length of the buffer
+ *
+ * @return the size of the profile dumped, 0 if failed
+ */
+WASM_RUNTIME_API_EXTERN uint32_t
+wasm_runtime_dump_sampling_profile_to_buf(char *buf, uint32_t len);
+
 /* wasm thread callback function type */
 typedef void *(*wasm_thread_callback_t)(wasm_exec_env_t, void *);
 /* wasm thread type */
@@ -22,6 +22,7 @@ endif ()
 file (GLOB_RECURSE source_all
     ${IWASM_INTERP_DIR}/${LOADER}
     ${IWASM_INTERP_DIR}/wasm_runtime.c
+    ${IWASM_INTERP_DIR}/wasm_simd.c
     ${IWASM_INTERP_DIR}/${INTERPRETER}
 )
 
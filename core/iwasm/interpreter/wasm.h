@@ -183,6 +183,8 @@ typedef struct WASMFunctionImport {
     const char *signature;
     /* attachment */
     void *attachment;
+    /* call shape of the native, 0 if it is called by invokeNative */
+    uint32 call_shape;
     bool call_conv_raw;
 #if WASM_ENABLE_MULTI_MODULE != 0
     WASMModule *import_module;
@@ -226,6 +228,18 @@ typedef struct WASMImport {
     } u;
 } WASMImport;
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+typedef struct BlockAddrEntry {
+    /* Offset of the block's code after the block type to the function's
+       code, 0 if the slot is empty */
+    uint32 start_offset;
+    /* Offsets of the block's else and end opcodes to the function's code,
+       else_offset is 0 if there is no else branch */
+    uint32 else_offset;
+    uint32 end_offset;
+} BlockAddrEntry;
+#endif
+
 struct WASMFunction {
 #if WASM_ENABLE_CUSTOM_NAME_SECTION != 0
     char *field_name;
@@ -254,6 +268,12 @@ struct WASMFunction {
     bool has_op_func_call;
     uint32 code_size;
     uint8 *code;
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    /* Hash table of the else and end addresses of the blocks, indexed
+       by the block's start offset and mask, NULL if not built */
+    BlockAddrEntry *block_addr_table;
+    uint32 block_addr_table_mask;
+#endif
 #if WASM_ENABLE_FAST_INTERP != 0
     uint32 code_compiled_size;
     uint8 *code_compiled;
@@ -262,6 +282,20 @@ struct WASMFunction {
 #endif
 #if WASM_ENABLE_FAST_JIT != 0
     void *fast_jit_jitted_code;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Call count plus loop back-edge count in interpreter */
+    uint32 hotness;
+    /* Whether the function is queued or being compiled by Fast JIT,
+       protected by the tier-up lock or the compile queue lock */
+    bool tier_up_queued;
+    /* Whether Fast JIT failed to compile the function, it then keeps
+       running in interpreter */
+    bool tier_up_failed;
+#endif
+#if WASM_ENABLE_JIT != 0
+    /* Call count in Fast JIT code */
+    uint32 llvm_jit_hotness;
+#endif
 #endif
 #if WASM_ENABLE_JIT != 0
     void *llvm_jit_func_ptr;
@@ -457,10 +491,28 @@ struct WASMModule {
     /* Whether there is possible memory grow, e.g. memory.grow opcode */
     bool possible_memory_grow;
 
+    /* Whether the tables may be changed after instantiation, e.g. by
+       table.set, table.grow, table.fill, table.copy or table.init */
+    bool possible_table_mutation;
+
     StringList const_str_list;
 #if WASM_ENABLE_FAST_INTERP == 0
     bh_list br_table_cache_list_head;
     bh_list *br_table_cache_list;
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    /* Total size of the block address tables of the functions */
+    uint32 block_addr_table_size;
+#endif
+    /* lock to insert the br_table caches and to account the size of the
+       block address tables when the functions are prepared with multiple
+       loader threads */
+    korp_mutex prepare_lock;
+#endif
+
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    /* lock to translate the bytecode of the functions when they are
+       called the first time */
+    korp_mutex lazy_prepare_lock;
 #endif
 
 #if WASM_ENABLE_LIBC_WASI != 0
@@ -479,7 +531,7 @@ struct WASMModule {
     uint64 buf_code_size;
 #endif
 #if WASM_ENABLE_DEBUG_INTERP != 0 || WASM_ENABLE_DEBUG_AOT != 0 \
-    || WASM_ENABLE_FAST_JIT != 0
+    || WASM_ENABLE_FAST_JIT != 0 || WASM_ENABLE_JIT != 0
     uint8 *load_addr;
     uint64 load_size;
 #endif
@@ -510,6 +562,13 @@ struct WASMModule {
 #if WASM_ENABLE_FAST_JIT != 0
     /* func pointers of Fast JITed (un-imported) functions */
     void **fast_jit_func_ptrs;
+    /* Size of the jitted code of the functions in the code cache */
+    uint32 fast_jit_code_size;
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    /* Hash of the module content which identifies the module in the
+       disk cache, 0 if the module isn't cached */
+    uint64 fast_jit_module_hash;
+#endif
 #endif
 
 #if WASM_ENABLE_JIT != 0
@@ -522,6 +581,22 @@ struct WASMModule {
     bool orcjit_stop_compiling;
     korp_tid orcjit_threads[WASM_ORC_JIT_BACKEND_THREAD_NUM];
     OrcJitThreadArg orcjit_thread_args[WASM_ORC_JIT_BACKEND_THREAD_NUM];
+#if WASM_ENABLE_FAST_JIT != 0
+    /* whether the functions are requested to be compiled by LLVM JIT */
+    bool *tier_up_requested;
+    /* queue of the functions hot in Fast JIT code, each function is
+       pushed at most once, so function_count entries are enough */
+    uint32 *tier_up_queue;
+    uint32 tier_up_queue_head;
+    uint32 tier_up_queue_tail;
+    korp_mutex tier_up_lock;
+    korp_cond tier_up_cond;
+    /* the LLVM IR is generated by the compile threads when the first
+       function is queued, these are protected by tier_up_lock */
+    bool llvm_ir_generating;
+    bool llvm_ir_generated;
+    bool llvm_ir_failed;
+#endif
 #endif
 };
 
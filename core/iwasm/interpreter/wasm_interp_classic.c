@@ -12,12 +12,16 @@
 #if WASM_ENABLE_SHARED_MEMORY != 0
 #include "../common/wasm_shared_memory.h"
 #endif
+#if WASM_ENABLE_SIMD != 0
+#include "wasm_simd.h"
+#endif
 #if WASM_ENABLE_THREAD_MGR != 0 && WASM_ENABLE_DEBUG_INTERP != 0
 #include "../libraries/thread-mgr/thread_manager.h"
 #include "../libraries/debug-engine/debug_engine.h"
 #endif
 #if WASM_ENABLE_FAST_JIT != 0
 #include "../fast-jit/jit_compiler.h"
+#include "../fast-jit/jit_codecache.h"
 #endif
 
 typedef int32 CellType_I32;
@@ -872,6 +876,11 @@ wasm_interp_call_func_native(WASMModuleInstance *module_inst,
             argv_ret[1] = frame->lp[1];
         }
     }
+    else if (func_import->call_shape) {
+        ret = wasm_runtime_invoke_native_shape(
+            exec_env, native_func_pointer, func_import->call_shape,
+            func_import->attachment, frame->lp, argv_ret);
+    }
     else if (!func_import->call_conv_raw) {
         ret = wasm_runtime_invoke_native(
             exec_env, native_func_pointer, func_import->func_type,
@@ -916,6 +925,84 @@ fast_jit_invoke_native(WASMExecEnv *exec_env, uint32 func_idx,
 }
 #endif
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+static void
+fast_jit_call_func_bytecode(WASMExecEnv *exec_env,
+                            WASMFunctionInstance *function,
+                            WASMInterpFrame *frame);
+
+/* Increase the hotness of the function and compile it with Fast JIT
+   once the hotness reaches the threshold */
+static inline void
+fast_jit_update_hotness(WASMModuleInstance *module_inst,
+                        WASMFunctionInstance *cur_func, uint32 inc)
+{
+    WASMFunction *func = cur_func->u.func;
+    uint32 threshold = jit_compiler_get_jit_globals()->tier_up_threshold;
+
+    if (!func->fast_jit_jitted_code && !func->tier_up_failed) {
+        /* The update isn't atomic, a lost update only delays the
+           tier-up as the hotness is compared with greater-or-equal */
+        if (func->hotness < threshold)
+            func->hotness += inc;
+        /* The flags are re-checked under lock by jit_compiler_tier_up */
+        if (func->hotness >= threshold && !func->tier_up_queued)
+            jit_compiler_tier_up(
+                module_inst->module,
+                (uint32)(cur_func - module_inst->e->functions));
+    }
+}
+#endif
+
+#if WASM_ENABLE_FAST_JIT != 0 && WASM_ENABLE_JIT != 0
+static bool
+llvm_jit_call_func_from_frame(WASMModuleInstance *module_inst,
+                              WASMExecEnv *exec_env,
+                              WASMFunctionInstance *function,
+                              WASMInterpFrame *prev_frame);
+
+/* Whether the function has become hot in Fast JIT code and been compiled
+   by LLVM JIT in background */
+static inline bool
+llvm_jit_func_compiled(WASMModuleInstance *module_inst,
+                       WASMFunctionInstance *function)
+{
+    WASMModule *module = module_inst->module;
+    uint32 func_idx = (uint32)(function - module_inst->e->functions);
+
+    return module->func_ptrs_compiled[func_idx - module->import_function_count];
+}
+#endif
+
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+/* Get the else and end addresses of the block whose code after the block
+   type starts at start_addr from the block address table of the function,
+   return false if the function has no table */
+static inline bool
+get_block_addr_from_table(const WASMFunction *func, const uint8 *start_addr,
+                          uint8 **p_else_addr, uint8 **p_end_addr)
+{
+    const BlockAddrEntry *table = func->block_addr_table;
+    uint32 start_offset = (uint32)(start_addr - func->code);
+    uint32 mask = func->block_addr_table_mask, i;
+
+    if (!table)
+        return false;
+
+    i = start_offset & mask;
+    while (table[i].start_offset != start_offset) {
+        if (table[i].start_offset == 0)
+            return false;
+        i = (i + 1) & mask;
+    }
+
+    *p_else_addr =
+        table[i].else_offset ? func->code + table[i].else_offset : NULL;
+    *p_end_addr = func->code + table[i].end_offset;
+    return true;
+}
+#endif
+
 #if WASM_ENABLE_MULTI_MODULE != 0
 static void
 wasm_interp_call_func_bytecode(WASMModuleInstance *module,
@@ -1152,6 +1239,11 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 param_cell_num = 0;
                 cell_num = wasm_value_type_cell_num(value_type);
             handle_op_block:
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if (get_block_addr_from_table(cur_func->u.func, frame_ip,
+                                              &else_addr, &end_addr))
+                    goto handle_op_block_push_csp;
+#endif
                 cache_index = ((uintptr_t)frame_ip)
                               & (uintptr_t)(BLOCK_ADDR_CACHE_SIZE - 1);
                 cache_items = exec_env->block_addr_cache[cache_index];
@@ -1173,6 +1265,9 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 else {
                     end_addr = NULL;
                 }
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+            handle_op_block_push_csp:
+#endif
                 PUSH_CSP(LABEL_TYPE_BLOCK, param_cell_num, cell_num, end_addr);
                 HANDLE_OP_END();
             }
@@ -1209,6 +1304,11 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 param_cell_num = 0;
                 cell_num = wasm_value_type_cell_num(value_type);
             handle_op_if:
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if (get_block_addr_from_table(cur_func->u.func, frame_ip,
+                                              &else_addr, &end_addr))
+                    goto handle_op_if_pop_cond;
+#endif
                 cache_index = ((uintptr_t)frame_ip)
                               & (uintptr_t)(BLOCK_ADDR_CACHE_SIZE - 1);
                 cache_items = exec_env->block_addr_cache[cache_index];
@@ -1228,6 +1328,9 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                     goto got_exception;
                 }
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+            handle_op_if_pop_cond:
+#endif
                 cond = (uint32)POP_I32();
 
                 if (cond) { /* if branch is met */
@@ -1278,6 +1381,11 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 read_leb_uint32(frame_ip, frame_ip_end, depth);
             label_pop_csp_n:
                 POP_CSP_N(depth);
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+                /* Branch to the beginning of a loop */
+                if (frame_ip == (frame_csp - 1)->begin_addr)
+                    fast_jit_update_hotness(module, cur_func, 1);
+#endif
                 if (!frame_ip) { /* must be label pushed by WASM_OP_BLOCK */
                     if (!wasm_loader_find_block_addr(
                             exec_env, (BlockAddr *)exec_env->block_addr_cache,
@@ -1469,6 +1577,14 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_DROP_V128)
+            {
+                frame_sp -= 4;
+                HANDLE_OP_END();
+            }
+#endif
+
             HANDLE_OP(WASM_OP_SELECT)
             {
                 cond = (uint32)POP_I32();
@@ -1489,6 +1605,17 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SELECT_V128)
+            {
+                cond = (uint32)POP_I32();
+                frame_sp -= 4;
+                if (!cond)
+                    wasm_simd_copy_v128(frame_sp - 4, frame_sp);
+                HANDLE_OP_END();
+            }
+#endif
+
 #if WASM_ENABLE_REF_TYPES != 0
             HANDLE_OP(WASM_OP_SELECT_T)
             {
@@ -1506,6 +1633,13 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                         *(frame_sp - 1) = *(frame_sp + 1);
                     }
                 }
+#if WASM_ENABLE_SIMD != 0
+                else if (type == VALUE_TYPE_V128) {
+                    frame_sp -= 4;
+                    if (!cond)
+                        wasm_simd_copy_v128(frame_sp - 4, frame_sp);
+                }
+#endif
                 else {
                     frame_sp--;
                     if (!cond)
@@ -1600,6 +1734,12 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                     case VALUE_TYPE_F64:
                         PUSH_I64(GET_I64_FROM_ADDR(frame_lp + local_offset));
                         break;
+#if WASM_ENABLE_SIMD != 0
+                    case VALUE_TYPE_V128:
+                        wasm_simd_copy_v128(frame_sp, frame_lp + local_offset);
+                        frame_sp += 4;
+                        break;
+#endif
                     default:
                         wasm_set_exception(module, "invalid local type");
                         goto got_exception;
@@ -1637,6 +1777,12 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                         PUT_I64_TO_ADDR((uint32 *)(frame_lp + local_offset),
                                         POP_I64());
                         break;
+#if WASM_ENABLE_SIMD != 0
+                    case VALUE_TYPE_V128:
+                        frame_sp -= 4;
+                        wasm_simd_copy_v128(frame_lp + local_offset, frame_sp);
+                        break;
+#endif
                     default:
                         wasm_set_exception(module, "invalid local type");
                         goto got_exception;
@@ -1676,6 +1822,12 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                         PUT_I64_TO_ADDR((uint32 *)(frame_lp + local_offset),
                                         GET_I64_FROM_ADDR(frame_sp - 2));
                         break;
+#if WASM_ENABLE_SIMD != 0
+                    case VALUE_TYPE_V128:
+                        wasm_simd_copy_v128(frame_lp + local_offset,
+                                            frame_sp - 4);
+                        break;
+#endif
                     default:
                         wasm_set_exception(module, "invalid local type");
                         goto got_exception;
@@ -1717,6 +1869,19 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_GET_GLOBAL_V128)
+            {
+                read_leb_uint32(frame_ip, frame_ip_end, global_idx);
+                bh_assert(global_idx < module->e->global_count);
+                global = globals + global_idx;
+                global_addr = get_global_addr(global_data, global);
+                wasm_simd_copy_v128(frame_sp, (uint32 *)global_addr);
+                frame_sp += 4;
+                HANDLE_OP_END();
+            }
+#endif
+
             HANDLE_OP(WASM_OP_SET_GLOBAL)
             {
                 read_leb_uint32(frame_ip, frame_ip_end, global_idx);
@@ -1768,6 +1933,19 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SET_GLOBAL_V128)
+            {
+                read_leb_uint32(frame_ip, frame_ip_end, global_idx);
+                bh_assert(global_idx < module->e->global_count);
+                global = globals + global_idx;
+                global_addr = get_global_addr(global_data, global);
+                frame_sp -= 4;
+                wasm_simd_copy_v128((uint32 *)global_addr, frame_sp);
+                HANDLE_OP_END();
+            }
+#endif
+
             /* memory load instructions */
             HANDLE_OP(WASM_OP_I32_LOAD)
             HANDLE_OP(WASM_OP_F32_LOAD)
@@ -3331,6 +3509,118 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SIMD_PREFIX)
+            {
+                uint32 offset, flags, addr;
+                uint64 mask_low, mask_high;
+                uint8 lane = 0, op_param_cell_num, op_result_cell_num;
+
+                opcode = *frame_ip++;
+                switch (opcode) {
+                    case SIMD_v128_load:
+                    case SIMD_v128_load8x8_s:
+                    case SIMD_v128_load8x8_u:
+                    case SIMD_v128_load16x4_s:
+                    case SIMD_v128_load16x4_u:
+                    case SIMD_v128_load32x2_s:
+                    case SIMD_v128_load32x2_u:
+                    case SIMD_v128_load8_splat:
+                    case SIMD_v128_load16_splat:
+                    case SIMD_v128_load32_splat:
+                    case SIMD_v128_load64_splat:
+                    case SIMD_v128_load32_zero:
+                    case SIMD_v128_load64_zero:
+                    {
+                        read_leb_uint32(frame_ip, frame_ip_end, flags);
+                        read_leb_uint32(frame_ip, frame_ip_end, offset);
+                        addr = POP_I32();
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        wasm_simd_load(opcode, 0, maddr, frame_sp);
+                        frame_sp += 4;
+                        (void)flags;
+                        break;
+                    }
+
+                    case SIMD_v128_load8_lane:
+                    case SIMD_v128_load16_lane:
+                    case SIMD_v128_load32_lane:
+                    case SIMD_v128_load64_lane:
+                    {
+                        read_leb_uint32(frame_ip, frame_ip_end, flags);
+                        read_leb_uint32(frame_ip, frame_ip_end, offset);
+                        lane = *frame_ip++;
+                        addr = *(uint32 *)(frame_sp - 5);
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        /* move the v128 operand down to replace the address */
+                        frame_sp--;
+                        wasm_simd_copy_v128(frame_sp - 4, frame_sp - 3);
+                        wasm_simd_load(opcode, lane, maddr, frame_sp - 4);
+                        (void)flags;
+                        break;
+                    }
+
+                    case SIMD_v128_store:
+                    case SIMD_v128_store8_lane:
+                    case SIMD_v128_store16_lane:
+                    case SIMD_v128_store32_lane:
+                    case SIMD_v128_store64_lane:
+                    {
+                        read_leb_uint32(frame_ip, frame_ip_end, flags);
+                        read_leb_uint32(frame_ip, frame_ip_end, offset);
+                        if (opcode != SIMD_v128_store)
+                            lane = *frame_ip++;
+                        frame_sp -= 4;
+                        addr = POP_I32();
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        wasm_simd_store(opcode, lane, maddr, frame_sp + 1);
+                        (void)flags;
+                        break;
+                    }
+
+                    case SIMD_v128_const:
+                    {
+                        bh_memcpy_s(frame_sp, sizeof(V128), frame_ip,
+                                    sizeof(V128));
+                        frame_ip += sizeof(V128);
+                        frame_sp += 4;
+                        break;
+                    }
+
+                    case SIMD_v8x16_shuffle:
+                    {
+                        bh_memcpy_s(&mask_low, sizeof(uint64), frame_ip,
+                                    sizeof(uint64));
+                        bh_memcpy_s(&mask_high, sizeof(uint64),
+                                    frame_ip + sizeof(uint64), sizeof(uint64));
+                        frame_ip += sizeof(V128);
+                        frame_sp -= 8;
+                        wasm_simd_shuffle(frame_sp, mask_low, mask_high);
+                        frame_sp += 4;
+                        break;
+                    }
+
+                    default:
+                    {
+                        if (opcode >= SIMD_i8x16_extract_lane_s
+                            && opcode <= SIMD_f64x2_replace_lane)
+                            lane = *frame_ip++;
+
+                        wasm_simd_get_op_cell_num(opcode, &op_param_cell_num,
+                                                  &op_result_cell_num);
+                        frame_sp -= op_param_cell_num;
+                        wasm_simd_exec_op(opcode, lane, frame_sp);
+                        frame_sp += op_result_cell_num;
+                        break;
+                    }
+                }
+                HANDLE_OP_END();
+            }
+#endif /* end of WASM_ENABLE_SIMD != 0 */
+
 #if WASM_ENABLE_SHARED_MEMORY != 0
             HANDLE_OP(WASM_OP_ATOMIC_PREFIX)
             {
@@ -3738,6 +4028,11 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
         HANDLE_OP(EXT_OP_COPY_STACK_TOP)
         HANDLE_OP(EXT_OP_COPY_STACK_TOP_I64)
         HANDLE_OP(EXT_OP_COPY_STACK_VALUES)
+#if WASM_ENABLE_SIMD != 0
+        HANDLE_OP(EXT_OP_SET_LOCAL_FAST_V128)
+        HANDLE_OP(EXT_OP_TEE_LOCAL_FAST_V128)
+        HANDLE_OP(EXT_OP_COPY_STACK_TOP_V128)
+#endif
         {
             wasm_set_exception(module, "unsupported opcode");
             goto got_exception;
@@ -3808,6 +4103,44 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
             WASMFunction *cur_wasm_func = cur_func->u.func;
             WASMType *func_type;
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+            fast_jit_update_hotness(module, cur_func, 1);
+
+            if (cur_wasm_func->fast_jit_jitted_code
+#if WASM_ENABLE_JIT != 0
+                || llvm_jit_func_compiled(module, cur_func)
+#endif
+            ) {
+                /* The arguments have been copied to the outs area, the
+                   jitted code allocates its frame and puts the results
+                   to prev_frame */
+#if WASM_ENABLE_JIT != 0
+                if (llvm_jit_func_compiled(module, cur_func))
+                    llvm_jit_call_func_from_frame(module, exec_env, cur_func,
+                                                  prev_frame);
+                else
+#endif
+                    fast_jit_call_func_bytecode(exec_env, cur_func,
+                                                prev_frame);
+
+                if (!prev_frame->ip)
+                    /* Called from native. */
+                    return;
+
+                RECOVER_CONTEXT(prev_frame);
+#if !defined(OS_ENABLE_HW_BOUND_CHECK)              \
+    || WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS == 0 \
+    || WASM_ENABLE_BULK_MEMORY != 0
+                if (memory)
+                    linear_mem_size =
+                        num_bytes_per_page * memory->cur_page_count;
+#endif
+                if (wasm_get_exception(module))
+                    goto got_exception;
+                HANDLE_OP_END();
+            }
+#endif
+
             func_type = cur_wasm_func->func_type;
 
             all_cell_num = (uint64)cur_func->param_cell_num
@@ -3916,6 +4249,26 @@ fast_jit_call_func_bytecode(WASMExecEnv *exec_env,
     uint8 type = func_type->result_count
                      ? func_type->types[func_type->param_count]
                      : VALUE_TYPE_VOID;
+    void *jitted_code;
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    uint32 pin_depth = jit_code_cache_pin(exec_env);
+    uint8 *ip;
+
+    /* Re-check the jitted code after pinning, it may have been evicted
+       from the code cache, run the function with interpreter then */
+    if (!(jitted_code = function->u.func->fast_jit_jitted_code)) {
+        jit_code_cache_unpin(exec_env, pin_depth);
+        ip = frame->ip;
+        frame->ip = NULL;
+        wasm_interp_call_func_bytecode(
+            (WASMModuleInstance *)exec_env->module_inst, exec_env, function,
+            frame);
+        frame->ip = ip;
+        return;
+    }
+#else
+    jitted_code = function->u.func->fast_jit_jitted_code;
+#endif
 
 #if WASM_ENABLE_REF_TYPES != 0
     if (type == VALUE_TYPE_EXTERNREF || type == VALUE_TYPE_FUNCREF)
@@ -3926,8 +4279,10 @@ fast_jit_call_func_bytecode(WASMExecEnv *exec_env,
     info.frame = frame;
     frame->jitted_return_addr =
         (uint8 *)jit_globals->return_to_interp_from_jitted;
-    jit_interp_switch_to_jitted(exec_env, &info,
-                                function->u.func->fast_jit_jitted_code);
+    jit_interp_switch_to_jitted(exec_env, &info, jitted_code);
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    jit_code_cache_unpin(exec_env, pin_depth);
+#endif
     if (func_type->result_count) {
         switch (type) {
             case VALUE_TYPE_I32:
@@ -3954,6 +4309,68 @@ fast_jit_call_func_bytecode(WASMExecEnv *exec_env,
 }
 #endif
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 \
+    || (WASM_ENABLE_FAST_JIT != 0 && WASM_ENABLE_JIT != 0)
+bool
+fast_jit_call_interp_func(WASMExecEnv *exec_env, WASMInterpFrame *prev_frame)
+{
+    WASMModuleInstance *module_inst =
+        (WASMModuleInstance *)exec_env->module_inst;
+    /* The jitted caller saved the function index in jit_cache */
+    uint32 func_idx = *(uint32 *)exec_env->jit_cache;
+    WASMFunctionInstance *cur_func = module_inst->e->functions + func_idx;
+    WASMType *func_type = cur_func->u.func->func_type;
+    uint8 *ip = prev_frame->ip;
+    uint8 *jitted_return_addr = prev_frame->jitted_return_addr;
+    uint32 cell_num;
+
+#ifndef OS_ENABLE_HW_BOUND_CHECK
+    if ((uint8 *)&module_inst < exec_env->native_stack_boundary) {
+        wasm_set_exception(module_inst, "native stack overflow");
+        return false;
+    }
+#endif
+
+#if WASM_ENABLE_JIT != 0
+    if (llvm_jit_func_compiled(module_inst, cur_func)) {
+        /* The function is hot and has been compiled by LLVM JIT */
+        if (!llvm_jit_call_func_from_frame(module_inst, exec_env, cur_func,
+                                           prev_frame))
+            return false;
+    }
+    else
+#endif
+    {
+        /* The arguments have been stored to the outs area by the jitted
+           caller, set ip NULL to make call_func_bytecode return after
+           executing this function */
+        prev_frame->ip = NULL;
+        wasm_interp_call_func_bytecode(module_inst, exec_env, cur_func,
+                                       prev_frame);
+        /* The callee may tier up and be run by jitted code, which
+           overwrites jitted_return_addr of prev_frame, restore it to let
+           the stub return to the jitted caller */
+        prev_frame->ip = ip;
+        prev_frame->jitted_return_addr = jitted_return_addr;
+
+        if (wasm_get_exception(module_inst))
+            return false;
+    }
+
+    /* All the results were pushed to prev_frame, the jitted caller
+       expects the first result in register, copy it to jit_cache, from
+       which the stub loads it */
+    if (func_type->result_count > 0) {
+        cell_num =
+            wasm_value_type_cell_num(func_type->types[func_type->param_count]);
+        bh_memcpy_s(exec_env->jit_cache, sizeof(exec_env->jit_cache),
+                    prev_frame->sp - cur_func->ret_cell_num,
+                    sizeof(uint32) * cell_num);
+    }
+    return true;
+}
+#endif
+
 #if WASM_ENABLE_JIT != 0
 static bool
 clear_wasi_proc_exit_exception(WASMModuleInstance *module_inst)
@@ -3973,6 +4390,33 @@ clear_wasi_proc_exit_exception(WASMModuleInstance *module_inst)
 #endif
 }
 
+#if WASM_ENABLE_FAST_JIT != 0
+/* Get the LLVM jitted code of a function which has been compiled by the
+   compile threads. The jit functions are looked up when the first hot
+   function is queued, which may be after the instance is created, so
+   copy their pointers to the instance under lock on the first call */
+static void *
+llvm_jit_get_func_ptr(WASMModuleInstance *module_inst,
+                      WASMFunctionInstance *function)
+{
+    WASMModule *module = module_inst->module;
+    uint32 func_idx = (uint32)(function - module_inst->e->functions);
+    void *func_ptr = module_inst->func_ptrs[func_idx];
+
+    if (!func_ptr) {
+        os_mutex_lock(&module->tier_up_lock);
+        bh_memcpy_s(module_inst->func_ptrs + module->import_function_count,
+                    sizeof(void *) * module->function_count,
+                    module->func_ptrs,
+                    sizeof(void *) * module->function_count);
+        func_ptr = module_inst->func_ptrs[func_idx];
+        os_mutex_unlock(&module->tier_up_lock);
+    }
+
+    return func_ptr;
+}
+#endif
+
 static bool
 llvm_jit_call_func_bytecode(WASMModuleInstance *module_inst,
                             WASMExecEnv *exec_env,
@@ -3982,9 +4426,15 @@ llvm_jit_call_func_bytecode(WASMModuleInstance *module_inst,
     WASMType *func_type = function->u.func->func_type;
     uint32 result_count = func_type->result_count;
     uint32 ext_ret_count = result_count > 1 ? result_count - 1 : 0;
+#if WASM_ENABLE_FAST_JIT != 0
+    void *func_ptr = llvm_jit_get_func_ptr(module_inst, function);
+#else
+    void *func_ptr = function->u.func->llvm_jit_func_ptr;
+#endif
     bool ret;
 
-#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0)
+#if (WASM_ENABLE_DUMP_CALL_STACK != 0) || (WASM_ENABLE_PERF_PROFILING != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
     if (!llvm_jit_alloc_frame(exec_env, function - module_inst->e->functions)) {
         wasm_set_exception(module_inst, "wasm operand stack overflow");
     }
@@ -4026,9 +4476,8 @@ llvm_jit_call_func_bytecode(WASMModuleInstance *module_inst,
             cell_num += wasm_value_type_cell_num(ext_ret_types[i]);
         }
 
-        ret = wasm_runtime_invoke_native(
-            exec_env, function->u.func->llvm_jit_func_ptr, func_type, NULL,
-            NULL, argv1, argc, argv);
+        ret = wasm_runtime_invoke_native(exec_env, func_ptr, func_type, NULL,
+                                         NULL, argv1, argc, argv);
 
         if (!ret || wasm_get_exception(module_inst)) {
             if (clear_wasi_proc_exit_exception(module_inst))
@@ -4077,9 +4526,8 @@ llvm_jit_call_func_bytecode(WASMModuleInstance *module_inst,
         return true;
     }
     else {
-        ret = wasm_runtime_invoke_native(
-            exec_env, function->u.func->llvm_jit_func_ptr, func_type, NULL,
-            NULL, argv, argc, argv);
+        ret = wasm_runtime_invoke_native(exec_env, func_ptr, func_type, NULL,
+                                         NULL, argv, argc, argv);
 
         if (clear_wasi_proc_exit_exception(module_inst))
             ret = true;
@@ -4087,6 +4535,47 @@ llvm_jit_call_func_bytecode(WASMModuleInstance *module_inst,
         return ret && !wasm_get_exception(module_inst) ? true : false;
     }
 }
+
+#if WASM_ENABLE_FAST_JIT != 0
+/* Call the LLVM jitted code of the function with the arguments in the
+   outs area, and push the results to prev_frame like the interpreter */
+static bool
+llvm_jit_call_func_from_frame(WASMModuleInstance *module_inst,
+                              WASMExecEnv *exec_env,
+                              WASMFunctionInstance *function,
+                              WASMInterpFrame *prev_frame)
+{
+    WASMInterpFrame *outs_area = wasm_exec_env_wasm_stack_top(exec_env);
+    uint32 argv_buf[32], *argv = argv_buf;
+    uint32 cell_num = function->param_cell_num > function->ret_cell_num
+                          ? function->param_cell_num
+                          : function->ret_cell_num;
+    uint64 size = sizeof(uint32) * (uint64)cell_num;
+    bool ret;
+
+    if (size > sizeof(argv_buf)) {
+        if (size > UINT32_MAX
+            || !(argv = wasm_runtime_malloc((uint32)size))) {
+            wasm_set_exception(module_inst, "allocate memory failed");
+            return false;
+        }
+    }
+
+    if (function->param_cell_num > 0)
+        word_copy(argv, outs_area->lp, function->param_cell_num);
+
+    ret = llvm_jit_call_func_bytecode(module_inst, exec_env, function,
+                                      function->param_cell_num, argv);
+    if (ret) {
+        word_copy(prev_frame->sp, argv, function->ret_cell_num);
+        prev_frame->sp += function->ret_cell_num;
+    }
+
+    if (argv != argv_buf)
+        wasm_runtime_free(argv);
+    return ret;
+}
+#endif
 #endif
 
 void
@@ -4153,14 +4642,42 @@ wasm_interp_call_wasm(WASMModuleInstance *module_inst, WASMExecEnv *exec_env,
         }
     }
     else {
-#if WASM_ENABLE_JIT != 0
+#if WASM_ENABLE_JIT != 0 && WASM_ENABLE_FAST_JIT != 0
+        if (llvm_jit_func_compiled(module_inst, function)) {
+            llvm_jit_call_func_bytecode(module_inst, exec_env, function, argc,
+                                        argv);
+            /* For llvm jit, the results have been stored in argv,
+               no need to copy them from stack frame again */
+            copy_argv_from_frame = false;
+        }
+        else {
+            /* Run the function with Fast JIT (or interpreter in tier-up
+               mode) until it becomes hot */
+#if WASM_ENABLE_FAST_JIT_TIER_UP == 0
+            fast_jit_call_func_bytecode(exec_env, function, frame);
+#else
+            if (function->u.func->fast_jit_jitted_code)
+                fast_jit_call_func_bytecode(exec_env, function, frame);
+            else
+                wasm_interp_call_func_bytecode(module_inst, exec_env,
+                                               function, frame);
+#endif
+        }
+#elif WASM_ENABLE_JIT != 0
         llvm_jit_call_func_bytecode(module_inst, exec_env, function, argc,
                                     argv);
         /* For llvm jit, the results have been stored in argv,
            no need to copy them from stack frame again */
         copy_argv_from_frame = false;
-#elif WASM_ENABLE_FAST_JIT != 0
+#elif WASM_ENABLE_FAST_JIT != 0 && WASM_ENABLE_FAST_JIT_TIER_UP == 0
         fast_jit_call_func_bytecode(exec_env, function, frame);
+#elif WASM_ENABLE_FAST_JIT_TIER_UP != 0
+        /* Run the function with interpreter until it becomes hot */
+        if (function->u.func->fast_jit_jitted_code)
+            fast_jit_call_func_bytecode(exec_env, function, frame);
+        else
+            wasm_interp_call_func_bytecode(module_inst, exec_env, function,
+                                           frame);
 #else
         wasm_interp_call_func_bytecode(module_inst, exec_env, function, frame);
 #endif
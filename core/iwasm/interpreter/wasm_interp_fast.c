@@ -9,6 +9,9 @@
 #include "wasm_opcode.h"
 #include "wasm_loader.h"
 #include "../common/wasm_exec_env.h"
+#if WASM_ENABLE_SIMD != 0
+#include "wasm_simd.h"
+#endif
 #if WASM_ENABLE_SHARED_MEMORY != 0
 #include "../common/wasm_shared_memory.h"
 #endif
@@ -311,6 +314,11 @@ LOAD_PTR(void *addr)
 
 #define GET_OPERAND(type, op_type, off) GET_OPERAND_##op_type(type, off)
 
+#if WASM_ENABLE_SIMD != 0
+/* the address of the four cells of a v128 operand */
+#define GET_OPERAND_V128_ADDR(off) (frame_lp + *(int16 *)(frame_ip + off))
+#endif
+
 #define PUSH_I32(value)                              \
     do {                                             \
         *(int32 *)(frame_lp + GET_OFFSET()) = value; \
@@ -375,6 +383,17 @@ LOAD_PTR(void *addr)
     frame_ip += 2;
 #endif
 
+#if WASM_ENABLE_SIMD != 0
+/* the lane index immediate is emitted by the loader like an opcode */
+#if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
+#define GET_SIMD_LANE() lane = *frame_ip++;
+#else
+#define GET_SIMD_LANE() \
+    lane = *frame_ip;   \
+    frame_ip += 2;
+#endif
+#endif
+
 #define DEF_OP_EQZ(ctype, src_op_type)                                  \
     do {                                                                \
         SET_OPERAND(I32, 2, (GET_OPERAND(ctype, src_op_type, 0) == 0)); \
@@ -389,6 +408,17 @@ LOAD_PTR(void *addr)
         frame_ip += 6;                                               \
     } while (0)
 
+#define DEF_OP_CMP_BR_IF(src_type, cmp)               \
+    do {                                              \
+        src_type lhs = GET_OPERAND(src_type, I32, 2); \
+        src_type rhs = GET_OPERAND(src_type, I32, 0); \
+        frame_ip += 4;                                \
+        if (lhs cmp rhs)                              \
+            goto recover_br_info;                     \
+        else                                          \
+            SKIP_BR_INFO();                           \
+    } while (0)
+
 #define DEF_OP_BIT_COUNT(src_type, src_op_type, operation)               \
     do {                                                                 \
         SET_OPERAND(                                                     \
@@ -704,6 +734,12 @@ copy_stack_values(WASMModuleInstance *module, uint32 *frame_lp, uint32 arity,
         else {
             tmp_buf[buf_index] = frame_lp[src];
             tmp_buf[buf_index + 1] = frame_lp[src + 1];
+#if WASM_ENABLE_SIMD != 0
+            if (cell == 4) {
+                tmp_buf[buf_index + 2] = frame_lp[src + 2];
+                tmp_buf[buf_index + 3] = frame_lp[src + 3];
+            }
+#endif
         }
         buf_index += cell;
     }
@@ -718,6 +754,12 @@ copy_stack_values(WASMModuleInstance *module, uint32 *frame_lp, uint32 arity,
         else {
             frame_lp[dst] = tmp_buf[buf_index];
             frame_lp[dst + 1] = tmp_buf[buf_index + 1];
+#if WASM_ENABLE_SIMD != 0
+            if (cell == 4) {
+                frame_lp[dst + 2] = tmp_buf[buf_index + 2];
+                frame_lp[dst + 3] = tmp_buf[buf_index + 3];
+            }
+#endif
         }
         buf_index += cell;
     }
@@ -750,7 +792,8 @@ copy_stack_values(WASMModuleInstance *module, uint32 *frame_lp, uint32 arity,
             /* dst offsets */                                               \
             dst_offsets = (uint16 *)frame_ip;                               \
             frame_ip += arity * sizeof(uint16);                             \
-            if (arity == 1) {                                               \
+            /* a single v128 value is copied by copy_stack_values */        \
+            if (arity == 1 && cells[0] <= 2) {                              \
                 if (cells[0] == 1)                                          \
                     frame_lp[dst_offsets[0]] = frame_lp[src_offsets[0]];    \
                 else if (cells[0] == 2) {                                   \
@@ -783,6 +826,34 @@ copy_stack_values(WASMModuleInstance *module, uint32 *frame_lp, uint32 arity,
         frame_ip += sizeof(uint8 *);                                          \
     } while (0)
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+static bool
+prepare_function(WASMModuleInstance *module_inst,
+                 WASMModuleInstance *func_module_inst,
+                 WASMFunctionInstance *function)
+{
+    char error_buf[128];
+
+    if (!wasm_prepare_function(func_module_inst, function, error_buf,
+                               sizeof(error_buf))) {
+        wasm_set_exception(module_inst, error_buf);
+        return false;
+    }
+    return true;
+}
+
+/* Translate the bytecode of a function called the first time, it must
+   be done before the const_cell_num of the function is used */
+#define PREPARE_FUNCTION(func_module_inst, function)                  \
+    do {                                                              \
+        if (!wasm_is_function_prepared(function)                      \
+            && !prepare_function(module, func_module_inst, function)) \
+            goto got_exception;                                       \
+    } while (0)
+#else
+#define PREPARE_FUNCTION(func_module_inst, function) (void)0
+#endif
+
 static inline int32
 sign_ext_8_32(int8 val)
 {
@@ -936,6 +1007,11 @@ wasm_interp_call_func_native(WASMModuleInstance *module_inst,
             argv_ret[1] = frame->lp[1];
         }
     }
+    else if (func_import->call_shape) {
+        ret = wasm_runtime_invoke_native_shape(
+            exec_env, native_func_pointer, func_import->call_shape,
+            func_import->attachment, frame->lp, argv_ret);
+    }
     else if (!func_import->call_conv_raw) {
         ret = wasm_runtime_invoke_native(
             exec_env, native_func_pointer, func_import->func_type,
@@ -1052,34 +1128,85 @@ wasm_interp_call_func_import(WASMModuleInstance *module_inst,
 #endif
 
 #if WASM_ENABLE_OPCODE_COUNTER != 0
-typedef struct OpcodeInfo {
-    char *name;
-    uint64 count;
-} OpcodeInfo;
-
-/* clang-format off */
-#define HANDLE_OPCODE(op) \
-    {                     \
-        #op, 0            \
-    }
-DEFINE_GOTO_TABLE(OpcodeInfo, opcode_table);
-#undef HANDLE_OPCODE
-/* clang-format on */
+/* Number of the top opcode pairs to dump */
+#define OPCODE_PAIR_DUMP_NUM 32
+
+/* Executed times of each opcode and of each pair of consecutively
+   executed opcodes, indexed by the previous opcode first */
+static uint64 opcode_counts[WASM_INSTRUCTION_NUM];
+static uint64 opcode_pair_counts[WASM_INSTRUCTION_NUM][WASM_INSTRUCTION_NUM];
+static uint8 last_counted_opcode = WASM_OP_IMPDEP;
+
+static inline void
+wasm_interp_count_op(uint8 opcode)
+{
+    opcode_counts[opcode]++;
+    opcode_pair_counts[last_counted_opcode][opcode]++;
+    last_counted_opcode = opcode;
+}
 
 static void
 wasm_interp_dump_op_count()
 {
-    uint32 i;
-    uint64 total_count = 0;
-    for (i = 0; i < WASM_OP_IMPDEP; i++)
-        total_count += opcode_table[i].count;
-
-    printf("total opcode count: %ld\n", total_count);
-    for (i = 0; i < WASM_OP_IMPDEP; i++)
-        if (opcode_table[i].count > 0)
-            printf("\t\t%s count:\t\t%ld,\t\t%.2f%%\n", opcode_table[i].name,
-                   opcode_table[i].count,
-                   opcode_table[i].count * 100.0f / total_count);
+    uint32 top_pairs[OPCODE_PAIR_DUMP_NUM], top_pair_num = 0;
+    uint32 i, j, k;
+    uint64 total_count = 0, total_pair_count = 0;
+
+    /* The opcode names, the handlers of the prefixed opcodes are counted
+       as their prefixes */
+#define HANDLE_OPCODE(op) #op
+    DEFINE_GOTO_TABLE(const char *, opcode_names);
+#undef HANDLE_OPCODE
+
+    /* WASM_OP_IMPDEP is the entry of a call from the host, don't count
+       it and the pairs it is in */
+    for (i = 0; i < WASM_INSTRUCTION_NUM; i++) {
+        if (i == WASM_OP_IMPDEP)
+            continue;
+        total_count += opcode_counts[i];
+        for (j = 0; j < WASM_INSTRUCTION_NUM; j++) {
+            uint64 pair_count = opcode_pair_counts[i][j];
+
+            if (j == WASM_OP_IMPDEP || pair_count == 0)
+                continue;
+            total_pair_count += pair_count;
+
+            /* Insert the pair into the top pairs sorted in descending
+               order of the count */
+            for (k = top_pair_num; k > 0; k--) {
+                uint32 top_pair = top_pairs[k - 1];
+                if (opcode_pair_counts[top_pair >> 8][top_pair & 0xFF]
+                    >= pair_count)
+                    break;
+                if (k < OPCODE_PAIR_DUMP_NUM)
+                    top_pairs[k] = top_pair;
+            }
+            if (k < OPCODE_PAIR_DUMP_NUM) {
+                top_pairs[k] = (i << 8) | j;
+                if (top_pair_num < OPCODE_PAIR_DUMP_NUM)
+                    top_pair_num++;
+            }
+        }
+    }
+
+    printf("total opcode count: %" PRIu64 "\n", total_count);
+    for (i = 0; i < WASM_INSTRUCTION_NUM; i++)
+        if (i != WASM_OP_IMPDEP && opcode_counts[i] > 0)
+            printf("\t\t%s count:\t\t%" PRIu64 ",\t\t%.2f%%\n",
+                   opcode_names[i] ? opcode_names[i] : "(unknown)",
+                   opcode_counts[i],
+                   opcode_counts[i] * 100.0f / total_count);
+
+    printf("total opcode pair count: %" PRIu64 "\n", total_pair_count);
+    for (k = 0; k < top_pair_num; k++) {
+        i = top_pairs[k] >> 8;
+        j = top_pairs[k] & 0xFF;
+        printf("\t\t%s %s count:\t\t%" PRIu64 ",\t\t%.2f%%\n",
+               opcode_names[i] ? opcode_names[i] : "(unknown)",
+               opcode_names[j] ? opcode_names[j] : "(unknown)",
+               opcode_pair_counts[i][j],
+               opcode_pair_counts[i][j] * 100.0f / total_pair_count);
+    }
 }
 #endif
 
@@ -1087,15 +1214,25 @@ wasm_interp_dump_op_count()
 
 /* #define HANDLE_OP(opcode) HANDLE_##opcode:printf(#opcode"\n"); */
 #if WASM_ENABLE_OPCODE_COUNTER != 0
-#define HANDLE_OP(opcode) HANDLE_##opcode : opcode_table[opcode].count++;
+/* Only count the opcode dispatched to, not the ones whose labels the
+   handler falls through */
+#define HANDLE_OP(opcode)                  \
+    HANDLE_##opcode:                       \
+    if (!opcode_counted) {                 \
+        wasm_interp_count_op(opcode);      \
+        opcode_counted = true;             \
+    }
+#define RESET_OPCODE_COUNTED() opcode_counted = false
 #else
 #define HANDLE_OP(opcode) HANDLE_##opcode:
+#define RESET_OPCODE_COUNTED() (void)0
 #endif
 #if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
 #define FETCH_OPCODE_AND_DISPATCH()                    \
     do {                                               \
         const void *p_label_addr = *(void **)frame_ip; \
         frame_ip += sizeof(void *);                    \
+        RESET_OPCODE_COUNTED();                        \
         goto *p_label_addr;                            \
     } while (0)
 #else
@@ -1103,6 +1240,7 @@ wasm_interp_dump_op_count()
     do {                                                            \
         const void *p_label_addr = label_base + *(int16 *)frame_ip; \
         frame_ip += sizeof(int16);                                  \
+        RESET_OPCODE_COUNTED();                                     \
         goto *p_label_addr;                                         \
     } while (0)
 #endif /* end of WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS */
@@ -1169,6 +1307,9 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
     uint8 *maddr = NULL;
     uint32 local_idx, local_offset, global_idx;
     uint8 opcode, local_type, *global_addr;
+#if WASM_ENABLE_OPCODE_COUNTER != 0 && WASM_ENABLE_LABELS_AS_VALUES != 0
+    bool opcode_counted = false;
+#endif
 
 #if WASM_ENABLE_LABELS_AS_VALUES != 0
 #define HANDLE_OPCODE(op) &&HANDLE_##op
@@ -1248,6 +1389,112 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+            /* superinstructions of i32 compare fused with br_if */
+            HANDLE_OP(EXT_OP_BR_IF_I32_EQZ)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                cond = frame_lp[GET_OFFSET()];
+
+                if (!cond)
+                    goto recover_br_info;
+                else
+                    SKIP_BR_INFO();
+
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_EQ)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, ==);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_NE)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, !=);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_LT_S)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(int32, <);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_LT_U)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, <);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_GT_S)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(int32, >);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_GT_U)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, >);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_LE_S)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(int32, <=);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_LE_U)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, <=);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_GE_S)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(int32, >=);
+                HANDLE_OP_END();
+            }
+
+            HANDLE_OP(EXT_OP_BR_IF_I32_GE_U)
+            {
+#if WASM_ENABLE_THREAD_MGR != 0
+                CHECK_SUSPEND_FLAGS();
+#endif
+                DEF_OP_CMP_BR_IF(uint32, >=);
+                HANDLE_OP_END();
+            }
+
             HANDLE_OP(WASM_OP_BR_TABLE)
             {
                 uint32 arity, br_item_size;
@@ -1305,6 +1552,13 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                                         GET_OPERAND(uint64, I64, off));
                         ret_offset += 2;
                     }
+#if WASM_ENABLE_SIMD != 0
+                    else if (ret_types[ret_idx] == VALUE_TYPE_V128) {
+                        wasm_simd_copy_v128(prev_frame->lp + ret_offset,
+                                            GET_OPERAND_V128_ADDR(off));
+                        ret_offset += 4;
+                    }
+#endif
                     else {
                         prev_frame->lp[ret_offset] =
                             GET_OPERAND(uint32, I32, off);
@@ -1421,6 +1675,28 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SELECT_V128)
+            {
+                cond = frame_lp[GET_OFFSET()];
+                addr1 = GET_OFFSET();
+                addr2 = GET_OFFSET();
+                addr_ret = GET_OFFSET();
+
+                if (!cond) {
+                    if (addr_ret != addr1)
+                        wasm_simd_copy_v128(frame_lp + addr_ret,
+                                            frame_lp + addr1);
+                }
+                else {
+                    if (addr_ret != addr2)
+                        wasm_simd_copy_v128(frame_lp + addr_ret,
+                                            frame_lp + addr2);
+                }
+                HANDLE_OP_END();
+            }
+#endif
+
 #if WASM_ENABLE_REF_TYPES != 0
             HANDLE_OP(WASM_OP_TABLE_GET)
             {
@@ -1520,6 +1796,25 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(EXT_OP_SET_LOCAL_FAST_V128)
+            HANDLE_OP(EXT_OP_TEE_LOCAL_FAST_V128)
+            {
+#if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
+                local_offset = *frame_ip++;
+#else
+        /* clang-format off */
+                local_offset = *frame_ip;
+                frame_ip += 2;
+        /* clang-format on */
+#endif
+                wasm_simd_copy_v128(frame_lp + local_offset,
+                                    GET_OPERAND_V128_ADDR(0));
+                frame_ip += 2;
+                HANDLE_OP_END();
+            }
+#endif
+
             HANDLE_OP(WASM_OP_GET_GLOBAL)
             {
                 global_idx = read_uint32(frame_ip);
@@ -1543,6 +1838,20 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_GET_GLOBAL_V128)
+            {
+                global_idx = read_uint32(frame_ip);
+                bh_assert(global_idx < module->e->global_count);
+                global = globals + global_idx;
+                global_addr = get_global_addr(global_data, global);
+                addr_ret = GET_OFFSET();
+                wasm_simd_copy_v128(frame_lp + addr_ret,
+                                    (uint32 *)global_addr);
+                HANDLE_OP_END();
+            }
+#endif
+
             HANDLE_OP(WASM_OP_SET_GLOBAL)
             {
                 global_idx = read_uint32(frame_ip);
@@ -1596,6 +1905,19 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SET_GLOBAL_V128)
+            {
+                global_idx = read_uint32(frame_ip);
+                bh_assert(global_idx < module->e->global_count);
+                global = globals + global_idx;
+                global_addr = get_global_addr(global_data, global);
+                addr1 = GET_OFFSET();
+                wasm_simd_copy_v128((uint32 *)global_addr, frame_lp + addr1);
+                HANDLE_OP_END();
+            }
+#endif
+
             /* memory load instructions */
             HANDLE_OP(WASM_OP_I32_LOAD)
             {
@@ -2840,6 +3162,16 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(EXT_OP_COPY_STACK_TOP_V128)
+            {
+                addr1 = GET_OFFSET();
+                addr2 = GET_OFFSET();
+                wasm_simd_copy_v128(frame_lp + addr2, frame_lp + addr1);
+                HANDLE_OP_END();
+            }
+#endif
+
             HANDLE_OP(EXT_OP_COPY_STACK_VALUES)
             {
                 uint32 values_count, total_cell;
@@ -2884,6 +3216,12 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                     PUT_I64_TO_ADDR((uint32 *)(frame_lp + local_offset),
                                     GET_I64_FROM_ADDR(frame_lp + addr1));
                 }
+#if WASM_ENABLE_SIMD != 0
+                else if (local_type == VALUE_TYPE_V128) {
+                    wasm_simd_copy_v128(frame_lp + local_offset,
+                                        frame_lp + addr1);
+                }
+#endif
                 else {
                     wasm_set_exception(module, "invalid local type");
                     goto got_exception;
@@ -3224,6 +3562,143 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                 HANDLE_OP_END();
             }
 
+#if WASM_ENABLE_SIMD != 0
+            HANDLE_OP(WASM_OP_SIMD_PREFIX)
+            {
+                uint32 offset, addr, cells[12];
+                uint64 mask_low, mask_high;
+                uint8 lane = 0, param_cell_num, result_cell_num;
+                int32 i;
+
+                GET_OPCODE();
+                switch (opcode) {
+                    case SIMD_v128_load:
+                    case SIMD_v128_load8x8_s:
+                    case SIMD_v128_load8x8_u:
+                    case SIMD_v128_load16x4_s:
+                    case SIMD_v128_load16x4_u:
+                    case SIMD_v128_load32x2_s:
+                    case SIMD_v128_load32x2_u:
+                    case SIMD_v128_load8_splat:
+                    case SIMD_v128_load16_splat:
+                    case SIMD_v128_load32_splat:
+                    case SIMD_v128_load64_splat:
+                    case SIMD_v128_load32_zero:
+                    case SIMD_v128_load64_zero:
+                    {
+                        offset = read_uint32(frame_ip);
+                        addr = frame_lp[GET_OFFSET()];
+                        addr_ret = GET_OFFSET();
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        wasm_simd_load(opcode, 0, maddr, frame_lp + addr_ret);
+                        break;
+                    }
+
+                    case SIMD_v128_load8_lane:
+                    case SIMD_v128_load16_lane:
+                    case SIMD_v128_load32_lane:
+                    case SIMD_v128_load64_lane:
+                    {
+                        offset = read_uint32(frame_ip);
+                        GET_SIMD_LANE();
+                        addr1 = GET_OFFSET();
+                        addr = frame_lp[GET_OFFSET()];
+                        addr_ret = GET_OFFSET();
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        if (addr_ret != addr1)
+                            wasm_simd_copy_v128(frame_lp + addr_ret,
+                                                frame_lp + addr1);
+                        wasm_simd_load(opcode, lane, maddr,
+                                       frame_lp + addr_ret);
+                        break;
+                    }
+
+                    case SIMD_v128_store:
+                    case SIMD_v128_store8_lane:
+                    case SIMD_v128_store16_lane:
+                    case SIMD_v128_store32_lane:
+                    case SIMD_v128_store64_lane:
+                    {
+                        offset = read_uint32(frame_ip);
+                        if (opcode != SIMD_v128_store) {
+                            GET_SIMD_LANE();
+                        }
+                        addr1 = GET_OFFSET();
+                        addr = frame_lp[GET_OFFSET()];
+                        CHECK_MEMORY_OVERFLOW(
+                            wasm_simd_get_mem_access_size(opcode));
+                        wasm_simd_store(opcode, lane, maddr, frame_lp + addr1);
+                        break;
+                    }
+
+                    /* only emitted when the const buffer is full */
+                    case SIMD_v128_const:
+                    {
+                        bh_memcpy_s(cells, sizeof(V128), frame_ip,
+                                    sizeof(V128));
+                        frame_ip += sizeof(V128);
+                        addr_ret = GET_OFFSET();
+                        wasm_simd_copy_v128(frame_lp + addr_ret, cells);
+                        break;
+                    }
+
+                    case SIMD_v8x16_shuffle:
+                    {
+                        bh_memcpy_s(&mask_low, sizeof(uint64), frame_ip,
+                                    sizeof(uint64));
+                        frame_ip += sizeof(uint64);
+                        bh_memcpy_s(&mask_high, sizeof(uint64), frame_ip,
+                                    sizeof(uint64));
+                        frame_ip += sizeof(uint64);
+                        addr2 = GET_OFFSET();
+                        addr1 = GET_OFFSET();
+                        addr_ret = GET_OFFSET();
+                        wasm_simd_copy_v128(cells, frame_lp + addr1);
+                        wasm_simd_copy_v128(cells + 4, frame_lp + addr2);
+                        wasm_simd_shuffle(cells, mask_low, mask_high);
+                        wasm_simd_copy_v128(frame_lp + addr_ret, cells);
+                        break;
+                    }
+
+                    default:
+                    {
+                        if (opcode >= SIMD_i8x16_extract_lane_s
+                            && opcode <= SIMD_f64x2_replace_lane) {
+                            GET_SIMD_LANE();
+                        }
+
+                        wasm_simd_get_op_cell_num(opcode, &param_cell_num,
+                                                  &result_cell_num);
+                        /* the operand offsets were emitted in the pop order,
+                           the scalar operand (if any) is the first one */
+                        i = param_cell_num;
+                        if (param_cell_num % 4) {
+                            i -= param_cell_num % 4;
+                            addr1 = GET_OFFSET();
+                            cells[i] = frame_lp[addr1];
+                            if (param_cell_num % 4 == 2)
+                                cells[i + 1] = frame_lp[addr1 + 1];
+                        }
+                        while (i > 0) {
+                            i -= 4;
+                            wasm_simd_copy_v128(cells + i,
+                                                frame_lp + GET_OFFSET());
+                        }
+
+                        wasm_simd_exec_op(opcode, lane, cells);
+
+                        addr_ret = GET_OFFSET();
+                        for (i = 0; i < result_cell_num; i++)
+                            frame_lp[addr_ret + i] = cells[i];
+                        break;
+                    }
+                }
+                HANDLE_OP_END();
+            }
+#endif /* end of WASM_ENABLE_SIMD != 0 */
+
 #if WASM_ENABLE_SHARED_MEMORY != 0
             HANDLE_OP(WASM_OP_ATOMIC_PREFIX)
             {
@@ -3647,6 +4122,9 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
         HANDLE_OP(WASM_OP_GET_LOCAL)
         HANDLE_OP(WASM_OP_DROP)
         HANDLE_OP(WASM_OP_DROP_64)
+#if WASM_ENABLE_SIMD != 0
+        HANDLE_OP(WASM_OP_DROP_V128)
+#endif
         HANDLE_OP(WASM_OP_BLOCK)
         HANDLE_OP(WASM_OP_LOOP)
         HANDLE_OP(WASM_OP_END)
@@ -3674,6 +4152,8 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
         uint32 *lp;
         int i;
 
+        PREPARE_FUNCTION(module, cur_func);
+
         if (!(lp_base = lp = wasm_runtime_malloc(cur_func->param_cell_num
                                                  * sizeof(uint32)))) {
             wasm_set_exception(module, "allocate memory failed");
@@ -3687,6 +4167,14 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                                     2 * (cur_func->param_count - i - 1)));
                 lp += 2;
             }
+#if WASM_ENABLE_SIMD != 0
+            else if (cur_func->param_types[i] == VALUE_TYPE_V128) {
+                wasm_simd_copy_v128(lp,
+                                    GET_OPERAND_V128_ADDR(
+                                        2 * (cur_func->param_count - i - 1)));
+                lp += 4;
+            }
+#endif
             else {
                 *lp = GET_OPERAND(uint32, I32,
                                   (2 * (cur_func->param_count - i - 1)));
@@ -3711,6 +4199,15 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
         WASMInterpFrame *outs_area = wasm_exec_env_wasm_stack_top(exec_env);
         int i;
 
+        /* Import functions are always prepared, while the function
+           of the sub module is prepared before its consts are used */
+        PREPARE_FUNCTION(module, cur_func);
+#if WASM_ENABLE_LAZY_PREPARE != 0 && WASM_ENABLE_MULTI_MODULE != 0
+        if (cur_func->is_import_func && cur_func->import_func_inst)
+            PREPARE_FUNCTION(cur_func->import_module_inst,
+                             cur_func->import_func_inst);
+#endif
+
 #if WASM_ENABLE_MULTI_MODULE != 0
         if (cur_func->is_import_func) {
             outs_area->lp = outs_area->operand
@@ -3739,6 +4236,14 @@ wasm_interp_call_func_bytecode(WASMModuleInstance *module,
                                 2 * (cur_func->param_count - i - 1)));
                 outs_area->lp += 2;
             }
+#if WASM_ENABLE_SIMD != 0
+            else if (cur_func->param_types[i] == VALUE_TYPE_V128) {
+                wasm_simd_copy_v128(outs_area->lp,
+                                    GET_OPERAND_V128_ADDR(
+                                        2 * (cur_func->param_count - i - 1)));
+                outs_area->lp += 4;
+            }
+#endif
             else {
                 *outs_area->lp = GET_OPERAND(
                     uint32, I32, (2 * (cur_func->param_count - i - 1)));
@@ -3911,6 +4416,12 @@ wasm_interp_call_wasm(WASMModuleInstance *module_inst, WASMExecEnv *exec_env,
     }
     argc = function->param_cell_num;
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    if (!wasm_is_function_prepared(function)
+        && !prepare_function(module_inst, module_inst, function))
+        return;
+#endif
+
 #ifndef OS_ENABLE_HW_BOUND_CHECK
     if ((uint8 *)&prev_frame < exec_env->native_stack_boundary) {
         wasm_set_exception((WASMModuleInstance *)exec_env->module_inst,
@@ -17,6 +17,7 @@
 #if WASM_ENABLE_FAST_JIT != 0
 #include "../fast-jit/jit_compiler.h"
 #include "../fast-jit/jit_codecache.h"
+#include "../fast-jit/jit_disk_cache.h"
 #endif
 #if WASM_ENABLE_JIT != 0
 #include "../compilation/aot_llvm.h"
@@ -246,9 +247,7 @@ is_value_type(uint8 type)
         || type == VALUE_TYPE_FUNCREF || type == VALUE_TYPE_EXTERNREF
 #endif
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
         || type == VALUE_TYPE_V128
-#endif
 #endif
     )
         return true;
@@ -262,7 +261,6 @@ is_byte_a_type(uint8 type)
 }
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
 static V128
 read_i8x16(uint8 *p_buf, char *error_buf, uint32 error_buf_size)
 {
@@ -275,7 +273,6 @@ read_i8x16(uint8 *p_buf, char *error_buf, uint32 error_buf_size)
 
     return result;
 }
-#endif /* end of (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
 #endif /* end of WASM_ENABLE_SIMD */
 
 static void *
@@ -476,7 +473,6 @@ load_init_expr(const uint8 **p_buf, const uint8 *buf_end,
                 *p_float++ = *p++;
             break;
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
         case INIT_EXPR_TYPE_V128_CONST:
         {
             uint64 high, low;
@@ -495,7 +491,6 @@ load_init_expr(const uint8 **p_buf, const uint8 *buf_end,
             init_expr->u.v128.i64x2[1] = low;
             break;
         }
-#endif /* end of (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
 #endif /* end of WASM_ENABLE_SIMD */
 #if WASM_ENABLE_REF_TYPES != 0
         case INIT_EXPR_TYPE_FUNCREF_CONST:
@@ -1141,6 +1136,9 @@ load_function_import(const uint8 **p_buf, const uint8 *buf_end,
     function->signature = linked_signature;
     function->attachment = linked_attachment;
     function->call_conv_raw = linked_call_conv_raw;
+    if (is_native_symbol && !linked_call_conv_raw)
+        function->call_shape = wasm_runtime_get_native_call_shape(
+            declare_func_type, linked_signature);
 #if WASM_ENABLE_MULTI_MODULE != 0
     function->import_module = is_native_symbol ? NULL : sub_module;
     function->import_func_linked = is_native_symbol ? NULL : linked_func;
@@ -2250,10 +2248,8 @@ load_export_section(const uint8 *buf, const uint8 *buf_end, WASMModule *module,
                         return false;
                     }
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
                     /* TODO: check func type, if it has v128 param or result,
                              report error */
-#endif
 #endif
                     break;
                 /* table index */
@@ -2953,6 +2949,99 @@ calculate_global_data_offset(WASMModule *module)
 }
 
 #if WASM_ENABLE_JIT != 0
+/* Translate the module into LLVM IR, add it to the ORC JIT and look up
+   the lazily compiled jit functions */
+static bool
+generate_llvm_jit_functions(WASMModule *module, char *error_buf,
+                            uint32 error_buf_size)
+{
+    AOTCompOption option = { 0 };
+    char *aot_last_error;
+    uint32 i;
+
+    module->comp_data = aot_create_comp_data(module);
+    if (!module->comp_data) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    option.is_jit_mode = true;
+    option.opt_level = 3;
+    option.size_level = 3;
+#if WASM_ENABLE_BULK_MEMORY != 0
+    option.enable_bulk_memory = true;
+#endif
+#if WASM_ENABLE_THREAD_MGR != 0
+    option.enable_thread_mgr = true;
+#endif
+#if WASM_ENABLE_TAIL_CALL != 0
+    option.enable_tail_call = true;
+#endif
+#if WASM_ENABLE_SIMD != 0
+    option.enable_simd = true;
+#endif
+#if WASM_ENABLE_REF_TYPES != 0
+    option.enable_ref_types = true;
+#endif
+    option.enable_aux_stack_check = true;
+#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
+    option.enable_aux_stack_frame = true;
+#endif
+    /* The object files are cached by the hash of the module content */
+    if (module->load_addr)
+        option.cache_dir =
+            (char *)wasm_runtime_get_llvm_jit_options().object_cache_dir;
+
+    module->comp_ctx = aot_create_comp_context(module->comp_data, &option);
+    if (!module->comp_ctx) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    if (!aot_compile_wasm(module->comp_ctx)) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    bh_print_time("Begin to lookup jit functions");
+
+    for (i = 0; i < module->function_count; i++) {
+        LLVMOrcJITTargetAddress func_addr = 0;
+        LLVMErrorRef error;
+        char func_name[48];
+
+        snprintf(func_name, sizeof(func_name), "%s%d", AOT_FUNC_PREFIX, i);
+        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
+                                       func_name);
+        if (error != LLVMErrorSuccess) {
+            char *err_msg = LLVMGetErrorMessage(error);
+            set_error_buf_v(error_buf, error_buf_size,
+                            "failed to compile orc jit function: %s", err_msg);
+            LLVMDisposeErrorMessage(err_msg);
+            return false;
+        }
+
+        /**
+         * No need to lock the func_ptr[func_idx] here as it is basic
+         * data type, the load/store for it can be finished by one cpu
+         * instruction, and there can be only one cpu instruction
+         * loading/storing at the same time.
+         */
+        module->func_ptrs[i] = (void *)func_addr;
+        module->functions[i]->llvm_jit_func_ptr = (void *)func_addr;
+    }
+
+    return true;
+}
+
+#if WASM_ENABLE_FAST_JIT == 0
 static void *
 orcjit_thread_callback(void *arg)
 {
@@ -3005,6 +3094,100 @@ orcjit_thread_callback(void *arg)
 
     return NULL;
 }
+#else
+/* Compile the functions which become hot in Fast JIT code, and make the
+   Fast JIT func ptrs point to the stub, which calls the LLVM jitted code
+   for them */
+static void *
+orcjit_thread_callback(void *arg)
+{
+    LLVMOrcJITTargetAddress func_addr = 0;
+    OrcJitThreadArg *thread_arg = (OrcJitThreadArg *)arg;
+    WASMModule *module = thread_arg->module;
+    uint32 group_stride = WASM_ORC_JIT_BACKEND_THREAD_NUM;
+    uint32 func_count = module->function_count;
+    uint32 i, j, k;
+    typedef void (*F)(void);
+    LLVMErrorRef error;
+    char func_name[48], error_buf[128];
+    bool ret;
+    union {
+        F f;
+        void *v;
+    } u;
+
+    os_mutex_lock(&module->tier_up_lock);
+    while (!module->orcjit_stop_compiling) {
+        if (module->tier_up_queue_head == module->tier_up_queue_tail
+            || module->llvm_ir_generating) {
+            os_cond_wait(&module->tier_up_cond, &module->tier_up_lock);
+            continue;
+        }
+
+        if (module->llvm_ir_failed) {
+            /* Keep running the hot functions with Fast JIT */
+            module->tier_up_queue_head = module->tier_up_queue_tail;
+            continue;
+        }
+
+        if (!module->llvm_ir_generated) {
+            /* Generate the LLVM IR when the first function is queued
+               rather than when loading, the other threads wait for it */
+            module->llvm_ir_generating = true;
+            os_mutex_unlock(&module->tier_up_lock);
+            ret = generate_llvm_jit_functions(module, error_buf,
+                                              sizeof(error_buf));
+            if (!ret)
+                os_printf("failed to generate llvm jit functions: %s\n",
+                          error_buf);
+            os_mutex_lock(&module->tier_up_lock);
+            module->llvm_ir_generating = false;
+            module->llvm_ir_generated = ret;
+            module->llvm_ir_failed = !ret;
+            os_cond_broadcast(&module->tier_up_cond);
+            continue;
+        }
+
+        i = module->tier_up_queue[module->tier_up_queue_head++];
+        if (module->func_ptrs_compiled[i])
+            /* Compiled together with another hot function */
+            continue;
+        os_mutex_unlock(&module->tier_up_lock);
+
+        snprintf(func_name, sizeof(func_name), "%s%d%s", AOT_FUNC_PREFIX, i,
+                 "_wrapper");
+        LOG_VERBOSE("JIT: tier up func %s to llvm jit", func_name);
+        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
+                                       func_name);
+        if (error != LLVMErrorSuccess) {
+            char *err_msg = LLVMGetErrorMessage(error);
+            os_printf("failed to compile orc jit function: %s", err_msg);
+            LLVMDisposeErrorMessage(err_msg);
+            os_mutex_lock(&module->tier_up_lock);
+            continue;
+        }
+
+        /* Call the jit wrapper function to trigger its compilation,
+           the functions of the same group are compiled together */
+        u.v = (void *)func_addr;
+        u.f();
+
+        os_mutex_lock(&module->tier_up_lock);
+        for (j = 0; j < WASM_ORC_JIT_COMPILE_THREAD_NUM; j++) {
+            k = i + j * group_stride;
+            if (k < func_count && !module->func_ptrs_compiled[k]) {
+                module->func_ptrs_compiled[k] = true;
+                /* The later calls from Fast JIT code go to the stub */
+                module->fast_jit_func_ptrs[k] =
+                    jit_compiler_get_jit_globals()->call_to_interp_from_jitted;
+            }
+        }
+    }
+    os_mutex_unlock(&module->tier_up_lock);
+
+    return NULL;
+}
+#endif
 
 static void
 orcjit_stop_compile_threads(WASMModule *module)
@@ -3012,10 +3195,21 @@ orcjit_stop_compile_threads(WASMModule *module)
     uint32 i, thread_num = (uint32)(sizeof(module->orcjit_thread_args)
                                     / sizeof(OrcJitThreadArg));
 
+#if WASM_ENABLE_FAST_JIT != 0
+    if (module->tier_up_queue) {
+        /* Wake up the threads waiting for hot functions */
+        os_mutex_lock(&module->tier_up_lock);
+        module->orcjit_stop_compiling = true;
+        os_cond_broadcast(&module->tier_up_cond);
+        os_mutex_unlock(&module->tier_up_lock);
+    }
+#endif
     module->orcjit_stop_compiling = true;
     for (i = 0; i < thread_num; i++) {
-        if (module->orcjit_threads[i])
+        if (module->orcjit_threads[i]) {
             os_thread_join(module->orcjit_threads[i], NULL);
+            module->orcjit_threads[i] = 0;
+        }
     }
 }
 
@@ -3023,95 +3217,56 @@ static bool
 compile_llvm_jit_functions(WASMModule *module, char *error_buf,
                            uint32 error_buf_size)
 {
-    AOTCompOption option = { 0 };
-    char *aot_last_error;
     uint64 size;
     uint32 thread_num, i;
 
     if (module->function_count > 0) {
         size = sizeof(void *) * (uint64)module->function_count
                + sizeof(bool) * (uint64)module->function_count;
+#if WASM_ENABLE_FAST_JIT != 0
+        size += sizeof(uint32) * (uint64)module->function_count
+                + sizeof(bool) * (uint64)module->function_count;
+#endif
         if (!(module->func_ptrs =
                   loader_malloc(size, error_buf, error_buf_size))) {
             return false;
         }
+#if WASM_ENABLE_FAST_JIT != 0
+        /* Put the queue before bool arrays to keep it aligned */
+        module->tier_up_queue =
+            (uint32 *)((uint8 *)module->func_ptrs
+                       + sizeof(void *) * module->function_count);
+        module->func_ptrs_compiled =
+            (bool *)(module->tier_up_queue + module->function_count);
+        module->tier_up_requested =
+            module->func_ptrs_compiled + module->function_count;
+
+        if (os_mutex_init(&module->tier_up_lock) != 0) {
+            module->tier_up_queue = NULL;
+            set_error_buf(error_buf, error_buf_size, "init mutex failed");
+            return false;
+        }
+        if (os_cond_init(&module->tier_up_cond) != 0) {
+            os_mutex_destroy(&module->tier_up_lock);
+            module->tier_up_queue = NULL;
+            set_error_buf(error_buf, error_buf_size, "init cond failed");
+            return false;
+        }
+#else
         module->func_ptrs_compiled =
             (bool *)((uint8 *)module->func_ptrs
                      + sizeof(void *) * module->function_count);
-    }
-
-    module->comp_data = aot_create_comp_data(module);
-    if (!module->comp_data) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
-    }
-
-    option.is_jit_mode = true;
-    option.opt_level = 3;
-    option.size_level = 3;
-#if WASM_ENABLE_BULK_MEMORY != 0
-    option.enable_bulk_memory = true;
-#endif
-#if WASM_ENABLE_THREAD_MGR != 0
-    option.enable_thread_mgr = true;
-#endif
-#if WASM_ENABLE_TAIL_CALL != 0
-    option.enable_tail_call = true;
 #endif
-#if WASM_ENABLE_SIMD != 0
-    option.enable_simd = true;
-#endif
-#if WASM_ENABLE_REF_TYPES != 0
-    option.enable_ref_types = true;
-#endif
-    option.enable_aux_stack_check = true;
-#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0)
-    option.enable_aux_stack_frame = true;
-#endif
-
-    module->comp_ctx = aot_create_comp_context(module->comp_data, &option);
-    if (!module->comp_ctx) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
-    }
-
-    if (!aot_compile_wasm(module->comp_ctx)) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
     }
 
-    bh_print_time("Begin to lookup jit functions");
-
-    for (i = 0; i < module->function_count; i++) {
-        LLVMOrcJITTargetAddress func_addr = 0;
-        LLVMErrorRef error;
-        char func_name[48];
-
-        snprintf(func_name, sizeof(func_name), "%s%d", AOT_FUNC_PREFIX, i);
-        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
-                                       func_name);
-        if (error != LLVMErrorSuccess) {
-            char *err_msg = LLVMGetErrorMessage(error);
-            set_error_buf_v(error_buf, error_buf_size,
-                            "failed to compile orc jit function: %s", err_msg);
-            LLVMDisposeErrorMessage(err_msg);
+#if WASM_ENABLE_FAST_JIT != 0
+    /* In tier-up mode the LLVM IR is generated by the compile threads
+       when the first function becomes hot in Fast JIT code */
+    if (!module->tier_up_queue)
+#endif
+    {
+        if (!generate_llvm_jit_functions(module, error_buf, error_buf_size))
             return false;
-        }
-
-        /**
-         * No need to lock the func_ptr[func_idx] here as it is basic
-         * data type, the load/store for it can be finished by one cpu
-         * instruction, and there can be only one cpu instruction
-         * loading/storing at the same time.
-         */
-        module->func_ptrs[i] = (void *)func_addr;
-        module->functions[i]->llvm_jit_func_ptr = (void *)func_addr;
     }
 
     bh_print_time("Begin to compile jit functions");
@@ -3119,6 +3274,13 @@ compile_llvm_jit_functions(WASMModule *module, char *error_buf,
     thread_num =
         (uint32)(sizeof(module->orcjit_thread_args) / sizeof(OrcJitThreadArg));
 
+#if WASM_ENABLE_FAST_JIT != 0
+    /* Functions are run by Fast JIT first, only the functions hot in
+       Fast JIT code are compiled by the threads */
+    if (!module->tier_up_queue)
+        thread_num = 0;
+#endif
+
     /* Create threads to compile the jit functions */
     for (i = 0; i < thread_num; i++) {
         module->orcjit_thread_args[i].comp_ctx = module->comp_ctx;
@@ -3129,20 +3291,17 @@ compile_llvm_jit_functions(WASMModule *module, char *error_buf,
                              (void *)&module->orcjit_thread_args[i],
                              APP_THREAD_STACK_SIZE_DEFAULT)
             != 0) {
-            uint32 j;
-
             set_error_buf(error_buf, error_buf_size,
                           "create orcjit compile thread failed");
-            /* Terminate the threads created */
-            module->orcjit_stop_compiling = true;
-            for (j = 0; j < i; j++) {
-                os_thread_join(module->orcjit_threads[j], NULL);
-            }
+            /* Terminate the threads created, the module is unloaded
+               by the caller */
+            module->orcjit_threads[i] = 0;
+            orcjit_stop_compile_threads(module);
             return false;
         }
     }
 
-#if WASM_ENABLE_LAZY_JIT == 0
+#if WASM_ENABLE_LAZY_JIT == 0 && WASM_ENABLE_FAST_JIT == 0
     /* Wait until all jit functions are compiled for eager mode */
     for (i = 0; i < thread_num; i++) {
         os_thread_join(module->orcjit_threads[i], NULL);
@@ -3155,9 +3314,31 @@ compile_llvm_jit_functions(WASMModule *module, char *error_buf,
 }
 #endif /* end of WASM_ENABLE_JIT != 0 */
 
+/* The properties of the module found in the function bodies, they are
+   recorded by the caller of wasm_loader_prepare_bytecode and set to the
+   module after all the functions are prepared, since the functions may
+   be prepared by multiple loader threads */
+typedef struct ModuleFlags {
+    /* Whether there is memory.grow or memory.size */
+    bool possible_memory_grow;
+    /* Whether there is table.set, table.grow, table.fill, table.copy
+       or table.init */
+    bool possible_table_mutation;
+} ModuleFlags;
+
+static void
+set_module_flags(WASMModule *module, const ModuleFlags *flags)
+{
+    if (flags->possible_memory_grow)
+        module->possible_memory_grow = true;
+    if (flags->possible_table_mutation)
+        module->possible_table_mutation = true;
+}
+
 static bool
 wasm_loader_prepare_bytecode(WASMModule *module, WASMFunction *func,
-                             uint32 cur_func_idx, char *error_buf,
+                             uint32 cur_func_idx, bool validate_only,
+                             ModuleFlags *module_flags, char *error_buf,
                              uint32 error_buf_size);
 
 #if WASM_ENABLE_FAST_INTERP != 0 && WASM_ENABLE_LABELS_AS_VALUES != 0
@@ -3167,6 +3348,123 @@ wasm_interp_get_handle_table();
 static void **handle_table;
 #endif
 
+#if WASM_ENABLE_DEBUG_INTERP == 0
+typedef struct PrepareBytecodeContext {
+    WASMModule *module;
+    /* lock to take the functions to prepare and to record the error */
+    korp_mutex lock;
+    /* Index of the next function to prepare */
+    uint32 next_func_idx;
+    /* Index of the first function failed to prepare, (uint32)-1 if
+       no function fails */
+    uint32 failed_func_idx;
+    /* Error message of the first function failed to prepare */
+    char error_buf[256];
+    /* Module flags merged from all the threads */
+    ModuleFlags module_flags;
+} PrepareBytecodeContext;
+
+static void
+merge_module_flags(ModuleFlags *dst, const ModuleFlags *src)
+{
+    dst->possible_memory_grow |= src->possible_memory_grow;
+    dst->possible_table_mutation |= src->possible_table_mutation;
+}
+
+static void *
+prepare_bytecode_thread_callback(void *arg)
+{
+    PrepareBytecodeContext *ctx = (PrepareBytecodeContext *)arg;
+    WASMModule *module = ctx->module;
+    ModuleFlags module_flags = { 0 };
+    char error_buf[256];
+    uint32 func_idx;
+
+    while (true) {
+        /* The functions are taken in ascending order, and the ones after
+           a failed function are skipped as the sequential loading never
+           prepares them */
+        os_mutex_lock(&ctx->lock);
+        func_idx = ctx->next_func_idx++;
+        if (func_idx >= module->function_count
+            || func_idx > ctx->failed_func_idx) {
+            os_mutex_unlock(&ctx->lock);
+            break;
+        }
+        os_mutex_unlock(&ctx->lock);
+
+        if (!wasm_loader_prepare_bytecode(
+                module, module->functions[func_idx], func_idx,
+                WASM_ENABLE_LAZY_PREPARE != 0, &module_flags, error_buf,
+                sizeof(error_buf))) {
+            /* Keep the error of the function with the smallest index, which
+               is the one reported by the sequential loading */
+            os_mutex_lock(&ctx->lock);
+            if (func_idx < ctx->failed_func_idx) {
+                ctx->failed_func_idx = func_idx;
+                snprintf(ctx->error_buf, sizeof(ctx->error_buf), "%s",
+                         error_buf);
+            }
+            os_mutex_unlock(&ctx->lock);
+            break;
+        }
+    }
+
+    os_mutex_lock(&ctx->lock);
+    merge_module_flags(&ctx->module_flags, &module_flags);
+    os_mutex_unlock(&ctx->lock);
+    return NULL;
+}
+
+static bool
+prepare_bytecode_in_threads(WASMModule *module, uint32 thread_num,
+                            char *error_buf, uint32 error_buf_size)
+{
+    PrepareBytecodeContext ctx = { 0 };
+    korp_tid tids[WASM_LOADER_MAX_THREAD_NUM];
+    uint32 created_thread_num = 0, i;
+
+    bh_assert(thread_num <= WASM_LOADER_MAX_THREAD_NUM);
+
+    ctx.module = module;
+    ctx.failed_func_idx = (uint32)-1;
+    if (os_mutex_init(&ctx.lock) != 0) {
+        set_error_buf(error_buf, error_buf_size, "init lock failed");
+        return false;
+    }
+
+    /* The calling thread is also one of the loader threads, if a thread
+       fails to be created, go on with the threads created */
+    for (i = 0; i < thread_num - 1; i++) {
+        if (os_thread_create(&tids[created_thread_num],
+                             prepare_bytecode_thread_callback, &ctx,
+                             APP_THREAD_STACK_SIZE_DEFAULT)
+            != 0) {
+            LOG_WARNING("warning: create loader thread failed");
+            break;
+        }
+        created_thread_num++;
+    }
+
+    prepare_bytecode_thread_callback(&ctx);
+
+    for (i = 0; i < created_thread_num; i++) {
+        os_thread_join(tids[i], NULL);
+    }
+    os_mutex_destroy(&ctx.lock);
+
+    /* All the threads are joined, no one accesses the module flags */
+    set_module_flags(module, &ctx.module_flags);
+
+    if (ctx.failed_func_idx != (uint32)-1) {
+        if (error_buf != NULL)
+            snprintf(error_buf, error_buf_size, "%s", ctx.error_buf);
+        return false;
+    }
+    return true;
+}
+#endif /* end of WASM_ENABLE_DEBUG_INTERP == 0 */
+
 static bool
 load_from_sections(WASMModule *module, WASMSection *sections,
                    bool is_load_from_file_buf, char *error_buf,
@@ -3181,7 +3479,7 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     uint32 aux_data_end = (uint32)-1, aux_heap_base = (uint32)-1;
     uint32 aux_stack_top = (uint32)-1, global_index, func_index, i;
     uint32 aux_data_end_global_index = (uint32)-1;
-    uint32 aux_heap_base_global_index = (uint32)-1;
+    uint32 aux_heap_base_global_index = (uint32)-1, thread_num = 1;
     WASMType *func_type;
 
     /* Find code and function sections if have */
@@ -3482,15 +3780,43 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     handle_table = wasm_interp_get_handle_table();
 #endif
 
-    for (i = 0; i < module->function_count; i++) {
-        WASMFunction *func = module->functions[i];
-        if (!wasm_loader_prepare_bytecode(module, func, i, error_buf,
-                                          error_buf_size)) {
+#if WASM_ENABLE_DEBUG_INTERP == 0
+    /* The function bodies are independent of each other, prepare them with
+       multiple threads if required. Not supported by the debug interpreter
+       as it records the patched opcodes of all functions in one list */
+    thread_num = wasm_runtime_get_loader_thread_num();
+    if (thread_num > module->function_count)
+        thread_num = module->function_count;
+#endif
+
+    if (thread_num > 1) {
+#if WASM_ENABLE_DEBUG_INTERP == 0
+        if (!prepare_bytecode_in_threads(module, thread_num, error_buf,
+                                         error_buf_size)) {
             return false;
         }
+#endif
+    }
+    else {
+        ModuleFlags module_flags = { 0 };
+
+        for (i = 0; i < module->function_count; i++) {
+            /* With lazy preparation, the function is only validated here,
+               and its bytecode is translated when it is called the first
+               time */
+            if (!wasm_loader_prepare_bytecode(
+                    module, module->functions[i], i,
+                    WASM_ENABLE_LAZY_PREPARE != 0, &module_flags, error_buf,
+                    error_buf_size)) {
+                return false;
+            }
+        }
+        set_module_flags(module, &module_flags);
+    }
 
-        if (i == module->function_count - 1
-            && func->code + func->code_size != buf_code_end) {
+    if (module->function_count) {
+        WASMFunction *func = module->functions[module->function_count - 1];
+        if (func->code + func->code_size != buf_code_end) {
             set_error_buf(error_buf, error_buf_size,
                           "code section size mismatch");
             return false;
@@ -3565,17 +3891,26 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     calculate_global_data_offset(module);
 
 #if WASM_ENABLE_FAST_JIT != 0
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    jit_disk_cache_init_module(module);
+#endif
     if (module->function_count
         && !(module->fast_jit_func_ptrs =
                  loader_malloc(sizeof(void *) * module->function_count,
                                error_buf, error_buf_size))) {
         return false;
     }
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Functions are compiled when they become hot in interpreter */
+    if (module->function_count)
+        jit_compiler_init_func_ptrs(module);
+#else
     if (!jit_compiler_compile_all(module)) {
         set_error_buf(error_buf, error_buf_size, "fast jit compilation failed");
         return false;
     }
 #endif
+#endif
 
 #if WASM_ENABLE_JIT != 0
     if (!compile_llvm_jit_functions(module, error_buf, error_buf_size)) {
@@ -3612,6 +3947,17 @@ create_module(char *error_buf, uint32 error_buf_size)
     ret = bh_list_init(module->br_table_cache_list);
     bh_assert(ret == BH_LIST_SUCCESS);
     (void)ret;
+    if (os_mutex_init(&module->prepare_lock) != 0) {
+        wasm_runtime_free(module);
+        return NULL;
+    }
+#endif
+
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    if (os_mutex_init(&module->lazy_prepare_lock) != 0) {
+        wasm_runtime_free(module);
+        return NULL;
+    }
 #endif
 
 #if WASM_ENABLE_MULTI_MODULE != 0
@@ -3958,7 +4304,8 @@ wasm_loader_load(uint8 *buf, uint32 size,
         return NULL;
     }
 
-#if WASM_ENABLE_DEBUG_INTERP != 0 || WASM_ENABLE_FAST_JIT != 0
+#if WASM_ENABLE_DEBUG_INTERP != 0 || WASM_ENABLE_FAST_JIT != 0 \
+    || WASM_ENABLE_JIT != 0
     module->load_addr = (uint8 *)buf;
     module->load_size = size;
 #endif
@@ -3995,6 +4342,12 @@ wasm_loader_unload(WASMModule *module)
     /* Stop LLVM JIT compilation firstly to avoid accessing
        module internal data after they were freed */
     orcjit_stop_compile_threads(module);
+#if WASM_ENABLE_FAST_JIT != 0
+    if (module->tier_up_queue) {
+        os_cond_destroy(&module->tier_up_cond);
+        os_mutex_destroy(&module->tier_up_lock);
+    }
+#endif
     if (module->func_ptrs)
         wasm_runtime_free(module->func_ptrs);
     if (module->comp_ctx)
@@ -4014,11 +4367,26 @@ wasm_loader_unload(WASMModule *module)
     if (module->imports)
         wasm_runtime_free(module->imports);
 
+#if WASM_ENABLE_FAST_JIT != 0
+    /* The functions may be being compiled in background */
+    jit_compiler_cancel_compilation(module);
+
+    /* Free the jitted code of the functions rather than the code their
+       func ptrs point to, which may be the stub to call the function in
+       interpreter or LLVM jitted code */
+    if (module->fast_jit_code_size > 0)
+        jit_code_cache_free_module(module);
+#endif
+
     if (module->functions) {
         for (i = 0; i < module->function_count; i++) {
             if (module->functions[i]) {
                 if (module->functions[i]->local_offsets)
                     wasm_runtime_free(module->functions[i]->local_offsets);
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if (module->functions[i]->block_addr_table)
+                    wasm_runtime_free(module->functions[i]->block_addr_table);
+#endif
 #if WASM_ENABLE_FAST_INTERP != 0
                 if (module->functions[i]->code_compiled)
                     wasm_runtime_free(module->functions[i]->code_compiled);
@@ -4031,6 +4399,10 @@ wasm_loader_unload(WASMModule *module)
         wasm_runtime_free(module->functions);
     }
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    os_mutex_destroy(&module->lazy_prepare_lock);
+#endif
+
     if (module->tables)
         wasm_runtime_free(module->tables);
 
@@ -4078,6 +4450,7 @@ wasm_loader_unload(WASMModule *module)
             node = node_next;
         }
     }
+    os_mutex_destroy(&module->prepare_lock);
 #endif
 
 #if WASM_ENABLE_MULTI_MODULE != 0
@@ -4120,10 +4493,6 @@ wasm_loader_unload(WASMModule *module)
 
 #if WASM_ENABLE_FAST_JIT != 0
     if (module->fast_jit_func_ptrs) {
-        for (i = 0; i < module->function_count; i++) {
-            if (module->fast_jit_func_ptrs[i])
-                jit_code_cache_free(module->fast_jit_func_ptrs[i]);
-        }
         wasm_runtime_free(module->fast_jit_func_ptrs);
     }
 #endif
@@ -4131,6 +4500,41 @@ wasm_loader_unload(WASMModule *module)
     wasm_runtime_free(module);
 }
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+bool
+wasm_loader_prepare_function(WASMModule *module, uint32 func_idx,
+                             char *error_buf, uint32 error_buf_size)
+{
+    WASMFunction *func;
+    /* The module flags were set when the function was validated in
+       loading, the running module isn't changed again */
+    ModuleFlags module_flags = { 0 };
+    bool ret = true;
+
+    bh_assert(func_idx < module->function_count);
+    func = module->functions[func_idx];
+
+    /* The function may have been prepared for another module instance */
+    if (!func->code_compiled) {
+        if (!(ret = wasm_loader_prepare_bytecode(module, func, func_idx, false,
+                                                 &module_flags, error_buf,
+                                                 error_buf_size))) {
+            /* Drop the partially prepared code so that it can be
+               prepared again in the next call */
+            if (func->code_compiled) {
+                wasm_runtime_free(func->code_compiled);
+                func->code_compiled = NULL;
+            }
+            if (func->consts) {
+                wasm_runtime_free(func->consts);
+                func->consts = NULL;
+            }
+        }
+    }
+    return ret;
+}
+#endif
+
 bool
 wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
                             const uint8 *start_addr, const uint8 *code_end_addr,
@@ -4296,6 +4700,10 @@ wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
             case WASM_OP_SELECT:
             case WASM_OP_DROP_64:
             case WASM_OP_SELECT_64:
+#if WASM_ENABLE_SIMD != 0
+            case WASM_OP_DROP_V128:
+            case WASM_OP_SELECT_V128:
+#endif
                 break;
 
 #if WASM_ENABLE_REF_TYPES != 0
@@ -4325,6 +4733,10 @@ wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
             case WASM_OP_SET_GLOBAL:
             case WASM_OP_GET_GLOBAL_64:
             case WASM_OP_SET_GLOBAL_64:
+#if WASM_ENABLE_SIMD != 0
+            case WASM_OP_GET_GLOBAL_V128:
+            case WASM_OP_SET_GLOBAL_V128:
+#endif
             case WASM_OP_SET_GLOBAL_AUX_STACK:
                 skip_leb_uint32(p, p_end); /* local index */
                 break;
@@ -4569,7 +4981,6 @@ wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
             }
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
             case WASM_OP_SIMD_PREFIX:
             {
                 /* TODO: shall we ceate a table to be friendly to branch
@@ -4658,7 +5069,6 @@ wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
                 }
                 break;
             }
-#endif /* end of (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
 #endif /* end of WASM_ENABLE_SIMD */
 
 #if WASM_ENABLE_SHARED_MEMORY != 0
@@ -4787,6 +5197,13 @@ typedef struct WASMLoaderContext {
     uint32 csp_num;
     uint32 max_csp_num;
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    /* else and end addresses of the blocks validated */
+    BlockAddrEntry *block_addrs;
+    uint32 block_addr_num;
+    uint32 block_addrs_size;
+#endif
+
 #if WASM_ENABLE_FAST_INTERP != 0
     /* frame offset stack */
     int16 *frame_offset;
@@ -4945,9 +5362,7 @@ check_stack_top_values(uint8 *frame_ref, int32 stack_cell_num, uint8 type,
     if ((is_32bit_type(type) && stack_cell_num < 1)
         || (is_64bit_type(type) && stack_cell_num < 2)
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
         || (type == VALUE_TYPE_V128 && stack_cell_num < 4)
-#endif
 #endif
     ) {
         set_error_buf(error_buf, error_buf_size,
@@ -4959,12 +5374,10 @@ check_stack_top_values(uint8 *frame_ref, int32 stack_cell_num, uint8 type,
         || (is_64bit_type(type)
             && (*(frame_ref - 2) != type || *(frame_ref - 1) != type))
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
         || (type == VALUE_TYPE_V128
             && (*(frame_ref - 4) != REF_V128_1 || *(frame_ref - 3) != REF_V128_2
                 || *(frame_ref - 2) != REF_V128_3
                 || *(frame_ref - 1) != REF_V128_4))
-#endif
 #endif
     ) {
         set_error_buf_v(error_buf, error_buf_size, "%s%s%s",
@@ -5007,6 +5420,10 @@ wasm_loader_ctx_destroy(WASMLoaderContext *ctx)
 #endif
             wasm_runtime_free(ctx->frame_csp_bottom);
         }
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+        if (ctx->block_addrs)
+            wasm_runtime_free(ctx->block_addrs);
+#endif
 #if WASM_ENABLE_FAST_INTERP != 0
         if (ctx->frame_offset_bottom)
             wasm_runtime_free(ctx->frame_offset_bottom);
@@ -5090,7 +5507,6 @@ wasm_loader_push_frame_ref(WASMLoaderContext *ctx, uint8 type, char *error_buf,
     ctx->stack_cell_num++;
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
     if (type == VALUE_TYPE_V128) {
         if (!check_stack_push(ctx, error_buf, error_buf_size))
             return false;
@@ -5102,7 +5518,6 @@ wasm_loader_push_frame_ref(WASMLoaderContext *ctx, uint8 type, char *error_buf,
         ctx->stack_cell_num++;
     }
 #endif
-#endif
 
 check_stack_and_return:
     if (ctx->stack_cell_num > ctx->max_stack_cell_num)
@@ -5139,12 +5554,10 @@ wasm_loader_pop_frame_ref(WASMLoaderContext *ctx, uint8 type, char *error_buf,
     ctx->stack_cell_num--;
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
     if (type == VALUE_TYPE_V128) {
         ctx->frame_ref -= 2;
         ctx->stack_cell_num -= 2;
     }
-#endif
 #endif
     return true;
 }
@@ -5205,6 +5618,83 @@ fail:
     return false;
 }
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+static bool
+wasm_loader_add_block_addr(WASMLoaderContext *ctx, WASMFunction *func,
+                           BranchBlock *block, uint8 *end_addr,
+                           char *error_buf, uint32 error_buf_size)
+{
+    BlockAddrEntry *block_addr;
+
+    if (sizeof(BlockAddrEntry) * ctx->block_addr_num
+        >= ctx->block_addrs_size) {
+        uint32 size_new = ctx->block_addrs_size
+                              ? ctx->block_addrs_size * 2
+                              : (uint32)sizeof(BlockAddrEntry) * 8;
+        if (!ctx->block_addrs) {
+            if (!(ctx->block_addrs =
+                      loader_malloc(size_new, error_buf, error_buf_size)))
+                goto fail;
+        }
+        else {
+            MEM_REALLOC(ctx->block_addrs, ctx->block_addrs_size, size_new);
+        }
+        ctx->block_addrs_size = size_new;
+    }
+
+    block_addr = ctx->block_addrs + ctx->block_addr_num++;
+    block_addr->start_offset = (uint32)(block->start_addr - func->code);
+    block_addr->else_offset =
+        block->else_addr ? (uint32)(block->else_addr - func->code) : 0;
+    block_addr->end_offset = (uint32)(end_addr - func->code);
+    return true;
+fail:
+    return false;
+}
+
+static void
+wasm_loader_build_block_addr_table(WASMLoaderContext *ctx, WASMModule *module,
+                                   WASMFunction *func)
+{
+    BlockAddrEntry *table, *block_addr;
+    uint32 table_count = 8, table_size, i, j;
+
+    if (ctx->block_addr_num == 0)
+        return;
+
+    /* Keep the load factor of the table under 2/3 */
+    while (table_count < ctx->block_addr_num + ctx->block_addr_num / 2)
+        table_count *= 2;
+    table_size = (uint32)sizeof(BlockAddrEntry) * table_count;
+
+    os_mutex_lock(&module->prepare_lock);
+    if (table_size > BLOCK_ADDR_TABLE_BUDGET - module->block_addr_table_size) {
+        os_mutex_unlock(&module->prepare_lock);
+        LOG_VERBOSE("Block address table budget used up");
+        return;
+    }
+    module->block_addr_table_size += table_size;
+    os_mutex_unlock(&module->prepare_lock);
+
+    /* The table is an optimization only, fall back to the block address
+       cache if it fails to be allocated */
+    if (!(table = wasm_runtime_malloc(table_size)))
+        return;
+    memset(table, 0, table_size);
+
+    for (i = 0; i < ctx->block_addr_num; i++) {
+        block_addr = ctx->block_addrs + i;
+        j = block_addr->start_offset & (table_count - 1);
+        while (table[j].start_offset != 0)
+            j = (j + 1) & (table_count - 1);
+        table[j] = *block_addr;
+    }
+
+    func->block_addr_table = table;
+    func->block_addr_table_mask = table_count - 1;
+}
+#endif /* end of WASM_ENABLE_BLOCK_ADDR_TABLE != 0 */
+
 #if WASM_ENABLE_FAST_INTERP != 0
 
 #if WASM_ENABLE_LABELS_AS_VALUES != 0
@@ -5543,6 +6033,13 @@ preserve_referenced_local(WASMLoaderContext *loader_ctx, uint8 opcode,
                         loader_ctx->preserved_local_offset++;
                     emit_label(EXT_OP_COPY_STACK_TOP);
                 }
+#if WASM_ENABLE_SIMD != 0
+                else if (local_type == VALUE_TYPE_V128) {
+                    if (loader_ctx->p_code_compiled)
+                        loader_ctx->preserved_local_offset += 4;
+                    emit_label(EXT_OP_COPY_STACK_TOP_V128);
+                }
+#endif
                 else {
                     if (loader_ctx->p_code_compiled)
                         loader_ctx->preserved_local_offset += 2;
@@ -5557,6 +6054,10 @@ preserve_referenced_local(WASMLoaderContext *loader_ctx, uint8 opcode,
 
         if (is_32bit_type(cur_type))
             i++;
+#if WASM_ENABLE_SIMD != 0
+        else if (cur_type == VALUE_TYPE_V128)
+            i += 4;
+#endif
         else
             i += 2;
     }
@@ -5594,6 +6095,11 @@ preserve_local_for_block(WASMLoaderContext *loader_ctx, uint8 opcode,
         if (is_32bit_type(cur_type)) {
             i++;
         }
+#if WASM_ENABLE_SIMD != 0
+        else if (cur_type == VALUE_TYPE_V128) {
+            i += 4;
+        }
+#endif
         else {
             i += 2;
         }
@@ -5731,6 +6237,8 @@ wasm_loader_push_frame_offset(WASMLoaderContext *ctx, uint8 type,
                               bool disable_emit, int16 operand_offset,
                               char *error_buf, uint32 error_buf_size)
 {
+    uint32 cell_num;
+
     if (type == VALUE_TYPE_VOID)
         return true;
 
@@ -5757,18 +6265,22 @@ wasm_loader_push_frame_offset(WASMLoaderContext *ctx, uint8 type,
     if (is_32bit_type(type))
         return true;
 
-    if (ctx->p_code_compiled == NULL) {
-        if (!check_offset_push(ctx, error_buf, error_buf_size))
-            return false;
-    }
+    /* the remaining cells of i64/f64 (1 cell) and v128 (3 cells) */
+    cell_num = (uint32)wasm_value_type_cell_num(type) - 1;
+    while (cell_num-- > 0) {
+        if (ctx->p_code_compiled == NULL) {
+            if (!check_offset_push(ctx, error_buf, error_buf_size))
+                return false;
+        }
 
-    ctx->frame_offset++;
-    if (!disable_emit) {
-        ctx->dynamic_offset++;
-        if (ctx->dynamic_offset > ctx->max_dynamic_offset) {
-            ctx->max_dynamic_offset = ctx->dynamic_offset;
-            if (ctx->max_dynamic_offset >= INT16_MAX) {
-                goto fail;
+        ctx->frame_offset++;
+        if (!disable_emit) {
+            ctx->dynamic_offset++;
+            if (ctx->dynamic_offset > ctx->max_dynamic_offset) {
+                ctx->max_dynamic_offset = ctx->dynamic_offset;
+                if (ctx->max_dynamic_offset >= INT16_MAX) {
+                    goto fail;
+                }
             }
         }
     }
@@ -5816,13 +6328,16 @@ wasm_loader_pop_frame_offset(WASMLoaderContext *ctx, uint8 type,
             ctx->dynamic_offset -= 1;
     }
     else {
-        if (!check_offset_pop(ctx, 2))
+        /* i64/f64 takes 2 cells and v128 takes 4 cells */
+        uint32 cell_num = (uint32)wasm_value_type_cell_num(type);
+
+        if (!check_offset_pop(ctx, cell_num))
             return true;
 
-        ctx->frame_offset -= 2;
+        ctx->frame_offset -= cell_num;
         if ((*(ctx->frame_offset) > ctx->start_dynamic_offset)
             && (*(ctx->frame_offset) < ctx->max_dynamic_offset))
-            ctx->dynamic_offset -= 2;
+            ctx->dynamic_offset -= cell_num;
     }
     emit_operand(ctx, *(ctx->frame_offset));
     return true;
@@ -5905,7 +6420,6 @@ wasm_loader_get_const_offset(WASMLoaderContext *ctx, uint8 type, void *value,
     /* Search existing constant */
     for (c = (Const *)ctx->const_buf;
          (uint8 *)c < ctx->const_buf + ctx->num_const * sizeof(Const); c++) {
-        /* TODO: handle v128 type? */
         if ((type == c->value_type)
             && ((type == VALUE_TYPE_I64 && *(int64 *)value == c->value.i64)
                 || (type == VALUE_TYPE_I32 && *(int32 *)value == c->value.i32)
@@ -5918,13 +6432,21 @@ wasm_loader_get_const_offset(WASMLoaderContext *ctx, uint8 type, void *value,
                 || (type == VALUE_TYPE_F64
                     && (0 == memcmp(value, &(c->value.f64), sizeof(float64))))
                 || (type == VALUE_TYPE_F32
-                    && (0
-                        == memcmp(value, &(c->value.f32), sizeof(float32)))))) {
+                    && (0 == memcmp(value, &(c->value.f32), sizeof(float32))))
+#if WASM_ENABLE_SIMD != 0
+                || (type == VALUE_TYPE_V128
+                    && (0 == memcmp(value, &(c->value.v128), sizeof(V128))))
+#endif
+                    )) {
             operand_offset = c->slot_index;
             break;
         }
         if (is_32bit_type(c->value_type))
             operand_offset += 1;
+#if WASM_ENABLE_SIMD != 0
+        else if (c->value_type == VALUE_TYPE_V128)
+            operand_offset += 4;
+#endif
         else
             operand_offset += 2;
     }
@@ -5934,6 +6456,11 @@ wasm_loader_get_const_offset(WASMLoaderContext *ctx, uint8 type, void *value,
         if ((type == VALUE_TYPE_F64) || (type == VALUE_TYPE_I64)) {
             bytes_to_increase = 2;
         }
+#if WASM_ENABLE_SIMD != 0
+        else if (type == VALUE_TYPE_V128) {
+            bytes_to_increase = 4;
+        }
+#endif
         else {
             bytes_to_increase = 1;
         }
@@ -5976,6 +6503,15 @@ wasm_loader_get_const_offset(WASMLoaderContext *ctx, uint8 type, void *value,
                 c->value.i32 = *(int32 *)value;
                 ctx->const_cell_num++;
                 break;
+#if WASM_ENABLE_SIMD != 0
+            case VALUE_TYPE_V128:
+                bh_memcpy_s(&(c->value.v128), sizeof(WASMValue), value,
+                            sizeof(V128));
+                ctx->const_cell_num += 4;
+                /* use the last cell of the v128 const like i64/f64 */
+                operand_offset += 3;
+                break;
+#endif
 #if WASM_ENABLE_REF_TYPES != 0
             case VALUE_TYPE_EXTERNREF:
             case VALUE_TYPE_FUNCREF:
@@ -6131,17 +6667,21 @@ reserve_block_ret(WASMLoaderContext *loader_ctx, uint8 opcode,
 
     return_count = block_type_get_result_types(block_type, &return_types);
 
-    /* If there is only one return value, use EXT_OP_COPY_STACK_TOP/_I64 instead
-     * of EXT_OP_COPY_STACK_VALUES for interpreter performance. */
+    /* If there is only one return value, use EXT_OP_COPY_STACK_TOP/_I64/_V128
+     * instead of EXT_OP_COPY_STACK_VALUES for interpreter performance. */
     if (return_count == 1) {
         uint8 cell = (uint8)wasm_value_type_cell_num(return_types[0]);
-        if (cell <= 2 /* V128 isn't supported whose cell num is 4 */
-            && block->dynamic_offset != *(loader_ctx->frame_offset - cell)) {
+        if (block->dynamic_offset != *(loader_ctx->frame_offset - cell)) {
             /* insert op_copy before else opcode */
             if (opcode == WASM_OP_ELSE)
                 skip_label();
-            emit_label(cell == 1 ? EXT_OP_COPY_STACK_TOP
-                                 : EXT_OP_COPY_STACK_TOP_I64);
+#if WASM_ENABLE_SIMD != 0
+            if (cell == 4)
+                emit_label(EXT_OP_COPY_STACK_TOP_V128);
+            else
+#endif
+                emit_label(cell == 1 ? EXT_OP_COPY_STACK_TOP
+                                     : EXT_OP_COPY_STACK_TOP_I64);
             emit_operand(loader_ctx, *(loader_ctx->frame_offset - cell));
             emit_operand(loader_ctx, block->dynamic_offset);
 
@@ -6352,7 +6892,6 @@ check_memory_access_align(uint8 opcode, uint32 align, char *error_buf,
 }
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
 static bool
 check_simd_memory_access_align(uint8 opcode, uint32 align, char *error_buf,
                                uint32 error_buf_size)
@@ -6466,7 +7005,6 @@ check_simd_shuffle_mask(V128 mask, char *error_buf, uint32 error_buf_size)
     }
     return true;
 }
-#endif /* end of (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
 #endif /* end of WASM_ENABLE_SIMD */
 
 #if WASM_ENABLE_SHARED_MEMORY != 0
@@ -6858,7 +7396,8 @@ wasm_loader_get_custom_section(WASMModule *module, const char *name,
 
 static bool
 wasm_loader_prepare_bytecode(WASMModule *module, WASMFunction *func,
-                             uint32 cur_func_idx, char *error_buf,
+                             uint32 cur_func_idx, bool validate_only,
+                             ModuleFlags *module_flags, char *error_buf,
                              uint32 error_buf_size)
 {
     uint8 *p = func->code, *p_end = func->code + func->code_size, *p_org;
@@ -7179,6 +7718,15 @@ re_scan:
                     }
                 }
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if ((cur_block->label_type == LABEL_TYPE_BLOCK
+                     || cur_block->label_type == LABEL_TYPE_IF)
+                    && !wasm_loader_add_block_addr(loader_ctx, func, cur_block,
+                                                   p - 1, error_buf,
+                                                   error_buf_size))
+                    goto fail;
+#endif
+
                 POP_CSP();
 
 #if WASM_ENABLE_FAST_INTERP != 0
@@ -7231,6 +7779,9 @@ re_scan:
             {
                 POP_I32();
 
+#if WASM_ENABLE_FAST_INTERP != 0
+            handle_op_br_if:
+#endif
                 if (!(frame_csp_tmp = check_branch_block(
                           loader_ctx, &p, p_end, error_buf, error_buf_size)))
                     goto fail;
@@ -7323,8 +7874,10 @@ re_scan:
                                 br_table_cache->br_depths[j] = p_depth_begin[j];
                             }
                             br_table_cache->br_depths[i] = depth;
+                            os_mutex_lock(&module->prepare_lock);
                             bh_list_insert(module->br_table_cache_list,
                                            br_table_cache);
+                            os_mutex_unlock(&module->prepare_lock);
                         }
                         else {
                             /* The depth can be stored in one byte, use the
@@ -7592,12 +8145,25 @@ re_scan:
 #endif
                     }
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
                     else if (*(loader_ctx->frame_ref - 1) == REF_V128_1) {
                         loader_ctx->frame_ref -= 4;
                         loader_ctx->stack_cell_num -= 4;
-                    }
+#if WASM_ENABLE_FAST_INTERP == 0
+#if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
+    && (WASM_ENABLE_FAST_JIT == 0)
+                        *(p - 1) = WASM_OP_DROP_V128;
+#endif
+#endif
+#if WASM_ENABLE_FAST_INTERP != 0
+                        skip_label();
+                        loader_ctx->frame_offset -= 4;
+                        if ((*(loader_ctx->frame_offset)
+                             > loader_ctx->start_dynamic_offset)
+                            && (*(loader_ctx->frame_offset)
+                                < loader_ctx->max_dynamic_offset))
+                            loader_ctx->dynamic_offset -= 4;
 #endif
+                    }
 #endif
                     else {
                         set_error_buf(error_buf, error_buf_size,
@@ -7640,7 +8206,19 @@ re_scan:
                             break;
                         case REF_I64_2:
                         case REF_F64_2:
+#if WASM_ENABLE_SIMD != 0
+                        case REF_V128_4:
+#endif
 #if WASM_ENABLE_FAST_INTERP == 0
+#if WASM_ENABLE_SIMD != 0
+                            if (*(loader_ctx->frame_ref - 1) == REF_V128_4) {
+#if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
+    && (WASM_ENABLE_FAST_JIT == 0)
+                                *(p - 1) = WASM_OP_SELECT_V128;
+#endif
+                                break;
+                            }
+#endif
                             *(p - 1) = WASM_OP_SELECT_64;
 #endif
 #if WASM_ENABLE_FAST_INTERP != 0
@@ -7648,6 +8226,10 @@ re_scan:
                                 uint8 opcode_tmp = WASM_OP_SELECT_64;
                                 uint8 *p_code_compiled_tmp =
                                     loader_ctx->p_code_compiled - 2;
+#if WASM_ENABLE_SIMD != 0
+                                if (*(loader_ctx->frame_ref - 1) == REF_V128_4)
+                                    opcode_tmp = WASM_OP_SELECT_V128;
+#endif
 #if WASM_ENABLE_LABELS_AS_VALUES != 0
 #if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
                                 *(void **)(p_code_compiled_tmp
@@ -7677,12 +8259,6 @@ re_scan:
                             }
 #endif /* end of WASM_ENABLE_FAST_INTERP */
                             break;
-#if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
-                        case REF_V128_4:
-                            break;
-#endif /* (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
-#endif /* WASM_ENABLE_SIMD != 0 */
                         default:
                         {
                             set_error_buf(error_buf, error_buf_size,
@@ -7740,42 +8316,35 @@ re_scan:
                     uint8 *p_code_compiled_tmp =
                         loader_ctx->p_code_compiled - 2;
 
-                    if (ref_type == VALUE_TYPE_V128) {
-#if (WASM_ENABLE_SIMD == 0) \
-    || ((WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0))
-                        set_error_buf(error_buf, error_buf_size,
-                                      "SIMD v128 type isn't supported");
-                        goto fail;
+                    if (ref_type == VALUE_TYPE_F64
+                        || ref_type == VALUE_TYPE_I64)
+                        opcode_tmp = WASM_OP_SELECT_64;
+#if WASM_ENABLE_SIMD != 0
+                    else if (ref_type == VALUE_TYPE_V128)
+                        opcode_tmp = WASM_OP_SELECT_V128;
 #endif
-                    }
-                    else {
-                        if (ref_type == VALUE_TYPE_F64
-                            || ref_type == VALUE_TYPE_I64)
-                            opcode_tmp = WASM_OP_SELECT_64;
 #if WASM_ENABLE_LABELS_AS_VALUES != 0
 #if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
-                        *(void **)(p_code_compiled_tmp - sizeof(void *)) =
-                            handle_table[opcode_tmp];
+                    *(void **)(p_code_compiled_tmp - sizeof(void *)) =
+                        handle_table[opcode_tmp];
 #else
-                        int32 offset = (int32)((uint8 *)handle_table[opcode_tmp]
-                                               - (uint8 *)handle_table[0]);
-                        if (!(offset >= INT16_MIN && offset < INT16_MAX)) {
-                            set_error_buf(
-                                error_buf, error_buf_size,
-                                "pre-compiled label offset out of range");
-                            goto fail;
-                        }
-                        *(int16 *)(p_code_compiled_tmp - sizeof(int16)) =
-                            (int16)offset;
+                    int32 offset = (int32)((uint8 *)handle_table[opcode_tmp]
+                                           - (uint8 *)handle_table[0]);
+                    if (!(offset >= INT16_MIN && offset < INT16_MAX)) {
+                        set_error_buf(error_buf, error_buf_size,
+                                      "pre-compiled label offset out of range");
+                        goto fail;
+                    }
+                    *(int16 *)(p_code_compiled_tmp - sizeof(int16)) =
+                        (int16)offset;
 #endif /* end of WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS */
 #else  /* else of WASM_ENABLE_LABELS_AS_VALUES */
 #if WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS != 0
-                        *(p_code_compiled_tmp - 1) = opcode_tmp;
+                    *(p_code_compiled_tmp - 1) = opcode_tmp;
 #else
-                        *(p_code_compiled_tmp - 2) = opcode_tmp;
+                    *(p_code_compiled_tmp - 2) = opcode_tmp;
 #endif /* end of WASM_CPU_SUPPORTS_UNALIGNED_ADDR_ACCESS */
 #endif /* end of WASM_ENABLE_LABELS_AS_VALUES */
-                    }
                 }
 #endif /* WASM_ENABLE_FAST_INTERP != 0 */
 
@@ -7818,6 +8387,7 @@ re_scan:
                     PUSH_TYPE(decl_ref_type);
                 }
                 else {
+                    module_flags->possible_table_mutation = true;
 #if WASM_ENABLE_FAST_INTERP != 0
                     POP_OFFSET_TYPE(decl_ref_type);
 #endif
@@ -7923,7 +8493,11 @@ re_scan:
 #else
 #if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
     && (WASM_ENABLE_FAST_JIT == 0) && (WASM_ENABLE_DEBUG_INTERP == 0)
-                if (local_offset < 0x80) {
+                if (local_offset < 0x80
+#if WASM_ENABLE_SIMD != 0
+                    && local_type != VALUE_TYPE_V128
+#endif
+                ) {
                     *p_org++ = EXT_OP_GET_LOCAL_FAST;
                     if (is_32bit_type(local_type)) {
                         *p_org++ = (uint8)local_offset;
@@ -7973,6 +8547,12 @@ re_scan:
                             emit_label(EXT_OP_SET_LOCAL_FAST);
                             emit_byte(loader_ctx, (uint8)local_offset);
                         }
+#if WASM_ENABLE_SIMD != 0
+                        else if (local_type == VALUE_TYPE_V128) {
+                            emit_label(EXT_OP_SET_LOCAL_FAST_V128);
+                            emit_byte(loader_ctx, (uint8)local_offset);
+                        }
+#endif
                         else {
                             emit_label(EXT_OP_SET_LOCAL_FAST_I64);
                             emit_byte(loader_ctx, (uint8)local_offset);
@@ -7987,7 +8567,11 @@ re_scan:
 #else
 #if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
     && (WASM_ENABLE_FAST_JIT == 0) && (WASM_ENABLE_DEBUG_INTERP == 0)
-                if (local_offset < 0x80) {
+                if (local_offset < 0x80
+#if WASM_ENABLE_SIMD != 0
+                    && local_type != VALUE_TYPE_V128
+#endif
+                ) {
                     *p_org++ = EXT_OP_SET_LOCAL_FAST;
                     if (is_32bit_type(local_type)) {
                         *p_org++ = (uint8)local_offset;
@@ -8033,6 +8617,12 @@ re_scan:
                         emit_label(EXT_OP_TEE_LOCAL_FAST);
                         emit_byte(loader_ctx, (uint8)local_offset);
                     }
+#if WASM_ENABLE_SIMD != 0
+                    else if (local_type == VALUE_TYPE_V128) {
+                        emit_label(EXT_OP_TEE_LOCAL_FAST_V128);
+                        emit_byte(loader_ctx, (uint8)local_offset);
+                    }
+#endif
                     else {
                         emit_label(EXT_OP_TEE_LOCAL_FAST_I64);
                         emit_byte(loader_ctx, (uint8)local_offset);
@@ -8047,7 +8637,11 @@ re_scan:
 #else
 #if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
     && (WASM_ENABLE_FAST_JIT == 0) && (WASM_ENABLE_DEBUG_INTERP == 0)
-                if (local_offset < 0x80) {
+                if (local_offset < 0x80
+#if WASM_ENABLE_SIMD != 0
+                    && local_type != VALUE_TYPE_V128
+#endif
+                ) {
                     *p_org++ = EXT_OP_TEE_LOCAL_FAST;
                     if (is_32bit_type(local_type)) {
                         *p_org++ = (uint8)local_offset;
@@ -8094,12 +8688,32 @@ re_scan:
 #endif
                     *p_org = WASM_OP_GET_GLOBAL_64;
                 }
+#if WASM_ENABLE_SIMD != 0
+#if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
+    && (WASM_ENABLE_FAST_JIT == 0)
+                else if (global_type == VALUE_TYPE_V128) {
+#if WASM_ENABLE_DEBUG_INTERP != 0
+                    if (!record_fast_op(module, p_org, *p_org, error_buf,
+                                        error_buf_size)) {
+                        goto fail;
+                    }
+#endif
+                    *p_org = WASM_OP_GET_GLOBAL_V128;
+                }
+#endif
+#endif
 #else  /* else of WASM_ENABLE_FAST_INTERP */
                 if (global_type == VALUE_TYPE_I64
                     || global_type == VALUE_TYPE_F64) {
                     skip_label();
                     emit_label(WASM_OP_GET_GLOBAL_64);
                 }
+#if WASM_ENABLE_SIMD != 0
+                else if (global_type == VALUE_TYPE_V128) {
+                    skip_label();
+                    emit_label(WASM_OP_GET_GLOBAL_V128);
+                }
+#endif
                 emit_uint32(loader_ctx, global_idx);
                 PUSH_OFFSET_TYPE(global_type);
 #endif /* end of WASM_ENABLE_FAST_INTERP */
@@ -8151,6 +8765,20 @@ re_scan:
 #endif
                     *p_org = WASM_OP_SET_GLOBAL_64;
                 }
+#if WASM_ENABLE_SIMD != 0
+#if (WASM_ENABLE_WAMR_COMPILER == 0) && (WASM_ENABLE_JIT == 0) \
+    && (WASM_ENABLE_FAST_JIT == 0)
+                else if (global_type == VALUE_TYPE_V128) {
+#if WASM_ENABLE_DEBUG_INTERP != 0
+                    if (!record_fast_op(module, p_org, *p_org, error_buf,
+                                        error_buf_size)) {
+                        goto fail;
+                    }
+#endif
+                    *p_org = WASM_OP_SET_GLOBAL_V128;
+                }
+#endif
+#endif
                 else if (module->aux_stack_size > 0
                          && global_idx == module->aux_stack_top_global_index) {
 #if WASM_ENABLE_DEBUG_INTERP != 0
@@ -8167,6 +8795,12 @@ re_scan:
                     skip_label();
                     emit_label(WASM_OP_SET_GLOBAL_64);
                 }
+#if WASM_ENABLE_SIMD != 0
+                else if (global_type == VALUE_TYPE_V128) {
+                    skip_label();
+                    emit_label(WASM_OP_SET_GLOBAL_V128);
+                }
+#endif
                 else if (module->aux_stack_size > 0
                          && global_idx == module->aux_stack_top_global_index) {
                     skip_label();
@@ -8295,7 +8929,7 @@ re_scan:
                 }
                 PUSH_I32();
 
-                module->possible_memory_grow = true;
+                module_flags->possible_memory_grow = true;
                 break;
 
             case WASM_OP_MEMORY_GROW:
@@ -8309,7 +8943,7 @@ re_scan:
                 POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
 
                 func->has_op_memory_grow = true;
-                module->possible_memory_grow = true;
+                module_flags->possible_memory_grow = true;
                 break;
 
             case WASM_OP_I32_CONST:
@@ -8384,6 +9018,18 @@ re_scan:
                 break;
 
             case WASM_OP_I32_EQZ:
+#if WASM_ENABLE_FAST_INTERP != 0
+                if (p < p_end && *p == WASM_OP_BR_IF) {
+                    /* Fuse the compare and the br_if following it into
+                       a superinstruction, which saves a dispatch and
+                       the store and reload of the condition */
+                    skip_label();
+                    emit_label(EXT_OP_BR_IF_I32_EQZ);
+                    POP_I32();
+                    opcode = *p++;
+                    goto handle_op_br_if;
+                }
+#endif
                 POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
                 break;
 
@@ -8397,6 +9043,16 @@ re_scan:
             case WASM_OP_I32_LE_U:
             case WASM_OP_I32_GE_S:
             case WASM_OP_I32_GE_U:
+#if WASM_ENABLE_FAST_INTERP != 0
+                if (p < p_end && *p == WASM_OP_BR_IF) {
+                    skip_label();
+                    emit_label(EXT_OP_BR_IF_I32_EQ + opcode - WASM_OP_I32_EQ);
+                    POP_I32();
+                    POP_I32();
+                    opcode = *p++;
+                    goto handle_op_br_if;
+                }
+#endif
                 POP2_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
                 break;
 
@@ -8728,6 +9384,8 @@ re_scan:
                     {
                         uint8 seg_ref_type = 0, tbl_ref_type = 0;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, table_seg_idx);
                         read_leb_uint32(p, p_end, table_idx);
 
@@ -8773,6 +9431,8 @@ re_scan:
                         uint8 src_ref_type, dst_ref_type;
                         uint32 src_tbl_idx, dst_tbl_idx;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, src_tbl_idx);
                         if (!get_table_elem_type(module, src_tbl_idx,
                                                  &src_ref_type, error_buf,
@@ -8821,6 +9481,8 @@ re_scan:
                     {
                         uint8 decl_ref_type;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, table_idx);
                         if (!get_table_elem_type(module, table_idx,
                                                  &decl_ref_type, error_buf,
@@ -8866,10 +9528,12 @@ re_scan:
             }
 
 #if WASM_ENABLE_SIMD != 0
-#if (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0)
             case WASM_OP_SIMD_PREFIX:
             {
                 opcode = read_uint8(p);
+#if WASM_ENABLE_FAST_INTERP != 0
+                emit_byte(loader_ctx, opcode);
+#endif
                 /* follow the order of enum WASMSimdEXTOpcode in wasm_opcode.h
                  */
                 switch (opcode) {
@@ -8895,6 +9559,9 @@ re_scan:
                         }
 
                         read_leb_uint32(p, p_end, mem_offset); /* offset */
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_uint32(loader_ctx, mem_offset);
+#endif
 
                         POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_V128);
                         break;
@@ -8911,6 +9578,9 @@ re_scan:
                         }
 
                         read_leb_uint32(p, p_end, mem_offset); /* offset */
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_uint32(loader_ctx, mem_offset);
+#endif
 
                         POP_V128();
                         POP_I32();
@@ -8921,6 +9591,29 @@ re_scan:
                     case SIMD_v128_const:
                     {
                         CHECK_BUF1(p, p_end, 16);
+#if WASM_ENABLE_FAST_INTERP != 0
+                        {
+                            V128 v128_const;
+
+                            bh_memcpy_s(&v128_const, sizeof(V128), p,
+                                        sizeof(V128));
+                            /* remove the emitted opcode and the prefix, use
+                               the const offset instead */
+                            wasm_loader_emit_backspace(loader_ctx,
+                                                       sizeof(uint8));
+                            skip_label();
+                            disable_emit = true;
+                            GET_CONST_OFFSET(VALUE_TYPE_V128, v128_const);
+
+                            if (operand_offset == 0) {
+                                disable_emit = false;
+                                emit_label(WASM_OP_SIMD_PREFIX);
+                                emit_byte(loader_ctx, opcode);
+                                emit_uint64(loader_ctx, v128_const.i64x2[0]);
+                                emit_uint64(loader_ctx, v128_const.i64x2[1]);
+                            }
+                        }
+#endif
                         p += 16;
                         PUSH_V128();
                         break;
@@ -8937,6 +9630,10 @@ re_scan:
                                                      error_buf_size)) {
                             goto fail;
                         }
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_uint64(loader_ctx, mask.i64x2[0]);
+                        emit_uint64(loader_ctx, mask.i64x2[1]);
+#endif
 
                         POP2_AND_PUSH(VALUE_TYPE_V128, VALUE_TYPE_V128);
                         break;
@@ -9008,13 +9705,17 @@ re_scan:
                                                     error_buf_size)) {
                             goto fail;
                         }
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_byte(loader_ctx, lane);
+#endif
 
                         if (replace[opcode - SIMD_i8x16_extract_lane_s]) {
-                            if (!(wasm_loader_pop_frame_ref(
-                                    loader_ctx,
-                                    replace[opcode - SIMD_i8x16_extract_lane_s],
-                                    error_buf, error_buf_size)))
-                                goto fail;
+                            uint8 replace_type =
+                                replace[opcode - SIMD_i8x16_extract_lane_s];
+#if WASM_ENABLE_FAST_INTERP != 0
+                            POP_OFFSET_TYPE(replace_type);
+#endif
+                            POP_TYPE(replace_type);
                         }
 
                         POP_AND_PUSH(
@@ -9125,6 +9826,9 @@ re_scan:
                         }
 
                         read_leb_uint32(p, p_end, mem_offset); /* offset */
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_uint32(loader_ctx, mem_offset);
+#endif
 
                         CHECK_BUF(p, p_end, 1);
                         lane = read_uint8(p);
@@ -9132,6 +9836,9 @@ re_scan:
                                                     error_buf_size)) {
                             goto fail;
                         }
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_byte(loader_ctx, lane);
+#endif
 
                         POP_V128();
                         POP_I32();
@@ -9153,6 +9860,9 @@ re_scan:
                         }
 
                         read_leb_uint32(p, p_end, mem_offset); /* offset */
+#if WASM_ENABLE_FAST_INTERP != 0
+                        emit_uint32(loader_ctx, mem_offset);
+#endif
 
                         POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_V128);
                         break;
@@ -9507,9 +10217,13 @@ re_scan:
                         goto fail;
                     }
                 }
+#if WASM_ENABLE_FAST_INTERP != 0
+                /* restore the opcode so that the SIMD opcode isn't taken
+                   as a normal opcode by last_op */
+                opcode = WASM_OP_SIMD_PREFIX;
+#endif
                 break;
             }
-#endif /* end of (WASM_ENABLE_WAMR_COMPILER != 0) || (WASM_ENABLE_JIT != 0) */
 #endif /* end of WASM_ENABLE_SIMD */
 
 #if WASM_ENABLE_SHARED_MEMORY != 0
@@ -9679,8 +10393,15 @@ re_scan:
     }
 
 #if WASM_ENABLE_FAST_INTERP != 0
-    if (loader_ctx->p_code_compiled == NULL)
+    if (loader_ctx->p_code_compiled == NULL) {
+        if (validate_only) {
+            /* Skip the translation, the code size and the consts
+               calculated by the first traverse are dropped */
+            return_value = true;
+            goto fail;
+        }
         goto re_scan;
+    }
 
     func->const_cell_num = loader_ctx->const_cell_num;
     if (func->const_cell_num > 0) {
@@ -9700,6 +10421,13 @@ re_scan:
                             &(c->value.f64), (uint32)sizeof(int64));
                 func_const += sizeof(int64);
             }
+#if WASM_ENABLE_SIMD != 0
+            else if (c->value_type == VALUE_TYPE_V128) {
+                bh_memcpy_s(func_const, (uint32)(func_const_end - func_const),
+                            &(c->value.v128), (uint32)sizeof(V128));
+                func_const += sizeof(V128);
+            }
+#endif
             else {
                 bh_memcpy_s(func_const, (uint32)(func_const_end - func_const),
                             &(c->value.f32), (uint32)sizeof(int32));
@@ -9714,6 +10442,9 @@ re_scan:
     func->max_stack_cell_num = loader_ctx->max_stack_cell_num;
 #endif
     func->max_block_num = loader_ctx->max_csp_num;
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    wasm_loader_build_block_addr_table(loader_ctx, module, func);
+#endif
     return_value = true;
 
 fail:
@@ -51,6 +51,24 @@ wasm_loader_load_from_sections(WASMSection *section_list, char *error_buf,
 void
 wasm_loader_unload(WASMModule *module);
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+/**
+ * Translate the bytecode of a function which was only validated when
+ * the module was loaded, it does nothing if the function was translated.
+ * The caller must hold the lazy_prepare_lock of the module.
+ *
+ * @param module the module which the function belongs to
+ * @param func_idx the index of the function, excluding import functions
+ * @param error_buf output of the exception info
+ * @param error_buf_size the size of the exception string
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wasm_loader_prepare_function(WASMModule *module, uint32 func_idx,
+                             char *error_buf, uint32 error_buf_size);
+#endif
+
 /**
  * Find address of related else opcode and end opcode of opcode block/loop/if
  * according to the start address of opcode.
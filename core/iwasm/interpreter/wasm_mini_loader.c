@@ -14,6 +14,7 @@
 #if WASM_ENABLE_FAST_JIT != 0
 #include "../fast-jit/jit_compiler.h"
 #include "../fast-jit/jit_codecache.h"
+#include "../fast-jit/jit_disk_cache.h"
 #endif
 #if WASM_ENABLE_JIT != 0
 #include "../compilation/aot_llvm.h"
@@ -87,6 +88,20 @@ is_byte_a_type(uint8 type)
     return is_value_type(type) || (type == VALUE_TYPE_VOID);
 }
 
+/* The mini loader doesn't support SIMD, reject v128 with an error instead
+   of only asserting the value type, as the modules using it are valid
+   for the other loader */
+static bool
+check_not_v128(uint8 type, char *error_buf, uint32 error_buf_size)
+{
+    if (type == VALUE_TYPE_V128) {
+        set_error_buf(error_buf, error_buf_size,
+                      "v128 is not supported by the mini loader");
+        return false;
+    }
+    return true;
+}
+
 static void
 read_leb(uint8 **p_buf, const uint8 *buf_end, uint32 maxbits, bool sign,
          uint64 *p_result, char *error_buf, uint32 error_buf_size)
@@ -401,6 +416,9 @@ load_type_section(const uint8 *buf, const uint8 *buf_end, WASMModule *module,
                 type->types[param_count + j] = read_uint8(p);
             }
             for (j = 0; j < param_count + result_count; j++) {
+                if (!check_not_v128(type->types[j], error_buf,
+                                    error_buf_size))
+                    return false;
                 bh_assert(is_value_type(type->types[j]));
             }
 
@@ -486,6 +504,9 @@ load_function_import(const uint8 **p_buf, const uint8 *buf_end,
     function->signature = linked_signature;
     function->attachment = linked_attachment;
     function->call_conv_raw = linked_call_conv_raw;
+    if (linked_func && !linked_call_conv_raw)
+        function->call_shape = wasm_runtime_get_native_call_shape(
+            declare_func_type, linked_signature);
     return true;
 }
 
@@ -592,6 +613,9 @@ load_global_import(const uint8 **p_buf, const uint8 *buf_end,
     declare_mutable = read_uint8(p);
     *p_buf = p;
 
+    if (!check_not_v128(declare_type, error_buf, error_buf_size))
+        return false;
+
     bh_assert(declare_mutable < 2);
 
     is_mutable = declare_mutable & 1 ? true : false;
@@ -1028,6 +1052,8 @@ load_function_section(const uint8 *buf, const uint8 *buf_end,
                 CHECK_BUF(p_code, buf_code_end, 1);
                 /* 0x7F/0x7E/0x7D/0x7C */
                 type = read_uint8(p_code);
+                if (!check_not_v128(type, error_buf, error_buf_size))
+                    return false;
                 bh_assert(is_value_type(type));
                 for (k = 0; k < sub_local_count; k++) {
                     func->local_types[local_type_index++] = type;
@@ -1155,6 +1181,8 @@ load_global_section(const uint8 *buf, const uint8 *buf_end, WASMModule *module,
             CHECK_BUF(p, p_end, 2);
             global->type = read_uint8(p);
             mutable = read_uint8(p);
+            if (!check_not_v128(global->type, error_buf, error_buf_size))
+                return false;
             bh_assert(mutable < 2);
             global->is_mutable = mutable ? true : false;
 
@@ -1784,6 +1812,101 @@ calculate_global_data_offset(WASMModule *module)
 }
 
 #if WASM_ENABLE_JIT != 0
+/* Translate the module into LLVM IR, add it to the ORC JIT and look up
+   the lazily compiled jit functions */
+static bool
+generate_llvm_jit_functions(WASMModule *module, char *error_buf,
+                            uint32 error_buf_size)
+{
+    AOTCompOption option = { 0 };
+    char *aot_last_error;
+    uint32 i;
+
+    module->comp_data = aot_create_comp_data(module);
+    if (!module->comp_data) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    option.is_jit_mode = true;
+    option.opt_level = 3;
+    option.size_level = 3;
+#if WASM_ENABLE_BULK_MEMORY != 0
+    option.enable_bulk_memory = true;
+#endif
+#if WASM_ENABLE_THREAD_MGR != 0
+    option.enable_thread_mgr = true;
+#endif
+#if WASM_ENABLE_TAIL_CALL != 0
+    option.enable_tail_call = true;
+#endif
+#if WASM_ENABLE_SIMD != 0
+    option.enable_simd = true;
+#endif
+#if WASM_ENABLE_REF_TYPES != 0
+    option.enable_ref_types = true;
+#endif
+    option.enable_aux_stack_check = true;
+#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0) \
+    || (WASM_ENABLE_SAMPLING_PROFILER != 0)
+    option.enable_aux_stack_frame = true;
+#endif
+    /* The object files are cached by the hash of the module content */
+    if (module->load_addr)
+        option.cache_dir =
+            (char *)wasm_runtime_get_llvm_jit_options().object_cache_dir;
+
+    module->comp_ctx = aot_create_comp_context(module->comp_data, &option);
+    if (!module->comp_ctx) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    if (!aot_compile_wasm(module->comp_ctx)) {
+        aot_last_error = aot_get_last_error();
+        bh_assert(aot_last_error != NULL);
+        set_error_buf(error_buf, error_buf_size, aot_last_error);
+        return false;
+    }
+
+    bh_print_time("Begin to lookup jit functions");
+
+    for (i = 0; i < module->function_count; i++) {
+        LLVMOrcJITTargetAddress func_addr = 0;
+        LLVMErrorRef error;
+        char func_name[48];
+
+        snprintf(func_name, sizeof(func_name), "%s%d", AOT_FUNC_PREFIX, i);
+        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
+                                       func_name);
+        if (error != LLVMErrorSuccess) {
+            char *err_msg = LLVMGetErrorMessage(error);
+            char buf[128];
+            snprintf(buf, sizeof(buf), "failed to compile orc jit function: %s",
+                     err_msg);
+            set_error_buf(error_buf, error_buf_size, buf);
+            LLVMDisposeErrorMessage(err_msg);
+            return false;
+        }
+
+        /**
+         * No need to lock the func_ptr[func_idx] here as it is basic
+         * data type, the load/store for it can be finished by one cpu
+         * instruction, and there can be only one cpu instruction
+         * loading/storing at the same time.
+         */
+        module->func_ptrs[i] = (void *)func_addr;
+        module->functions[i]->llvm_jit_func_ptr = (void *)func_addr;
+    }
+
+    return true;
+}
+
+#if WASM_ENABLE_FAST_JIT == 0
 static void *
 orcjit_thread_callback(void *arg)
 {
@@ -1836,6 +1959,100 @@ orcjit_thread_callback(void *arg)
 
     return NULL;
 }
+#else
+/* Compile the functions which become hot in Fast JIT code, and make the
+   Fast JIT func ptrs point to the stub, which calls the LLVM jitted code
+   for them */
+static void *
+orcjit_thread_callback(void *arg)
+{
+    LLVMOrcJITTargetAddress func_addr = 0;
+    OrcJitThreadArg *thread_arg = (OrcJitThreadArg *)arg;
+    WASMModule *module = thread_arg->module;
+    uint32 group_stride = WASM_ORC_JIT_BACKEND_THREAD_NUM;
+    uint32 func_count = module->function_count;
+    uint32 i, j, k;
+    typedef void (*F)(void);
+    LLVMErrorRef error;
+    char func_name[48], error_buf[128];
+    bool ret;
+    union {
+        F f;
+        void *v;
+    } u;
+
+    os_mutex_lock(&module->tier_up_lock);
+    while (!module->orcjit_stop_compiling) {
+        if (module->tier_up_queue_head == module->tier_up_queue_tail
+            || module->llvm_ir_generating) {
+            os_cond_wait(&module->tier_up_cond, &module->tier_up_lock);
+            continue;
+        }
+
+        if (module->llvm_ir_failed) {
+            /* Keep running the hot functions with Fast JIT */
+            module->tier_up_queue_head = module->tier_up_queue_tail;
+            continue;
+        }
+
+        if (!module->llvm_ir_generated) {
+            /* Generate the LLVM IR when the first function is queued
+               rather than when loading, the other threads wait for it */
+            module->llvm_ir_generating = true;
+            os_mutex_unlock(&module->tier_up_lock);
+            ret = generate_llvm_jit_functions(module, error_buf,
+                                              sizeof(error_buf));
+            if (!ret)
+                os_printf("failed to generate llvm jit functions: %s\n",
+                          error_buf);
+            os_mutex_lock(&module->tier_up_lock);
+            module->llvm_ir_generating = false;
+            module->llvm_ir_generated = ret;
+            module->llvm_ir_failed = !ret;
+            os_cond_broadcast(&module->tier_up_cond);
+            continue;
+        }
+
+        i = module->tier_up_queue[module->tier_up_queue_head++];
+        if (module->func_ptrs_compiled[i])
+            /* Compiled together with another hot function */
+            continue;
+        os_mutex_unlock(&module->tier_up_lock);
+
+        snprintf(func_name, sizeof(func_name), "%s%d%s", AOT_FUNC_PREFIX, i,
+                 "_wrapper");
+        LOG_VERBOSE("JIT: tier up func %s to llvm jit", func_name);
+        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
+                                       func_name);
+        if (error != LLVMErrorSuccess) {
+            char *err_msg = LLVMGetErrorMessage(error);
+            os_printf("failed to compile orc jit function: %s", err_msg);
+            LLVMDisposeErrorMessage(err_msg);
+            os_mutex_lock(&module->tier_up_lock);
+            continue;
+        }
+
+        /* Call the jit wrapper function to trigger its compilation,
+           the functions of the same group are compiled together */
+        u.v = (void *)func_addr;
+        u.f();
+
+        os_mutex_lock(&module->tier_up_lock);
+        for (j = 0; j < WASM_ORC_JIT_COMPILE_THREAD_NUM; j++) {
+            k = i + j * group_stride;
+            if (k < func_count && !module->func_ptrs_compiled[k]) {
+                module->func_ptrs_compiled[k] = true;
+                /* The later calls from Fast JIT code go to the stub */
+                module->fast_jit_func_ptrs[k] =
+                    jit_compiler_get_jit_globals()->call_to_interp_from_jitted;
+            }
+        }
+    }
+    os_mutex_unlock(&module->tier_up_lock);
+
+    return NULL;
+}
+#endif
 
 static void
 orcjit_stop_compile_threads(WASMModule *module)
@@ -1843,10 +2060,21 @@ orcjit_stop_compile_threads(WASMModule *module)
     uint32 i, thread_num = (uint32)(sizeof(module->orcjit_thread_args)
                                     / sizeof(OrcJitThreadArg));
 
+#if WASM_ENABLE_FAST_JIT != 0
+    if (module->tier_up_queue) {
+        /* Wake up the threads waiting for hot functions */
+        os_mutex_lock(&module->tier_up_lock);
+        module->orcjit_stop_compiling = true;
+        os_cond_broadcast(&module->tier_up_cond);
+        os_mutex_unlock(&module->tier_up_lock);
+    }
+#endif
     module->orcjit_stop_compiling = true;
     for (i = 0; i < thread_num; i++) {
-        if (module->orcjit_threads[i])
+        if (module->orcjit_threads[i]) {
             os_thread_join(module->orcjit_threads[i], NULL);
+            module->orcjit_threads[i] = 0;
+        }
     }
 }
 
@@ -1854,97 +2082,56 @@ static bool
 compile_llvm_jit_functions(WASMModule *module, char *error_buf,
                            uint32 error_buf_size)
 {
-    AOTCompOption option = { 0 };
-    char *aot_last_error;
     uint64 size;
     uint32 thread_num, i;
 
     if (module->function_count > 0) {
         size = sizeof(void *) * (uint64)module->function_count
                + sizeof(bool) * (uint64)module->function_count;
+#if WASM_ENABLE_FAST_JIT != 0
+        size += sizeof(uint32) * (uint64)module->function_count
+                + sizeof(bool) * (uint64)module->function_count;
+#endif
         if (!(module->func_ptrs =
                   loader_malloc(size, error_buf, error_buf_size))) {
             return false;
         }
+#if WASM_ENABLE_FAST_JIT != 0
+        /* Put the queue before bool arrays to keep it aligned */
+        module->tier_up_queue =
+            (uint32 *)((uint8 *)module->func_ptrs
+                       + sizeof(void *) * module->function_count);
+        module->func_ptrs_compiled =
+            (bool *)(module->tier_up_queue + module->function_count);
+        module->tier_up_requested =
+            module->func_ptrs_compiled + module->function_count;
+
+        if (os_mutex_init(&module->tier_up_lock) != 0) {
+            module->tier_up_queue = NULL;
+            set_error_buf(error_buf, error_buf_size, "init mutex failed");
+            return false;
+        }
+        if (os_cond_init(&module->tier_up_cond) != 0) {
+            os_mutex_destroy(&module->tier_up_lock);
+            module->tier_up_queue = NULL;
+            set_error_buf(error_buf, error_buf_size, "init cond failed");
+            return false;
+        }
+#else
         module->func_ptrs_compiled =
             (bool *)((uint8 *)module->func_ptrs
                      + sizeof(void *) * module->function_count);
-    }
-
-    module->comp_data = aot_create_comp_data(module);
-    if (!module->comp_data) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
-    }
-
-    option.is_jit_mode = true;
-    option.opt_level = 3;
-    option.size_level = 3;
-#if WASM_ENABLE_BULK_MEMORY != 0
-    option.enable_bulk_memory = true;
-#endif
-#if WASM_ENABLE_THREAD_MGR != 0
-    option.enable_thread_mgr = true;
-#endif
-#if WASM_ENABLE_TAIL_CALL != 0
-    option.enable_tail_call = true;
-#endif
-#if WASM_ENABLE_SIMD != 0
-    option.enable_simd = true;
-#endif
-#if WASM_ENABLE_REF_TYPES != 0
-    option.enable_ref_types = true;
-#endif
-    option.enable_aux_stack_check = true;
-#if (WASM_ENABLE_PERF_PROFILING != 0) || (WASM_ENABLE_DUMP_CALL_STACK != 0)
-    option.enable_aux_stack_frame = true;
 #endif
-
-    module->comp_ctx = aot_create_comp_context(module->comp_data, &option);
-    if (!module->comp_ctx) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
-    }
-
-    if (!aot_compile_wasm(module->comp_ctx)) {
-        aot_last_error = aot_get_last_error();
-        bh_assert(aot_last_error != NULL);
-        set_error_buf(error_buf, error_buf_size, aot_last_error);
-        return false;
     }
 
-    bh_print_time("Begin to lookup jit functions");
-
-    for (i = 0; i < module->function_count; i++) {
-        LLVMOrcJITTargetAddress func_addr = 0;
-        LLVMErrorRef error;
-        char func_name[48];
-
-        snprintf(func_name, sizeof(func_name), "%s%d", AOT_FUNC_PREFIX, i);
-        error = LLVMOrcLLLazyJITLookup(module->comp_ctx->orc_jit, &func_addr,
-                                       func_name);
-        if (error != LLVMErrorSuccess) {
-            char *err_msg = LLVMGetErrorMessage(error);
-            char buf[128];
-            snprintf(buf, sizeof(buf), "failed to compile orc jit function: %s",
-                     err_msg);
-            set_error_buf(error_buf, error_buf_size, buf);
-            LLVMDisposeErrorMessage(err_msg);
+#if WASM_ENABLE_FAST_JIT != 0
+    /* In tier-up mode the LLVM IR is generated by the compile threads
+       when the first function becomes hot in Fast JIT code */
+    if (!module->tier_up_queue)
+#endif
+    {
+        if (!generate_llvm_jit_functions(module, error_buf, error_buf_size))
             return false;
-        }
-
-        /**
-         * No need to lock the func_ptr[func_idx] here as it is basic
-         * data type, the load/store for it can be finished by one cpu
-         * instruction, and there can be only one cpu instruction
-         * loading/storing at the same time.
-         */
-        module->func_ptrs[i] = (void *)func_addr;
-        module->functions[i]->llvm_jit_func_ptr = (void *)func_addr;
     }
 
     bh_print_time("Begin to compile jit functions");
@@ -1952,6 +2139,13 @@ compile_llvm_jit_functions(WASMModule *module, char *error_buf,
     thread_num =
         (uint32)(sizeof(module->orcjit_thread_args) / sizeof(OrcJitThreadArg));
 
+#if WASM_ENABLE_FAST_JIT != 0
+    /* Functions are run by Fast JIT first, only the functions hot in
+       Fast JIT code are compiled by the threads */
+    if (!module->tier_up_queue)
+        thread_num = 0;
+#endif
+
     /* Create threads to compile the jit functions */
     for (i = 0; i < thread_num; i++) {
         module->orcjit_thread_args[i].comp_ctx = module->comp_ctx;
@@ -1962,20 +2156,17 @@ compile_llvm_jit_functions(WASMModule *module, char *error_buf,
                              (void *)&module->orcjit_thread_args[i],
                              APP_THREAD_STACK_SIZE_DEFAULT)
             != 0) {
-            uint32 j;
-
             set_error_buf(error_buf, error_buf_size,
                           "create orcjit compile thread failed");
-            /* Terminate the threads created */
-            module->orcjit_stop_compiling = true;
-            for (j = 0; j < i; j++) {
-                os_thread_join(module->orcjit_threads[j], NULL);
-            }
+            /* Terminate the threads created, the module is unloaded
+               by the caller */
+            module->orcjit_threads[i] = 0;
+            orcjit_stop_compile_threads(module);
             return false;
         }
     }
 
-#if WASM_ENABLE_LAZY_JIT == 0
+#if WASM_ENABLE_LAZY_JIT == 0 && WASM_ENABLE_FAST_JIT == 0
     /* Wait until all jit functions are compiled for eager mode */
     for (i = 0; i < thread_num; i++) {
         os_thread_join(module->orcjit_threads[i], NULL);
@@ -2024,9 +2215,31 @@ get_table_seg_elem_type(const WASMModule *module, uint32 table_seg_idx,
 }
 #endif
 
+/* The properties of the module found in the function bodies, they are
+   recorded by the caller of wasm_loader_prepare_bytecode and set to the
+   module after all the functions are prepared, since the functions may
+   be prepared by multiple loader threads */
+typedef struct ModuleFlags {
+    /* Whether there is memory.grow or memory.size */
+    bool possible_memory_grow;
+    /* Whether there is table.set, table.grow, table.fill, table.copy
+       or table.init */
+    bool possible_table_mutation;
+} ModuleFlags;
+
+static void
+set_module_flags(WASMModule *module, const ModuleFlags *flags)
+{
+    if (flags->possible_memory_grow)
+        module->possible_memory_grow = true;
+    if (flags->possible_table_mutation)
+        module->possible_table_mutation = true;
+}
+
 static bool
 wasm_loader_prepare_bytecode(WASMModule *module, WASMFunction *func,
-                             uint32 cur_func_idx, char *error_buf,
+                             uint32 cur_func_idx, bool validate_only,
+                             ModuleFlags *module_flags, char *error_buf,
                              uint32 error_buf_size);
 
 #if WASM_ENABLE_FAST_INTERP != 0 && WASM_ENABLE_LABELS_AS_VALUES != 0
@@ -2036,6 +2249,123 @@ wasm_interp_get_handle_table();
 static void **handle_table;
 #endif
 
+#if WASM_ENABLE_DEBUG_INTERP == 0
+typedef struct PrepareBytecodeContext {
+    WASMModule *module;
+    /* lock to take the functions to prepare and to record the error */
+    korp_mutex lock;
+    /* Index of the next function to prepare */
+    uint32 next_func_idx;
+    /* Index of the first function failed to prepare, (uint32)-1 if
+       no function fails */
+    uint32 failed_func_idx;
+    /* Error message of the first function failed to prepare */
+    char error_buf[256];
+    /* Module flags merged from all the threads */
+    ModuleFlags module_flags;
+} PrepareBytecodeContext;
+
+static void
+merge_module_flags(ModuleFlags *dst, const ModuleFlags *src)
+{
+    dst->possible_memory_grow |= src->possible_memory_grow;
+    dst->possible_table_mutation |= src->possible_table_mutation;
+}
+
+static void *
+prepare_bytecode_thread_callback(void *arg)
+{
+    PrepareBytecodeContext *ctx = (PrepareBytecodeContext *)arg;
+    WASMModule *module = ctx->module;
+    ModuleFlags module_flags = { 0 };
+    char error_buf[256];
+    uint32 func_idx;
+
+    while (true) {
+        /* The functions are taken in ascending order, and the ones after
+           a failed function are skipped as the sequential loading never
+           prepares them */
+        os_mutex_lock(&ctx->lock);
+        func_idx = ctx->next_func_idx++;
+        if (func_idx >= module->function_count
+            || func_idx > ctx->failed_func_idx) {
+            os_mutex_unlock(&ctx->lock);
+            break;
+        }
+        os_mutex_unlock(&ctx->lock);
+
+        if (!wasm_loader_prepare_bytecode(
+                module, module->functions[func_idx], func_idx,
+                WASM_ENABLE_LAZY_PREPARE != 0, &module_flags, error_buf,
+                sizeof(error_buf))) {
+            /* Keep the error of the function with the smallest index, which
+               is the one reported by the sequential loading */
+            os_mutex_lock(&ctx->lock);
+            if (func_idx < ctx->failed_func_idx) {
+                ctx->failed_func_idx = func_idx;
+                snprintf(ctx->error_buf, sizeof(ctx->error_buf), "%s",
+                         error_buf);
+            }
+            os_mutex_unlock(&ctx->lock);
+            break;
+        }
+    }
+
+    os_mutex_lock(&ctx->lock);
+    merge_module_flags(&ctx->module_flags, &module_flags);
+    os_mutex_unlock(&ctx->lock);
+    return NULL;
+}
+
+static bool
+prepare_bytecode_in_threads(WASMModule *module, uint32 thread_num,
+                            char *error_buf, uint32 error_buf_size)
+{
+    PrepareBytecodeContext ctx = { 0 };
+    korp_tid tids[WASM_LOADER_MAX_THREAD_NUM];
+    uint32 created_thread_num = 0, i;
+
+    bh_assert(thread_num <= WASM_LOADER_MAX_THREAD_NUM);
+
+    ctx.module = module;
+    ctx.failed_func_idx = (uint32)-1;
+    if (os_mutex_init(&ctx.lock) != 0) {
+        set_error_buf(error_buf, error_buf_size, "init lock failed");
+        return false;
+    }
+
+    /* The calling thread is also one of the loader threads, if a thread
+       fails to be created, go on with the threads created */
+    for (i = 0; i < thread_num - 1; i++) {
+        if (os_thread_create(&tids[created_thread_num],
+                             prepare_bytecode_thread_callback, &ctx,
+                             APP_THREAD_STACK_SIZE_DEFAULT)
+            != 0) {
+            LOG_WARNING("warning: create loader thread failed");
+            break;
+        }
+        created_thread_num++;
+    }
+
+    prepare_bytecode_thread_callback(&ctx);
+
+    for (i = 0; i < created_thread_num; i++) {
+        os_thread_join(tids[i], NULL);
+    }
+    os_mutex_destroy(&ctx.lock);
+
+    /* All the threads are joined, no one accesses the module flags */
+    set_module_flags(module, &ctx.module_flags);
+
+    if (ctx.failed_func_idx != (uint32)-1) {
+        if (error_buf != NULL)
+            snprintf(error_buf, error_buf_size, "%s", ctx.error_buf);
+        return false;
+    }
+    return true;
+}
+#endif /* end of WASM_ENABLE_DEBUG_INTERP == 0 */
+
 static bool
 load_from_sections(WASMModule *module, WASMSection *sections,
                    bool is_load_from_file_buf, char *error_buf,
@@ -2050,7 +2380,7 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     uint32 aux_data_end = (uint32)-1, aux_heap_base = (uint32)-1;
     uint32 aux_stack_top = (uint32)-1, global_index, func_index, i;
     uint32 aux_data_end_global_index = (uint32)-1;
-    uint32 aux_heap_base_global_index = (uint32)-1;
+    uint32 aux_heap_base_global_index = (uint32)-1, thread_num = 1;
     WASMType *func_type;
 
     /* Find code and function sections if have */
@@ -2348,16 +2678,44 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     handle_table = wasm_interp_get_handle_table();
 #endif
 
-    for (i = 0; i < module->function_count; i++) {
-        WASMFunction *func = module->functions[i];
-        if (!wasm_loader_prepare_bytecode(module, func, i, error_buf,
-                                          error_buf_size)) {
+#if WASM_ENABLE_DEBUG_INTERP == 0
+    /* The function bodies are independent of each other, prepare them with
+       multiple threads if required. Not supported by the debug interpreter
+       as it records the patched opcodes of all functions in one list */
+    thread_num = wasm_runtime_get_loader_thread_num();
+    if (thread_num > module->function_count)
+        thread_num = module->function_count;
+#endif
+
+    if (thread_num > 1) {
+#if WASM_ENABLE_DEBUG_INTERP == 0
+        if (!prepare_bytecode_in_threads(module, thread_num, error_buf,
+                                         error_buf_size)) {
             return false;
         }
+#endif
+    }
+    else {
+        ModuleFlags module_flags = { 0 };
 
-        if (i == module->function_count - 1) {
-            bh_assert(func->code + func->code_size == buf_code_end);
+        for (i = 0; i < module->function_count; i++) {
+            /* With lazy preparation, the function is only validated here,
+               and its bytecode is translated when it is called the first
+               time */
+            if (!wasm_loader_prepare_bytecode(
+                    module, module->functions[i], i,
+                    WASM_ENABLE_LAZY_PREPARE != 0, &module_flags, error_buf,
+                    error_buf_size)) {
+                return false;
+            }
         }
+        set_module_flags(module, &module_flags);
+    }
+
+    if (module->function_count) {
+        WASMFunction *func = module->functions[module->function_count - 1];
+        bh_assert(func->code + func->code_size == buf_code_end);
+        (void)func;
     }
 
     if (!module->possible_memory_grow) {
@@ -2427,16 +2785,25 @@ load_from_sections(WASMModule *module, WASMSection *sections,
     calculate_global_data_offset(module);
 
 #if WASM_ENABLE_FAST_JIT != 0
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    jit_disk_cache_init_module(module);
+#endif
     if (!(module->fast_jit_func_ptrs =
               loader_malloc(sizeof(void *) * module->function_count, error_buf,
                             error_buf_size))) {
         return false;
     }
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Functions are compiled when they become hot in interpreter */
+    if (module->function_count)
+        jit_compiler_init_func_ptrs(module);
+#else
     if (!jit_compiler_compile_all(module)) {
         set_error_buf(error_buf, error_buf_size, "fast jit compilation failed");
         return false;
     }
 #endif
+#endif
 
 #if WASM_ENABLE_JIT != 0
     if (!compile_llvm_jit_functions(module, error_buf, error_buf_size)) {
@@ -2473,6 +2840,17 @@ create_module(char *error_buf, uint32 error_buf_size)
     ret = bh_list_init(module->br_table_cache_list);
     bh_assert(ret == BH_LIST_SUCCESS);
     (void)ret;
+    if (os_mutex_init(&module->prepare_lock) != 0) {
+        wasm_runtime_free(module);
+        return NULL;
+    }
+#endif
+
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    if (os_mutex_init(&module->lazy_prepare_lock) != 0) {
+        wasm_runtime_free(module);
+        return NULL;
+    }
 #endif
 
     return module;
@@ -2661,7 +3039,7 @@ wasm_loader_load(uint8 *buf, uint32 size, char *error_buf,
         return NULL;
     }
 
-#if WASM_ENABLE_FAST_JIT != 0
+#if WASM_ENABLE_FAST_JIT != 0 || WASM_ENABLE_JIT != 0
     module->load_addr = (uint8 *)buf;
     module->load_size = size;
 #endif
@@ -2690,6 +3068,12 @@ wasm_loader_unload(WASMModule *module)
     /* Stop LLVM JIT compilation firstly to avoid accessing
        module internal data after they were freed */
     orcjit_stop_compile_threads(module);
+#if WASM_ENABLE_FAST_JIT != 0
+    if (module->tier_up_queue) {
+        os_cond_destroy(&module->tier_up_cond);
+        os_mutex_destroy(&module->tier_up_lock);
+    }
+#endif
     if (module->func_ptrs)
         wasm_runtime_free(module->func_ptrs);
     if (module->comp_ctx)
@@ -2709,11 +3093,26 @@ wasm_loader_unload(WASMModule *module)
     if (module->imports)
         wasm_runtime_free(module->imports);
 
+#if WASM_ENABLE_FAST_JIT != 0
+    /* The functions may be being compiled in background */
+    jit_compiler_cancel_compilation(module);
+
+    /* Free the jitted code of the functions rather than the code their
+       func ptrs point to, which may be the stub to call the function in
+       interpreter or LLVM jitted code */
+    if (module->fast_jit_code_size > 0)
+        jit_code_cache_free_module(module);
+#endif
+
     if (module->functions) {
         for (i = 0; i < module->function_count; i++) {
             if (module->functions[i]) {
                 if (module->functions[i]->local_offsets)
                     wasm_runtime_free(module->functions[i]->local_offsets);
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if (module->functions[i]->block_addr_table)
+                    wasm_runtime_free(module->functions[i]->block_addr_table);
+#endif
 #if WASM_ENABLE_FAST_INTERP != 0
                 if (module->functions[i]->code_compiled)
                     wasm_runtime_free(module->functions[i]->code_compiled);
@@ -2726,6 +3125,10 @@ wasm_loader_unload(WASMModule *module)
         wasm_runtime_free(module->functions);
     }
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    os_mutex_destroy(&module->lazy_prepare_lock);
+#endif
+
     if (module->tables)
         wasm_runtime_free(module->tables);
 
@@ -2773,14 +3176,11 @@ wasm_loader_unload(WASMModule *module)
             node = node_next;
         }
     }
+    os_mutex_destroy(&module->prepare_lock);
 #endif
 
 #if WASM_ENABLE_FAST_JIT != 0
     if (module->fast_jit_func_ptrs) {
-        for (i = 0; i < module->function_count; i++) {
-            if (module->fast_jit_func_ptrs[i])
-                jit_code_cache_free(module->fast_jit_func_ptrs[i]);
-        }
         wasm_runtime_free(module->fast_jit_func_ptrs);
     }
 #endif
@@ -2788,6 +3188,41 @@ wasm_loader_unload(WASMModule *module)
     wasm_runtime_free(module);
 }
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+bool
+wasm_loader_prepare_function(WASMModule *module, uint32 func_idx,
+                             char *error_buf, uint32 error_buf_size)
+{
+    WASMFunction *func;
+    /* The module flags were set when the function was validated in
+       loading, the running module isn't changed again */
+    ModuleFlags module_flags = { 0 };
+    bool ret = true;
+
+    bh_assert(func_idx < module->function_count);
+    func = module->functions[func_idx];
+
+    /* The function may have been prepared for another module instance */
+    if (!func->code_compiled) {
+        if (!(ret = wasm_loader_prepare_bytecode(module, func, func_idx, false,
+                                                 &module_flags, error_buf,
+                                                 error_buf_size))) {
+            /* Drop the partially prepared code so that it can be
+               prepared again in the next call */
+            if (func->code_compiled) {
+                wasm_runtime_free(func->code_compiled);
+                func->code_compiled = NULL;
+            }
+            if (func->consts) {
+                wasm_runtime_free(func->consts);
+                func->consts = NULL;
+            }
+        }
+    }
+    return ret;
+}
+#endif
+
 bool
 wasm_loader_find_block_addr(WASMExecEnv *exec_env, BlockAddr *block_addr_cache,
                             const uint8 *start_addr, const uint8 *code_end_addr,
@@ -3316,6 +3751,13 @@ typedef struct WASMLoaderContext {
     uint32 csp_num;
     uint32 max_csp_num;
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    /* else and end addresses of the blocks validated */
+    BlockAddrEntry *block_addrs;
+    uint32 block_addr_num;
+    uint32 block_addrs_size;
+#endif
+
 #if WASM_ENABLE_FAST_INTERP != 0
     /* frame offset stack */
     int16 *frame_offset;
@@ -3511,6 +3953,10 @@ wasm_loader_ctx_destroy(WASMLoaderContext *ctx)
 #endif
             wasm_runtime_free(ctx->frame_csp_bottom);
         }
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+        if (ctx->block_addrs)
+            wasm_runtime_free(ctx->block_addrs);
+#endif
 #if WASM_ENABLE_FAST_INTERP != 0
         if (ctx->frame_offset_bottom)
             wasm_runtime_free(ctx->frame_offset_bottom);
@@ -3682,6 +4128,83 @@ wasm_loader_pop_frame_csp(WASMLoaderContext *ctx, char *error_buf,
     return true;
 }
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+static bool
+wasm_loader_add_block_addr(WASMLoaderContext *ctx, WASMFunction *func,
+                           BranchBlock *block, uint8 *end_addr,
+                           char *error_buf, uint32 error_buf_size)
+{
+    BlockAddrEntry *block_addr;
+
+    if (sizeof(BlockAddrEntry) * ctx->block_addr_num
+        >= ctx->block_addrs_size) {
+        uint32 size_new = ctx->block_addrs_size
+                              ? ctx->block_addrs_size * 2
+                              : (uint32)sizeof(BlockAddrEntry) * 8;
+        if (!ctx->block_addrs) {
+            if (!(ctx->block_addrs =
+                      loader_malloc(size_new, error_buf, error_buf_size)))
+                goto fail;
+        }
+        else {
+            MEM_REALLOC(ctx->block_addrs, ctx->block_addrs_size, size_new);
+        }
+        ctx->block_addrs_size = size_new;
+    }
+
+    block_addr = ctx->block_addrs + ctx->block_addr_num++;
+    block_addr->start_offset = (uint32)(block->start_addr - func->code);
+    block_addr->else_offset =
+        block->else_addr ? (uint32)(block->else_addr - func->code) : 0;
+    block_addr->end_offset = (uint32)(end_addr - func->code);
+    return true;
+fail:
+    return false;
+}
+
+static void
+wasm_loader_build_block_addr_table(WASMLoaderContext *ctx, WASMModule *module,
+                                   WASMFunction *func)
+{
+    BlockAddrEntry *table, *block_addr;
+    uint32 table_count = 8, table_size, i, j;
+
+    if (ctx->block_addr_num == 0)
+        return;
+
+    /* Keep the load factor of the table under 2/3 */
+    while (table_count < ctx->block_addr_num + ctx->block_addr_num / 2)
+        table_count *= 2;
+    table_size = (uint32)sizeof(BlockAddrEntry) * table_count;
+
+    os_mutex_lock(&module->prepare_lock);
+    if (table_size > BLOCK_ADDR_TABLE_BUDGET - module->block_addr_table_size) {
+        os_mutex_unlock(&module->prepare_lock);
+        LOG_VERBOSE("Block address table budget used up");
+        return;
+    }
+    module->block_addr_table_size += table_size;
+    os_mutex_unlock(&module->prepare_lock);
+
+    /* The table is an optimization only, fall back to the block address
+       cache if it fails to be allocated */
+    if (!(table = wasm_runtime_malloc(table_size)))
+        return;
+    memset(table, 0, table_size);
+
+    for (i = 0; i < ctx->block_addr_num; i++) {
+        block_addr = ctx->block_addrs + i;
+        j = block_addr->start_offset & (table_count - 1);
+        while (table[j].start_offset != 0)
+            j = (j + 1) & (table_count - 1);
+        table[j] = *block_addr;
+    }
+
+    func->block_addr_table = table;
+    func->block_addr_table_mask = table_count - 1;
+}
+#endif /* end of WASM_ENABLE_BLOCK_ADDR_TABLE != 0 */
+
 #if WASM_ENABLE_FAST_INTERP != 0
 
 #if WASM_ENABLE_LABELS_AS_VALUES != 0
@@ -5170,7 +5693,8 @@ fail:
 
 static bool
 wasm_loader_prepare_bytecode(WASMModule *module, WASMFunction *func,
-                             uint32 cur_func_idx, char *error_buf,
+                             uint32 cur_func_idx, bool validate_only,
+                             ModuleFlags *module_flags, char *error_buf,
                              uint32 error_buf_size)
 {
     uint8 *p = func->code, *p_end = func->code + func->code_size, *p_org;
@@ -5476,6 +6000,15 @@ re_scan:
                     (void)block_param_types;
                 }
 
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+                if ((cur_block->label_type == LABEL_TYPE_BLOCK
+                     || cur_block->label_type == LABEL_TYPE_IF)
+                    && !wasm_loader_add_block_addr(loader_ctx, func, cur_block,
+                                                   p - 1, error_buf,
+                                                   error_buf_size))
+                    goto fail;
+#endif
+
                 POP_CSP();
 
 #if WASM_ENABLE_FAST_INTERP != 0
@@ -5524,6 +6057,9 @@ re_scan:
             {
                 POP_I32();
 
+#if WASM_ENABLE_FAST_INTERP != 0
+            handle_op_br_if:
+#endif
                 if (!(frame_csp_tmp = check_branch_block(
                           loader_ctx, &p, p_end, error_buf, error_buf_size)))
                     goto fail;
@@ -5588,8 +6124,10 @@ re_scan:
                                 br_table_cache->br_depths[j] = p_depth_begin[j];
                             }
                             br_table_cache->br_depths[i] = depth;
+                            os_mutex_lock(&module->prepare_lock);
                             bh_list_insert(module->br_table_cache_list,
                                            br_table_cache);
+                            os_mutex_unlock(&module->prepare_lock);
                         }
                         else {
                             /* The depth can be stored in one byte, use the
@@ -6012,6 +6550,7 @@ re_scan:
                     PUSH_TYPE(decl_ref_type);
                 }
                 else {
+                    module_flags->possible_table_mutation = true;
 #if WASM_ENABLE_FAST_INTERP != 0
                     POP_OFFSET_TYPE(decl_ref_type);
 #endif
@@ -6445,7 +6984,7 @@ re_scan:
                 p++;
                 PUSH_I32();
 
-                module->possible_memory_grow = true;
+                module_flags->possible_memory_grow = true;
                 break;
 
             case WASM_OP_MEMORY_GROW:
@@ -6456,7 +6995,7 @@ re_scan:
                 POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
 
                 func->has_op_memory_grow = true;
-                module->possible_memory_grow = true;
+                module_flags->possible_memory_grow = true;
                 break;
 
             case WASM_OP_I32_CONST:
@@ -6531,6 +7070,18 @@ re_scan:
                 break;
 
             case WASM_OP_I32_EQZ:
+#if WASM_ENABLE_FAST_INTERP != 0
+                if (p < p_end && *p == WASM_OP_BR_IF) {
+                    /* Fuse the compare and the br_if following it into
+                       a superinstruction, which saves a dispatch and
+                       the store and reload of the condition */
+                    skip_label();
+                    emit_label(EXT_OP_BR_IF_I32_EQZ);
+                    POP_I32();
+                    opcode = *p++;
+                    goto handle_op_br_if;
+                }
+#endif
                 POP_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
                 break;
 
@@ -6544,6 +7095,16 @@ re_scan:
             case WASM_OP_I32_LE_U:
             case WASM_OP_I32_GE_S:
             case WASM_OP_I32_GE_U:
+#if WASM_ENABLE_FAST_INTERP != 0
+                if (p < p_end && *p == WASM_OP_BR_IF) {
+                    skip_label();
+                    emit_label(EXT_OP_BR_IF_I32_EQ + opcode - WASM_OP_I32_EQ);
+                    POP_I32();
+                    POP_I32();
+                    opcode = *p++;
+                    goto handle_op_br_if;
+                }
+#endif
                 POP2_AND_PUSH(VALUE_TYPE_I32, VALUE_TYPE_I32);
                 break;
 
@@ -6839,6 +7400,8 @@ re_scan:
                         uint8 seg_ref_type, tbl_ref_type;
                         uint32 table_seg_idx, table_idx;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, table_seg_idx);
                         read_leb_uint32(p, p_end, table_idx);
 
@@ -6885,6 +7448,8 @@ re_scan:
                         uint8 src_ref_type, dst_ref_type;
                         uint32 src_tbl_idx, dst_tbl_idx;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, src_tbl_idx);
                         if (!get_table_elem_type(module, src_tbl_idx,
                                                  &src_ref_type, error_buf,
@@ -6936,6 +7501,8 @@ re_scan:
                         uint8 decl_ref_type;
                         uint32 table_idx;
 
+                        module_flags->possible_table_mutation = true;
+
                         read_leb_uint32(p, p_end, table_idx);
                         if (!get_table_elem_type(module, table_idx,
                                                  &decl_ref_type, error_buf,
@@ -6978,6 +7545,11 @@ re_scan:
                 break;
             }
 
+            case WASM_OP_SIMD_PREFIX:
+                set_error_buf(error_buf, error_buf_size,
+                              "v128 is not supported by the mini loader");
+                goto fail;
+
 #if WASM_ENABLE_SHARED_MEMORY != 0
             case WASM_OP_ATOMIC_PREFIX:
             {
@@ -7128,8 +7700,15 @@ re_scan:
     }
 
 #if WASM_ENABLE_FAST_INTERP != 0
-    if (loader_ctx->p_code_compiled == NULL)
+    if (loader_ctx->p_code_compiled == NULL) {
+        if (validate_only) {
+            /* Skip the translation, the code size and the consts
+               calculated by the first traverse are dropped */
+            return_value = true;
+            goto fail;
+        }
         goto re_scan;
+    }
 
     func->const_cell_num = loader_ctx->const_cell_num;
     if (func->const_cell_num > 0) {
@@ -7163,6 +7742,9 @@ re_scan:
     func->max_stack_cell_num = loader_ctx->max_stack_cell_num;
 #endif
     func->max_block_num = loader_ctx->max_csp_num;
+#if WASM_ENABLE_BLOCK_ADDR_TABLE != 0
+    wasm_loader_build_block_addr_table(loader_ctx, module, func);
+#endif
     return_value = true;
 
 fail:
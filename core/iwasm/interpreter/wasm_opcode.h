@@ -272,6 +272,32 @@ typedef enum WASMOpcode {
     DEBUG_OP_BREAK = 0xd7, /* debug break point */
 #endif
 
+#if WASM_ENABLE_SIMD != 0
+    /* drop/select/global/local ops of v128 type for interpreter */
+    WASM_OP_DROP_V128 = 0xd8,
+    WASM_OP_SELECT_V128 = 0xd9,
+    WASM_OP_GET_GLOBAL_V128 = 0xda,
+    WASM_OP_SET_GLOBAL_V128 = 0xdb,
+    EXT_OP_SET_LOCAL_FAST_V128 = 0xdc,
+    EXT_OP_TEE_LOCAL_FAST_V128 = 0xdd,
+    EXT_OP_COPY_STACK_TOP_V128 = 0xde,
+#endif
+
+#if WASM_ENABLE_FAST_INTERP != 0
+    /* superinstructions of fast interpreter: i32 compare fused with br_if */
+    EXT_OP_BR_IF_I32_EQZ = 0xdf,
+    EXT_OP_BR_IF_I32_EQ = 0xe0,
+    EXT_OP_BR_IF_I32_NE = 0xe1,
+    EXT_OP_BR_IF_I32_LT_S = 0xe2,
+    EXT_OP_BR_IF_I32_LT_U = 0xe3,
+    EXT_OP_BR_IF_I32_GT_S = 0xe4,
+    EXT_OP_BR_IF_I32_GT_U = 0xe5,
+    EXT_OP_BR_IF_I32_LE_S = 0xe6,
+    EXT_OP_BR_IF_I32_LE_U = 0xe7,
+    EXT_OP_BR_IF_I32_GE_S = 0xe8,
+    EXT_OP_BR_IF_I32_GE_U = 0xe9,
+#endif
+
     /* Post-MVP extend op prefix */
     WASM_OP_MISC_PREFIX = 0xfc,
     WASM_OP_SIMD_PREFIX = 0xfd,
@@ -681,6 +707,43 @@ typedef enum WASMAtomicEXTOpcode {
 #define DEF_DEBUG_BREAK_HANDLE(_name)
 #endif
 
+#if WASM_ENABLE_SIMD != 0
+#define DEF_SIMD_HANDLE(_name)                                       \
+    _name[WASM_OP_DROP_V128] = HANDLE_OPCODE(WASM_OP_DROP_V128);     \
+    _name[WASM_OP_SELECT_V128] = HANDLE_OPCODE(WASM_OP_SELECT_V128); \
+    _name[WASM_OP_GET_GLOBAL_V128] =                                 \
+        HANDLE_OPCODE(WASM_OP_GET_GLOBAL_V128);                      \
+    _name[WASM_OP_SET_GLOBAL_V128] =                                 \
+        HANDLE_OPCODE(WASM_OP_SET_GLOBAL_V128);                      \
+    _name[EXT_OP_SET_LOCAL_FAST_V128] =                              \
+        HANDLE_OPCODE(EXT_OP_SET_LOCAL_FAST_V128);                   \
+    _name[EXT_OP_TEE_LOCAL_FAST_V128] =                              \
+        HANDLE_OPCODE(EXT_OP_TEE_LOCAL_FAST_V128);                   \
+    _name[EXT_OP_COPY_STACK_TOP_V128] =                              \
+        HANDLE_OPCODE(EXT_OP_COPY_STACK_TOP_V128);                   \
+    _name[WASM_OP_SIMD_PREFIX] =                                     \
+        HANDLE_OPCODE(WASM_OP_SIMD_PREFIX); /* 0xfd */
+#else
+#define DEF_SIMD_HANDLE(_name)
+#endif
+
+#if WASM_ENABLE_FAST_INTERP != 0
+#define DEF_FUSED_BR_IF_HANDLE(_name)                                    \
+    _name[EXT_OP_BR_IF_I32_EQZ] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_EQZ);   \
+    _name[EXT_OP_BR_IF_I32_EQ] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_EQ);     \
+    _name[EXT_OP_BR_IF_I32_NE] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_NE);     \
+    _name[EXT_OP_BR_IF_I32_LT_S] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_LT_S); \
+    _name[EXT_OP_BR_IF_I32_LT_U] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_LT_U); \
+    _name[EXT_OP_BR_IF_I32_GT_S] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_GT_S); \
+    _name[EXT_OP_BR_IF_I32_GT_U] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_GT_U); \
+    _name[EXT_OP_BR_IF_I32_LE_S] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_LE_S); \
+    _name[EXT_OP_BR_IF_I32_LE_U] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_LE_U); \
+    _name[EXT_OP_BR_IF_I32_GE_S] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_GE_S); \
+    _name[EXT_OP_BR_IF_I32_GE_U] = HANDLE_OPCODE(EXT_OP_BR_IF_I32_GE_U);
+#else
+#define DEF_FUSED_BR_IF_HANDLE(_name)
+#endif
+
 /*
  * Macro used to generate computed goto tables for the C interpreter.
  */
@@ -910,6 +973,8 @@ typedef enum WASMAtomicEXTOpcode {
         _name[WASM_OP_ATOMIC_PREFIX] =                          \
             HANDLE_OPCODE(WASM_OP_ATOMIC_PREFIX); /* 0xfe */    \
         DEF_DEBUG_BREAK_HANDLE(_name)                           \
+        DEF_SIMD_HANDLE(_name)                                  \
+        DEF_FUSED_BR_IF_HANDLE(_name)                           \
     } while (0)
 
 #ifdef __cplusplus
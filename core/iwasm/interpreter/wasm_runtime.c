@@ -22,6 +22,9 @@
 #if WASM_ENABLE_JIT != 0
 #include "../aot/aot_runtime.h"
 #endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+#include "../fast-jit/jit_codecache.h"
+#endif
 
 static void
 set_error_buf(char *error_buf, uint32 error_buf_size, const char *string)
@@ -695,6 +698,9 @@ functions_instantiate(const WASMModule *module, WASMModuleInstance *module_inst,
         }
 #endif /* WASM_ENABLE_MULTI_MODULE */
         function->u.func_import = &import->u.function;
+#if WASM_ENABLE_LAZY_PREPARE != 0
+        function->is_prepared = 1;
+#endif
         function->param_cell_num = import->u.function.func_type->param_cell_num;
         function->ret_cell_num = import->u.function.func_type->ret_cell_num;
         function->param_count =
@@ -1963,6 +1969,36 @@ wasm_lookup_function(const WASMModuleInstance *module_inst, const char *name,
     return NULL;
 }
 
+#if WASM_ENABLE_LAZY_PREPARE != 0
+bool
+wasm_prepare_function(WASMModuleInstance *module_inst,
+                      WASMFunctionInstance *function, char *error_buf,
+                      uint32 error_buf_size)
+{
+    WASMModule *module = module_inst->module;
+    uint32 func_idx = (uint32)(function - module_inst->e->functions)
+                      - module->import_function_count;
+    bool ret = true;
+
+    bh_assert(!function->is_import_func);
+
+    os_mutex_lock(&module->lazy_prepare_lock);
+    /* The function may have been prepared by another thread */
+    if (!function->is_prepared) {
+        if ((ret = wasm_loader_prepare_function(module, func_idx, error_buf,
+                                                error_buf_size))) {
+            function->const_cell_num =
+                (uint16)function->u.func->const_cell_num;
+            /* Publish the translated bytecode and const_cell_num to the
+               threads checking the flag without the lock */
+            BH_ATOMIC_32_STORE_RELEASE(function->is_prepared, 1);
+        }
+    }
+    os_mutex_unlock(&module->lazy_prepare_lock);
+    return ret;
+}
+#endif
+
 #if WASM_ENABLE_MULTI_MODULE != 0
 WASMGlobalInstance *
 wasm_lookup_global(const WASMModuleInstance *module_inst, const char *name)
@@ -2030,6 +2066,9 @@ call_wasm_with_hw_bound_check(WASMModuleInstance *module_inst,
 #ifdef BH_PLATFORM_WINDOWS
     const char *exce;
     int result;
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    uint32 jit_code_cache_pins = exec_env->jit_code_cache_pins;
 #endif
     bool ret = true;
 
@@ -2081,6 +2120,11 @@ call_wasm_with_hw_bound_check(WASMModuleInstance *module_inst,
         ret = false;
     }
 
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    /* Release the pins of the jitted code skipped by longjmp */
+    jit_code_cache_unpin(exec_env, jit_code_cache_pins);
+#endif
+
     if (wasm_get_exception(module_inst)) {
 #if WASM_ENABLE_DUMP_CALL_STACK != 0
         if (wasm_interp_create_call_stack(exec_env)) {
@@ -2200,6 +2244,67 @@ wasm_dump_perf_profiling(const WASMModuleInstance *module_inst)
 }
 #endif
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+const char *
+wasm_get_func_name_from_index(const WASMModuleInstance *module_inst,
+                              uint32 func_idx)
+{
+    WASMFunctionInstance *func_inst;
+    const char *func_name = NULL;
+    uint32 i;
+
+    if (func_idx >= module_inst->e->function_count)
+        return NULL;
+
+    func_inst = module_inst->e->functions + func_idx;
+    if (func_inst->is_import_func)
+        return func_inst->u.func_import->field_name;
+
+#if WASM_ENABLE_CUSTOM_NAME_SECTION != 0
+    func_name = func_inst->u.func->field_name;
+#endif
+    /* if custom name section is not generated,
+       search symbols from export table */
+    for (i = 0; !func_name && i < module_inst->export_func_count; i++) {
+        if (module_inst->export_functions[i].function == func_inst)
+            func_name = module_inst->export_functions[i].name;
+    }
+    return func_name;
+}
+
+uint32
+wasm_sample_call_stack(WASMExecEnv *exec_env, uint32 *func_idxes,
+                       uint32 max_depth)
+{
+    WASMModuleInstance *module_inst =
+        (WASMModuleInstance *)exec_env->module_inst;
+    WASMFunctionInstance *functions = module_inst->e->functions;
+    uint32 function_count = module_inst->e->function_count;
+    WASMInterpFrame *frame = wasm_exec_env_get_cur_frame(exec_env);
+    uint8 *stack_bottom = exec_env->wasm_stack.s.bottom;
+    uint8 *stack_top = exec_env->wasm_stack.s.top;
+    uint32 depth = 0;
+
+    /* Called in the signal handler which may interrupt the thread when it
+       is pushing or popping a frame, so don't follow the frames which are
+       outside the used wasm stack */
+    while (frame && depth < max_depth && (uint8 *)frame >= stack_bottom
+           && (uint8 *)frame < stack_top) {
+        if (frame->function) {
+            /* The functions of the other module instances in the
+               multi-module mode aren't symbolized */
+            if (frame->function >= functions
+                && frame->function < functions + function_count)
+                func_idxes[depth++] = (uint32)(frame->function - functions);
+            else
+                func_idxes[depth++] = (uint32)-1;
+        }
+        frame = frame->prev_frame;
+    }
+    return depth;
+}
+#endif /* end of WASM_ENABLE_SAMPLING_PROFILER != 0 */
+
 uint32
 wasm_module_malloc(WASMModuleInstance *module_inst, uint32 size,
                    void **p_native_addr)
@@ -2796,6 +2901,23 @@ fast_jit_call_indirect(WASMExecEnv *exec_env, uint32 tbl_idx, uint32 elem_idx,
     return call_indirect(exec_env, tbl_idx, elem_idx, argc, argv, true,
                          type_idx);
 }
+
+#if WASM_ENABLE_JIT != 0
+void
+fast_jit_request_llvm_jit_tier_up(WASMModule *module, uint32 func_idx)
+{
+    os_mutex_lock(&module->tier_up_lock);
+    if (!module->func_ptrs_compiled[func_idx]
+        && !module->tier_up_requested[func_idx]) {
+        /* Each function is pushed at most once, the queue never
+           overflows */
+        module->tier_up_requested[func_idx] = true;
+        module->tier_up_queue[module->tier_up_queue_tail++] = func_idx;
+        os_cond_signal(&module->tier_up_cond);
+    }
+    os_mutex_unlock(&module->tier_up_lock);
+}
+#endif
 #endif
 
 #if WASM_ENABLE_JIT != 0 || WASM_ENABLE_WAMR_COMPILER != 0
@@ -2857,6 +2979,11 @@ llvm_jit_invoke_native(WASMExecEnv *exec_env, uint32 func_idx, uint32 argc,
             (WASMModuleInstanceCommon *)module_inst, func_ptr, func_type, argc,
             argv, import_func->wasm_c_api_with_env, attachment);
     }
+    else if (import_func->call_shape) {
+        return wasm_runtime_invoke_native_shape(exec_env, func_ptr,
+                                                import_func->call_shape,
+                                                attachment, argv, argv);
+    }
     else if (!import_func->call_conv_raw) {
         signature = import_func->signature;
         return wasm_runtime_invoke_native(exec_env, func_ptr, func_type,
@@ -3096,7 +3223,8 @@ llvm_jit_table_grow(WASMModuleInstance *module_inst, uint32 tbl_idx,
 }
 #endif /* end of WASM_ENABLE_REF_TYPES != 0 */
 
-#if WASM_ENABLE_DUMP_CALL_STACK != 0 || WASM_ENABLE_PERF_PROFILING != 0
+#if WASM_ENABLE_DUMP_CALL_STACK != 0 || WASM_ENABLE_PERF_PROFILING != 0 \
+    || WASM_ENABLE_SAMPLING_PROFILER != 0
 bool
 llvm_jit_alloc_frame(WASMExecEnv *exec_env, uint32 func_index)
 {
@@ -150,6 +150,12 @@ struct WASMFunctionInstance {
 #if WASM_ENABLE_FAST_INTERP != 0
     /* cell num of consts */
     uint16 const_cell_num;
+#endif
+#if WASM_ENABLE_LAZY_PREPARE != 0
+    /* whether the bytecode is translated and const_cell_num is set,
+       always true for import function, it is set with release semantics
+       after them and must be loaded with acquire semantics */
+    uint32 is_prepared;
 #endif
     uint16 *local_offsets;
     /* parameter types */
@@ -292,7 +298,10 @@ struct WASMModuleInstance {
 
     /* Default WASM operand stack size */
     uint32 default_wasm_stack_size;
-    uint32 reserved[3];
+    uint32 reserved[1];
+    /* Counters of the PGO instrumented AOT code, only available
+       in AOTModuleInstance */
+    DefPointer(uint64 *, pgo_counters);
 
     /*
      * +------------------------------+ <-- memories
@@ -378,6 +387,60 @@ wasm_instantiate(WASMModule *module, bool is_sub_inst, uint32 stack_size,
 void
 wasm_dump_perf_profiling(const WASMModuleInstance *module_inst);
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+/**
+ * Get the name of a function from the name section or the import/export
+ * sections, NULL if not found
+ */
+const char *
+wasm_get_func_name_from_index(const WASMModuleInstance *module_inst,
+                              uint32 func_idx);
+
+/**
+ * Walk the wasm frames of the exec_env from the innermost one, it is
+ * called in the signal handler of the sampling profiler
+ *
+ * @param exec_env the exec_env interrupted by the signal
+ * @param func_idxes return the function indexes, -1 if unknown
+ * @param max_depth the max number of the frames to walk
+ *
+ * @return the number of the frames walked
+ */
+uint32
+wasm_sample_call_stack(WASMExecEnv *exec_env, uint32 *func_idxes,
+                       uint32 max_depth);
+#endif
+
+#if WASM_ENABLE_LAZY_PREPARE != 0
+/**
+ * Translate the bytecode of a function of the module instance when it is
+ * called the first time, and set the const cell num of the function
+ *
+ * @param module_inst the module instance which the function belongs to
+ * @param function the function to prepare, which isn't an import function
+ * @param error_buf output of the exception info
+ * @param error_buf_size the size of the exception string
+ *
+ * @return true if success, false otherwise
+ */
+bool
+wasm_prepare_function(WASMModuleInstance *module_inst,
+                      WASMFunctionInstance *function, char *error_buf,
+                      uint32 error_buf_size);
+
+static inline bool
+wasm_is_function_prepared(WASMFunctionInstance *function)
+{
+#if BH_ATOMIC_32_IS_ATOMIC != 0
+    return BH_ATOMIC_32_LOAD_ACQUIRE(function->is_prepared) ? true : false;
+#else
+    /* Let wasm_prepare_function check the flag under the lock */
+    (void)function;
+    return false;
+#endif
+}
+#endif
+
 void
 wasm_deinstantiate(WASMModuleInstance *module_inst, bool is_sub_inst);
 
@@ -553,6 +616,24 @@ fast_jit_call_indirect(WASMExecEnv *exec_env, uint32 tbl_idx, uint32 elem_idx,
 bool
 fast_jit_invoke_native(WASMExecEnv *exec_env, uint32 func_idx,
                        struct WASMInterpFrame *prev_frame);
+
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0 || WASM_ENABLE_JIT != 0
+bool
+fast_jit_call_interp_func(WASMExecEnv *exec_env,
+                          struct WASMInterpFrame *prev_frame);
+#endif
+
+#if WASM_ENABLE_JIT != 0
+/**
+ * Request LLVM JIT to compile a function which is hot in Fast JIT code,
+ * the function is compiled by the background compilation threads.
+ *
+ * @param module the wasm module
+ * @param func_idx the index of the function, excluding the imported ones
+ */
+void
+fast_jit_request_llvm_jit_tier_up(WASMModule *module, uint32 func_idx);
+#endif
 #endif
 
 #if WASM_ENABLE_JIT != 0 || WASM_ENABLE_WAMR_COMPILER != 0
@@ -596,7 +677,8 @@ llvm_jit_table_grow(WASMModuleInstance *module_inst, uint32 tbl_idx,
                     uint32 inc_entries, uint32 init_val);
 #endif
 
-#if WASM_ENABLE_DUMP_CALL_STACK != 0 || WASM_ENABLE_PERF_PROFILING != 0
+#if WASM_ENABLE_DUMP_CALL_STACK != 0 || WASM_ENABLE_PERF_PROFILING != 0 \
+    || WASM_ENABLE_SAMPLING_PROFILER != 0
 bool
 llvm_jit_alloc_frame(WASMExecEnv *exec_env, uint32 func_index);
 
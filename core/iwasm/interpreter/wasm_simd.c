@@ -0,0 +1,1644 @@
+/*
+ * Copyright (C) 2019 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#include "wasm_simd.h"
+#include "wasm_opcode.h"
+#include "bh_common.h"
+
+#if WASM_ENABLE_SIMD != 0
+
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static inline V128
+read_v128(const uint32 *cells)
+{
+    V128 v;
+    bh_memcpy_s(&v, sizeof(V128), cells, sizeof(V128));
+    return v;
+}
+
+static inline void
+write_v128(uint32 *cells, const V128 *v)
+{
+    bh_memcpy_s(cells, sizeof(V128), v, sizeof(V128));
+}
+
+static inline int8
+sat_i8(int32 v)
+{
+    return (int8)(v < INT8_MIN ? INT8_MIN : (v > INT8_MAX ? INT8_MAX : v));
+}
+
+static inline uint8
+sat_u8(int32 v)
+{
+    return (uint8)(v < 0 ? 0 : (v > UINT8_MAX ? UINT8_MAX : v));
+}
+
+static inline int16
+sat_i16(int32 v)
+{
+    return (int16)(v < INT16_MIN ? INT16_MIN : (v > INT16_MAX ? INT16_MAX : v));
+}
+
+static inline uint16
+sat_u16(int32 v)
+{
+    return (uint16)(v < 0 ? 0 : (v > UINT16_MAX ? UINT16_MAX : v));
+}
+
+static inline int32
+sat_i32(int64 v)
+{
+    return (int32)(v < INT32_MIN ? INT32_MIN : (v > INT32_MAX ? INT32_MAX : v));
+}
+
+static inline uint32
+sat_u32(int64 v)
+{
+    return (uint32)(v < 0 ? 0 : (v > UINT32_MAX ? UINT32_MAX : v));
+}
+
+/* min/max follow the wasm semantics: NaN is propagated and -0.0 is
+   less than +0.0 */
+static inline float32
+f32_min(float32 a, float32 b)
+{
+    if (isnan(a) || isnan(b))
+        return a + b;
+    if (a == b)
+        return signbit(a) ? a : b;
+    return a < b ? a : b;
+}
+
+static inline float32
+f32_max(float32 a, float32 b)
+{
+    if (isnan(a) || isnan(b))
+        return a + b;
+    if (a == b)
+        return signbit(a) ? b : a;
+    return a > b ? a : b;
+}
+
+static inline float64
+f64_min(float64 a, float64 b)
+{
+    if (isnan(a) || isnan(b))
+        return a + b;
+    if (a == b)
+        return signbit(a) ? a : b;
+    return a < b ? a : b;
+}
+
+static inline float64
+f64_max(float64 a, float64 b)
+{
+    if (isnan(a) || isnan(b))
+        return a + b;
+    if (a == b)
+        return signbit(a) ? b : a;
+    return a > b ? a : b;
+}
+
+static inline int32
+trunc_sat_i32(float64 f)
+{
+    if (isnan(f))
+        return 0;
+    if (f <= (float64)INT32_MIN)
+        return INT32_MIN;
+    if (f >= (float64)INT32_MAX)
+        return INT32_MAX;
+    return (int32)f;
+}
+
+static inline uint32
+trunc_sat_u32(float64 f)
+{
+    if (isnan(f) || f <= -1.0)
+        return 0;
+    if (f >= (float64)UINT32_MAX)
+        return UINT32_MAX;
+    return (uint32)f;
+}
+
+/* Apply an expression to each lane, the lanes of the operands and the
+   result are named a, b and r, and i is the lane index */
+#define LANES(shape, n, expr)     \
+    do {                          \
+        for (i = 0; i < n; i++) { \
+            r.shape[i] = (expr);  \
+        }                         \
+    } while (0)
+
+/* Same as LANES, but the operation also takes the second v128 operand */
+#define BINARY_LANES(shape, n, expr) \
+    do {                             \
+        b = read_v128(cells + 4);    \
+        LANES(shape, n, expr);       \
+    } while (0)
+
+#define A8(i) a.i8x16[i]
+#define B8(i) b.i8x16[i]
+#define UA8(i) ((uint8)a.i8x16[i])
+#define UB8(i) ((uint8)b.i8x16[i])
+#define A16(i) a.i16x8[i]
+#define B16(i) b.i16x8[i]
+#define UA16(i) ((uint16)a.i16x8[i])
+#define UB16(i) ((uint16)b.i16x8[i])
+#define A32(i) a.i32x8[i]
+#define B32(i) b.i32x8[i]
+#define UA32(i) ((uint32)a.i32x8[i])
+#define UB32(i) ((uint32)b.i32x8[i])
+#define A64(i) a.i64x2[i]
+#define B64(i) b.i64x2[i]
+#define UA64(i) ((uint64)a.i64x2[i])
+#define UB64(i) ((uint64)b.i64x2[i])
+
+/* All bits of the lane are set if cond is true, or cleared otherwise */
+#define MASK(cond) ((cond) ? -1 : 0)
+
+#if defined(__SSE2__)
+#define LOAD_V(n) _mm_loadu_si128((const __m128i *)(cells + (n)))
+#define LOAD_F32X4(n) _mm_loadu_ps((const float *)(cells + (n)))
+#define LOAD_F64X2(n) _mm_loadu_pd((const double *)(cells + (n)))
+#define STORE_V(v) _mm_storeu_si128((__m128i *)cells, v)
+#define STORE_F32X4(v) _mm_storeu_ps((float *)cells, v)
+#define STORE_F64X2(v) _mm_storeu_pd((double *)cells, v)
+#define SHIFT_COUNT(bits) _mm_cvtsi32_si128((int)(cells[4] & (bits - 1)))
+
+/* Execute the common SIMD opcodes with the host SSE2 instructions,
+   return false if the opcode should be executed by the scalar code */
+static inline bool
+exec_op_native(uint8 opcode, uint32 *cells)
+{
+    __m128i a = LOAD_V(0);
+
+    switch (opcode) {
+        case SIMD_v128_not:
+            STORE_V(_mm_xor_si128(a, _mm_set1_epi32(-1)));
+            return true;
+        case SIMD_v128_and:
+            STORE_V(_mm_and_si128(a, LOAD_V(4)));
+            return true;
+        case SIMD_v128_andnot:
+            STORE_V(_mm_andnot_si128(LOAD_V(4), a));
+            return true;
+        case SIMD_v128_or:
+            STORE_V(_mm_or_si128(a, LOAD_V(4)));
+            return true;
+        case SIMD_v128_xor:
+            STORE_V(_mm_xor_si128(a, LOAD_V(4)));
+            return true;
+        case SIMD_v128_bitselect:
+        {
+            __m128i c = LOAD_V(8);
+            STORE_V(_mm_or_si128(_mm_and_si128(a, c),
+                                 _mm_andnot_si128(c, LOAD_V(4))));
+            return true;
+        }
+        case SIMD_i8x16_eq:
+            STORE_V(_mm_cmpeq_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_lt_s:
+            STORE_V(_mm_cmplt_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_gt_s:
+            STORE_V(_mm_cmpgt_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_eq:
+            STORE_V(_mm_cmpeq_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_lt_s:
+            STORE_V(_mm_cmplt_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_gt_s:
+            STORE_V(_mm_cmpgt_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_eq:
+            STORE_V(_mm_cmpeq_epi32(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_lt_s:
+            STORE_V(_mm_cmplt_epi32(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_gt_s:
+            STORE_V(_mm_cmpgt_epi32(a, LOAD_V(4)));
+            return true;
+        case SIMD_f32x4_eq:
+            STORE_F32X4(_mm_cmpeq_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_ne:
+            STORE_F32X4(_mm_cmpneq_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_lt:
+            STORE_F32X4(_mm_cmplt_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_gt:
+            STORE_F32X4(_mm_cmpgt_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_le:
+            STORE_F32X4(_mm_cmple_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_ge:
+            STORE_F32X4(_mm_cmpge_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_i8x16_bitmask:
+            cells[0] = (uint32)_mm_movemask_epi8(a);
+            return true;
+        case SIMD_i8x16_add:
+            STORE_V(_mm_add_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_add_sat_s:
+            STORE_V(_mm_adds_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_add_sat_u:
+            STORE_V(_mm_adds_epu8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_sub:
+            STORE_V(_mm_sub_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_sub_sat_s:
+            STORE_V(_mm_subs_epi8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_sub_sat_u:
+            STORE_V(_mm_subs_epu8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_min_u:
+            STORE_V(_mm_min_epu8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_max_u:
+            STORE_V(_mm_max_epu8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i8x16_avgr_u:
+            STORE_V(_mm_avg_epu8(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_shl:
+            STORE_V(_mm_sll_epi16(a, SHIFT_COUNT(16)));
+            return true;
+        case SIMD_i16x8_shr_s:
+            STORE_V(_mm_sra_epi16(a, SHIFT_COUNT(16)));
+            return true;
+        case SIMD_i16x8_shr_u:
+            STORE_V(_mm_srl_epi16(a, SHIFT_COUNT(16)));
+            return true;
+        case SIMD_i16x8_add:
+            STORE_V(_mm_add_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_add_sat_s:
+            STORE_V(_mm_adds_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_add_sat_u:
+            STORE_V(_mm_adds_epu16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_sub:
+            STORE_V(_mm_sub_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_sub_sat_s:
+            STORE_V(_mm_subs_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_sub_sat_u:
+            STORE_V(_mm_subs_epu16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_mul:
+            STORE_V(_mm_mullo_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_min_s:
+            STORE_V(_mm_min_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_max_s:
+            STORE_V(_mm_max_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i16x8_avgr_u:
+            STORE_V(_mm_avg_epu16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_shl:
+            STORE_V(_mm_sll_epi32(a, SHIFT_COUNT(32)));
+            return true;
+        case SIMD_i32x4_shr_s:
+            STORE_V(_mm_sra_epi32(a, SHIFT_COUNT(32)));
+            return true;
+        case SIMD_i32x4_shr_u:
+            STORE_V(_mm_srl_epi32(a, SHIFT_COUNT(32)));
+            return true;
+        case SIMD_i32x4_add:
+            STORE_V(_mm_add_epi32(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_sub:
+            STORE_V(_mm_sub_epi32(a, LOAD_V(4)));
+            return true;
+        case SIMD_i32x4_dot_i16x8_s:
+            STORE_V(_mm_madd_epi16(a, LOAD_V(4)));
+            return true;
+        case SIMD_i64x2_shl:
+            STORE_V(_mm_sll_epi64(a, SHIFT_COUNT(64)));
+            return true;
+        case SIMD_i64x2_shr_u:
+            STORE_V(_mm_srl_epi64(a, SHIFT_COUNT(64)));
+            return true;
+        case SIMD_i64x2_add:
+            STORE_V(_mm_add_epi64(a, LOAD_V(4)));
+            return true;
+        case SIMD_i64x2_sub:
+            STORE_V(_mm_sub_epi64(a, LOAD_V(4)));
+            return true;
+        case SIMD_f32x4_sqrt:
+            STORE_F32X4(_mm_sqrt_ps(LOAD_F32X4(0)));
+            return true;
+        case SIMD_f32x4_add:
+            STORE_F32X4(_mm_add_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_sub:
+            STORE_F32X4(_mm_sub_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_mul:
+            STORE_F32X4(_mm_mul_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f32x4_div:
+            STORE_F32X4(_mm_div_ps(LOAD_F32X4(0), LOAD_F32X4(4)));
+            return true;
+        case SIMD_f64x2_sqrt:
+            STORE_F64X2(_mm_sqrt_pd(LOAD_F64X2(0)));
+            return true;
+        case SIMD_f64x2_add:
+            STORE_F64X2(_mm_add_pd(LOAD_F64X2(0), LOAD_F64X2(4)));
+            return true;
+        case SIMD_f64x2_sub:
+            STORE_F64X2(_mm_sub_pd(LOAD_F64X2(0), LOAD_F64X2(4)));
+            return true;
+        case SIMD_f64x2_mul:
+            STORE_F64X2(_mm_mul_pd(LOAD_F64X2(0), LOAD_F64X2(4)));
+            return true;
+        case SIMD_f64x2_div:
+            STORE_F64X2(_mm_div_pd(LOAD_F64X2(0), LOAD_F64X2(4)));
+            return true;
+        default:
+            return false;
+    }
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define LOAD_V(type, n) vld1q_##type((const void *)(cells + (n)))
+#define STORE_V(type, v) vst1q_##type((void *)cells, v)
+#define UNARY_V(type, op) STORE_V(type, op(LOAD_V(type, 0)))
+#define BINARY_V(type, op) STORE_V(type, op(LOAD_V(type, 0), LOAD_V(type, 4)))
+#define CMP_V(type, utype, op) \
+    STORE_V(utype, op(LOAD_V(type, 0), LOAD_V(type, 4)))
+
+/* Execute the common SIMD opcodes with the host NEON instructions,
+   return false if the opcode should be executed by the scalar code */
+static inline bool
+exec_op_native(uint8 opcode, uint32 *cells)
+{
+    switch (opcode) {
+        case SIMD_v128_not:
+            UNARY_V(u8, vmvnq_u8);
+            return true;
+        case SIMD_v128_and:
+            BINARY_V(u8, vandq_u8);
+            return true;
+        case SIMD_v128_andnot:
+            BINARY_V(u8, vbicq_u8);
+            return true;
+        case SIMD_v128_or:
+            BINARY_V(u8, vorrq_u8);
+            return true;
+        case SIMD_v128_xor:
+            BINARY_V(u8, veorq_u8);
+            return true;
+        case SIMD_v128_bitselect:
+            STORE_V(u8, vbslq_u8(LOAD_V(u8, 8), LOAD_V(u8, 0), LOAD_V(u8, 4)));
+            return true;
+        case SIMD_i8x16_eq:
+            CMP_V(s8, u8, vceqq_s8);
+            return true;
+        case SIMD_i8x16_lt_s:
+            CMP_V(s8, u8, vcltq_s8);
+            return true;
+        case SIMD_i8x16_gt_s:
+            CMP_V(s8, u8, vcgtq_s8);
+            return true;
+        case SIMD_i16x8_eq:
+            CMP_V(s16, u16, vceqq_s16);
+            return true;
+        case SIMD_i16x8_lt_s:
+            CMP_V(s16, u16, vcltq_s16);
+            return true;
+        case SIMD_i16x8_gt_s:
+            CMP_V(s16, u16, vcgtq_s16);
+            return true;
+        case SIMD_i32x4_eq:
+            CMP_V(s32, u32, vceqq_s32);
+            return true;
+        case SIMD_i32x4_lt_s:
+            CMP_V(s32, u32, vcltq_s32);
+            return true;
+        case SIMD_i32x4_gt_s:
+            CMP_V(s32, u32, vcgtq_s32);
+            return true;
+        case SIMD_f32x4_eq:
+            CMP_V(f32, u32, vceqq_f32);
+            return true;
+        case SIMD_f32x4_lt:
+            CMP_V(f32, u32, vcltq_f32);
+            return true;
+        case SIMD_f32x4_gt:
+            CMP_V(f32, u32, vcgtq_f32);
+            return true;
+        case SIMD_f32x4_le:
+            CMP_V(f32, u32, vcleq_f32);
+            return true;
+        case SIMD_f32x4_ge:
+            CMP_V(f32, u32, vcgeq_f32);
+            return true;
+        case SIMD_i8x16_add:
+            BINARY_V(s8, vaddq_s8);
+            return true;
+        case SIMD_i8x16_add_sat_s:
+            BINARY_V(s8, vqaddq_s8);
+            return true;
+        case SIMD_i8x16_add_sat_u:
+            BINARY_V(u8, vqaddq_u8);
+            return true;
+        case SIMD_i8x16_sub:
+            BINARY_V(s8, vsubq_s8);
+            return true;
+        case SIMD_i8x16_sub_sat_s:
+            BINARY_V(s8, vqsubq_s8);
+            return true;
+        case SIMD_i8x16_sub_sat_u:
+            BINARY_V(u8, vqsubq_u8);
+            return true;
+        case SIMD_i8x16_min_s:
+            BINARY_V(s8, vminq_s8);
+            return true;
+        case SIMD_i8x16_min_u:
+            BINARY_V(u8, vminq_u8);
+            return true;
+        case SIMD_i8x16_max_s:
+            BINARY_V(s8, vmaxq_s8);
+            return true;
+        case SIMD_i8x16_max_u:
+            BINARY_V(u8, vmaxq_u8);
+            return true;
+        case SIMD_i8x16_avgr_u:
+            BINARY_V(u8, vrhaddq_u8);
+            return true;
+        case SIMD_i16x8_add:
+            BINARY_V(s16, vaddq_s16);
+            return true;
+        case SIMD_i16x8_add_sat_s:
+            BINARY_V(s16, vqaddq_s16);
+            return true;
+        case SIMD_i16x8_add_sat_u:
+            BINARY_V(u16, vqaddq_u16);
+            return true;
+        case SIMD_i16x8_sub:
+            BINARY_V(s16, vsubq_s16);
+            return true;
+        case SIMD_i16x8_sub_sat_s:
+            BINARY_V(s16, vqsubq_s16);
+            return true;
+        case SIMD_i16x8_sub_sat_u:
+            BINARY_V(u16, vqsubq_u16);
+            return true;
+        case SIMD_i16x8_mul:
+            BINARY_V(s16, vmulq_s16);
+            return true;
+        case SIMD_i16x8_min_s:
+            BINARY_V(s16, vminq_s16);
+            return true;
+        case SIMD_i16x8_min_u:
+            BINARY_V(u16, vminq_u16);
+            return true;
+        case SIMD_i16x8_max_s:
+            BINARY_V(s16, vmaxq_s16);
+            return true;
+        case SIMD_i16x8_max_u:
+            BINARY_V(u16, vmaxq_u16);
+            return true;
+        case SIMD_i16x8_avgr_u:
+            BINARY_V(u16, vrhaddq_u16);
+            return true;
+        case SIMD_i32x4_add:
+            BINARY_V(s32, vaddq_s32);
+            return true;
+        case SIMD_i32x4_sub:
+            BINARY_V(s32, vsubq_s32);
+            return true;
+        case SIMD_i32x4_mul:
+            BINARY_V(s32, vmulq_s32);
+            return true;
+        case SIMD_i32x4_min_s:
+            BINARY_V(s32, vminq_s32);
+            return true;
+        case SIMD_i32x4_min_u:
+            BINARY_V(u32, vminq_u32);
+            return true;
+        case SIMD_i32x4_max_s:
+            BINARY_V(s32, vmaxq_s32);
+            return true;
+        case SIMD_i32x4_max_u:
+            BINARY_V(u32, vmaxq_u32);
+            return true;
+        case SIMD_i64x2_add:
+            BINARY_V(s64, vaddq_s64);
+            return true;
+        case SIMD_i64x2_sub:
+            BINARY_V(s64, vsubq_s64);
+            return true;
+        case SIMD_f32x4_sqrt:
+            UNARY_V(f32, vsqrtq_f32);
+            return true;
+        case SIMD_f32x4_add:
+            BINARY_V(f32, vaddq_f32);
+            return true;
+        case SIMD_f32x4_sub:
+            BINARY_V(f32, vsubq_f32);
+            return true;
+        case SIMD_f32x4_mul:
+            BINARY_V(f32, vmulq_f32);
+            return true;
+        case SIMD_f32x4_div:
+            BINARY_V(f32, vdivq_f32);
+            return true;
+        case SIMD_f64x2_sqrt:
+            UNARY_V(f64, vsqrtq_f64);
+            return true;
+        case SIMD_f64x2_add:
+            BINARY_V(f64, vaddq_f64);
+            return true;
+        case SIMD_f64x2_sub:
+            BINARY_V(f64, vsubq_f64);
+            return true;
+        case SIMD_f64x2_mul:
+            BINARY_V(f64, vmulq_f64);
+            return true;
+        case SIMD_f64x2_div:
+            BINARY_V(f64, vdivq_f64);
+            return true;
+        default:
+            return false;
+    }
+}
+#endif /* end of defined(__SSE2__) */
+
+void
+wasm_simd_exec_op(uint8 opcode, uint8 lane, uint32 *cells)
+{
+    V128 a, b, c, r = { 0 };
+    uint32 i, shift = 0;
+    int32 result_i32;
+
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+    if (exec_op_native(opcode, cells))
+        return;
+#endif
+
+    a = read_v128(cells);
+
+    switch (opcode) {
+        case SIMD_v8x16_swizzle:
+            BINARY_LANES(i8x16, 16, UB8(i) < 16 ? A8(UB8(i)) : 0);
+            break;
+
+        /* splat operation */
+        case SIMD_i8x16_splat:
+            LANES(i8x16, 16, (int8)cells[0]);
+            break;
+        case SIMD_i16x8_splat:
+            LANES(i16x8, 8, (int16)cells[0]);
+            break;
+        case SIMD_i32x4_splat:
+            LANES(i32x8, 4, (int32)cells[0]);
+            break;
+        case SIMD_i64x2_splat:
+        {
+            int64 v;
+            bh_memcpy_s(&v, sizeof(int64), cells, sizeof(int64));
+            LANES(i64x2, 2, v);
+            break;
+        }
+        case SIMD_f32x4_splat:
+        {
+            float32 v;
+            bh_memcpy_s(&v, sizeof(float32), cells, sizeof(float32));
+            LANES(f32x4, 4, v);
+            break;
+        }
+        case SIMD_f64x2_splat:
+        {
+            float64 v;
+            bh_memcpy_s(&v, sizeof(float64), cells, sizeof(float64));
+            LANES(f64x2, 2, v);
+            break;
+        }
+
+        /* lane operation */
+        case SIMD_i8x16_extract_lane_s:
+            cells[0] = (uint32)(int32)A8(lane);
+            return;
+        case SIMD_i8x16_extract_lane_u:
+            cells[0] = (uint32)UA8(lane);
+            return;
+        case SIMD_i16x8_extract_lane_s:
+            cells[0] = (uint32)(int32)A16(lane);
+            return;
+        case SIMD_i16x8_extract_lane_u:
+            cells[0] = (uint32)UA16(lane);
+            return;
+        case SIMD_i32x4_extract_lane:
+        case SIMD_f32x4_extract_lane:
+            cells[0] = (uint32)A32(lane);
+            return;
+        case SIMD_i64x2_extract_lane:
+        case SIMD_f64x2_extract_lane:
+            bh_memcpy_s(cells, sizeof(int64), &A64(lane), sizeof(int64));
+            return;
+        case SIMD_i8x16_replace_lane:
+            r = a;
+            r.i8x16[lane] = (int8)cells[4];
+            break;
+        case SIMD_i16x8_replace_lane:
+            r = a;
+            r.i16x8[lane] = (int16)cells[4];
+            break;
+        case SIMD_i32x4_replace_lane:
+        case SIMD_f32x4_replace_lane:
+            r = a;
+            r.i32x8[lane] = (int32)cells[4];
+            break;
+        case SIMD_i64x2_replace_lane:
+        case SIMD_f64x2_replace_lane:
+            r = a;
+            bh_memcpy_s(&r.i64x2[lane], sizeof(int64), cells + 4,
+                        sizeof(int64));
+            break;
+
+        /* i8x16 compare operation */
+        case SIMD_i8x16_eq:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) == B8(i)));
+            break;
+        case SIMD_i8x16_ne:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) != B8(i)));
+            break;
+        case SIMD_i8x16_lt_s:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) < B8(i)));
+            break;
+        case SIMD_i8x16_lt_u:
+            BINARY_LANES(i8x16, 16, MASK(UA8(i) < UB8(i)));
+            break;
+        case SIMD_i8x16_gt_s:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) > B8(i)));
+            break;
+        case SIMD_i8x16_gt_u:
+            BINARY_LANES(i8x16, 16, MASK(UA8(i) > UB8(i)));
+            break;
+        case SIMD_i8x16_le_s:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) <= B8(i)));
+            break;
+        case SIMD_i8x16_le_u:
+            BINARY_LANES(i8x16, 16, MASK(UA8(i) <= UB8(i)));
+            break;
+        case SIMD_i8x16_ge_s:
+            BINARY_LANES(i8x16, 16, MASK(A8(i) >= B8(i)));
+            break;
+        case SIMD_i8x16_ge_u:
+            BINARY_LANES(i8x16, 16, MASK(UA8(i) >= UB8(i)));
+            break;
+
+        /* i16x8 compare operation */
+        case SIMD_i16x8_eq:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) == B16(i)));
+            break;
+        case SIMD_i16x8_ne:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) != B16(i)));
+            break;
+        case SIMD_i16x8_lt_s:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) < B16(i)));
+            break;
+        case SIMD_i16x8_lt_u:
+            BINARY_LANES(i16x8, 8, MASK(UA16(i) < UB16(i)));
+            break;
+        case SIMD_i16x8_gt_s:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) > B16(i)));
+            break;
+        case SIMD_i16x8_gt_u:
+            BINARY_LANES(i16x8, 8, MASK(UA16(i) > UB16(i)));
+            break;
+        case SIMD_i16x8_le_s:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) <= B16(i)));
+            break;
+        case SIMD_i16x8_le_u:
+            BINARY_LANES(i16x8, 8, MASK(UA16(i) <= UB16(i)));
+            break;
+        case SIMD_i16x8_ge_s:
+            BINARY_LANES(i16x8, 8, MASK(A16(i) >= B16(i)));
+            break;
+        case SIMD_i16x8_ge_u:
+            BINARY_LANES(i16x8, 8, MASK(UA16(i) >= UB16(i)));
+            break;
+
+        /* i32x4 compare operation */
+        case SIMD_i32x4_eq:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) == B32(i)));
+            break;
+        case SIMD_i32x4_ne:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) != B32(i)));
+            break;
+        case SIMD_i32x4_lt_s:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) < B32(i)));
+            break;
+        case SIMD_i32x4_lt_u:
+            BINARY_LANES(i32x8, 4, MASK(UA32(i) < UB32(i)));
+            break;
+        case SIMD_i32x4_gt_s:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) > B32(i)));
+            break;
+        case SIMD_i32x4_gt_u:
+            BINARY_LANES(i32x8, 4, MASK(UA32(i) > UB32(i)));
+            break;
+        case SIMD_i32x4_le_s:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) <= B32(i)));
+            break;
+        case SIMD_i32x4_le_u:
+            BINARY_LANES(i32x8, 4, MASK(UA32(i) <= UB32(i)));
+            break;
+        case SIMD_i32x4_ge_s:
+            BINARY_LANES(i32x8, 4, MASK(A32(i) >= B32(i)));
+            break;
+        case SIMD_i32x4_ge_u:
+            BINARY_LANES(i32x8, 4, MASK(UA32(i) >= UB32(i)));
+            break;
+
+        /* f32x4 compare operation */
+        case SIMD_f32x4_eq:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] == b.f32x4[i]));
+            break;
+        case SIMD_f32x4_ne:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] != b.f32x4[i]));
+            break;
+        case SIMD_f32x4_lt:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] < b.f32x4[i]));
+            break;
+        case SIMD_f32x4_gt:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] > b.f32x4[i]));
+            break;
+        case SIMD_f32x4_le:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] <= b.f32x4[i]));
+            break;
+        case SIMD_f32x4_ge:
+            BINARY_LANES(i32x8, 4, MASK(a.f32x4[i] >= b.f32x4[i]));
+            break;
+
+        /* f64x2 compare operation */
+        case SIMD_f64x2_eq:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] == b.f64x2[i]));
+            break;
+        case SIMD_f64x2_ne:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] != b.f64x2[i]));
+            break;
+        case SIMD_f64x2_lt:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] < b.f64x2[i]));
+            break;
+        case SIMD_f64x2_gt:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] > b.f64x2[i]));
+            break;
+        case SIMD_f64x2_le:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] <= b.f64x2[i]));
+            break;
+        case SIMD_f64x2_ge:
+            BINARY_LANES(i64x2, 2, MASK(a.f64x2[i] >= b.f64x2[i]));
+            break;
+
+        /* v128 operation */
+        case SIMD_v128_not:
+            LANES(i64x2, 2, ~A64(i));
+            break;
+        case SIMD_v128_and:
+            BINARY_LANES(i64x2, 2, A64(i) & B64(i));
+            break;
+        case SIMD_v128_andnot:
+            BINARY_LANES(i64x2, 2, A64(i) & ~B64(i));
+            break;
+        case SIMD_v128_or:
+            BINARY_LANES(i64x2, 2, A64(i) | B64(i));
+            break;
+        case SIMD_v128_xor:
+            BINARY_LANES(i64x2, 2, A64(i) ^ B64(i));
+            break;
+        case SIMD_v128_bitselect:
+            b = read_v128(cells + 4);
+            c = read_v128(cells + 8);
+            LANES(i64x2, 2, (A64(i) & c.i64x2[i]) | (B64(i) & ~c.i64x2[i]));
+            break;
+        case SIMD_v128_any_true:
+            cells[0] = (A64(0) | A64(1)) ? 1 : 0;
+            return;
+
+        /* float conversion */
+        case SIMD_f32x4_demote_f64x2_zero:
+            LANES(f32x4, 2, (float32)a.f64x2[i]);
+            break;
+        case SIMD_f64x2_promote_low_f32x4_zero:
+            LANES(f64x2, 2, (float64)a.f32x4[i]);
+            break;
+
+        /* i8x16 operation */
+        case SIMD_i8x16_abs:
+            LANES(i8x16, 16, (int8)(A8(i) < 0 ? 0 - UA8(i) : UA8(i)));
+            break;
+        case SIMD_i8x16_neg:
+            LANES(i8x16, 16, (int8)(0 - UA8(i)));
+            break;
+        case SIMD_i8x16_popcnt:
+        {
+            uint8 v;
+            for (i = 0; i < 16; i++) {
+                for (v = UA8(i), r.i8x16[i] = 0; v; v &= (uint8)(v - 1))
+                    r.i8x16[i]++;
+            }
+            break;
+        }
+        case SIMD_i8x16_all_true:
+            for (i = 0, result_i32 = 1; i < 16; i++)
+                result_i32 &= A8(i) != 0;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i8x16_bitmask:
+            for (i = 0, result_i32 = 0; i < 16; i++)
+                result_i32 |= (A8(i) < 0 ? 1 : 0) << i;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i8x16_narrow_i16x8_s:
+            BINARY_LANES(i8x16, 16, sat_i8(i < 8 ? A16(i) : B16(i - 8)));
+            break;
+        case SIMD_i8x16_narrow_i16x8_u:
+            BINARY_LANES(i8x16, 16, (int8)sat_u8(i < 8 ? A16(i) : B16(i - 8)));
+            break;
+        case SIMD_i8x16_shl:
+            shift = cells[4] & 7;
+            LANES(i8x16, 16, (int8)(UA8(i) << shift));
+            break;
+        case SIMD_i8x16_shr_s:
+            shift = cells[4] & 7;
+            LANES(i8x16, 16, (int8)(A8(i) >> shift));
+            break;
+        case SIMD_i8x16_shr_u:
+            shift = cells[4] & 7;
+            LANES(i8x16, 16, (int8)(UA8(i) >> shift));
+            break;
+        case SIMD_i8x16_add:
+            BINARY_LANES(i8x16, 16, (int8)(UA8(i) + UB8(i)));
+            break;
+        case SIMD_i8x16_add_sat_s:
+            BINARY_LANES(i8x16, 16, sat_i8(A8(i) + B8(i)));
+            break;
+        case SIMD_i8x16_add_sat_u:
+            BINARY_LANES(i8x16, 16, (int8)sat_u8(UA8(i) + UB8(i)));
+            break;
+        case SIMD_i8x16_sub:
+            BINARY_LANES(i8x16, 16, (int8)(UA8(i) - UB8(i)));
+            break;
+        case SIMD_i8x16_sub_sat_s:
+            BINARY_LANES(i8x16, 16, sat_i8(A8(i) - B8(i)));
+            break;
+        case SIMD_i8x16_sub_sat_u:
+            BINARY_LANES(i8x16, 16, (int8)sat_u8(UA8(i) - UB8(i)));
+            break;
+        case SIMD_i8x16_min_s:
+            BINARY_LANES(i8x16, 16, A8(i) < B8(i) ? A8(i) : B8(i));
+            break;
+        case SIMD_i8x16_min_u:
+            BINARY_LANES(i8x16, 16, UA8(i) < UB8(i) ? A8(i) : B8(i));
+            break;
+        case SIMD_i8x16_max_s:
+            BINARY_LANES(i8x16, 16, A8(i) > B8(i) ? A8(i) : B8(i));
+            break;
+        case SIMD_i8x16_max_u:
+            BINARY_LANES(i8x16, 16, UA8(i) > UB8(i) ? A8(i) : B8(i));
+            break;
+        case SIMD_i8x16_avgr_u:
+            BINARY_LANES(i8x16, 16, (int8)((UA8(i) + UB8(i) + 1) >> 1));
+            break;
+
+        case SIMD_i16x8_extadd_pairwise_i8x16_s:
+            LANES(i16x8, 8, (int16)(A8(2 * i) + A8(2 * i + 1)));
+            break;
+        case SIMD_i16x8_extadd_pairwise_i8x16_u:
+            LANES(i16x8, 8, (int16)(UA8(2 * i) + UA8(2 * i + 1)));
+            break;
+        case SIMD_i32x4_extadd_pairwise_i16x8_s:
+            LANES(i32x8, 4, A16(2 * i) + A16(2 * i + 1));
+            break;
+        case SIMD_i32x4_extadd_pairwise_i16x8_u:
+            LANES(i32x8, 4, UA16(2 * i) + UA16(2 * i + 1));
+            break;
+
+        /* i16x8 operation */
+        case SIMD_i16x8_abs:
+            LANES(i16x8, 8, (int16)(A16(i) < 0 ? 0 - UA16(i) : UA16(i)));
+            break;
+        case SIMD_i16x8_neg:
+            LANES(i16x8, 8, (int16)(0 - UA16(i)));
+            break;
+        case SIMD_i16x8_q15mulr_sat_s:
+            BINARY_LANES(i16x8, 8, sat_i16((A16(i) * B16(i) + 0x4000) >> 15));
+            break;
+        case SIMD_i16x8_all_true:
+            for (i = 0, result_i32 = 1; i < 8; i++)
+                result_i32 &= A16(i) != 0;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i16x8_bitmask:
+            for (i = 0, result_i32 = 0; i < 8; i++)
+                result_i32 |= (A16(i) < 0 ? 1 : 0) << i;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i16x8_narrow_i32x4_s:
+            BINARY_LANES(i16x8, 8, sat_i16(i < 4 ? A32(i) : B32(i - 4)));
+            break;
+        case SIMD_i16x8_narrow_i32x4_u:
+            BINARY_LANES(i16x8, 8, (int16)sat_u16(i < 4 ? A32(i) : B32(i - 4)));
+            break;
+        case SIMD_i16x8_extend_low_i8x16_s:
+            LANES(i16x8, 8, A8(i));
+            break;
+        case SIMD_i16x8_extend_high_i8x16_s:
+            LANES(i16x8, 8, A8(i + 8));
+            break;
+        case SIMD_i16x8_extend_low_i8x16_u:
+            LANES(i16x8, 8, UA8(i));
+            break;
+        case SIMD_i16x8_extend_high_i8x16_u:
+            LANES(i16x8, 8, UA8(i + 8));
+            break;
+        case SIMD_i16x8_shl:
+            shift = cells[4] & 15;
+            LANES(i16x8, 8, (int16)(UA16(i) << shift));
+            break;
+        case SIMD_i16x8_shr_s:
+            shift = cells[4] & 15;
+            LANES(i16x8, 8, (int16)(A16(i) >> shift));
+            break;
+        case SIMD_i16x8_shr_u:
+            shift = cells[4] & 15;
+            LANES(i16x8, 8, (int16)(UA16(i) >> shift));
+            break;
+        case SIMD_i16x8_add:
+            BINARY_LANES(i16x8, 8, (int16)(UA16(i) + UB16(i)));
+            break;
+        case SIMD_i16x8_add_sat_s:
+            BINARY_LANES(i16x8, 8, sat_i16(A16(i) + B16(i)));
+            break;
+        case SIMD_i16x8_add_sat_u:
+            BINARY_LANES(i16x8, 8, (int16)sat_u16(UA16(i) + UB16(i)));
+            break;
+        case SIMD_i16x8_sub:
+            BINARY_LANES(i16x8, 8, (int16)(UA16(i) - UB16(i)));
+            break;
+        case SIMD_i16x8_sub_sat_s:
+            BINARY_LANES(i16x8, 8, sat_i16(A16(i) - B16(i)));
+            break;
+        case SIMD_i16x8_sub_sat_u:
+            BINARY_LANES(i16x8, 8, (int16)sat_u16(UA16(i) - UB16(i)));
+            break;
+        case SIMD_i16x8_mul:
+            BINARY_LANES(i16x8, 8, (int16)(UA16(i) * UB16(i)));
+            break;
+        case SIMD_i16x8_min_s:
+            BINARY_LANES(i16x8, 8, A16(i) < B16(i) ? A16(i) : B16(i));
+            break;
+        case SIMD_i16x8_min_u:
+            BINARY_LANES(i16x8, 8, UA16(i) < UB16(i) ? A16(i) : B16(i));
+            break;
+        case SIMD_i16x8_max_s:
+            BINARY_LANES(i16x8, 8, A16(i) > B16(i) ? A16(i) : B16(i));
+            break;
+        case SIMD_i16x8_max_u:
+            BINARY_LANES(i16x8, 8, UA16(i) > UB16(i) ? A16(i) : B16(i));
+            break;
+        case SIMD_i16x8_avgr_u:
+            BINARY_LANES(i16x8, 8, (int16)((UA16(i) + UB16(i) + 1) >> 1));
+            break;
+        case SIMD_i16x8_extmul_low_i8x16_s:
+            BINARY_LANES(i16x8, 8, (int16)(A8(i) * B8(i)));
+            break;
+        case SIMD_i16x8_extmul_high_i8x16_s:
+            BINARY_LANES(i16x8, 8, (int16)(A8(i + 8) * B8(i + 8)));
+            break;
+        case SIMD_i16x8_extmul_low_i8x16_u:
+            BINARY_LANES(i16x8, 8, (int16)(UA8(i) * UB8(i)));
+            break;
+        case SIMD_i16x8_extmul_high_i8x16_u:
+            BINARY_LANES(i16x8, 8, (int16)(UA8(i + 8) * UB8(i + 8)));
+            break;
+
+        /* i32x4 operation */
+        case SIMD_i32x4_abs:
+            LANES(i32x8, 4, (int32)(A32(i) < 0 ? 0 - UA32(i) : UA32(i)));
+            break;
+        case SIMD_i32x4_neg:
+            LANES(i32x8, 4, (int32)(0 - UA32(i)));
+            break;
+        case SIMD_i32x4_all_true:
+            for (i = 0, result_i32 = 1; i < 4; i++)
+                result_i32 &= A32(i) != 0;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i32x4_bitmask:
+            for (i = 0, result_i32 = 0; i < 4; i++)
+                result_i32 |= (A32(i) < 0 ? 1 : 0) << i;
+            cells[0] = (uint32)result_i32;
+            return;
+        case SIMD_i32x4_narrow_i64x2_s:
+            BINARY_LANES(i32x8, 4, sat_i32(i < 2 ? A64(i) : B64(i - 2)));
+            break;
+        case SIMD_i32x4_narrow_i64x2_u:
+            BINARY_LANES(i32x8, 4, (int32)sat_u32(i < 2 ? A64(i) : B64(i - 2)));
+            break;
+        case SIMD_i32x4_extend_low_i16x8_s:
+            LANES(i32x8, 4, A16(i));
+            break;
+        case SIMD_i32x4_extend_high_i16x8_s:
+            LANES(i32x8, 4, A16(i + 4));
+            break;
+        case SIMD_i32x4_extend_low_i16x8_u:
+            LANES(i32x8, 4, UA16(i));
+            break;
+        case SIMD_i32x4_extend_high_i16x8_u:
+            LANES(i32x8, 4, UA16(i + 4));
+            break;
+        case SIMD_i32x4_shl:
+            shift = cells[4] & 31;
+            LANES(i32x8, 4, (int32)(UA32(i) << shift));
+            break;
+        case SIMD_i32x4_shr_s:
+            shift = cells[4] & 31;
+            LANES(i32x8, 4, A32(i) >> shift);
+            break;
+        case SIMD_i32x4_shr_u:
+            shift = cells[4] & 31;
+            LANES(i32x8, 4, (int32)(UA32(i) >> shift));
+            break;
+        case SIMD_i32x4_add:
+            BINARY_LANES(i32x8, 4, (int32)(UA32(i) + UB32(i)));
+            break;
+        case SIMD_i32x4_add_sat_s:
+            BINARY_LANES(i32x8, 4, sat_i32((int64)A32(i) + B32(i)));
+            break;
+        case SIMD_i32x4_add_sat_u:
+            BINARY_LANES(i32x8, 4, (int32)sat_u32((int64)UA32(i) + UB32(i)));
+            break;
+        case SIMD_i32x4_sub:
+            BINARY_LANES(i32x8, 4, (int32)(UA32(i) - UB32(i)));
+            break;
+        case SIMD_i32x4_sub_sat_s:
+            BINARY_LANES(i32x8, 4, sat_i32((int64)A32(i) - B32(i)));
+            break;
+        case SIMD_i32x4_sub_sat_u:
+            BINARY_LANES(i32x8, 4, (int32)sat_u32((int64)UA32(i) - UB32(i)));
+            break;
+        case SIMD_i32x4_mul:
+            BINARY_LANES(i32x8, 4, (int32)(UA32(i) * UB32(i)));
+            break;
+        case SIMD_i32x4_min_s:
+            BINARY_LANES(i32x8, 4, A32(i) < B32(i) ? A32(i) : B32(i));
+            break;
+        case SIMD_i32x4_min_u:
+            BINARY_LANES(i32x8, 4, UA32(i) < UB32(i) ? A32(i) : B32(i));
+            break;
+        case SIMD_i32x4_max_s:
+            BINARY_LANES(i32x8, 4, A32(i) > B32(i) ? A32(i) : B32(i));
+            break;
+        case SIMD_i32x4_max_u:
+            BINARY_LANES(i32x8, 4, UA32(i) > UB32(i) ? A32(i) : B32(i));
+            break;
+        case SIMD_i32x4_dot_i16x8_s:
+            BINARY_LANES(i32x8, 4,
+                         (int32)((uint32)(A16(2 * i) * B16(2 * i))
+                                 + (uint32)(A16(2 * i + 1) * B16(2 * i + 1))));
+            break;
+        case SIMD_i32x4_avgr_u:
+            BINARY_LANES(i32x8, 4,
+                         (int32)(((uint64)UA32(i) + UB32(i) + 1) >> 1));
+            break;
+        case SIMD_i32x4_extmul_low_i16x8_s:
+            BINARY_LANES(i32x8, 4, A16(i) * B16(i));
+            break;
+        case SIMD_i32x4_extmul_high_i16x8_s:
+            BINARY_LANES(i32x8, 4, A16(i + 4) * B16(i + 4));
+            break;
+        case SIMD_i32x4_extmul_low_i16x8_u:
+            BINARY_LANES(i32x8, 4, (int32)((uint32)UA16(i) * UB16(i)));
+            break;
+        case SIMD_i32x4_extmul_high_i16x8_u:
+            BINARY_LANES(i32x8, 4, (int32)((uint32)UA16(i + 4) * UB16(i + 4)));
+            break;
+
+        /* i64x2 operation */
+        case SIMD_i64x2_abs:
+            LANES(i64x2, 2, (int64)(A64(i) < 0 ? 0 - UA64(i) : UA64(i)));
+            break;
+        case SIMD_i64x2_neg:
+            LANES(i64x2, 2, (int64)(0 - UA64(i)));
+            break;
+        case SIMD_i64x2_all_true:
+            cells[0] = (A64(0) != 0 && A64(1) != 0) ? 1 : 0;
+            return;
+        case SIMD_i64x2_bitmask:
+            cells[0] = (A64(0) < 0 ? 1 : 0) | (A64(1) < 0 ? 2 : 0);
+            return;
+        case SIMD_i64x2_extend_low_i32x4_s:
+            LANES(i64x2, 2, A32(i));
+            break;
+        case SIMD_i64x2_extend_high_i32x4_s:
+            LANES(i64x2, 2, A32(i + 2));
+            break;
+        case SIMD_i64x2_extend_low_i32x4_u:
+            LANES(i64x2, 2, UA32(i));
+            break;
+        case SIMD_i64x2_extend_high_i32x4_u:
+            LANES(i64x2, 2, UA32(i + 2));
+            break;
+        case SIMD_i64x2_shl:
+            shift = cells[4] & 63;
+            LANES(i64x2, 2, (int64)(UA64(i) << shift));
+            break;
+        case SIMD_i64x2_shr_s:
+            shift = cells[4] & 63;
+            LANES(i64x2, 2, A64(i) >> shift);
+            break;
+        case SIMD_i64x2_shr_u:
+            shift = cells[4] & 63;
+            LANES(i64x2, 2, (int64)(UA64(i) >> shift));
+            break;
+        case SIMD_i64x2_add:
+            BINARY_LANES(i64x2, 2, (int64)(UA64(i) + UB64(i)));
+            break;
+        case SIMD_i64x2_sub:
+            BINARY_LANES(i64x2, 2, (int64)(UA64(i) - UB64(i)));
+            break;
+        case SIMD_i64x2_mul:
+            BINARY_LANES(i64x2, 2, (int64)(UA64(i) * UB64(i)));
+            break;
+        case SIMD_i64x2_eq:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) == B64(i)));
+            break;
+        case SIMD_i64x2_ne:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) != B64(i)));
+            break;
+        case SIMD_i64x2_lt_s:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) < B64(i)));
+            break;
+        case SIMD_i64x2_gt_s:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) > B64(i)));
+            break;
+        case SIMD_i64x2_le_s:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) <= B64(i)));
+            break;
+        case SIMD_i64x2_ge_s:
+            BINARY_LANES(i64x2, 2, MASK(A64(i) >= B64(i)));
+            break;
+        case SIMD_i64x2_extmul_low_i32x4_s:
+            BINARY_LANES(i64x2, 2, (int64)A32(i) * B32(i));
+            break;
+        case SIMD_i64x2_extmul_high_i32x4_s:
+            BINARY_LANES(i64x2, 2, (int64)A32(i + 2) * B32(i + 2));
+            break;
+        case SIMD_i64x2_extmul_low_i32x4_u:
+            BINARY_LANES(i64x2, 2, (int64)((uint64)UA32(i) * UB32(i)));
+            break;
+        case SIMD_i64x2_extmul_high_i32x4_u:
+            BINARY_LANES(i64x2, 2, (int64)((uint64)UA32(i + 2) * UB32(i + 2)));
+            break;
+
+        /* f32x4 operation */
+        case SIMD_f32x4_ceil:
+            LANES(f32x4, 4, ceilf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_floor:
+            LANES(f32x4, 4, floorf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_trunc:
+            LANES(f32x4, 4, truncf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_nearest:
+            LANES(f32x4, 4, rintf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_round:
+            LANES(f32x4, 4, roundf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_abs:
+            LANES(i32x8, 4, (int32)(UA32(i) & 0x7FFFFFFF));
+            break;
+        case SIMD_f32x4_neg:
+            LANES(i32x8, 4, (int32)(UA32(i) ^ 0x80000000));
+            break;
+        case SIMD_f32x4_sqrt:
+            LANES(f32x4, 4, sqrtf(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_add:
+            BINARY_LANES(f32x4, 4, a.f32x4[i] + b.f32x4[i]);
+            break;
+        case SIMD_f32x4_sub:
+            BINARY_LANES(f32x4, 4, a.f32x4[i] - b.f32x4[i]);
+            break;
+        case SIMD_f32x4_mul:
+            BINARY_LANES(f32x4, 4, a.f32x4[i] * b.f32x4[i]);
+            break;
+        case SIMD_f32x4_div:
+            BINARY_LANES(f32x4, 4, a.f32x4[i] / b.f32x4[i]);
+            break;
+        case SIMD_f32x4_min:
+            BINARY_LANES(f32x4, 4, f32_min(a.f32x4[i], b.f32x4[i]));
+            break;
+        case SIMD_f32x4_max:
+            BINARY_LANES(f32x4, 4, f32_max(a.f32x4[i], b.f32x4[i]));
+            break;
+        case SIMD_f32x4_pmin:
+            BINARY_LANES(f32x4, 4,
+                         b.f32x4[i] < a.f32x4[i] ? b.f32x4[i] : a.f32x4[i]);
+            break;
+        case SIMD_f32x4_pmax:
+            BINARY_LANES(f32x4, 4,
+                         a.f32x4[i] < b.f32x4[i] ? b.f32x4[i] : a.f32x4[i]);
+            break;
+
+        /* f64x2 operation */
+        case SIMD_f64x2_ceil:
+            LANES(f64x2, 2, ceil(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_floor:
+            LANES(f64x2, 2, floor(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_trunc:
+            LANES(f64x2, 2, trunc(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_nearest:
+            LANES(f64x2, 2, rint(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_round:
+            LANES(f64x2, 2, round(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_abs:
+            LANES(i64x2, 2, (int64)(UA64(i) & 0x7FFFFFFFFFFFFFFFLL));
+            break;
+        case SIMD_f64x2_neg:
+            LANES(i64x2, 2, (int64)(UA64(i) ^ 0x8000000000000000ULL));
+            break;
+        case SIMD_f64x2_sqrt:
+            LANES(f64x2, 2, sqrt(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_add:
+            BINARY_LANES(f64x2, 2, a.f64x2[i] + b.f64x2[i]);
+            break;
+        case SIMD_f64x2_sub:
+            BINARY_LANES(f64x2, 2, a.f64x2[i] - b.f64x2[i]);
+            break;
+        case SIMD_f64x2_mul:
+            BINARY_LANES(f64x2, 2, a.f64x2[i] * b.f64x2[i]);
+            break;
+        case SIMD_f64x2_div:
+            BINARY_LANES(f64x2, 2, a.f64x2[i] / b.f64x2[i]);
+            break;
+        case SIMD_f64x2_min:
+            BINARY_LANES(f64x2, 2, f64_min(a.f64x2[i], b.f64x2[i]));
+            break;
+        case SIMD_f64x2_max:
+            BINARY_LANES(f64x2, 2, f64_max(a.f64x2[i], b.f64x2[i]));
+            break;
+        case SIMD_f64x2_pmin:
+            BINARY_LANES(f64x2, 2,
+                         b.f64x2[i] < a.f64x2[i] ? b.f64x2[i] : a.f64x2[i]);
+            break;
+        case SIMD_f64x2_pmax:
+            BINARY_LANES(f64x2, 2,
+                         a.f64x2[i] < b.f64x2[i] ? b.f64x2[i] : a.f64x2[i]);
+            break;
+
+        /* conversion operation */
+        case SIMD_i32x4_trunc_sat_f32x4_s:
+            LANES(i32x8, 4, trunc_sat_i32(a.f32x4[i]));
+            break;
+        case SIMD_i32x4_trunc_sat_f32x4_u:
+            LANES(i32x8, 4, (int32)trunc_sat_u32(a.f32x4[i]));
+            break;
+        case SIMD_f32x4_convert_i32x4_s:
+            LANES(f32x4, 4, (float32)A32(i));
+            break;
+        case SIMD_f32x4_convert_i32x4_u:
+            LANES(f32x4, 4, (float32)UA32(i));
+            break;
+        case SIMD_i32x4_trunc_sat_f64x2_s_zero:
+            LANES(i32x8, 2, trunc_sat_i32(a.f64x2[i]));
+            break;
+        case SIMD_i32x4_trunc_sat_f64x2_u_zero:
+            LANES(i32x8, 2, (int32)trunc_sat_u32(a.f64x2[i]));
+            break;
+        case SIMD_f64x2_convert_low_i32x4_s:
+            LANES(f64x2, 2, (float64)A32(i));
+            break;
+        case SIMD_f64x2_convert_low_i32x4_u:
+            LANES(f64x2, 2, (float64)UA32(i));
+            break;
+
+        default:
+            bh_assert(0);
+            break;
+    }
+
+    write_v128(cells, &r);
+}
+
+void
+wasm_simd_shuffle(uint32 *cells, uint64 mask_low, uint64 mask_high)
+{
+    uint8 src[32], dst[16], idx;
+    uint32 i;
+
+    bh_memcpy_s(src, sizeof(src), cells, sizeof(src));
+    for (i = 0; i < 16; i++) {
+        idx = (uint8)((i < 8 ? mask_low >> (i * 8) : mask_high >> (i * 8 - 64))
+                      & 0xFF);
+        /* The lane indices were validated by the loader */
+        dst[i] = src[idx & 31];
+    }
+    bh_memcpy_s(cells, sizeof(dst), dst, sizeof(dst));
+}
+
+void
+wasm_simd_get_op_cell_num(uint8 opcode, uint8 *p_param_cell_num,
+                          uint8 *p_result_cell_num)
+{
+    uint8 param_cell_num = 4, result_cell_num = 4;
+
+    switch (opcode) {
+        case SIMD_i8x16_splat:
+        case SIMD_i16x8_splat:
+        case SIMD_i32x4_splat:
+        case SIMD_f32x4_splat:
+            param_cell_num = 1;
+            break;
+        case SIMD_i64x2_splat:
+        case SIMD_f64x2_splat:
+            param_cell_num = 2;
+            break;
+
+        case SIMD_i8x16_extract_lane_s:
+        case SIMD_i8x16_extract_lane_u:
+        case SIMD_i16x8_extract_lane_s:
+        case SIMD_i16x8_extract_lane_u:
+        case SIMD_i32x4_extract_lane:
+        case SIMD_f32x4_extract_lane:
+        case SIMD_v128_any_true:
+        case SIMD_i8x16_all_true:
+        case SIMD_i8x16_bitmask:
+        case SIMD_i16x8_all_true:
+        case SIMD_i16x8_bitmask:
+        case SIMD_i32x4_all_true:
+        case SIMD_i32x4_bitmask:
+        case SIMD_i64x2_all_true:
+        case SIMD_i64x2_bitmask:
+            result_cell_num = 1;
+            break;
+        case SIMD_i64x2_extract_lane:
+        case SIMD_f64x2_extract_lane:
+            result_cell_num = 2;
+            break;
+
+        case SIMD_i8x16_replace_lane:
+        case SIMD_i16x8_replace_lane:
+        case SIMD_i32x4_replace_lane:
+        case SIMD_f32x4_replace_lane:
+        case SIMD_i8x16_shl:
+        case SIMD_i8x16_shr_s:
+        case SIMD_i8x16_shr_u:
+        case SIMD_i16x8_shl:
+        case SIMD_i16x8_shr_s:
+        case SIMD_i16x8_shr_u:
+        case SIMD_i32x4_shl:
+        case SIMD_i32x4_shr_s:
+        case SIMD_i32x4_shr_u:
+        case SIMD_i64x2_shl:
+        case SIMD_i64x2_shr_s:
+        case SIMD_i64x2_shr_u:
+            param_cell_num = 5;
+            break;
+        case SIMD_i64x2_replace_lane:
+        case SIMD_f64x2_replace_lane:
+            param_cell_num = 6;
+            break;
+
+        case SIMD_v128_bitselect:
+            param_cell_num = 12;
+            break;
+
+        /* unary v128 operation */
+        case SIMD_v128_not:
+        case SIMD_f32x4_demote_f64x2_zero:
+        case SIMD_f64x2_promote_low_f32x4_zero:
+        case SIMD_i8x16_abs:
+        case SIMD_i8x16_neg:
+        case SIMD_i8x16_popcnt:
+        case SIMD_f32x4_ceil:
+        case SIMD_f32x4_floor:
+        case SIMD_f32x4_trunc:
+        case SIMD_f32x4_nearest:
+        case SIMD_f64x2_ceil:
+        case SIMD_f64x2_floor:
+        case SIMD_f64x2_trunc:
+        case SIMD_f64x2_nearest:
+        case SIMD_i16x8_extadd_pairwise_i8x16_s:
+        case SIMD_i16x8_extadd_pairwise_i8x16_u:
+        case SIMD_i32x4_extadd_pairwise_i16x8_s:
+        case SIMD_i32x4_extadd_pairwise_i16x8_u:
+        case SIMD_i16x8_abs:
+        case SIMD_i16x8_neg:
+        case SIMD_i16x8_extend_low_i8x16_s:
+        case SIMD_i16x8_extend_high_i8x16_s:
+        case SIMD_i16x8_extend_low_i8x16_u:
+        case SIMD_i16x8_extend_high_i8x16_u:
+        case SIMD_i32x4_abs:
+        case SIMD_i32x4_neg:
+        case SIMD_i32x4_extend_low_i16x8_s:
+        case SIMD_i32x4_extend_high_i16x8_s:
+        case SIMD_i32x4_extend_low_i16x8_u:
+        case SIMD_i32x4_extend_high_i16x8_u:
+        case SIMD_i64x2_abs:
+        case SIMD_i64x2_neg:
+        case SIMD_i64x2_extend_low_i32x4_s:
+        case SIMD_i64x2_extend_high_i32x4_s:
+        case SIMD_i64x2_extend_low_i32x4_u:
+        case SIMD_i64x2_extend_high_i32x4_u:
+        case SIMD_f32x4_abs:
+        case SIMD_f32x4_neg:
+        case SIMD_f32x4_round:
+        case SIMD_f32x4_sqrt:
+        case SIMD_f64x2_abs:
+        case SIMD_f64x2_neg:
+        case SIMD_f64x2_round:
+        case SIMD_f64x2_sqrt:
+        case SIMD_i32x4_trunc_sat_f32x4_s:
+        case SIMD_i32x4_trunc_sat_f32x4_u:
+        case SIMD_f32x4_convert_i32x4_s:
+        case SIMD_f32x4_convert_i32x4_u:
+        case SIMD_i32x4_trunc_sat_f64x2_s_zero:
+        case SIMD_i32x4_trunc_sat_f64x2_u_zero:
+        case SIMD_f64x2_convert_low_i32x4_s:
+        case SIMD_f64x2_convert_low_i32x4_u:
+            break;
+
+        /* the others are binary v128 operations */
+        default:
+            param_cell_num = 8;
+            break;
+    }
+
+    *p_param_cell_num = param_cell_num;
+    *p_result_cell_num = result_cell_num;
+}
+
+uint32
+wasm_simd_get_mem_access_size(uint8 opcode)
+{
+    switch (opcode) {
+        case SIMD_v128_load8_splat:
+        case SIMD_v128_load8_lane:
+        case SIMD_v128_store8_lane:
+            return 1;
+        case SIMD_v128_load16_splat:
+        case SIMD_v128_load16_lane:
+        case SIMD_v128_store16_lane:
+            return 2;
+        case SIMD_v128_load32_splat:
+        case SIMD_v128_load32_lane:
+        case SIMD_v128_store32_lane:
+        case SIMD_v128_load32_zero:
+            return 4;
+        case SIMD_v128_load8x8_s:
+        case SIMD_v128_load8x8_u:
+        case SIMD_v128_load16x4_s:
+        case SIMD_v128_load16x4_u:
+        case SIMD_v128_load32x2_s:
+        case SIMD_v128_load32x2_u:
+        case SIMD_v128_load64_splat:
+        case SIMD_v128_load64_lane:
+        case SIMD_v128_store64_lane:
+        case SIMD_v128_load64_zero:
+            return 8;
+        default:
+            bh_assert(opcode == SIMD_v128_load || opcode == SIMD_v128_store);
+            return 16;
+    }
+}
+
+void
+wasm_simd_load(uint8 opcode, uint8 lane, const uint8 *maddr, uint32 *cells)
+{
+    V128 a = { 0 }, r = { 0 };
+    uint32 i;
+
+    /* Read the accessed memory to the low bytes of a, and keep the
+       other bytes zero for v128.load32_zero and v128.load64_zero */
+    bh_memcpy_s(&a, sizeof(V128), maddr,
+                wasm_simd_get_mem_access_size(opcode));
+
+    switch (opcode) {
+        case SIMD_v128_load:
+            r = a;
+            break;
+        case SIMD_v128_load8x8_s:
+            LANES(i16x8, 8, A8(i));
+            break;
+        case SIMD_v128_load8x8_u:
+            LANES(i16x8, 8, UA8(i));
+            break;
+        case SIMD_v128_load16x4_s:
+            LANES(i32x8, 4, A16(i));
+            break;
+        case SIMD_v128_load16x4_u:
+            LANES(i32x8, 4, UA16(i));
+            break;
+        case SIMD_v128_load32x2_s:
+            LANES(i64x2, 2, A32(i));
+            break;
+        case SIMD_v128_load32x2_u:
+            LANES(i64x2, 2, UA32(i));
+            break;
+        case SIMD_v128_load8_splat:
+            LANES(i8x16, 16, A8(0));
+            break;
+        case SIMD_v128_load16_splat:
+            LANES(i16x8, 8, A16(0));
+            break;
+        case SIMD_v128_load32_splat:
+            LANES(i32x8, 4, A32(0));
+            break;
+        case SIMD_v128_load64_splat:
+            LANES(i64x2, 2, A64(0));
+            break;
+        case SIMD_v128_load32_zero:
+        case SIMD_v128_load64_zero:
+            r = a;
+            break;
+        case SIMD_v128_load8_lane:
+            r = read_v128(cells);
+            r.i8x16[lane] = A8(0);
+            break;
+        case SIMD_v128_load16_lane:
+            r = read_v128(cells);
+            r.i16x8[lane] = A16(0);
+            break;
+        case SIMD_v128_load32_lane:
+            r = read_v128(cells);
+            r.i32x8[lane] = A32(0);
+            break;
+        case SIMD_v128_load64_lane:
+            r = read_v128(cells);
+            r.i64x2[lane] = A64(0);
+            break;
+        default:
+            bh_assert(0);
+            break;
+    }
+
+    write_v128(cells, &r);
+}
+
+void
+wasm_simd_store(uint8 opcode, uint8 lane, uint8 *maddr, const uint32 *cells)
+{
+    V128 a = read_v128(cells);
+    uint32 size = wasm_simd_get_mem_access_size(opcode);
+
+    switch (opcode) {
+        case SIMD_v128_store:
+            bh_memcpy_s(maddr, size, &a, size);
+            break;
+        case SIMD_v128_store8_lane:
+            bh_memcpy_s(maddr, size, &a.i8x16[lane], size);
+            break;
+        case SIMD_v128_store16_lane:
+            bh_memcpy_s(maddr, size, &a.i16x8[lane], size);
+            break;
+        case SIMD_v128_store32_lane:
+            bh_memcpy_s(maddr, size, &a.i32x8[lane], size);
+            break;
+        case SIMD_v128_store64_lane:
+            bh_memcpy_s(maddr, size, &a.i64x2[lane], size);
+            break;
+        default:
+            bh_assert(0);
+            break;
+    }
+}
+
+#endif /* end of WASM_ENABLE_SIMD != 0 */
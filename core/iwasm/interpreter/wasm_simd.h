@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _WASM_SIMD_H
+#define _WASM_SIMD_H
+
+#include "wasm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if WASM_ENABLE_SIMD != 0
+
+/**
+ * Execute a SIMD opcode which doesn't access the linear memory.
+ *
+ * The operands are stored in consecutive stack cells starting from
+ * cells[0] in the order they were pushed, e.g. the v128 operand of
+ * i32x4.replace_lane is stored in cells[0..3] and the i32 operand in
+ * cells[4]. The result, a v128 or a scalar value, is stored to the
+ * cells starting from cells[0].
+ *
+ * @param opcode the SIMD opcode after the 0xfd prefix
+ * @param lane the lane index immediate, ignored if the opcode has no lane
+ * @param cells the stack cells of the operands and the result
+ */
+void
+wasm_simd_exec_op(uint8 opcode, uint8 lane, uint32 *cells);
+
+/**
+ * Execute i8x16.shuffle, the two v128 operands are stored in
+ * cells[0..7] and the result is stored to cells[0..3].
+ *
+ * @param cells the stack cells of the operands and the result
+ * @param mask_low the lane indices 0 ~ 7 of the shuffle mask
+ * @param mask_high the lane indices 8 ~ 15 of the shuffle mask
+ */
+void
+wasm_simd_shuffle(uint32 *cells, uint64 mask_low, uint64 mask_high);
+
+/**
+ * Get the cell numbers of the operands and the result of a SIMD opcode
+ * executed by wasm_simd_exec_op. The v128 operands are always pushed
+ * before the scalar operand, so (param_cell_num / 4) is the count of the
+ * v128 operands and (param_cell_num % 4) is the cell num of the scalar
+ * operand, e.g. it is 5 for i32x4.replace_lane and 2 for i64x2.splat.
+ *
+ * @param opcode the SIMD opcode after the 0xfd prefix
+ * @param p_param_cell_num return the total cell num of the operands
+ * @param p_result_cell_num return the cell num of the result
+ */
+void
+wasm_simd_get_op_cell_num(uint8 opcode, uint8 *p_param_cell_num,
+                          uint8 *p_result_cell_num);
+
+/**
+ * Get the bytes of the linear memory accessed by a SIMD load/store opcode
+ */
+uint32
+wasm_simd_get_mem_access_size(uint8 opcode);
+
+/**
+ * Execute a SIMD load opcode, the memory has been bound-checked. For the
+ * load lane opcodes the v128 operand is stored in cells[0..3], and the
+ * loaded v128 result is stored to cells[0..3].
+ *
+ * @param opcode the SIMD opcode after the 0xfd prefix
+ * @param lane the lane index immediate of the load lane opcodes
+ * @param maddr the native address of the memory to load
+ * @param cells the stack cells of the v128 operand and the result
+ */
+void
+wasm_simd_load(uint8 opcode, uint8 lane, const uint8 *maddr, uint32 *cells);
+
+/**
+ * Execute a SIMD store opcode, the memory has been bound-checked, and the
+ * v128 operand is stored in cells[0..3].
+ */
+void
+wasm_simd_store(uint8 opcode, uint8 lane, uint8 *maddr, const uint32 *cells);
+
+/**
+ * Copy the four cells of a v128 value, the cells of dst and src may overlap
+ */
+static inline void
+wasm_simd_copy_v128(uint32 *dst, const uint32 *src)
+{
+    uint32 c0 = src[0], c1 = src[1], c2 = src[2], c3 = src[3];
+
+    dst[0] = c0;
+    dst[1] = c1;
+    dst[2] = c2;
+    dst[3] = c3;
+}
+
+#endif /* end of WASM_ENABLE_SIMD != 0 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of _WASM_SIMD_H */
@@ -250,6 +250,28 @@ gci_verify_heap(gc_heap_t *heap)
 }
 #endif
 
+/* Get the size of the largest free chunk by walking the heap */
+static uint32
+gc_get_max_free_size(gc_heap_t *heap)
+{
+    hmu_t *cur = (hmu_t *)heap->base_addr;
+    hmu_t *end = (hmu_t *)((char *)heap->base_addr + heap->current_size);
+    gc_size_t size, max_free_size = 0;
+
+    os_mutex_lock(&heap->lock);
+    while (cur < end) {
+        size = hmu_get_size(cur);
+        if (size == 0 || size > (uint32)((uint8 *)end - (uint8 *)cur))
+            break;
+        if (hmu_get_ut(cur) == HMU_FC && size > max_free_size)
+            max_free_size = size;
+        cur = (hmu_t *)((char *)cur + size);
+    }
+    os_mutex_unlock(&heap->lock);
+
+    return max_free_size;
+}
+
 void *
 gc_heap_stats(void *heap_arg, uint32 *stats, int size)
 {
@@ -267,6 +289,9 @@ gc_heap_stats(void *heap_arg, uint32 *stats, int size)
             case GC_STAT_HIGHMARK:
                 stats[i] = heap->highmark_size;
                 break;
+            case GC_STAT_MAX_FREE:
+                stats[i] = gc_get_max_free_size(heap);
+                break;
             default:
                 break;
         }
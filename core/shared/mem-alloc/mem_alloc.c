@@ -76,6 +76,15 @@ mem_allocator_get_alloc_info(mem_allocator_t allocator, void *mem_alloc_info)
     return true;
 }
 
+uint32
+mem_allocator_get_max_free_size(mem_allocator_t allocator)
+{
+    uint32 stats[GC_STAT_MAX_FREE + 1];
+
+    gc_heap_stats((gc_handle_t)allocator, stats, GC_STAT_MAX_FREE + 1);
+    return stats[GC_STAT_MAX_FREE];
+}
+
 #else /* else of DEFAULT_MEM_ALLOCATOR */
 
 #include "tlsf/tlsf.h"
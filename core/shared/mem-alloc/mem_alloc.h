@@ -48,6 +48,9 @@ mem_allocator_is_heap_corrupted(mem_allocator_t allocator);
 bool
 mem_allocator_get_alloc_info(mem_allocator_t allocator, void *mem_alloc_info);
 
+uint32
+mem_allocator_get_max_free_size(mem_allocator_t allocator);
+
 #ifdef __cplusplus
 }
 #endif
@@ -248,6 +248,53 @@ os_mprotect(void *addr, size_t size, int prot)
     return mprotect(addr, request_size, map_prot);
 }
 
+#ifdef OS_ENABLE_MMAP_FILE
+void *
+os_mmap_file(const char *file_path, int prot, int flags, uint32 *p_size)
+{
+    int map_prot = PROT_NONE;
+    int map_flags = MAP_PRIVATE;
+    struct stat stat_buf;
+    void *addr;
+    int fd;
+
+    if ((fd = open(file_path, O_RDONLY, 0)) < 0)
+        return NULL;
+
+    if (fstat(fd, &stat_buf) != 0 || stat_buf.st_size <= 0
+        || (uint64)stat_buf.st_size >= UINT32_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    if (prot & MMAP_PROT_READ)
+        map_prot |= PROT_READ;
+
+    if (prot & MMAP_PROT_WRITE)
+        map_prot |= PROT_WRITE;
+
+    if (prot & MMAP_PROT_EXEC)
+        map_prot |= PROT_EXEC;
+
+#if defined(BUILD_TARGET_X86_64) || defined(BUILD_TARGET_AMD_64)
+#ifndef __APPLE__
+    if (flags & MMAP_MAP_32BIT)
+        map_flags |= MAP_32BIT;
+#endif
+#endif
+
+    addr = mmap(NULL, (size_t)stat_buf.st_size, map_prot, map_flags, fd, 0);
+    /* The mapping is kept after the file is closed */
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    *p_size = (uint32)stat_buf.st_size;
+    return addr;
+}
+#endif
+
 void
 os_dcache_flush(void)
 {}
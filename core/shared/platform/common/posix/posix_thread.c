@@ -658,3 +658,87 @@ os_sigreturn()
 #endif
 }
 #endif /* end of OS_ENABLE_HW_BOUND_CHECK */
+
+#ifdef OS_ENABLE_PROF_TIMER
+#include <ucontext.h>
+
+static os_prof_timer_handler prof_timer_handler;
+static struct sigaction prev_sig_act_SIGPROF;
+
+static void
+prof_timer_callback(int sig_num, siginfo_t *sig_info, void *sig_ucontext)
+{
+    ucontext_t *ucontext = (ucontext_t *)sig_ucontext;
+    os_prof_timer_handler handler = prof_timer_handler;
+    void *pc = NULL;
+    int saved_errno = errno;
+
+    (void)sig_num;
+    (void)sig_info;
+
+#if defined(BUILD_TARGET_X86_64) || defined(BUILD_TARGET_AMD_64)
+    pc = (void *)ucontext->uc_mcontext.gregs[REG_RIP];
+#elif defined(BUILD_TARGET_AARCH64)
+    pc = (void *)ucontext->uc_mcontext.pc;
+#else
+    (void)ucontext;
+#endif
+
+    if (handler)
+        handler(pc);
+
+    /* The handler may interrupt a system call of the thread */
+    errno = saved_errno;
+}
+
+int
+os_prof_timer_start(unsigned int interval_us, os_prof_timer_handler handler)
+{
+    struct sigaction sig_act;
+    struct itimerval timer;
+
+    prof_timer_handler = handler;
+
+    memset(&sig_act, 0, sizeof(struct sigaction));
+    sig_act.sa_sigaction = prof_timer_callback;
+    sig_act.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sig_act.sa_mask);
+    if (sigaction(SIGPROF, &sig_act, &prev_sig_act_SIGPROF) != 0) {
+        os_printf("Failed to register SIGPROF handler\n");
+        prof_timer_handler = NULL;
+        return -1;
+    }
+
+    /* ITIMER_PROF counts the CPU time consumed by the process, and the
+       signal is delivered to the thread which is consuming it */
+    timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_interval.tv_usec = interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        os_printf("Failed to start profiling timer\n");
+        sigaction(SIGPROF, &prev_sig_act_SIGPROF, NULL);
+        prof_timer_handler = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void
+os_prof_timer_stop()
+{
+    struct itimerval timer;
+
+    memset(&timer, 0, sizeof(struct itimerval));
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    prof_timer_handler = NULL;
+    /* Ignore the SIGPROF which may be still pending instead of
+       restoring the default action, which terminates the process */
+    if (!(prev_sig_act_SIGPROF.sa_flags & SA_SIGINFO)
+        && prev_sig_act_SIGPROF.sa_handler == SIG_DFL) {
+        prev_sig_act_SIGPROF.sa_handler = SIG_IGN;
+        prev_sig_act_SIGPROF.sa_flags = 0;
+    }
+    sigaction(SIGPROF, &prev_sig_act_SIGPROF, NULL);
+}
+#endif /* end of OS_ENABLE_PROF_TIMER */
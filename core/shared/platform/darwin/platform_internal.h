@@ -100,6 +100,9 @@ os_sigreturn();
 #endif /* end of BUILD_TARGET_X86_64/AMD_64/AARCH64/RISCV64 */
 #endif /* end of WASM_DISABLE_HW_BOUND_CHECK */
 
+/* The file can be mapped into memory with os_mmap_file() */
+#define OS_ENABLE_MMAP_FILE
+
 #ifdef __cplusplus
 }
 #endif
@@ -129,6 +129,23 @@ os_munmap(void *addr, size_t size);
 int
 os_mprotect(void *addr, size_t size, int prot);
 
+#ifdef OS_ENABLE_MMAP_FILE
+/**
+ * Map the whole file into memory privately: the pages which aren't
+ * written are shared with the other processes mapping the same file.
+ *
+ * @param file_path the path of the file
+ * @param prot the protection of the mapped memory, MMAP_PROT_XXX
+ * @param flags the flags of the mapping, MMAP_MAP_XXX
+ * @param p_size return the size of the file
+ *
+ * @return the address of the mapped memory, NULL if failed, it should
+ *         be unmapped with os_munmap()
+ */
+void *
+os_mmap_file(const char *file_path, int prot, int flags, uint32 *p_size);
+#endif
+
 /**
  * Flush cpu data cache, in some CPUs, after applying relocation to the
  * AOT code, the code may haven't been written back to the cpu data cache,
@@ -97,6 +97,21 @@ os_sigreturn();
 #endif /* end of BUILD_TARGET_X86_64/AMD_64/AARCH64/RISCV64 */
 #endif /* end of WASM_DISABLE_HW_BOUND_CHECK */
 
+/* The file can be mapped into memory with os_mmap_file() */
+#define OS_ENABLE_MMAP_FILE
+
+/* The profiling timer which sends SIGPROF to the thread consuming the
+   CPU time periodically, the handler is called with the interrupted pc */
+#define OS_ENABLE_PROF_TIMER
+
+typedef void (*os_prof_timer_handler)(void *pc);
+
+int
+os_prof_timer_start(unsigned int interval_us, os_prof_timer_handler handler);
+
+void
+os_prof_timer_stop();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2019 Intel Corporation.  All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ */
+
+#ifndef _BH_ATOMIC_H
+#define _BH_ATOMIC_H
+
+#include "../platform/include/platform_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Atomic load with acquire semantics and atomic store with release
+ * semantics of a uint32 variable. A thread which loads the value stored
+ * by another thread also sees all the writes done by that thread before
+ * the store, so they can publish data without holding a lock.
+ *
+ * BH_ATOMIC_32_IS_ATOMIC is 0 if the compiler doesn't support them, and
+ * the callers must fall back to a lock.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BH_ATOMIC_32_IS_ATOMIC 1
+#define BH_ATOMIC_32_LOAD_ACQUIRE(v) __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define BH_ATOMIC_32_STORE_RELEASE(v, val) \
+    __atomic_store_n(&(v), (val), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define BH_ATOMIC_32_IS_ATOMIC 1
+/* The Interlocked intrinsics are full barriers */
+#define BH_ATOMIC_32_LOAD_ACQUIRE(v) \
+    ((uint32)_InterlockedOr((volatile long *)&(v), 0))
+#define BH_ATOMIC_32_STORE_RELEASE(v, val) \
+    ((void)_InterlockedExchange((volatile long *)&(v), (long)(val)))
+#else
+#define BH_ATOMIC_32_IS_ATOMIC 0
+#define BH_ATOMIC_32_LOAD_ACQUIRE(v) (v)
+#define BH_ATOMIC_32_STORE_RELEASE(v, val) ((void)((v) = (val)))
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of _BH_ATOMIC_H */
@@ -10,6 +10,7 @@
 #include "../platform/include/platform_api_vmcore.h"
 #include "../platform/include/platform_api_extension.h"
 #include "bh_assert.h"
+#include "bh_atomic.h"
 #include "bh_common.h"
 #include "bh_hashmap.h"
 #include "bh_list.h"
@@ -34,9 +34,51 @@ print_help()
 #endif
     printf("  --stack-size=n           Set maximum stack size in bytes, default is 16 KB\n");
     printf("  --heap-size=n            Set maximum heap size in bytes, default is 16 KB\n");
+    printf("  --loader-threads=n       Set the number of threads to validate and prepare\n");
+    printf("                           the function bodies with when loading the wasm\n");
+    printf("                           file, default is 0 (the main thread only)\n");
 #if WASM_ENABLE_FAST_JIT != 0
     printf("  --jit-codecache-size=n   Set fast jit maximum code cache size in bytes,\n");
     printf("                           default is %u KB\n", FAST_JIT_DEFAULT_CODE_CACHE_SIZE / 1024);
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    printf("  --jit-linear-scan        Use the global linear scan register allocator of\n");
+    printf("                           fast jit\n");
+#endif
+    printf("  --jit-compile-threads=n  Set the number of threads to compile functions with\n");
+    printf("                           fast jit in background, default is 0\n");
+    printf("  --jit-opt-passes=n       Enable the fast jit IR optimization passes, n is\n");
+    printf("                           the bitwise or of 1 (constant folding), 2 (common\n");
+    printf("                           subexpression elimination), 4 (dead code\n");
+    printf("                           elimination) and 8 (bounds check elimination),\n");
+    printf("                           default is 0\n");
+#endif
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    printf("  --jit-cache-dir=<dir>    Save the fast jit jitted code into the existing\n");
+    printf("                           directory and reuse it in the later runs\n");
+#endif
+#if WASM_ENABLE_JIT != 0
+    printf("  --llvm-jit-cache-dir=<dir> Save the object files compiled by llvm jit into\n");
+    printf("                           the existing directory and reuse them in the\n");
+    printf("                           later runs\n");
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    printf("  --jit-tier-up-threshold=n Set the hotness of a function to trigger fast jit\n");
+    printf("                           compilation, default is %u\n", FAST_JIT_DEFAULT_TIER_UP_THRESHOLD);
+#endif
+#if WASM_ENABLE_AOT_PGO != 0
+    printf("  --gen-prof-file=<file>   Save the profile data of the AOT module generated\n");
+    printf("                           by wamrc --enable-llvm-pgo into the file\n");
+#endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    printf("  --sampling-profile=<file> Sample the wasm call stacks and save them into the\n");
+    printf("                           file in the folded stack format\n");
+    printf("  --sampling-interval=n    Set the sampling interval in microseconds, default\n");
+    printf("                           is %u\n", SAMPLING_PROFILER_DEFAULT_INTERVAL);
+#endif
+#if WASM_ENABLE_AOT != 0 && defined(OS_ENABLE_MMAP_FILE)
+    printf("  --map-aot-file           Map the AOT file into memory rather than reading it,\n");
+    printf("                           the code of the AOT file generated by wamrc with\n");
+    printf("                           --enable-indirect-mode is shared by the processes\n");
 #endif
     printf("  --repl                   Start a very simple REPL (read-eval-print-loop) mode\n"
            "                           that runs commands in the form of \"FUNC ARG...\"\n");
@@ -176,6 +218,83 @@ app_instance_repl(wasm_module_inst_t module_inst)
     return NULL;
 }
 
+#if WASM_ENABLE_AOT_PGO != 0
+static void
+dump_pgo_prof_data(wasm_module_inst_t module_inst, const char *path)
+{
+    char *buf;
+    uint32 len;
+    FILE *file;
+
+    if (!(len = wasm_runtime_get_pgo_prof_data_size(module_inst))) {
+        printf("failed to get profile data size, the module isn't "
+               "instrumented by wamrc --enable-llvm-pgo\n");
+        return;
+    }
+
+    if (!(buf = wasm_runtime_malloc(len))) {
+        printf("allocate memory failed\n");
+        return;
+    }
+
+    len = wasm_runtime_dump_pgo_prof_data_to_buf(module_inst, buf, len);
+    if (!len) {
+        printf("failed to dump profile data\n");
+        wasm_runtime_free(buf);
+        return;
+    }
+
+    if (!(file = fopen(path, "wb"))) {
+        printf("failed to create profile file %s\n", path);
+    }
+    else {
+        if (fwrite(buf, 1, len, file) != len)
+            printf("failed to write profile file %s\n", path);
+        fclose(file);
+    }
+
+    wasm_runtime_free(buf);
+}
+#endif
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+static void
+dump_sampling_profile(const char *path)
+{
+    char *buf;
+    uint32 len;
+    FILE *file;
+
+    if (!(len = wasm_runtime_get_sampling_profile_size())) {
+        printf("no sample is recorded by the sampling profiler\n");
+        return;
+    }
+
+    if (!(buf = wasm_runtime_malloc(len))) {
+        printf("allocate memory failed\n");
+        return;
+    }
+
+    len = wasm_runtime_dump_sampling_profile_to_buf(buf, len);
+    if (!len) {
+        printf("failed to dump sampling profile\n");
+        wasm_runtime_free(buf);
+        return;
+    }
+
+    if (!(file = fopen(path, "wb"))) {
+        printf("failed to create sampling profile file %s\n", path);
+    }
+    else {
+        if (fwrite(buf, 1, len, file) != len)
+            printf("failed to write sampling profile file %s\n", path);
+        fclose(file);
+    }
+
+    wasm_runtime_free(buf);
+}
+#endif
+
 #if WASM_ENABLE_LIBC_WASI != 0
 static bool
 validate_env_str(char *env)
@@ -302,8 +421,30 @@ main(int argc, char *argv[])
     uint8 *wasm_file_buf = NULL;
     uint32 wasm_file_size;
     uint32 stack_size = 16 * 1024, heap_size = 16 * 1024;
+    uint32 loader_thread_num = 0;
 #if WASM_ENABLE_FAST_JIT != 0
     uint32 jit_code_cache_size = FAST_JIT_DEFAULT_CODE_CACHE_SIZE;
+    uint32 jit_compile_thread_num = 0;
+    uint32 jit_opt_passes = 0;
+#endif
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    bool jit_linear_scan_regalloc = false;
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    uint32 jit_tier_up_threshold = FAST_JIT_DEFAULT_TIER_UP_THRESHOLD;
+#endif
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    const char *jit_disk_cache_dir = NULL;
+#endif
+#if WASM_ENABLE_JIT != 0
+    const char *llvm_jit_cache_dir = NULL;
+#endif
+#if WASM_ENABLE_AOT_PGO != 0
+    const char *gen_prof_file = NULL;
+#endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    const char *sampling_profile = NULL;
+    uint32 sampling_interval = 0;
 #endif
     wasm_module_t wasm_module = NULL;
     wasm_module_inst_t wasm_module_inst = NULL;
@@ -314,6 +455,7 @@ main(int argc, char *argv[])
 #endif
     bool is_repl_mode = false;
     bool is_xip_file = false;
+    bool is_mapped_aot_file = false;
 #if WASM_ENABLE_LIBC_WASI != 0
     const char *dir_list[8] = { NULL };
     uint32 dir_list_size = 0;
@@ -354,6 +496,11 @@ main(int argc, char *argv[])
         else if (!strcmp(argv[0], "--repl")) {
             is_repl_mode = true;
         }
+#if WASM_ENABLE_AOT != 0 && defined(OS_ENABLE_MMAP_FILE)
+        else if (!strcmp(argv[0], "--map-aot-file")) {
+            is_mapped_aot_file = true;
+        }
+#endif
         else if (!strncmp(argv[0], "--stack-size=", 13)) {
             if (argv[0][13] == '\0')
                 return print_help();
@@ -364,12 +511,72 @@ main(int argc, char *argv[])
                 return print_help();
             heap_size = atoi(argv[0] + 12);
         }
+        else if (!strncmp(argv[0], "--loader-threads=", 17)) {
+            if (argv[0][17] == '\0')
+                return print_help();
+            loader_thread_num = atoi(argv[0] + 17);
+        }
 #if WASM_ENABLE_FAST_JIT != 0
         else if (!strncmp(argv[0], "--jit-codecache-size=", 21)) {
             if (argv[0][21] == '\0')
                 return print_help();
             jit_code_cache_size = atoi(argv[0] + 21);
         }
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+        else if (!strcmp(argv[0], "--jit-linear-scan")) {
+            jit_linear_scan_regalloc = true;
+        }
+#endif
+        else if (!strncmp(argv[0], "--jit-compile-threads=", 22)) {
+            if (argv[0][22] == '\0')
+                return print_help();
+            jit_compile_thread_num = atoi(argv[0] + 22);
+        }
+        else if (!strncmp(argv[0], "--jit-opt-passes=", 17)) {
+            if (argv[0][17] == '\0')
+                return print_help();
+            jit_opt_passes = atoi(argv[0] + 17);
+        }
+#endif
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+        else if (!strncmp(argv[0], "--jit-cache-dir=", 16)) {
+            if (argv[0][16] == '\0')
+                return print_help();
+            jit_disk_cache_dir = argv[0] + 16;
+        }
+#endif
+#if WASM_ENABLE_JIT != 0
+        else if (!strncmp(argv[0], "--llvm-jit-cache-dir=", 21)) {
+            if (argv[0][21] == '\0')
+                return print_help();
+            llvm_jit_cache_dir = argv[0] + 21;
+        }
+#endif
+#if WASM_ENABLE_AOT_PGO != 0
+        else if (!strncmp(argv[0], "--gen-prof-file=", 16)) {
+            if (argv[0][16] == '\0')
+                return print_help();
+            gen_prof_file = argv[0] + 16;
+        }
+#endif
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+        else if (!strncmp(argv[0], "--sampling-profile=", 19)) {
+            if (argv[0][19] == '\0')
+                return print_help();
+            sampling_profile = argv[0] + 19;
+        }
+        else if (!strncmp(argv[0], "--sampling-interval=", 20)) {
+            if (argv[0][20] == '\0')
+                return print_help();
+            sampling_interval = atoi(argv[0] + 20);
+        }
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+        else if (!strncmp(argv[0], "--jit-tier-up-threshold=", 24)) {
+            if (argv[0][24] == '\0')
+                return print_help();
+            jit_tier_up_threshold = atoi(argv[0] + 24);
+        }
 #endif
 #if WASM_ENABLE_LIBC_WASI != 0
         else if (!strncmp(argv[0], "--dir=", 6)) {
@@ -507,8 +714,24 @@ main(int argc, char *argv[])
     init_args.mem_alloc_option.allocator.free_func = free;
 #endif
 
+    init_args.loader_thread_num = loader_thread_num;
+
 #if WASM_ENABLE_FAST_JIT != 0
     init_args.fast_jit_code_cache_size = jit_code_cache_size;
+    init_args.fast_jit_compile_thread_num = jit_compile_thread_num;
+    init_args.fast_jit_opt_passes = jit_opt_passes;
+#endif
+#if WASM_ENABLE_FAST_JIT_LINEAR_SCAN != 0
+    init_args.fast_jit_linear_scan_regalloc = jit_linear_scan_regalloc;
+#endif
+#if WASM_ENABLE_FAST_JIT_TIER_UP != 0
+    init_args.fast_jit_tier_up_threshold = jit_tier_up_threshold;
+#endif
+#if WASM_ENABLE_FAST_JIT_DISK_CACHE != 0
+    init_args.fast_jit_disk_cache_dir = jit_disk_cache_dir;
+#endif
+#if WASM_ENABLE_JIT != 0
+    init_args.llvm_jit_object_cache_dir = llvm_jit_cache_dir;
 #endif
 
 #if WASM_ENABLE_DEBUG_INTERP != 0
@@ -532,6 +755,20 @@ main(int argc, char *argv[])
         native_lib_list, native_lib_count, native_handle_list);
 #endif
 
+#if WASM_ENABLE_MULTI_MODULE != 0
+    wasm_runtime_set_module_reader(module_reader_callback, moudle_destroyer);
+#endif
+
+    if (is_mapped_aot_file) {
+        /* the AOT file is mapped and unmapped by the runtime */
+        if (!(wasm_module = wasm_runtime_load_mapped_aot_file(
+                  wasm_file, error_buf, sizeof(error_buf)))) {
+            printf("%s\n", error_buf);
+            goto fail1;
+        }
+        goto load_succ;
+    }
+
     /* load WASM byte buffer from WASM bin file */
     if (!(wasm_file_buf =
               (uint8 *)bh_read_file_to_buffer(wasm_file, &wasm_file_size)))
@@ -558,10 +795,6 @@ main(int argc, char *argv[])
     }
 #endif
 
-#if WASM_ENABLE_MULTI_MODULE != 0
-    wasm_runtime_set_module_reader(module_reader_callback, moudle_destroyer);
-#endif
-
     /* load WASM module */
     if (!(wasm_module = wasm_runtime_load(wasm_file_buf, wasm_file_size,
                                           error_buf, sizeof(error_buf)))) {
@@ -569,6 +802,8 @@ main(int argc, char *argv[])
         goto fail2;
     }
 
+load_succ:
+
 #if WASM_ENABLE_LIBC_WASI != 0
     wasm_runtime_set_wasi_args(wasm_module, dir_list, dir_list_size, NULL, 0,
                                env_list, env_list_size, argv, argc);
@@ -603,6 +838,14 @@ main(int argc, char *argv[])
     }
 #endif
 
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    if (sampling_profile
+        && !wasm_runtime_start_sampling_profiler(sampling_interval)) {
+        printf("failed to start sampling profiler\n");
+        sampling_profile = NULL;
+    }
+#endif
+
     if (is_repl_mode)
         app_instance_repl(wasm_module_inst);
     else if (func_name)
@@ -610,6 +853,18 @@ main(int argc, char *argv[])
     else
         app_instance_main(wasm_module_inst);
 
+#if WASM_ENABLE_AOT_PGO != 0
+    if (gen_prof_file)
+        dump_pgo_prof_data(wasm_module_inst, gen_prof_file);
+#endif
+
+#if WASM_ENABLE_SAMPLING_PROFILER != 0
+    if (sampling_profile) {
+        wasm_runtime_stop_sampling_profiler();
+        dump_sampling_profile(sampling_profile);
+    }
+#endif
+
     ret = 0;
 
 #if WASM_ENABLE_DEBUG_INTERP != 0
@@ -623,11 +878,14 @@ fail3:
     wasm_runtime_unload(wasm_module);
 
 fail2:
-    /* free the file buffer */
-    if (!is_xip_file)
-        wasm_runtime_free(wasm_file_buf);
-    else
-        os_munmap(wasm_file_buf, wasm_file_size);
+    /* free the file buffer, which isn't allocated for the mapped
+       AOT file */
+    if (wasm_file_buf) {
+        if (!is_xip_file)
+            wasm_runtime_free(wasm_file_buf);
+        else
+            os_munmap(wasm_file_buf, wasm_file_size);
+    }
 
 fail1:
 #if BH_HAS_DLFCN
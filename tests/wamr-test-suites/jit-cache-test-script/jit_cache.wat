@@ -0,0 +1,99 @@
+;; Copyright (C) 2019 Intel Corporation.  All rights reserved.
+;; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+;; Each function embeds some kind of absolute address which is relocated
+;; when its jitted code is loaded from the Fast JIT disk cache:
+;;   fib       the return addresses of CALLBC
+;;   switch    the jump table of LOOKUPSWITCH
+;;   float_ops the libm and conversion wrappers called by CALLNATIVE
+;;   grow      wasm_enlarge_memory
+;;   indirect  fast_jit_call_indirect and the exception of a wrong index
+;;   mem_ops   wasm_fill_memory and wasm_copy_memory
+;;   name_len  fast_jit_invoke_native of an import function
+;;   div       the exception of dividing by zero
+;; and all of them return to the interpreter through the stub.
+
+(module
+  (type $i2i (func (param i32) (result i32)))
+
+  (import "env" "strlen" (func $strlen (param i32) (result i32)))
+
+  (memory 1 4)
+  (data (i32.const 16) "hello, jit cache\00")
+
+  (table 2 funcref)
+  (elem (i32.const 0) $double $square)
+
+  (func $fib (export "fib") (param $n i32) (result i32)
+    (if (result i32) (i32.lt_s (local.get $n) (i32.const 2))
+      (then (local.get $n))
+      (else
+        (i32.add
+          (call $fib (i32.sub (local.get $n) (i32.const 1)))
+          (call $fib (i32.sub (local.get $n) (i32.const 2)))))))
+
+  (func (export "switch") (param $i i32) (result i32)
+    (block $default
+      (block $c
+        (block $b
+          (block $a
+            (br_table $a $b $c $default (local.get $i)))
+          (return (i32.const 100)))
+        (return (i32.const 200)))
+      (return (i32.const 300)))
+    (i32.const 400))
+
+  (func (export "float_ops") (param $n i32) (result f64)
+    (local $x f64)
+    (local.set $x (f64.convert_i32_s (local.get $n)))
+    (f64.add
+      (f64.add
+        (f64.sqrt (local.get $x))
+        (f64.nearest (f64.div (local.get $x) (f64.const 3))))
+      (f64.add
+        (f64.min (local.get $x) (f64.const 2.5))
+        (f64.convert_i64_u
+          (i64.trunc_f64_u (f64.mul (local.get $x) (f64.const 1.5)))))))
+
+  (func (export "grow") (param $n i32) (result i32)
+    (drop (memory.grow (local.get $n)))
+    (memory.size))
+
+  (func $double (type $i2i)
+    (i32.shl (local.get 0) (i32.const 1)))
+
+  (func $square (type $i2i)
+    (i32.mul (local.get 0) (local.get 0)))
+
+  (func (export "indirect") (param $i i32) (result i32)
+    (i32.add
+      (call_indirect (type $i2i) (i32.const 7) (i32.const 0))
+      (call_indirect (type $i2i) (i32.const 7) (local.get $i))))
+
+  (func (export "mem_ops") (param $n i32) (result i32)
+    (memory.fill (i32.const 1024) (local.get $n) (i32.const 64))
+    (memory.copy (i32.const 2048) (i32.const 1024) (i32.const 64))
+    (i32.add
+      (i32.load8_u (i32.const 2048))
+      (i32.load8_u (i32.const 2111))))
+
+  (func (export "name_len") (result i32)
+    (call $strlen (i32.const 16)))
+
+  (func (export "div") (param i32 i32) (result i32)
+    (i32.div_s (local.get 0) (local.get 1)))
+
+  (func (export "sum") (param $n i32) (result i64)
+    (local $i i32)
+    (local $s i64)
+    (block $exit
+      (loop $loop
+        (br_if $exit (i32.ge_s (local.get $i) (local.get $n)))
+        (local.set $s
+          (i64.add (local.get $s)
+                   (i64.extend_i32_s
+                     (i32.mul (local.get $i) (local.get $i)))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $loop)))
+    (local.get $s))
+)
@@ -0,0 +1,138 @@
+#!/usr/bin/env bash
+
+#
+# Copyright (C) 2019 Intel Corporation.  All rights reserved.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#
+
+# Test the Fast JIT disk cache: run the functions of jit_cache.wat with an
+# empty cache directory (cold run) and then again with the saved code
+# (warm run), and check that both runs give the same results as running
+# without the cache, and that the warm run loads every function from the
+# cache at another runtime base, i.e. the saved code is really relocated.
+#
+# usage: jit_cache_test.sh <iwasm> <wat2wasm>
+#   iwasm must be built with WAMR_BUILD_FAST_JIT=1 and
+#   WAMR_BUILD_FAST_JIT_DISK_CACHE=1 as a PIE
+
+readonly IWASM_CMD=$1
+readonly WAT2WASM_CMD=$2
+readonly SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+# The number of functions defined in jit_cache.wat
+readonly FUNC_NUM=11
+# The functions to run and their arguments
+readonly CASES=(
+    "fib 20"
+    "switch 0"
+    "switch 2"
+    "switch 9"
+    "float_ops 10"
+    "grow 2"
+    "indirect 1"
+    "indirect 5"
+    "mem_ops 7"
+    "name_len"
+    "div 7 2"
+    "div 7 0"
+    "sum 1000"
+)
+
+function fail()
+{
+    echo "FAILED: $*"
+    exit 1
+}
+
+# Get the runtime base printed by the disk cache from a verbose log
+function runtime_base()
+{
+    grep -o "runtime base: 0x[0-9a-f]*" "$1" | head -n 1 | cut -d ' ' -f 3
+}
+
+# Run a function: run <log file> <iwasm options> <function> [args...]
+function run()
+{
+    local log=$1
+    local options=$2
+    local func=$3
+    shift 3
+
+    ${IWASM_CMD} ${options} -f ${func} ${WASM_FILE} $* > ${log} 2>&1
+    echo "exit code: $?" >> ${log}
+}
+
+# Run a function without the cache to get the expected output
+function reference()
+{
+    run ${WORK_DIR}/reference.log "" $*
+    grep -v "^\[" ${WORK_DIR}/reference.log
+}
+
+if [[ ! -x ${IWASM_CMD} || ! -x ${WAT2WASM_CMD} ]]; then
+    echo "usage: jit_cache_test.sh <iwasm> <wat2wasm>"
+    exit 1
+fi
+
+if [[ -z $(readelf -h ${IWASM_CMD} | grep "DYN") ]]; then
+    fail "${IWASM_CMD} isn't a position independent executable"
+fi
+
+readonly WORK_DIR=$(mktemp -d)
+trap "rm -rf ${WORK_DIR}" EXIT
+readonly WASM_FILE=${WORK_DIR}/jit_cache.wasm
+readonly CACHE_DIR=${WORK_DIR}/cache
+mkdir ${CACHE_DIR}
+
+${WAT2WASM_CMD} ${SCRIPT_DIR}/jit_cache.wat -o ${WASM_FILE} \
+    || fail "compile jit_cache.wat"
+
+# Cold run: all the functions are compiled and saved into the cache
+echo "cold run: ${CASES[0]}"
+run ${WORK_DIR}/cold.log "-v=4 --jit-cache-dir=${CACHE_DIR}" ${CASES[0]}
+cold_base=$(runtime_base ${WORK_DIR}/cold.log)
+[[ -n ${cold_base} ]] || fail "no runtime base in the log of the cold run"
+
+saved_num=$(grep -c "JIT: save function" ${WORK_DIR}/cold.log)
+file_num=$(ls ${CACHE_DIR}/*.fjc 2> /dev/null | wc -l)
+if [[ ${saved_num} != ${FUNC_NUM} || ${file_num} != ${FUNC_NUM} ]]; then
+    cat ${WORK_DIR}/cold.log
+    fail "${saved_num} functions saved into ${file_num} files in the cold" \
+         "run, expect ${FUNC_NUM}"
+fi
+if [[ -n $(ls ${CACHE_DIR} | grep "\.tmp$") ]]; then
+    fail "temporary files are left in the cache directory"
+fi
+
+expect=$(reference ${CASES[0]})
+result=$(grep -v "^\[" ${WORK_DIR}/cold.log)
+[[ "${result}" == "${expect}" ]] \
+    || fail "cold run of ${CASES[0]}: got '${result}', expect '${expect}'"
+
+# Warm runs: all the functions are loaded from the cache and relocated
+for case in "${CASES[@]}"; do
+    echo "warm run: ${case}"
+    expect=$(reference ${case})
+
+    run ${WORK_DIR}/warm.log "-v=4 --jit-cache-dir=${CACHE_DIR}" ${case}
+    result=$(grep -v "^\[" ${WORK_DIR}/warm.log)
+    [[ "${result}" == "${expect}" ]] \
+        || fail "warm run of ${case}: got '${result}', expect '${expect}'"
+
+    loaded_num=$(grep -c "JIT: load function" ${WORK_DIR}/warm.log)
+    if [[ ${loaded_num} != ${FUNC_NUM} \
+          || -n $(grep "JIT: save function" ${WORK_DIR}/warm.log) ]]; then
+        cat ${WORK_DIR}/warm.log
+        fail "warm run of ${case}: ${loaded_num} functions loaded from" \
+             "the cache, expect ${FUNC_NUM}"
+    fi
+
+    warm_base=$(runtime_base ${WORK_DIR}/warm.log)
+    if [[ ${warm_base} == ${cold_base} ]]; then
+        fail "warm run of ${case}: the runtime is loaded at the same base" \
+             "${cold_base} as the cold run, is ASLR disabled?"
+    fi
+    echo "    same result, runtime base ${cold_base} -> ${warm_base}"
+done
+
+echo "jit cache test passed"
+exit 0
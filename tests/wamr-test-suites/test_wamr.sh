@@ -384,9 +384,10 @@ function spec_test()
         fi
     fi
 
-    # simd only enable in jit mode and aot mode
+    # simd is enabled in interpreter mode, jit mode and aot mode
     if [[ ${ENABLE_SIMD} == 1 ]]; then
-        if [[ $1 == 'jit' || $1 == 'aot' ]]; then
+        if [[ $1 == 'classic-interp' || $1 == 'fast-interp' \
+              || $1 == 'jit' || $1 == 'aot' ]]; then
           ARGS_FOR_SPEC_TEST+="-S "
         fi
     fi
@@ -477,6 +478,41 @@ function standalone_test()
     ./standalone.sh $args | tee ${REPORT_DIR}/standalone_$1_test_report.txt
 }
 
+function jit_cache_test()
+{
+    if [[ $1 != "fast-jit" || ${SGX_OPT} == "--sgx" ]]; then
+        echo "jit cache test only runs in fast-jit mode on linux"
+        return 0
+    fi
+
+    echo "Now start jit cache tests"
+
+    local WAT2WASM=${WORK_DIR}/wabt/out/gcc/Release/wat2wasm
+    if [[ ! -x ${WAT2WASM} ]]; then
+        WAT2WASM=$(command -v wat2wasm)
+    fi
+    if [[ -z ${WAT2WASM} ]]; then
+        echo "wat2wasm is required, run the spec test first or install wabt"
+        exit 1
+    fi
+
+    # the functions are compiled at load time, so that all of them are
+    # saved into the cache by the first run
+    build_iwasm_with_cfg $BUILD_FLAGS \
+        -DWAMR_BUILD_FAST_JIT_DISK_CACHE=1 -DWAMR_BUILD_FAST_JIT_TIER_UP=0
+
+    cd ${WORK_DIR}/../jit-cache-test-script
+    ./jit_cache_test.sh ${IWASM_CMD} ${WAT2WASM} \
+        | tee ${REPORT_DIR}/jit_cache_test_report.txt
+    [[ ${PIPESTATUS[0]} -ne 0 ]] && exit 1
+    cd -
+
+    # restore iwasm for the following suites
+    build_iwasm_with_cfg $BUILD_FLAGS
+
+    echo "Finish jit cache tests"
+}
+
 function build_iwasm_with_cfg()
 {
     echo "Build iwasm with compile flags with " $* " for spec test" \
@@ -572,11 +608,6 @@ function trigger()
     for t in "${TYPE[@]}"; do
         case $t in
             "classic-interp")
-                if [[ ${ENABLE_SIMD} == 1 ]]; then
-                    echo "does not support SIMD in interp mode, bypass"
-                    continue
-                fi
-
                 echo "work in classic-interp mode"
                 # classic-interp
                 BUILD_FLAGS="$CLASSIC_INTERP_COMPILE_FLAGS $EXTRA_COMPILE_FLAGS"
@@ -588,11 +619,6 @@ function trigger()
             ;;
 
             "fast-interp")
-                if [[ ${ENABLE_SIMD} == 1 ]]; then
-                    echo "does not support SIMD in interp mode, bypass"
-                    continue
-                fi
-
                 echo "work in fast-interp mode"
                 # fast-interp
                 BUILD_FLAGS="$FAST_INTERP_COMPILE_FLAGS $EXTRA_COMPILE_FLAGS"
@@ -639,6 +665,11 @@ function trigger()
             ;;
 
             "fast-jit")
+                if [[ ${ENABLE_SIMD} == 1 ]]; then
+                    echo "does not support SIMD in fast-jit mode, bypass"
+                    continue
+                fi
+
                 echo "work in fast-jit mode"
                 # jit
                 BUILD_FLAGS="$FAST_JIT_COMPILE_FLAGS $EXTRA_COMPILE_FLAGS"
@@ -57,6 +57,22 @@ print_help()
     printf("  --enable-indirect-mode    Enalbe call function through symbol table but not direct call\n");
     printf("  --disable-llvm-intrinsics Disable the LLVM built-in intrinsics\n");
     printf("  --disable-llvm-lto        Disable the LLVM link time optimization\n");
+    printf("  --threads=n               Split the functions into n modules and optimize and codegen them\n");
+    printf("                            in n threads, currently it is supported for x86-64 and aarch64\n");
+    printf("                            targets and AoT file format only, default is 1\n");
+    printf("  --cache-dir=<dir>         Save the object code of the functions into the existing directory,\n");
+    printf("                            keyed by their content and the compile options, and reuse it in\n");
+    printf("                            the later compilations, so that only the changed functions are\n");
+    printf("                            compiled again, the same targets as --threads are supported\n");
+    printf("  --enable-llvm-pgo         Instrument the AoT code to record the function entry counts, branch\n");
+    printf("                            counts and call_indirect targets, the profile data can be saved\n");
+    printf("                            by iwasm --gen-prof-file=<file>, see also --use-prof\n");
+    printf("  --use-prof=<file>         Use the profile data to set the branch weights and function entry\n");
+    printf("                            counts, which guide the LLVM inlining and hot/cold code splitting\n");
+    printf("  --bundle=<name>:<file>    Link the wasm module in the file, which is imported by the other\n");
+    printf("                            modules with the module name, into the AoT file, so that the\n");
+    printf("                            calls to it become direct calls, use it again to bundle more\n");
+    printf("                            modules, the modules must share one linear memory\n");
     printf("  --emit-custom-sections=<section names>\n");
     printf("                            Emit the specified custom sections to AoT file, using comma to separate\n");
     printf("                            multiple names, e.g.\n");
@@ -66,6 +82,7 @@ print_help()
     printf("Examples: wamrc -o test.aot test.wasm\n");
     printf("          wamrc --target=i386 -o test.aot test.wasm\n");
     printf("          wamrc --target=i386 --format=object -o test.o test.wasm\n");
+    printf("          wamrc --bundle=libm:libm.wasm -o test.aot test.wasm\n");
 }
 /* clang-format on */
 
@@ -118,11 +135,66 @@ split_string(char *str, int *count, const char *delimer)
     return res;
 }
 
+/**
+ * Read the bundled wasm modules and link them with the main module
+ * Returns the bundle, or NULL on failure
+ * Memory must be freed by caller with wasm_runtime_free
+ */
+static uint8 *
+bundle_wasm_modules(char **bundle_args, uint32 bundle_count,
+                    uint8 *wasm_file, uint32 *p_wasm_file_size)
+{
+    AOTBundleModule *modules;
+    uint8 *bundle = NULL;
+    char *file_name;
+    uint32 i;
+
+    if (!(modules = calloc(bundle_count + 1, sizeof(AOTBundleModule)))) {
+        printf("Failed to bundle wasm modules: alloc memory failed\n");
+        return NULL;
+    }
+
+    for (i = 0; i < bundle_count; i++) {
+        /* <name>:<file> */
+        file_name = strchr(bundle_args[i], ':');
+        *file_name++ = '\0';
+        modules[i].name = bundle_args[i];
+        if (!(modules[i].buf = (uint8 *)bh_read_file_to_buffer(
+                  file_name, &modules[i].size)))
+            goto fail;
+        if (get_package_type(modules[i].buf, modules[i].size)
+            != Wasm_Module_Bytecode) {
+            printf("Invalid file type of %s: expected wasm file but got "
+                   "other\n",
+                   file_name);
+            goto fail;
+        }
+    }
+
+    /* the main module is the last one */
+    modules[bundle_count].buf = wasm_file;
+    modules[bundle_count].size = *p_wasm_file_size;
+
+    if (!(bundle = aot_bundle_wasm_modules(modules, bundle_count + 1,
+                                           p_wasm_file_size)))
+        printf("%s\n", aot_get_last_error());
+
+fail:
+    for (i = 0; i < bundle_count; i++) {
+        if (modules[i].buf)
+            wasm_runtime_free((uint8 *)modules[i].buf);
+    }
+    free(modules);
+    return bundle;
+}
+
 int
 main(int argc, char *argv[])
 {
     char *wasm_file_name = NULL, *out_file_name = NULL;
-    uint8 *wasm_file = NULL;
+    char **bundle_args = NULL;
+    uint32 bundle_count = 0;
+    uint8 *wasm_file = NULL, *bundle;
     uint32 wasm_file_size;
     wasm_module_t wasm_module = NULL;
     aot_comp_data_t comp_data = NULL;
@@ -253,6 +325,37 @@ main(int argc, char *argv[])
         else if (!strcmp(argv[0], "--disable-llvm-lto")) {
             option.disable_llvm_lto = true;
         }
+        else if (!strncmp(argv[0], "--threads=", 10)) {
+            if (argv[0][10] == '\0')
+                PRINT_HELP_AND_EXIT();
+            option.thread_num = (uint32)atoi(argv[0] + 10);
+        }
+        else if (!strncmp(argv[0], "--cache-dir=", 12)) {
+            if (argv[0][12] == '\0')
+                PRINT_HELP_AND_EXIT();
+            option.cache_dir = argv[0] + 12;
+        }
+        else if (!strcmp(argv[0], "--enable-llvm-pgo")) {
+            option.enable_llvm_pgo = true;
+        }
+        else if (!strncmp(argv[0], "--use-prof=", 11)) {
+            if (argv[0][11] == '\0')
+                PRINT_HELP_AND_EXIT();
+            option.use_prof_file = argv[0] + 11;
+        }
+        else if (!strncmp(argv[0], "--bundle=", 9)) {
+            char **bundle_args1 = bundle_args;
+
+            if (argv[0][9] == ':' || !strchr(argv[0] + 9, ':'))
+                PRINT_HELP_AND_EXIT();
+            if (!(bundle_args = (char **)realloc(
+                      bundle_args1, sizeof(char *) * (bundle_count + 1)))) {
+                free(bundle_args1);
+                printf("Failed to process bundle: alloc memory failed\n");
+                PRINT_HELP_AND_EXIT();
+            }
+            bundle_args[bundle_count++] = argv[0] + 9;
+        }
         else if (!strncmp(argv[0], "--emit-custom-sections=", 23)) {
             int len = 0;
             if (option.custom_sections) {
@@ -340,6 +443,16 @@ main(int argc, char *argv[])
         goto fail2;
     }
 
+    if (bundle_count > 0) {
+        bh_print_time("Begin to bundle wasm modules");
+
+        if (!(bundle = bundle_wasm_modules(bundle_args, bundle_count,
+                                           wasm_file, &wasm_file_size)))
+            goto fail2;
+        wasm_runtime_free(wasm_file);
+        wasm_file = bundle;
+    }
+
     /* load WASM module */
     if (!(wasm_module = wasm_runtime_load(wasm_file, wasm_file_size, error_buf,
                                           sizeof(error_buf)))) {
@@ -353,7 +466,9 @@ main(int argc, char *argv[])
     }
 
 #if WASM_ENABLE_DEBUG_AOT != 0
-    if (!create_dwarf_extractor(comp_data, wasm_file_name)) {
+    /* the debug information isn't kept in the bundle */
+    if (bundle_count == 0
+        && !create_dwarf_extractor(comp_data, wasm_file_name)) {
         printf("%s:create dwarf extractor failed\n", wasm_file_name);
     }
 #endif
@@ -426,6 +541,9 @@ fail0:
     if (option.custom_sections) {
         free(option.custom_sections);
     }
+    if (bundle_args) {
+        free(bundle_args);
+    }
 
     bh_print_time("wamrc return");
     return exit_status;